@@ -31,6 +31,15 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
   /// because a recording can outlive the `repl` stream that started it (the app
   /// context keeps the app -- and the recording -- alive across reconnects).
   private let replRecordingCoordinator: ReplRecordingCoordinator
+  /// Files copied out of their container for ranged pulls. Held at target scope so
+  /// that the many range requests of one pull, and a resumed pull, share the copy.
+  private let pullStagingCache = PullStagingCache()
+  /// Named HID gestures, expanded once. Held at target scope so that a gesture defined on one
+  /// call can be performed by the calls after it.
+  private let hidGestures = HIDGestureCache()
+  /// The last accessibility tree each client session read. Held at target scope so that a read can
+  /// be sent as a diff from the one before it.
+  private let accessibilitySnapshots = AccessibilitySnapshotCache()
 
   init(
     target: FBiOSTarget,
@@ -51,6 +60,11 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
       auxillaryDirectory: commandExecutor.auxillaryDirectory, logger: target.logger)
   }
 
+  /// Deletes the files staged for ranged pulls. Called once the companion is stopping.
+  func tearDown() async {
+    await pullStagingCache.removeAll()
+  }
+
   /// Wraps a telemetry-reported call so it is also tracked as in-flight by
   /// `idleMonitor` (a no-op when idle shutdown is disabled). Telemetry and idle
   /// tracking stay independent; the provider composes them here.
@@ -158,7 +172,7 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
   func accessibility_info(request: Idb_AccessibilityInfoRequest, context: GRPCAsyncServerCallContext) async throws -> Idb_AccessibilityInfoResponse {
     return try await trackedUnaryCall("accessibility_info", request: request) {
       try await FBTeardownContext.withAutocleanup {
-        try await AccessibilityInfoMethodHandler(commandExecutor: commandExecutor)
+        try await AccessibilityInfoMethodHandler(commandExecutor: commandExecutor, snapshots: accessibilitySnapshots)
           .handle(request: request, context: context)
       }
     }
@@ -185,7 +199,7 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
   func hid(requestStream: GRPCAsyncRequestStream<Idb_HIDEvent>, context: GRPCAsyncServerCallContext) async throws -> Idb_HIDResponse {
     return try await trackedClientStreaming("hid") {
       try await FBTeardownContext.withAutocleanup {
-        try await HidMethodHandler(commandExecutor: commandExecutor)
+        try await HidMethodHandler(commandExecutor: commandExecutor, gestures: hidGestures)
           .handle(requestStream: requestStream, context: context)
       }
     }
@@ -347,7 +361,7 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
   func add_media(requestStream: GRPCAsyncRequestStream<Idb_AddMediaRequest>, context: GRPCAsyncServerCallContext) async throws -> Idb_AddMediaResponse {
     return try await trackedClientStreaming("add_media") {
       try await FBTeardownContext.withAutocleanup {
-        try await AddMediaMethodHandler(commandExecutor: commandExecutor)
+        try await AddMediaMethodHandler(commandExecutor: commandExecutor, targetLogger: targetLogger)
           .handle(requestStream: requestStream, context: context)
       }
     }
@@ -482,7 +496,7 @@ final class CompanionServiceProvider: Idb_CompanionServiceAsyncProvider, @unchec
   func pull(request: Idb_PullRequest, responseStream: GRPCAsyncResponseStreamWriter<Idb_PullResponse>, context: GRPCAsyncServerCallContext) async throws {
     try await trackedServerStreaming("pull", request: request) {
       try await FBTeardownContext.withAutocleanup {
-        try await PullMethodHandler(target: target, commandExecutor: commandExecutor)
+        try await PullMethodHandler(target: target, commandExecutor: commandExecutor, stagingCache: pullStagingCache)
           .handle(request: request, responseStream: responseStream, context: context)
       }
     }
@@ -25,7 +25,7 @@ final class GRPCSwiftServer: @unchecked Sendable {
   }
 
   private var server: EventLoopFuture<Server>?
-  private let provider: CallHandlerProvider
+  private let provider: CompanionServiceProvider
   private let logger: FBIDBLogger
 
   private let serverConfig: Server.Configuration
@@ -148,6 +148,12 @@ final class GRPCSwiftServer: @unchecked Sendable {
     }
   }
 
+  /// Releases what the server's calls left behind for the calls after them. Call once
+  /// the companion is stopping, whether or not the server has closed.
+  func tearDown() async {
+    await provider.tearDown()
+  }
+
   private func cleanupUnixDomainSocket(path: String) throws {
     do {
       self.logger.info().log("Cleaning up UDS if exists")
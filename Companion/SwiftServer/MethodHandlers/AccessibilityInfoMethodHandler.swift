@@ -15,6 +15,7 @@ import IDBGRPCSwift
 struct AccessibilityInfoMethodHandler {
 
   let commandExecutor: FBIDBCommandExecutor
+  let snapshots: AccessibilitySnapshotCache
 
   func handle(request: Idb_AccessibilityInfoRequest, context: GRPCAsyncServerCallContext) async throws -> Idb_AccessibilityInfoResponse {
     let format = AccessibilityInfoRequestTranslation.outputFormat(from: request.format)
@@ -30,9 +31,45 @@ struct AccessibilityInfoMethodHandler {
     let options = try AccessibilityInfoRequestTranslation.options(from: request, format: format)
     let response = try await commandExecutor.accessibility_info_at_point(
       AccessibilityInfoRequestTranslation.point(from: request), options: options, backend: backend)
+    if let snapshot = try Self.snapshotResponse(from: response, format: format, request: request, snapshots: snapshots) {
+      return snapshot
+    }
     let jsonData = try AccessibilityInfoRequestTranslation.responseJSON(from: response, format: format)
     return .with {
       $0.json = String(data: jsonData, encoding: .utf8) ?? ""
     }
   }
+
+  /// The response to a snapshot read: the tree is kept in the session, and described as a diff from the
+  /// client's base when it still matches and the diff is the smaller. Nil for a read that is not kept —
+  /// one with no session, a `complete` document, or a point read — which is answered as any other.
+  static func snapshotResponse(
+    from response: FBAccessibilityElementsResponse,
+    format: FBAccessibilityOutputFormat,
+    request: Idb_AccessibilityInfoRequest,
+    snapshots: AccessibilitySnapshotCache
+  ) throws -> Idb_AccessibilityInfoResponse? {
+    guard !request.snapshotSession.isEmpty, format != .complete, !request.hasPoint,
+      let tree = response.elements.legacyFoundationObject as? AccessibilitySnapshotCache.Tree
+    else {
+      return nil
+    }
+    // The same bytes `legacyJSON` would produce, serialized from the object kept.
+    let jsonData = try JSONSerialization.data(withJSONObject: tree)
+    let snapshot = snapshots.snapshot(tree, session: request.snapshotSession, baseVersion: request.baseVersion)
+    if let diff = snapshot.diff {
+      let diffData = try JSONSerialization.data(withJSONObject: diff)
+      if diffData.count < jsonData.count {
+        return .with {
+          $0.version = snapshot.version
+          $0.baseVersion = request.baseVersion
+          $0.diff = String(data: diffData, encoding: .utf8) ?? ""
+        }
+      }
+    }
+    return .with {
+      $0.version = snapshot.version
+      $0.json = String(data: jsonData, encoding: .utf8) ?? ""
+    }
+  }
 }
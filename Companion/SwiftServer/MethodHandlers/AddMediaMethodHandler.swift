@@ -13,11 +13,12 @@ import IDBGRPCSwift
 struct AddMediaMethodHandler {
 
   let commandExecutor: FBIDBCommandExecutor
+  let targetLogger: FBControlCoreLogger
 
   func handle(requestStream: GRPCAsyncRequestStream<Idb_AddMediaRequest>, context: GRPCAsyncServerCallContext) async throws -> Idb_AddMediaResponse {
     let extractedFileURLs =
       try await MultisourceFileReader
-      .filePathURLs(from: requestStream, temporaryDirectory: commandExecutor.temporaryDirectory, extractFromSubdir: true)
+      .filePathURLs(from: requestStream, temporaryDirectory: commandExecutor.temporaryDirectory, extractFromSubdir: true, logger: targetLogger)
 
     try await commandExecutor.add_media(extractedFileURLs)
     return .init()
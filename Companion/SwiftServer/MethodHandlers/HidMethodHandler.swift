@@ -14,16 +14,69 @@ import IDBGRPCSwift
 struct HidMethodHandler {
 
   let commandExecutor: FBIDBCommandExecutor
+  let gestures: HIDGestureCache
+
+  /// The most events one batch may carry. A 200 character string typed with shift is about 800.
+  static let maxBatchEvents = 16_384
 
   func handle(requestStream: GRPCAsyncRequestStream<Idb_HIDEvent>, context: GRPCAsyncServerCallContext) async throws -> Idb_HIDResponse {
     for try await request in requestStream {
-      let event = try fbSimulatorHIDEvent(from: request)
-      try await commandExecutor.hid(event)
+      switch request.event {
+      case let .batch(batch):
+        // Nothing is sent unless all of it can be, so an invalid event cannot leave half a gesture behind.
+        let events = try Self.fbSimulatorHIDEvents(from: batch.events)
+        try await commandExecutor.hid_batch(events)
+      case let .defineGesture(definition):
+        try Self.define(definition, in: gestures)
+      case let .gesture(gesture):
+        guard let timeline = gestures.timeline(named: gesture.name) else {
+          throw GRPCStatus(code: .notFound, message: "No gesture named '\(gesture.name)' is defined")
+        }
+        try await commandExecutor.hid_timeline(timeline)
+      default:
+        let event = try Self.fbSimulatorHIDEvent(from: request)
+        try await commandExecutor.hid(event)
+      }
     }
     return .init()
   }
 
-  private func fbSimulatorHIDEvent(from request: Idb_HIDEvent) throws -> FBSimulatorHIDEvent {
+  /// Checks and expands a gesture's events once, so that performing it sends them as they are.
+  static func define(_ definition: Idb_HIDEvent.HIDGestureDefinition, in gestures: HIDGestureCache) throws {
+    guard !definition.name.isEmpty else {
+      throw GRPCStatus(code: .invalidArgument, message: "A gesture must have a name")
+    }
+    guard !definition.events.isEmpty else {
+      gestures.remove(definition.name)
+      return
+    }
+    let events = try fbSimulatorHIDEvents(from: definition.events)
+    gestures.define(definition.name, timeline: FBSimulatorHIDTimeline(.composite(events)))
+  }
+
+  static func fbSimulatorHIDEvents(from requests: [Idb_HIDEvent]) throws -> [FBSimulatorHIDEvent] {
+    guard requests.count <= maxBatchEvents else {
+      throw GRPCStatus(code: .invalidArgument, message: "A batch may not have more than \(maxBatchEvents) events, got \(requests.count)")
+    }
+    return try requests.enumerated().map { index, request in
+      do {
+        switch request.event {
+        case .batch, .defineGesture, .gesture:
+          throw GRPCStatus(code: .invalidArgument, message: "Batches and gestures may not be nested")
+        case let .delay(delay) where !(delay.duration.isFinite && delay.duration >= 0):
+          throw GRPCStatus(code: .invalidArgument, message: "Invalid delay duration \(delay.duration)")
+        case let .swipe(swipe) where !(swipe.duration.isFinite && swipe.duration >= 0):
+          throw GRPCStatus(code: .invalidArgument, message: "Invalid swipe duration \(swipe.duration)")
+        default:
+          return try fbSimulatorHIDEvent(from: request)
+        }
+      } catch let status as GRPCStatus {
+        throw GRPCStatus(code: status.code, message: "Event \(index) of batch: \(status.message ?? "invalid")")
+      }
+    }
+  }
+
+  static func fbSimulatorHIDEvent(from request: Idb_HIDEvent) throws -> FBSimulatorHIDEvent {
     switch request.event {
     case let .press(press):
       switch press.action.action {
@@ -93,12 +146,15 @@ struct HidMethodHandler {
     case .shake:
       return .shake
 
+    case .batch, .defineGesture, .gesture:
+      throw GRPCStatus(code: .invalidArgument, message: "Unexpected batch or gesture")
+
     case .none:
       throw GRPCStatus(code: .invalidArgument, message: "Unrecognized request.event")
     }
   }
 
-  private func fbSimulatorHIDDeviceOrientation(from request: Idb_HIDEvent.HIDOrientationType) -> FBSimulatorHIDDeviceOrientation? {
+  private static func fbSimulatorHIDDeviceOrientation(from request: Idb_HIDEvent.HIDOrientationType) -> FBSimulatorHIDDeviceOrientation? {
     switch request {
     case .portrait:
       return .portrait
@@ -113,7 +169,7 @@ struct HidMethodHandler {
     }
   }
 
-  private func fbSimulatorHIDButton(from request: Idb_HIDEvent.HIDButtonType) -> FBSimulatorHIDButton? {
+  private static func fbSimulatorHIDButton(from request: Idb_HIDEvent.HIDButtonType) -> FBSimulatorHIDButton? {
     switch request {
     case .applePay:
       return .applePay
@@ -79,15 +79,42 @@ struct InstallMethodHandler: @unchecked Sendable {
       request = try await requestStream.requiredNext
     }
 
-    var payload = try extractPayloadFromRequest()
+    if case let .manifest(manifest) = request.value {
+      guard destination == .app else {
+        throw GRPCStatus(code: .invalidArgument, message: "Manifest installs are only supported for apps")
+      }
+      return try await installManifest(
+        manifest,
+        requestStream: requestStream,
+        responseStream: responseStream,
+        makeDebuggable: makeDebuggable,
+        overrideModificationTime: overrideModificationTime)
+    }
 
     var compression = FBCompressionFormat.GZIP
-    if case let .compression(format) = payload.source {
+    if case let .payload(payload) = request.value, case let .compression(format) = payload.source {
       compression = readCompressionFormat(from: format)
       request = try await requestStream.requiredNext
-      payload = try extractPayloadFromRequest()
     }
 
+    var cacheDigest: String?
+    if case let .bundleDigest(digest) = request.value {
+      if let artifact = try await installCachedBundle(
+        digest,
+        to: destination,
+        responseStream: responseStream,
+        makeDebuggable: makeDebuggable,
+        overrideModificationTime: overrideModificationTime,
+        skipSigningBundles: skipSigningBundles)
+      {
+        return artifact
+      }
+      cacheDigest = digest
+      request = try await requestStream.requiredNext
+    }
+
+    let payload = try extractPayloadFromRequest()
+
     return try await installData(
       from: payload.source,
       to: destination,
@@ -97,7 +124,36 @@ struct InstallMethodHandler: @unchecked Sendable {
       linkToBundle: linkToBundle,
       compression: compression,
       overrideModificationTime: overrideModificationTime,
-      skipSigningBundles: skipSigningBundles)
+      skipSigningBundles: skipSigningBundles,
+      cacheDigest: cacheDigest)
+  }
+
+  /// Answers a bundle digest hint, installing from the host's cache on a hit.
+  /// Returns nil on a miss, in which case the client goes on to send the payload.
+  private func installCachedBundle(
+    _ digest: String,
+    to destination: Idb_InstallRequest.Destination,
+    responseStream: GRPCAsyncResponseStreamWriter<Idb_InstallResponse>,
+    makeDebuggable: Bool,
+    overrideModificationTime: Bool,
+    skipSigningBundles: Bool
+  ) async throws -> FBInstalledArtifact? {
+    guard destination == .app || destination == .xctest else {
+      throw GRPCStatus(code: .invalidArgument, message: "Bundle digests are only supported for apps and xctests")
+    }
+    guard FBInstallArtifactCache.isValidDigest(digest) else {
+      throw GRPCStatus(code: .invalidArgument, message: "Invalid bundle digest \(digest)")
+    }
+    let cached = commandExecutor.storageManager.installCache.hasArtifact(forDigest: digest)
+    targetLogger.log("Bundle \(digest) is \(cached ? "" : "not ")in the artifact cache")
+    try await responseStream.send(Idb_InstallResponse.with { $0.bundleCached = cached })
+    guard cached else {
+      return nil
+    }
+    if destination == .app {
+      return try await commandExecutor.install_app_cached(digest, make_debuggable: makeDebuggable, override_modification_time: overrideModificationTime)
+    }
+    return try await commandExecutor.install_xctest_app_cached(digest, skipSigningBundles: skipSigningBundles)
   }
 
   private func installData(
@@ -109,15 +165,16 @@ struct InstallMethodHandler: @unchecked Sendable {
     linkToBundle: FBDsymInstallLinkToBundle?,
     compression: FBCompressionFormat,
     overrideModificationTime: Bool,
-    skipSigningBundles: Bool
+    skipSigningBundles: Bool,
+    cacheDigest: String?
   ) async throws -> FBInstalledArtifact {
 
     func installSource(dataStream: FBProcessInput<AnyObject>, skipSigningBundles: Bool) async throws -> FBInstalledArtifact {
       switch destination {
       case .app:
-        return try await commandExecutor.install_app_stream(dataStream, compression: compression, make_debuggable: makeDebuggable, override_modification_time: overrideModificationTime)
+        return try await commandExecutor.install_app_stream(dataStream, compression: compression, make_debuggable: makeDebuggable, override_modification_time: overrideModificationTime, cache_digest: cacheDigest)
       case .xctest:
-        return try await commandExecutor.install_xctest_app_stream(dataStream, skipSigningBundles: skipSigningBundles)
+        return try await commandExecutor.install_xctest_app_stream(dataStream, skipSigningBundles: skipSigningBundles, cache_digest: cacheDigest)
       case .dsym:
         return try await commandExecutor.install_dsym_stream(dataStream, compression: compression, linkTo: linkToBundle)
       case .dylib:
@@ -178,6 +235,64 @@ struct InstallMethodHandler: @unchecked Sendable {
     }
   }
 
+  private func installManifest(
+    _ manifest: Idb_InstallRequest.Manifest,
+    requestStream: GRPCAsyncRequestStream<Idb_InstallRequest>,
+    responseStream: GRPCAsyncResponseStreamWriter<Idb_InstallResponse>,
+    makeDebuggable: Bool,
+    overrideModificationTime: Bool
+  ) async throws -> FBInstalledArtifact {
+    let entries = try manifest.entries.map(readManifestEntry)
+    let missing = commandExecutor.storageManager.content.missingDigests(entries)
+    targetLogger.log("Manifest has \(entries.count) entries, \(missing.count) files need uploading")
+    try await responseStream.send(Idb_InstallResponse.with { $0.missingDigests = missing })
+
+    if missing.isEmpty {
+      return try await commandExecutor.install_app_manifest(entries, blobs: nil, compression: .GZIP, make_debuggable: makeDebuggable, override_modification_time: overrideModificationTime)
+    }
+
+    var request = try await requestStream.requiredNext
+    var compression = FBCompressionFormat.GZIP
+    if case let .payload(payload) = request.value, case let .compression(format) = payload.source {
+      compression = readCompressionFormat(from: format)
+      request = try await requestStream.requiredNext
+    }
+    guard let data = request.extractDataFrame() else {
+      throw GRPCStatus(code: .invalidArgument, message: "Expected an archive of the missing files after the manifest")
+    }
+
+    let input = FBProcessInput<OutputStream>.fromStream()
+    let output = input.contents
+    async let writePayload: Void = writePayload(initial: data, requestStream: requestStream, output: output)
+    let artifact = try await commandExecutor.install_app_manifest(
+      entries,
+      blobs: unsafeBitCast(input, to: FBProcessInput<AnyObject>.self),
+      compression: compression,
+      make_debuggable: makeDebuggable,
+      override_modification_time: overrideModificationTime)
+    try await writePayload
+    return artifact
+  }
+
+  private func readManifestEntry(_ entry: Idb_InstallRequest.Manifest.Entry) throws -> FBContentManifestEntry {
+    let kind: FBContentManifestEntry.Kind
+    switch entry.kind {
+    case .file:
+      kind = .file
+    case .directory:
+      kind = .directory
+    case .symlink:
+      kind = .symlink
+    case .UNRECOGNIZED:
+      throw GRPCStatus(code: .invalidArgument, message: "Unrecognized manifest entry kind for \(entry.path)")
+    }
+    // The digest names a file in the content store, so it must be exactly a sha256 in hex.
+    if kind == .file && (entry.digest.count != 64 || !entry.digest.allSatisfy { $0.isHexDigit && !$0.isUppercase }) {
+      throw GRPCStatus(code: .invalidArgument, message: "Invalid digest \(entry.digest) for \(entry.path)")
+    }
+    return FBContentManifestEntry(path: entry.path, kind: kind, digest: entry.digest, mode: UInt16(truncatingIfNeeded: entry.mode), symlinkDestination: entry.symlinkDestination)
+  }
+
   private func isZipArchive(_ data: Data) -> Bool {
     data.starts(with: [0x50, 0x4B, 0x03, 0x04])
   }
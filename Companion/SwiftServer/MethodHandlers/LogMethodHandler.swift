@@ -18,20 +18,21 @@ struct LogMethodHandler: @unchecked Sendable {
   let commandExecutor: FBIDBCommandExecutor
 
   func handle(request: Idb_LogRequest, responseStream: GRPCAsyncResponseStreamWriter<Idb_LogResponse>, context: GRPCAsyncServerCallContext) async throws {
-    let writingDone = AsyncPromise<Void>()
-    let streamWriter = FIFOStreamWriter(stream: responseStream)
-
-    let consumer = FBBlockDataConsumer.synchronousDataConsumer { data in
-      if writingDone.isResolved {
-        return
-      }
-      let response = Idb_LogResponse.with {
-        $0.output = data
+    // Logs arrive in many small writes, so they are coalesced into fewer, larger responses.
+    // The consumer never waits on the stream; output beyond the buffer is dropped and counted.
+    let output = CoalescingByteStream(configuration: OutputBatchingValueTransformer.configuration(from: request.hasBatching ? request.batching : nil))
+    defer { output.finish() }
+    // Entries are filtered here, before they are batched, so that only those wanted are sent.
+    let filter = try LogFilterValueTransformer.filter(from: request.filter)
+    let format = LogFilterValueTransformer.outputFormat(from: request.format)
+    let consumer: any FBDataConsumer
+    if filter.isEmpty && format == .text {
+      consumer = FBBlockDataConsumer.synchronousDataConsumer { data in
+        output.consume(data)
       }
-      do {
-        try streamWriter.send(response)
-      } catch {
-        writingDone.fail(error)
+    } else {
+      consumer = LogFilterStage.consumer(filter: filter, format: format) { data in
+        output.consume(data)
       }
     }
 
@@ -42,11 +43,23 @@ struct LogMethodHandler: @unchecked Sendable {
       guard let asyncTarget = target as? any LogCommands else {
         throw GRPCStatus(code: .failedPrecondition, message: "\(target) does not support LogCommands")
       }
-      operation = try await asyncTarget.tailLog(arguments: request.arguments, consumer: consumer)
+      var arguments = request.arguments
+      // `log stream` only writes subsystems and categories in its structured styles. Device
+      // logs are relayed from syslog, which takes no arguments.
+      if (filter.matchesStructuredFields || format == .ndjson) && target.targetType != .device {
+        arguments = LogFilterStage.argumentsRequestingNDJSON(arguments)
+      }
+      operation = try await asyncTarget.tailLog(arguments: arguments, consumer: consumer)
     }
 
-    let observeWritingDone = Task<Void, Error> {
-      try await writingDone.value
+    let sendOutput = Task<Void, Error> {
+      while let batch = await output.nextBatch() {
+        try await responseStream.send(
+          Idb_LogResponse.with {
+            $0.output = batch.data
+            $0.lostBytes = batch.lostBytes
+          })
+      }
     }
     // `operation` is a thread-safe handle but not Sendable; rebind as
     // nonisolated(unsafe) so the observer Task can capture it.
@@ -54,9 +67,12 @@ struct LogMethodHandler: @unchecked Sendable {
     let observeOperationCompletion = Task<Void, Error> {
       try await operationToObserve.waitUntilCompleted()
     }
-    try await Task.select(observeWritingDone, observeOperationCompletion).value
-    writingDone.resolve(())
-
+    let completed = await Task.select(sendOutput, observeOperationCompletion)
     observeOperationCompletion.cancel()
+    try await completed.value
+
+    // The operation has ended, send whatever it wrote before it did.
+    output.finish()
+    try await sendOutput.value
   }
 }
@@ -14,11 +14,17 @@ import IDBGRPCSwift
 
 struct PullMethodHandler {
 
+  /// The most file data sent in one response of a ranged pull, under a client's default receive limit.
+  static let rangeChunkSize = FileDrainWriter.defaultMaxChunkSize
+
   let target: FBiOSTarget
   let commandExecutor: FBIDBCommandExecutor
+  let stagingCache: PullStagingCache
 
   func handle(request: Idb_PullRequest, responseStream: GRPCAsyncResponseStreamWriter<Idb_PullResponse>, context: GRPCAsyncServerCallContext) async throws {
-    if request.dstPath.isEmpty {
+    if request.hasRange {
+      try await sendRange(request: request, responseStream: responseStream)
+    } else if request.dstPath.isEmpty {
       try await sendRawData(request: request, responseStream: responseStream)
     } else {
       try await sendFilePath(request: request, responseStream: responseStream)
@@ -45,6 +51,74 @@ struct PullMethodHandler {
     }
   }
 
+  private func sendRange(request: Idb_PullRequest, responseStream: GRPCAsyncResponseStreamWriter<Idb_PullResponse>) async throws {
+    let staged = try await stageForRange(request: request)
+    let offset = request.range.offset
+    guard offset <= staged.size else {
+      throw GRPCStatus(code: .outOfRange, message: "Offset \(offset) is beyond the end of \(request.srcPath) (\(staged.size) bytes)")
+    }
+    let length = min(request.range.length, staged.size - offset)
+    if length == 0 {
+      try await responseStream.send(Idb_PullResponse.with {
+        $0.totalSize = staged.size
+        $0.offset = offset
+        $0.version = staged.version
+      })
+      return
+    }
+
+    let handle = try FileHandle(forReadingFrom: staged.url)
+    defer { try? handle.close() }
+    try handle.seek(toOffset: offset)
+    var position = offset
+    let end = offset + length
+    while position < end {
+      let count = Int(min(UInt64(Self.rangeChunkSize), end - position))
+      guard let data = try handle.read(upToCount: count), !data.isEmpty else {
+        throw GRPCStatus(code: .dataLoss, message: "\(request.srcPath) was truncated at \(position) while being pulled")
+      }
+      let chunkOffset = position
+      try await responseStream.send(Idb_PullResponse.with {
+        $0.payload.data = data
+        $0.totalSize = staged.size
+        $0.offset = chunkOffset
+        $0.version = staged.version
+      })
+      position += UInt64(data.count)
+    }
+  }
+
+  private func stageForRange(request: Idb_PullRequest) async throws -> PullStagingCache.StagedFile {
+    let fileContainer = FileContainerValueTransformer.rawFileContainer(from: request.container)
+    let key = "\(fileContainer)\u{0}\(request.srcPath)"
+    let commandExecutor = self.commandExecutor
+    let srcPath = request.srcPath
+    let sourceVersion = try await commandExecutor.file_attributes(srcPath, containerType: fileContainer).map(Self.version(of:))
+    // Without a version to compare, a copy is trusted for one pull: the size request that starts the next
+    // copies the file again.
+    let startsPull = request.range.offset == 0 && request.range.length == 0
+    return try await stagingCache.stagedFile(forKey: key, sourceVersion: sourceVersion, replacing: sourceVersion == nil && startsPull) {
+      let directory = commandExecutor.temporaryDirectory.temporaryDirectory()
+      let tempPath = directory.appendingPathComponent((srcPath as NSString).lastPathComponent).path
+      let filePath = try await commandExecutor.pull_file_path(srcPath, destination_path: tempPath, containerType: fileContainer)
+      let attributes = try FileManager.default.attributesOfItem(atPath: filePath)
+      guard attributes[.type] as? FileAttributeType == .typeRegular, let size = attributes[.size] as? NSNumber else {
+        try? FileManager.default.removeItem(at: directory)
+        throw GRPCStatus(code: .failedPrecondition, message: "Ranged pulls are only supported for regular files, \(srcPath) is not one")
+      }
+      // A source written to during the copy may have been copied half old and half new.
+      if let sourceVersion, try await commandExecutor.file_attributes(srcPath, containerType: fileContainer).map(Self.version(of:)) != sourceVersion {
+        try? FileManager.default.removeItem(at: directory)
+        throw GRPCStatus(code: .unavailable, message: "\(srcPath) changed while it was being copied")
+      }
+      return PullStagingCache.StagedFile(url: URL(fileURLWithPath: filePath), size: size.uint64Value, version: sourceVersion ?? UUID().uuidString)
+    }
+  }
+
+  private static func version(of attributes: FBContainedFileAttributes) -> String {
+    "\(attributes.size)-\(attributes.modificationDate.timeIntervalSince1970)"
+  }
+
   private func sendFilePath(request: Idb_PullRequest, responseStream: GRPCAsyncResponseStreamWriter<Idb_PullResponse>) async throws {
     let fileContainer = FileContainerValueTransformer.rawFileContainer(from: request.container)
 
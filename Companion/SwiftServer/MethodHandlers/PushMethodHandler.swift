@@ -23,7 +23,7 @@ struct PushMethodHandler {
 
     let extractedFileURLs =
       try await MultisourceFileReader
-      .filePathURLs(from: requestStream, temporaryDirectory: commandExecutor.temporaryDirectory, extractFromSubdir: false)
+      .filePathURLs(from: requestStream, temporaryDirectory: commandExecutor.temporaryDirectory, extractFromSubdir: false, logger: target.logger)
 
     let fileContainer = FileContainerValueTransformer.rawFileContainer(from: inner.container)
     try await commandExecutor.push_files(extractedFileURLs, to_path: inner.dstPath, containerType: fileContainer)
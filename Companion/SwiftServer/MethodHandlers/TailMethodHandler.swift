@@ -17,21 +17,21 @@ struct TailMethodHandler {
   let commandExecutor: FBIDBCommandExecutor
 
   func handle(requestStream: GRPCAsyncRequestStream<Idb_TailRequest>, responseStream: GRPCAsyncResponseStreamWriter<Idb_TailResponse>, context: GRPCAsyncServerCallContext) async throws {
-    @Atomic var finished = false
-
     guard case let .start(start) = try await requestStream.requiredNext.control
     else { throw GRPCStatus(code: .failedPrecondition, message: "Expected start control") }
 
-    let responseWriter = FIFOStreamWriter(stream: responseStream)
-    let consumer = FBBlockDataConsumer.asynchronousDataConsumer { data in
-      guard !finished else { return }
-      let response = Idb_TailResponse.with {
-        $0.data = data
-      }
-      do {
-        try responseWriter.send(response)
-      } catch {
-        _finished.set(true)
+    let output = CoalescingByteStream(configuration: OutputBatchingValueTransformer.configuration(from: start.hasBatching ? start.batching : nil))
+    defer { output.finish() }
+    let consumer = FBBlockDataConsumer.synchronousDataConsumer { data in
+      output.consume(data)
+    }
+    let sendOutput = Task<Void, Error> {
+      while let batch = await output.nextBatch() {
+        try await responseStream.send(
+          Idb_TailResponse.with {
+            $0.data = batch.data
+            $0.lostBytes = batch.lostBytes
+          })
       }
     }
 
@@ -42,6 +42,9 @@ struct TailMethodHandler {
     else { throw GRPCStatus(code: .failedPrecondition, message: "Expected end control") }
 
     try await tail.cancel()
-    _finished.set(true)
+    // Send what was read before the tail stopped. A client that has stopped reading
+    // fails the send, which need not fail the call.
+    output.finish()
+    _ = await sendOutput.result
   }
 }
@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+import GRPC
+import IDBGRPCSwift
+
+struct LogFilterValueTransformer {
+
+  /// The filter a request selects, compiled. Rejects a message regex that does not compile.
+  static func filter(from proto: Idb_LogFilter) throws -> LogFilter {
+    do {
+      return try LogFilter(
+        subsystems: proto.subsystems,
+        categories: proto.categories,
+        processes: proto.processes,
+        messageRegex: proto.messageRegex
+      )
+    } catch {
+      throw GRPCStatus(code: .invalidArgument, message: "Invalid log message regex \(proto.messageRegex): \(error)")
+    }
+  }
+
+  static func outputFormat(from proto: Idb_LogRequest.Format) -> LogOutputFormat {
+    switch proto {
+    case .ndjson:
+      return .ndjson
+    case .text, .UNRECOGNIZED:
+      return .text
+    }
+  }
+}
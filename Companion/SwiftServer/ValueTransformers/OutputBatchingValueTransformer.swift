@@ -0,0 +1,25 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CompanionUtilities
+import Foundation
+import IDBGRPCSwift
+
+struct OutputBatchingValueTransformer {
+
+  /// The coalescing for a request's batching, or the defaults if the request did not set one.
+  static func configuration(from proto: Idb_OutputBatching?) -> CoalescingByteStream.Configuration {
+    guard let proto else {
+      return CoalescingByteStream.Configuration()
+    }
+    return CoalescingByteStream.Configuration(
+      maxBatchBytes: proto.maxBytes == 0 ? CoalescingByteStream.Configuration.defaultMaxBatchBytes : Int(proto.maxBytes),
+      maxLatency: TimeInterval(proto.maxLatencyMs) / 1000,
+      maxBufferedBytes: proto.maxBufferedBytes == 0 ? CoalescingByteStream.Configuration.defaultMaxBufferedBytes : Int(clamping: proto.maxBufferedBytes)
+    )
+  }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// Keeps the last accessibility tree each client session read, so the next read can be sent as a diff.
+///
+/// A UI-automation loop reads the whole screen after every tap, and a tap usually changes a label or
+/// two. Each session holds only its latest tree, under a version unique across sessions; a read that
+/// names that version gets the diff to the new tree, and any other read gets the whole tree, which
+/// becomes the session's new base either way.
+///
+/// Holds at most `capacity` sessions, evicting the least recently read. A client whose session was
+/// evicted gets a whole tree, as it would after any other mismatch.
+///
+/// `@unchecked Sendable`: `entries`, `clock` and `lastVersion` are guarded by `lock`, which is never held
+/// while a diff is computed. The trees are Foundation values that are never mutated once stored.
+final class AccessibilitySnapshotCache: @unchecked Sendable {
+
+  typealias Tree = [AccessibilityTreeDiff.Node]
+
+  private struct Entry {
+    let version: UInt64
+    let tree: Tree
+    var lastUse: UInt64
+  }
+
+  struct Snapshot {
+    /// The version `tree` is kept under.
+    let version: UInt64
+    /// The diff from the requested base version to `tree`, or nil when the session no longer holds it.
+    let diff: [String: Any]?
+  }
+
+  private let lock = NSLock()
+  private var entries: [String: Entry] = [:]
+  private var clock: UInt64 = 0
+  private var lastVersion: UInt64 = 0
+  let capacity: Int
+
+  init(capacity: Int = 16) {
+    self.capacity = max(1, capacity)
+  }
+
+  var count: Int {
+    lock.withLock { entries.count }
+  }
+
+  /// Keeps `tree` as `session`'s latest, and diffs it against the base the client holds.
+  func snapshot(_ tree: Tree, session: String, baseVersion: UInt64) -> Snapshot {
+    let base: Tree? = lock.withLock {
+      guard baseVersion != 0, let entry = entries[session], entry.version == baseVersion else {
+        return nil
+      }
+      return entry.tree
+    }
+    let diff = base.map { AccessibilityTreeDiff.diff(from: $0, to: tree) }
+    let version: UInt64 = lock.withLock {
+      lastVersion += 1
+      clock += 1
+      entries[session] = Entry(version: lastVersion, tree: tree, lastUse: clock)
+      if entries.count > capacity, let oldest = entries.min(by: { $0.value.lastUse < $1.value.lastUse })?.key {
+        entries[oldest] = nil
+      }
+      return lastVersion
+    }
+    return Snapshot(version: version, diff: diff)
+  }
+}
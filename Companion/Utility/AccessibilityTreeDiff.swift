@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// The structural difference between two accessibility trees, in the legacy Foundation spelling that
+/// `accessibility_info` serializes.
+///
+/// Elements are matched between the trees by what they are and where they sit — type, identifier and
+/// frame, the parts of `FBAXElementIdentity` that do not change when an element is updated in place —
+/// within the children of an already matched parent. A matched element whose other attributes differ
+/// is `changed`; anything unmatched is `removed` from the base or `inserted` into the new tree whole.
+/// A tap that changes one label is then one change rather than a new tree.
+///
+/// Base elements are named by their pre-order index, which a client holding the base tree can compute
+/// without knowing how elements were matched. The wire form is described on `AccessibilityInfoResponse`.
+enum AccessibilityTreeDiff {
+
+  typealias Node = [String: Any]
+
+  /// What an element is and where it sits. Frames are rounded as `FBAXElementIdentity` rounds them.
+  struct Key: Hashable {
+    let type: String?
+    let identifier: String?
+    let frame: [Double]
+    let axFrame: String?
+
+    init(_ node: Node) {
+      type = (node["type"] as? String) ?? (node["role"] as? String)
+      identifier = node["AXUniqueId"] as? String
+      let rect = node["frame"] as? [String: Any]
+      frame = ["x", "y", "width", "height"].compactMap { rect?[$0] as? Double }.map { ($0 * 100).rounded() / 100 }
+      // Only when there is no structured frame to go by.
+      axFrame = rect == nil ? node["AXFrame"] as? String : nil
+    }
+  }
+
+  private struct IndexedNode {
+    let index: Int
+    let key: Key
+    let node: Node
+    let children: [IndexedNode]
+  }
+
+  private struct Result {
+    var changed: [[String: Any]] = []
+    var removed: [Int] = []
+    var inserted: [[String: Any]] = []
+  }
+
+  /// The diff that turns `base` into `tree`, as the Foundation object the response carries.
+  static func diff(from base: [Node], to tree: [Node]) -> [String: Any] {
+    var next = 0
+    let indexed = indexed(base, next: &next)
+    var result = Result()
+    diffChildren(indexed, tree, parent: -1, into: &result)
+    return ["changed": result.changed, "removed": result.removed, "inserted": result.inserted]
+  }
+
+  private static func indexed(_ nodes: [Node], next: inout Int) -> [IndexedNode] {
+    var indexed: [IndexedNode] = []
+    indexed.reserveCapacity(nodes.count)
+    for node in nodes {
+      let index = next
+      next += 1
+      let children = Self.indexed(node["children"] as? [Node] ?? [], next: &next)
+      indexed.append(IndexedNode(index: index, key: Key(node), node: node, children: children))
+    }
+    return indexed
+  }
+
+  private static func diffChildren(_ base: [IndexedNode], _ tree: [Node], parent: Int, into result: inout Result) {
+    // Matches are kept in base order, so once the unmatched are removed, every kept element already
+    // sits before the insertions that follow it.
+    let candidates = Dictionary(grouping: base.indices, by: { base[$0].key })
+    var cursors: [Key: Int] = [:]
+    var matched = Set<Int>()
+    var last = -1
+    for (position, node) in tree.enumerated() {
+      let key = Key(node)
+      var cursor = cursors[key, default: 0]
+      let positions = candidates[key] ?? []
+      while cursor < positions.count, positions[cursor] <= last {
+        cursor += 1
+      }
+      guard cursor < positions.count else {
+        cursors[key] = cursor
+        result.inserted.append(["parent": parent, "index": position, "node": node])
+        continue
+      }
+      let match = positions[cursor]
+      cursors[key] = cursor + 1
+      matched.insert(match)
+      last = match
+      diffNode(base[match], node, into: &result)
+      diffChildren(base[match].children, node["children"] as? [Node] ?? [], parent: base[match].index, into: &result)
+    }
+    for position in base.indices where !matched.contains(position) {
+      result.removed.append(base[position].index)
+    }
+  }
+
+  private static func diffNode(_ base: IndexedNode, _ node: Node, into result: inout Result) {
+    var set: [String: Any] = [:]
+    for (key, value) in node where key != "children" {
+      if let previous = base.node[key], (previous as AnyObject).isEqual(value as AnyObject) {
+        continue
+      }
+      set[key] = value
+    }
+    var unset = base.node.keys.filter { $0 != "children" && node[$0] == nil }
+    // Children are diffed element by element; only whether the key is there at all is an attribute.
+    switch (base.node["children"] != nil, node["children"] != nil) {
+    case (false, true):
+      set["children"] = [Any]()
+    case (true, false):
+      unset.append("children")
+    default:
+      break
+    }
+    guard !set.isEmpty || !unset.isEmpty else {
+      return
+    }
+    result.changed.append(["node": base.index, "set": set, "unset": unset.sorted()])
+  }
+}
@@ -12,35 +12,78 @@ import GRPC
 
 struct FileDrainWriter {
 
-  static func performDrain(task: FBSubprocess<NSNull, InputStream, AnyObject>, sendResponse: (Data) async throws -> Void) async throws {
+  /// The largest payload sent in one response. gRPC clients receive at most 4Mb per
+  /// message by default, and that limit includes the protobuf and gRPC framing around the
+  /// payload, so 64Kb of it is left for them.
+  static let defaultMaxChunkSize = 4 * 1024 * 1024 - 64 * 1024
+
+  /// The size a message's buffer starts at. It doubles whenever reads fill it, up to
+  /// the chunk size, so a small pull does not zero-fill a whole chunk.
+  static let initialBufferSize = 64 * 1024
+
+  /// What a drain did, for logging and benchmarking.
+  struct Statistics: Equatable {
+    var bytes = 0
+    var reads = 0
+    var messages = 0
+  }
+
+  @discardableResult
+  static func performDrain(task: FBSubprocess<NSNull, InputStream, AnyObject>, maxChunkSize: Int = defaultMaxChunkSize, sendResponse: (Data) async throws -> Void) async throws -> Statistics {
     guard let inputStream = task.stdOut else {
       throw GRPCStatus(code: .internalError, message: "Unable to get stdOut to write")
     }
 
+    let statistics = try await drain(inputStream: inputStream, maxChunkSize: maxChunkSize, sendResponse: sendResponse)
+
+    let exitCode = try await awaitExitCode(of: task)
+    if exitCode != 0 {
+      throw GRPCStatus(code: .internalError, message: "Draining operation failed with exit code \(exitCode)")
+    }
+    return statistics
+  }
+
+  /// Reads `inputStream` to the end, coalescing reads into messages of up to `maxChunkSize`.
+  ///
+  /// Reads go straight into the storage of the `Data` that is sent, so there is no
+  /// intermediate buffer to copy out of. A response message owns its payload until it
+  /// has been written out, so each message gets its own buffer, grown as it fills.
+  static func drain(inputStream: InputStream, maxChunkSize: Int = defaultMaxChunkSize, sendResponse: (Data) async throws -> Void) async throws -> Statistics {
     inputStream.open()
     defer { inputStream.close() }
 
+    var statistics = Statistics()
+    var reachedEnd = false
     // inputStream.hasBytesAvailable is unavailable due to custom implementation of NSInputStream
-    while true {
-      let sixteenKilobytes = 16384
-      var buffer = [UInt8](repeating: 0, count: sixteenKilobytes)
-      let readBytes = inputStream.read(&buffer, maxLength: sixteenKilobytes)
-
-      guard readBytes >= 0 else {
-        let message = "Draining operation failed with stream error: \(inputStream.streamError?.localizedDescription ?? "Unknown")"
-        throw GRPCStatus(code: .internalError, message: message)
+    while !reachedEnd {
+      var buffer = Data(count: min(initialBufferSize, maxChunkSize))
+      var filled = 0
+      while filled < maxChunkSize {
+        if filled == buffer.count {
+          buffer.count = min(buffer.count * 2, maxChunkSize)
+        }
+        let readBytes = buffer.withUnsafeMutableBytes { bytes in
+          inputStream.read(bytes.baseAddress!.assumingMemoryBound(to: UInt8.self) + filled, maxLength: bytes.count - filled)
+        }
+        statistics.reads += 1
+        guard readBytes >= 0 else {
+          let message = "Draining operation failed with stream error: \(inputStream.streamError?.localizedDescription ?? "Unknown")"
+          throw GRPCStatus(code: .internalError, message: message)
+        }
+        if readBytes == 0 {
+          reachedEnd = true
+          break
+        }
+        filled += readBytes
       }
-      if readBytes == 0 {
+      if filled == 0 {
         break
       }
-
-      let data = Data(bytes: &buffer, count: readBytes)
-      try await sendResponse(data)
-    }
-
-    let exitCode = try await awaitExitCode(of: task)
-    if exitCode != 0 {
-      throw GRPCStatus(code: .internalError, message: "Draining operation failed with exit code \(exitCode)")
+      buffer.count = filled
+      statistics.bytes += filled
+      statistics.messages += 1
+      try await sendResponse(buffer)
     }
+    return statistics
   }
 }
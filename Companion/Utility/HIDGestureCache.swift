@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import FBSimulatorControl
+import Foundation
+
+/// Keeps named HID gestures, expanded and timed, so that repeating one costs a lookup.
+///
+/// UI tests replay the same swipes and pinches thousands of times. Each time they are sent as
+/// events, they are checked, interpolated into touches and laid out in time again. Here that is
+/// done once, when the gesture is defined, and performing it sends the stored timeline.
+///
+/// Holds at most `capacity` gestures, evicting the least recently performed. A client that finds
+/// its gesture gone defines it again.
+///
+/// `@unchecked Sendable`: `entries` and `clock` are guarded by `lock`, which is never held across
+/// an `await`.
+final class HIDGestureCache: @unchecked Sendable {
+
+  private struct Entry {
+    let timeline: FBSimulatorHIDTimeline
+    var lastUse: UInt64
+  }
+
+  private let lock = NSLock()
+  private var entries: [String: Entry] = [:]
+  private var clock: UInt64 = 0
+  let capacity: Int
+
+  init(capacity: Int = 256) {
+    self.capacity = max(1, capacity)
+  }
+
+  var count: Int {
+    lock.withLock { entries.count }
+  }
+
+  /// Stores `timeline` as `name`, replacing any gesture of that name.
+  func define(_ name: String, timeline: FBSimulatorHIDTimeline) {
+    lock.withLock {
+      clock += 1
+      entries[name] = Entry(timeline: timeline, lastUse: clock)
+      if entries.count > capacity, let oldest = entries.min(by: { $0.value.lastUse < $1.value.lastUse })?.key {
+        entries[oldest] = nil
+      }
+    }
+  }
+
+  func remove(_ name: String) {
+    lock.withLock {
+      entries[name] = nil
+    }
+  }
+
+  /// The timeline of the gesture named `name`, or nil if there is none.
+  func timeline(named name: String) -> FBSimulatorHIDTimeline? {
+    lock.withLock {
+      guard var entry = entries[name] else {
+        return nil
+      }
+      clock += 1
+      entry.lastUse = clock
+      entries[name] = entry
+      return entry.timeline
+    }
+  }
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import FBControlCore
+import Foundation
+
+/// One line of a log, with the fields that a `LogFilter` matches on.
+struct LogRecord {
+
+  /// The object of a structured entry, or nil for a line of text.
+  let object: [String: Any]?
+  let subsystem: String?
+  let category: String?
+  let processName: String?
+  let processIdentifier: Int?
+  let message: String
+
+  /// Reads a line of a log: an object from `log stream --style ndjson`, a line relayed from a
+  /// device's syslog, or any other text, which is all message.
+  static func parse(_ line: Data) -> LogRecord {
+    if line.first == UInt8(ascii: "{"),
+      let object = (try? JSONSerialization.jsonObject(with: line)) as? [String: Any]
+    {
+      let processImagePath = object["processImagePath"] as? String
+      return LogRecord(
+        object: object,
+        subsystem: object["subsystem"] as? String,
+        category: object["category"] as? String,
+        processName: processImagePath.map { ($0 as NSString).lastPathComponent },
+        processIdentifier: (object["processID"] as? NSNumber)?.intValue,
+        message: object["eventMessage"] as? String ?? ""
+      )
+    }
+    let text = String(decoding: line, as: UTF8.self)
+    let range = NSRange(text.startIndex..., in: text)
+    if let match = syslogPattern.firstMatch(in: text, range: range),
+      let process = Range(match.range(at: 1), in: text),
+      let processIdentifier = Range(match.range(at: 2), in: text),
+      let message = Range(match.range(at: 3), in: text)
+    {
+      return LogRecord(
+        object: nil,
+        subsystem: nil,
+        category: nil,
+        processName: String(text[process]),
+        processIdentifier: Int(text[processIdentifier]),
+        message: String(text[message])
+      )
+    }
+    return LogRecord(object: nil, subsystem: nil, category: nil, processName: nil, processIdentifier: nil, message: text)
+  }
+
+  /// A line relayed from a device's syslog, such as
+  /// `Oct 16 12:34:56 iPhone SpringBoard(FrontBoard)[57] <Notice>: message`.
+  private static let syslogPattern = try! NSRegularExpression(pattern: #"^\w{3} [ \d]\d \d\d:\d\d:\d\d \S+ ([^\[\(]+)(?:\([^\)]*\))?\[(\d+)\] <\w+>: (.*)$"#)
+}
+
+/// Selects entries of a log by subsystem, category, process and message.
+///
+/// Each set matches any one of its values, and an entry must match every set that is not
+/// empty. The message pattern is compiled once, when the filter is made, and searched for
+/// anywhere in the message.
+struct LogFilter: @unchecked Sendable {
+
+  let subsystems: Set<String>
+  let categories: Set<String>
+  let processNames: Set<String>
+  let processIdentifiers: Set<Int>
+  let messagePattern: NSRegularExpression?
+
+  /// Plain byte strings, one group per set of structured values, at least one of each group
+  /// appearing in any line that can match. Checked before a line is parsed, so most lines that
+  /// cannot match are never parsed.
+  private let requiredNeedles: [[Data]]
+
+  /// `processes` are names, or identifiers if they are numeric. Throws if `messageRegex` is not
+  /// a valid regular expression.
+  init(subsystems: [String] = [], categories: [String] = [], processes: [String] = [], messageRegex: String = "") throws {
+    self.subsystems = Set(subsystems)
+    self.categories = Set(categories)
+    self.processNames = Set(processes.filter { Int($0) == nil })
+    self.processIdentifiers = Set(processes.compactMap { Int($0) })
+    self.messagePattern = messageRegex.isEmpty ? nil : try NSRegularExpression(pattern: messageRegex)
+    self.requiredNeedles = [self.subsystems, self.categories].compactMap(Self.needles(for:))
+  }
+
+  var isEmpty: Bool {
+    subsystems.isEmpty && categories.isEmpty && processNames.isEmpty && processIdentifiers.isEmpty && messagePattern == nil
+  }
+
+  /// Whether the filter matches on fields that only structured entries carry.
+  var matchesStructuredFields: Bool {
+    !subsystems.isEmpty || !categories.isEmpty || !processNames.isEmpty || !processIdentifiers.isEmpty
+  }
+
+  /// Whether a line may match, from its bytes alone. A false answer is final, a true one is not.
+  func mayMatch(line: Data) -> Bool {
+    requiredNeedles.allSatisfy { group in
+      group.contains { line.range(of: $0) != nil }
+    }
+  }
+
+  func matches(_ record: LogRecord) -> Bool {
+    if !subsystems.isEmpty && !(record.subsystem.map(subsystems.contains) ?? false) {
+      return false
+    }
+    if !categories.isEmpty && !(record.category.map(categories.contains) ?? false) {
+      return false
+    }
+    if !processNames.isEmpty || !processIdentifiers.isEmpty {
+      let matchesName = record.processName.map(processNames.contains) ?? false
+      let matchesIdentifier = record.processIdentifier.map(processIdentifiers.contains) ?? false
+      if !matchesName && !matchesIdentifier {
+        return false
+      }
+    }
+    if let messagePattern {
+      let message = record.message
+      if messagePattern.firstMatch(in: message, range: NSRange(message.startIndex..., in: message)) == nil {
+        return false
+      }
+    }
+    return true
+  }
+
+  /// The needles for a set of values, or nil if they cannot be used to rule lines out: when the
+  /// set is empty, or a value could be escaped differently in JSON than it is written here.
+  private static func needles(for values: Set<String>) -> [Data]? {
+    guard !values.isEmpty else {
+      return nil
+    }
+    let escaped = CharacterSet(charactersIn: "\"\\/").union(.controlCharacters)
+    guard values.allSatisfy({ $0.unicodeScalars.allSatisfy { $0.isASCII && !escaped.contains($0) } }) else {
+      return nil
+    }
+    return values.map { Data("\"\($0)\"".utf8) }
+  }
+}
+
+/// How a filtered log is written.
+enum LogOutputFormat {
+  /// The log's own lines, or, for structured entries, lines laid out like `log stream`'s default style.
+  case text
+  /// One JSON object per line. Structured entries are written as they were read.
+  case ndjson
+}
+
+/// Applies a `LogFilter` to a log before its output is sent anywhere.
+enum LogFilterStage {
+
+  /// A consumer that splits what it consumes into lines, and writes those matching `filter` to
+  /// `output` in `format`.
+  static func consumer(filter: LogFilter, format: LogOutputFormat, output: @escaping @Sendable (Data) -> Void) -> any FBDataConsumer {
+    let lines = FBBlockDataConsumer.synchronousDataConsumer { line in
+      guard filter.mayMatch(line: line) else {
+        return
+      }
+      let record = LogRecord.parse(line)
+      guard filter.matches(record), let rendered = render(record, line: line, format: format) else {
+        return
+      }
+      output(rendered)
+    }
+    return FBDataBuffer.consumableBufferForwarding(to: lines, on: nil, terminal: FBDataBuffer.newlineTerminal())
+  }
+
+  /// The `log stream` arguments with the style set to NDJSON, so that entries carry the fields a
+  /// filter needs. Any style given is replaced.
+  static func argumentsRequestingNDJSON(_ arguments: [String]) -> [String] {
+    var result: [String] = []
+    var index = arguments.startIndex
+    while index < arguments.endIndex {
+      let argument = arguments[index]
+      if argument == "--style" {
+        index += 2
+        continue
+      }
+      if !argument.hasPrefix("--style=") {
+        result.append(argument)
+      }
+      index += 1
+    }
+    return result + ["--style", "ndjson"]
+  }
+
+  /// A record as a line of output, including its newline.
+  static func render(_ record: LogRecord, line: Data, format: LogOutputFormat) -> Data? {
+    var rendered: Data
+    switch (format, record.object) {
+    case (.ndjson, .some):
+      rendered = line
+    case (.ndjson, .none):
+      var object: [String: Any] = ["eventMessage": record.message]
+      if let processName = record.processName {
+        object["process"] = processName
+      }
+      if let processIdentifier = record.processIdentifier {
+        object["processID"] = processIdentifier
+      }
+      guard let data = try? JSONSerialization.data(withJSONObject: object, options: [.sortedKeys]) else {
+        return nil
+      }
+      rendered = data
+    case (.text, .none):
+      rendered = line
+    case let (.text, .some(object)):
+      rendered = Data(textLine(for: record, object: object).utf8)
+    }
+    rendered.append(UInt8(ascii: "\n"))
+    return rendered
+  }
+
+  /// Lays a structured entry out as `log stream`'s default style does:
+  /// timestamp, thread, type, activity, process identifier, TTL, then the process, library,
+  /// subsystem and category, and the message.
+  private static func textLine(for record: LogRecord, object: [String: Any]) -> String {
+    func hex(_ key: String) -> String {
+      "0x" + String((object[key] as? NSNumber)?.uint64Value ?? 0, radix: 16)
+    }
+    var line = [
+      object["timestamp"] as? String ?? "",
+      hex("threadID"),
+      object["messageType"] as? String ?? "Default",
+      hex("activityIdentifier"),
+      String(record.processIdentifier ?? 0),
+      "0",
+      (record.processName ?? "") + ":",
+    ].joined(separator: " ")
+    if let sender = object["senderImagePath"] as? String {
+      line += " (\((sender as NSString).lastPathComponent))"
+    }
+    if let subsystem = record.subsystem, !subsystem.isEmpty {
+      line += " [\(subsystem):\(record.category ?? "")]"
+    }
+    return line + " " + record.message
+  }
+}
@@ -6,6 +6,7 @@
  */
 
 import CompanionLib
+import CompanionUtilities
 import FBControlCore
 import Foundation
 import GRPC
@@ -13,7 +14,11 @@ import IDBGRPCSwift
 
 enum MultisourceFileReader {
 
-  static func filePathURLs<Request: PayloadExtractable>(from requestStream: GRPCAsyncRequestStream<Request>, temporaryDirectory: FBTemporaryDirectory, extractFromSubdir: Bool) async throws -> [URL] {
+  /// How many bytes of an archive are buffered between the request stream and the
+  /// extracting process before reading from the request stream waits for it to catch up.
+  static let defaultHighWaterMark = BoundedBytePipe.defaultHighWaterMark
+
+  static func filePathURLs<Request: PayloadExtractable>(from requestStream: GRPCAsyncRequestStream<Request>, temporaryDirectory: FBTemporaryDirectory, extractFromSubdir: Bool, highWaterMark: Int = defaultHighWaterMark, logger: FBControlCoreLogger? = nil) async throws -> [URL] {
     func readNextPayload() async throws -> Idb_Payload {
       guard let p = try await requestStream.requiredNext.extractPayload()
       else { throw GRPCStatus(code: .failedPrecondition, message: "Incorrect request. Expected payload") }
@@ -31,12 +36,29 @@ enum MultisourceFileReader {
 
     switch payload.source {
     case let .data(data):
-      let (readTaskFromStreamTask, input) = pipeToInput(initialData: data, requestStream: requestStream)
+      let input = FBProcessInput<OutputStream>.fromStream()
+      let pipe = BoundedBytePipe(highWaterMark: highWaterMark)
+      let readTask = Task {
+        try await readPayloads(initialData: data, from: requestStream, into: pipe)
+      }
+      let writeTask = Task {
+        try await write(pipe, to: input)
+      }
+
+      let result: [URL]
+      do {
+        result = try await filepathsFromTar(temporaryDirectory: temporaryDirectory, input: input, extractFromSubdir: extractFromSubdir, compression: compression)
+      } catch {
+        pipe.cancel(error)
+        throw error
+      }
 
-      let result = try await filepathsFromTar(temporaryDirectory: temporaryDirectory, input: input, extractFromSubdir: extractFromSubdir, compression: compression)
+      // We just check that read from request stream and the write to the extractor did not produce any errors
+      try await readTask.value
+      try await writeTask.value
 
-      // We just check that read from request stream did not produce any errors
-      _ = try await readTaskFromStreamTask.value
+      let statistics = pipe.currentStatistics
+      logger?.debug().log("Extracted \(statistics.bytes) bytes from \(statistics.chunks) payloads. Reading stalled \(statistics.stalls) times for \(String(format: "%.2f", statistics.stalledTime))s, at most \(statistics.maxQueuedBytes) bytes were queued")
 
       return result
 
@@ -85,18 +107,11 @@ enum MultisourceFileReader {
     }
   }
 
-  // TODO: Do we really need multithreading here? Isnt we just fill the stream sequentially while read is blocked and only then read starts?
-  private static func pipeToInput<Request: PayloadExtractable>(initialData: Data, requestStream: GRPCAsyncRequestStream<Request>) -> (Task<Void, Error>, FBProcessInput<OutputStream>) {
-    let input = FBProcessInput<OutputStream>.fromStream()
-    let stream = input.contents
-
-    let readFromStreamTask = Task {
-      stream.open()
-      defer { stream.close() }
-
-      var buffer = [UInt8](initialData)
-      stream.write(&buffer, maxLength: buffer.count)
-
+  /// Forwards the data payloads of the request stream into `pipe`, waiting whenever the
+  /// extractor falls behind so that a fast client cannot fill the companion's memory.
+  private static func readPayloads<Request: PayloadExtractable>(initialData: Data, from requestStream: GRPCAsyncRequestStream<Request>, into pipe: BoundedBytePipe) async throws {
+    do {
+      try await pipe.send(initialData)
       for try await request in requestStream {
         guard let payload = request.extractPayload()
         else { throw GRPCStatus(code: .invalidArgument, message: "Unrecogized buffer frame. Expect payload, got \(request)") }
@@ -104,11 +119,58 @@ enum MultisourceFileReader {
         guard case .data(let data) = payload.source
         else { throw GRPCStatus(code: .invalidArgument, message: "Unrecogized buffer frame. Expect file path, got \(payload.source as Any)") }
 
-        var buffer = [UInt8](data)
-        stream.write(&buffer, maxLength: buffer.count)
+        try await pipe.send(data)
+      }
+      pipe.finish()
+    } catch {
+      pipe.finish(throwing: error)
+      throw error
+    }
+  }
+
+  /// Writes everything sent to `pipe` to the stream of `input`, then closes it.
+  ///
+  /// Opening the stream waits for the extractor to attach to it, and writes block while
+  /// the extractor is busy, so both happen on a dedicated queue rather than on the
+  /// cooperative pool. The payload bytes are written directly, without a copy.
+  private static func write(_ pipe: BoundedBytePipe, to input: FBProcessInput<OutputStream>) async throws {
+    let queue = DispatchQueue(label: "com.facebook.idb.multisource.write")
+    do {
+      try await perform(on: queue) {
+        let stream = input.contents
+        stream.open()
+        if stream.streamStatus == .error {
+          throw streamError(stream)
+        }
       }
+      while let data = try await pipe.next() {
+        try await perform(on: queue) {
+          let stream = input.contents
+          let written = data.withUnsafeBytes { bytes in
+            stream.write(bytes.bindMemory(to: UInt8.self).baseAddress!, maxLength: bytes.count)
+          }
+          if written != data.count {
+            throw streamError(stream)
+          }
+        }
+      }
+      try await perform(on: queue) { input.contents.close() }
+    } catch {
+      pipe.cancel(error)
+      try? await perform(on: queue) { input.contents.close() }
+      throw error
     }
+  }
 
-    return (readFromStreamTask, input)
+  private static func streamError(_ stream: OutputStream) -> GRPCStatus {
+    GRPCStatus(code: .internalError, message: "Failed to write to the extractor: \(stream.streamError?.localizedDescription ?? "Unknown")")
+  }
+
+  private static func perform<T: Sendable>(on queue: DispatchQueue, _ work: @escaping @Sendable () throws -> T) async throws -> T {
+    try await withCheckedThrowingContinuation { continuation in
+      queue.async {
+        continuation.resume(with: Result { try work() })
+      }
+    }
   }
 }
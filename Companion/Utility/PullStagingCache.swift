@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// Keeps files copied out of their container for ranged pulls.
+///
+/// A client pulling a large file in ranges sends many requests for the same path,
+/// concurrently and again after a dropped connection. Each of them would otherwise
+/// copy the whole file out of its container before reading a few megabytes of it.
+/// Here the copy is made once per (container, path) and shared, and concurrent
+/// requests for a path that is still being copied wait on the same copy.
+///
+/// A copy is only reused while the source is unchanged. Each is staged for a
+/// version of its source, its size and modification date where the container can
+/// read them in place, and a request for another version replaces it. Where the
+/// container cannot, the caller decides when the copy is too old to trust.
+///
+/// Staged files are deleted once they have not been read for `idleTimeout`, by a timer
+/// that runs while anything is staged, so a pull that is never finished does not keep
+/// its copy until the next one. `removeAll()` deletes the rest when the companion stops.
+///
+/// `@unchecked Sendable`: `entries` and `sweepTimer` are guarded by `lock`, which is never
+/// held across an `await`.
+final class PullStagingCache: @unchecked Sendable {
+
+  struct StagedFile: Sendable {
+    let url: URL
+    let size: UInt64
+    /// Names the contents of the copy, and differs for any other copy of the path.
+    let version: String
+  }
+
+  private struct Entry {
+    let task: Task<StagedFile, Error>
+    let sourceVersion: String?
+    var lastAccess: Date
+  }
+
+  private let lock = NSLock()
+  private var entries: [String: Entry] = [:]
+  private let idleTimeout: TimeInterval
+  private let queue = DispatchQueue(label: "com.facebook.idb.PullStagingCache")
+  private var sweepTimer: DispatchSourceTimer?
+
+  init(idleTimeout: TimeInterval = 300) {
+    self.idleTimeout = idleTimeout
+  }
+
+  deinit {
+    sweepTimer?.cancel()
+  }
+
+  /// Returns the staged copy for `key`, calling `stage` to make it if there is none
+  /// staged from `sourceVersion`, or if `replacing` is set. A `nil` version is one the
+  /// container could not read. A failed copy is not cached, so the next request retries it.
+  func stagedFile(
+    forKey key: String,
+    sourceVersion: String?,
+    replacing: Bool = false,
+    stage: @escaping @Sendable () async throws -> StagedFile
+  ) async throws -> StagedFile {
+    let (task, replaced): (Task<StagedFile, Error>, Entry?) = lock.withLock {
+      evictIdleEntries(now: Date())
+      let existing = entries[key]
+      if var entry = existing, !replacing, entry.sourceVersion == sourceVersion {
+        entry.lastAccess = Date()
+        entries[key] = entry
+        return (entry.task, nil)
+      }
+      let task = Task { try await stage() }
+      entries[key] = Entry(task: task, sourceVersion: sourceVersion, lastAccess: Date())
+      armSweepTimerLocked()
+      return (task, existing)
+    }
+    if let replaced {
+      Self.remove(replaced.task)
+    }
+    do {
+      return try await task.value
+    } catch {
+      lock.withLock {
+        if entries[key]?.task == task {
+          entries[key] = nil
+        }
+      }
+      throw error
+    }
+  }
+
+  /// Deletes every staged file, returning once they are gone.
+  func removeAll() async {
+    let removed = lock.withLock {
+      let removed = Array(entries.values)
+      entries.removeAll()
+      sweepTimer?.cancel()
+      sweepTimer = nil
+      return removed
+    }
+    for entry in removed {
+      await Self.remove(entry.task).value
+    }
+  }
+
+  // MARK: - Eviction
+
+  /// Sweeps for idle entries every half `idleTimeout`, so none outlives it by more than that.
+  private func armSweepTimerLocked() {
+    guard sweepTimer == nil else {
+      return
+    }
+    let timer = DispatchSource.makeTimerSource(queue: queue)
+    timer.schedule(deadline: .now() + idleTimeout / 2, repeating: idleTimeout / 2)
+    timer.setEventHandler { [weak self] in
+      self?.sweep()
+    }
+    sweepTimer = timer
+    timer.resume()
+  }
+
+  private func sweep() {
+    lock.withLock {
+      evictIdleEntries(now: Date())
+      // Re-armed by the next staged file.
+      if entries.isEmpty {
+        sweepTimer?.cancel()
+        sweepTimer = nil
+      }
+    }
+  }
+
+  private func evictIdleEntries(now: Date) {
+    for (key, entry) in entries where now.timeIntervalSince(entry.lastAccess) > idleTimeout {
+      entries[key] = nil
+      Self.remove(entry.task)
+    }
+  }
+
+  @discardableResult
+  private static func remove(_ task: Task<StagedFile, Error>) -> Task<Void, Never> {
+    Task {
+      guard let staged = try? await task.value else {
+        return
+      }
+      try? FileManager.default.removeItem(at: staged.url.deletingLastPathComponent())
+    }
+  }
+}
@@ -52,6 +52,7 @@ private let kUsageHelpMessage = """
       --verify-booted VALUE      If VALUE is a true value, will verify that the Simulator is in a known-booted state before --boot completes. Default is true.
       --terminate-offline VALUE  Terminate if the target goes offline, otherwise the companion will stay alive.
       --idle-shutdown-time SECS  Exit after SECS seconds with no active or newly received gRPC requests (default: stays alive).
+      --install-cache-size MB    Size of the install artifact cache shared by every companion on the host, 0 disables it (default: 8192).
 
    Filter Options:
       simulator                  Limit interactions to Simulators only.
@@ -388,7 +389,8 @@ private func runCompanionServer(_ udid: String, userDefaults: UserDefaults, xcod
   reporter.report(FBEventReporterSubject(forEvent: "launched"))
 
   let temporaryDirectory = FBTemporaryDirectory(logger: logger)
-  let storageManager = try FBIDBStorageManager.manager(forTarget: target, logger: logger)
+  let installCacheSize = userDefaults.string(forKey: "-install-cache-size").flatMap(UInt64.init).map { $0 * 1024 * 1024 } ?? FBInstallArtifactCache.defaultMaximumSize
+  let storageManager = try FBIDBStorageManager.manager(forTarget: target, installCacheSize: installCacheSize, logger: logger)
 
   // Start up the companion
   let ports = IDBPortsConfiguration(arguments: userDefaults)
@@ -467,7 +469,10 @@ private func runCompanionServer(_ udid: String, userDefaults: UserDefaults, xcod
     raceTasks.append(Task { try await awaitTargetOffline(target, logger: logger) })
   }
   defer { raceTasks.forEach { $0.cancel() } }
-  _ = try await Task.select(raceTasks).value
+  let winner = await Task.select(raceTasks)
+  // Files staged for the server's calls are deleted however the companion ends.
+  await swiftServer.tearDown()
+  _ = try await winner.value
 }
 
 private func runNotifier(_ notify: String, userDefaults: UserDefaults, xcodeAvailable: Bool, logger: FBControlCoreLogger, reporter: FBEventReporter) async throws {
@@ -9,9 +9,9 @@ import Foundation
 
 /// Errors raised while discovering or starting companions.
 public enum CompanionDiscoveryError: Error, CustomStringConvertible {
-  /// The registry lockfile could not be acquired within the timeout.
+  /// The registry writer lock could not be acquired within the timeout.
   case lockTimedOut(path: String)
-  /// The registry lockfile could not be created for an unexpected reason.
+  /// The registry writer lock could not be opened or taken for an unexpected reason.
   case lockFailed(path: String, code: Int32)
   /// The companion process could not be launched.
   case spawnFailed(reason: String)
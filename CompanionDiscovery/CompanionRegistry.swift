@@ -21,32 +21,42 @@ import ucrt
 
 /// A persistent registry of running companions, keyed by `udid`, stored as JSON
 /// at `stateFilePath` (defaulting to the v1 `CompanionPaths().stateFile`).
+///
+/// Reads take no lock. Writers serialize with each other on an `flock` of a file
+/// beside the state file, which the kernel releases if the holder dies, and with an
+/// older idb's writers on the lockfile those create exclusively. They replace the
+/// state file by renaming a new one over it, so a reader always sees a complete
+/// snapshot. This matches `CompanionSet` in idb/common/companion_set.py.
 public final class CompanionRegistry {
   private let stateFilePath: String
   private let lockTimeout: TimeInterval
   private let lockRetryInterval: useconds_t
+  private let readAttempts: Int
+  private let readRetryInterval: useconds_t
 
   public init(stateFilePath: String = CompanionPaths().stateFile) {
     self.stateFilePath = stateFilePath
     self.lockTimeout = 3.0
-    self.lockRetryInterval = 50_000 // 50ms, matching `_open_lockfile`.
+    self.lockRetryInterval = 5_000 // 5ms, matching `_writer_lock`.
+    self.readAttempts = 3
+    self.readRetryInterval = 10_000 // 10ms, matching `CompanionSet._read_companions`.
   }
 
   /// All recorded companions, sorted by udid.
   public func companions() throws -> [CompanionInfo] {
-    try withLock { try readLocked() }
+    read()
   }
 
   /// Records a companion, replacing any existing entry with the same udid.
   public func add(_ companion: CompanionInfo) throws {
-    try withLock {
-      var companions = try readLocked()
+    try withWriterLock {
+      var companions = read()
       if let index = companions.firstIndex(where: { $0.udid == companion.udid }) {
         companions[index] = companion
       } else {
         companions.append(companion)
       }
-      try writeLocked(companions)
+      try write(companions)
     }
   }
 
@@ -54,11 +64,11 @@ public final class CompanionRegistry {
   /// removed.
   @discardableResult
   public func remove(udid: String) throws -> [CompanionInfo] {
-    try withLock {
-      var companions = try readLocked()
+    try withWriterLock {
+      var companions = read()
       let removed = companions.filter { $0.udid == udid }
       companions.removeAll { $0.udid == udid }
-      try writeLocked(companions)
+      try write(companions)
       return removed
     }
   }
@@ -67,11 +77,11 @@ public final class CompanionRegistry {
   /// removed.
   @discardableResult
   public func remove(address: CompanionAddress) throws -> [CompanionInfo] {
-    try withLock {
-      var companions = try readLocked()
+    try withWriterLock {
+      var companions = read()
       let removed = companions.filter { $0.address == address }
       companions.removeAll { $0.address == address }
-      try writeLocked(companions)
+      try write(companions)
       return removed
     }
   }
@@ -79,14 +89,14 @@ public final class CompanionRegistry {
   /// Empties the registry and returns what was removed.
   @discardableResult
   public func clear() throws -> [CompanionInfo] {
-    try withLock {
-      let companions = try readLocked()
-      try writeLocked([])
+    try withWriterLock {
+      let companions = read()
+      try write([])
       return companions
     }
   }
 
-  // MARK: - Locked file access
+  // MARK: - File access
 
   /// Creates the directory holding the state file (and its lockfile) if needed.
   private func ensureContainingDirectory() throws {
@@ -94,52 +104,87 @@ public final class CompanionRegistry {
     try FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: true)
   }
 
-  private func readLocked() throws -> [CompanionInfo] {
-    guard let data = FileManager.default.contents(atPath: stateFilePath), !data.isEmpty else {
-      return []
-    }
-    do {
-      return try JSONDecoder().decode([CompanionInfo].self, from: data).sorted { $0.udid < $1.udid }
-    } catch {
-      // An invalid or partially-written state file is treated as empty.
-      return []
+  private func read() -> [CompanionInfo] {
+    for attempt in 0..<readAttempts {
+      guard let data = FileManager.default.contents(atPath: stateFilePath), !data.isEmpty else {
+        return []
+      }
+      if let companions = try? JSONDecoder().decode([CompanionInfo].self, from: data) {
+        return companions.sorted { $0.udid < $1.udid }
+      }
+      // An older client writes the state file in place, so it can be read part-written.
+      if attempt + 1 < readAttempts {
+        usleep(readRetryInterval)
+      }
     }
+    // An invalid state file is treated as empty.
+    return []
   }
 
-  private func writeLocked(_ companions: [CompanionInfo]) throws {
+  private func write(_ companions: [CompanionInfo]) throws {
     try ensureContainingDirectory()
     let encoder = JSONEncoder()
     encoder.outputFormatting = [.sortedKeys]
     let data = try encoder.encode(companions.sorted { $0.udid < $1.udid })
-    try data.write(to: URL(fileURLWithPath: stateFilePath))
+    // Written to a temporary file and renamed over the state file.
+    try data.write(to: URL(fileURLWithPath: stateFilePath), options: .atomic)
   }
 
-  // MARK: - Lockfile
+  // MARK: - Writer lock
 
-  /// Runs `body` while holding an exclusive lock.
-  private func withLock<T>(_ body: () throws -> T) throws -> T {
+  /// Runs `body` while holding the writer lock. Readers do not take it.
+  private func withWriterLock<T>(_ body: () throws -> T) throws -> T {
     try ensureContainingDirectory()
-    let lockPath = stateFilePath + ".lock"
+    let lockPath = stateFilePath + ".writer.lock"
+    let fd = open(lockPath, O_CREAT | O_RDWR, 0o644)
+    if fd < 0 {
+      throw CompanionDiscoveryError.lockFailed(path: lockPath, code: errno)
+    }
+    // Closing the descriptor releases the lock.
+    defer { close(fd) }
     let deadline = Date().addingTimeInterval(lockTimeout)
-    var fd: Int32 = -1
+    while Platform.flock(fd, LOCK_EX | LOCK_NB) != 0 {
+      let err = errno
+      if err != EWOULDBLOCK && err != EINTR {
+        throw CompanionDiscoveryError.lockFailed(path: lockPath, code: err)
+      }
+      if Date() >= deadline {
+        throw CompanionDiscoveryError.lockTimedOut(path: lockPath)
+      }
+      usleep(lockRetryInterval)
+    }
+    let legacyLockPath = try acquireLegacyLock(until: deadline)
+    defer { unlink(legacyLockPath) }
+    return try body()
+  }
+
+  /// Takes the lockfile an older idb creates exclusively around its writes, so writes
+  /// from either version are serialized, returning its path. It is only taken inside
+  /// the writer lock, where an older writer or a dead process is all that can hold it,
+  /// and an older writer holds it for one small write: one still there at the deadline
+  /// is stale, and is broken once.
+  private func acquireLegacyLock(until deadline: Date) throws -> String {
+    let lockPath = stateFilePath + ".lock"
+    var broken = false
     while true {
-      fd = open(lockPath, O_CREAT | O_EXCL | O_RDWR, 0o644)
+      let fd = open(lockPath, O_CREAT | O_EXCL | O_RDWR, 0o644)
       if fd >= 0 {
-        break
+        close(fd)
+        return lockPath
       }
       let err = errno
-      if err != EEXIST {
+      if err != EEXIST && err != EINTR {
         throw CompanionDiscoveryError.lockFailed(path: lockPath, code: err)
       }
       if Date() >= deadline {
-        throw CompanionDiscoveryError.lockTimedOut(path: lockPath)
+        if broken {
+          throw CompanionDiscoveryError.lockTimedOut(path: lockPath)
+        }
+        broken = true
+        unlink(lockPath)
+        continue
       }
       usleep(lockRetryInterval)
     }
-    defer {
-      close(fd)
-      unlink(lockPath)
-    }
-    return try body()
   }
 }
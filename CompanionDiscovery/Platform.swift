@@ -40,4 +40,15 @@ enum Platform {
     return Musl.connect(fd, address, length)
     #endif
   }
+
+  /// `flock` is also the name of a C struct, so the function is qualified.
+  static func flock(_ fd: Int32, _ operation: Int32) -> Int32 {
+    #if os(macOS)
+    return Darwin.flock(fd, operation)
+    #elseif canImport(Glibc)
+    return Glibc.flock(fd, operation)
+    #elseif canImport(Musl)
+    return Musl.flock(fd, operation)
+    #endif
+  }
 }
@@ -6,6 +6,7 @@
  */
 
 import CompanionDiscovery
+import Darwin
 import Foundation
 import Testing
 
@@ -135,6 +136,70 @@ struct CompanionRegistryTests {
     }
   }
 
+  @Test
+  func concurrentWritersDoNotLoseUpdates() throws {
+    try withTemporaryStateFile { statePath in
+      DispatchQueue.concurrentPerform(iterations: 32) { index in
+        // Separate instances, as separate processes would have.
+        let registry = CompanionRegistry(stateFilePath: statePath)
+        try? registry.add(CompanionInfo(udid: "u\(index)", isLocal: true, pid: nil, address: .domainSocket(path: "/tmp/u\(index).sock")))
+      }
+      let companions = try CompanionRegistry(stateFilePath: statePath).companions()
+      #expect(companions.count == 32)
+    }
+  }
+
+  @Test
+  func readsDoNotWaitForWriters() throws {
+    try withTemporaryStateFile { statePath in
+      let registry = CompanionRegistry(stateFilePath: statePath)
+      let info = CompanionInfo(udid: "u1", isLocal: true, pid: 1, address: .domainSocket(path: "/tmp/u1.sock"))
+      try registry.add(info)
+      // A lockfile left behind by an older client, and a writer holding the lock.
+      FileManager.default.createFile(atPath: statePath + ".lock", contents: nil)
+      let fd = open(statePath + ".writer.lock", O_RDWR)
+      #expect(fd >= 0)
+      defer { close(fd) }
+      #expect(Darwin.flock(fd, LOCK_EX) == 0)
+
+      let start = Date()
+      #expect(try registry.companions() == [info])
+      #expect(Date().timeIntervalSince(start) < 1)
+    }
+  }
+
+  @Test
+  func writersWaitForAnOlderWritersLockfile() throws {
+    try withTemporaryStateFile { statePath in
+      let registry = CompanionRegistry(stateFilePath: statePath)
+      let info = CompanionInfo(udid: "u1", isLocal: true, pid: 1, address: .domainSocket(path: "/tmp/u1.sock"))
+      // An older client in the middle of a write, which finishes shortly.
+      FileManager.default.createFile(atPath: statePath + ".lock", contents: nil)
+      DispatchQueue.global().asyncAfter(deadline: .now() + 0.2) {
+        unlink(statePath + ".lock")
+      }
+
+      let start = Date()
+      try registry.add(info)
+      #expect(Date().timeIntervalSince(start) >= 0.15)
+      #expect(try registry.companions() == [info])
+      #expect(!FileManager.default.fileExists(atPath: statePath + ".lock"))
+    }
+  }
+
+  @Test
+  func writesReplaceTheStateFile() throws {
+    try withTemporaryStateFile { statePath in
+      let registry = CompanionRegistry(stateFilePath: statePath)
+      try registry.add(CompanionInfo(udid: "u1", isLocal: true, pid: nil, address: .domainSocket(path: "/tmp/u1.sock")))
+      let before = try FileManager.default.attributesOfItem(atPath: statePath)[.systemFileNumber] as? Int
+      try registry.add(CompanionInfo(udid: "u2", isLocal: true, pid: nil, address: .domainSocket(path: "/tmp/u2.sock")))
+      let after = try FileManager.default.attributesOfItem(atPath: statePath)[.systemFileNumber] as? Int
+      #expect(before != nil)
+      #expect(before != after)
+    }
+  }
+
   // MARK: - Helpers
 
   /// Runs `body` with a path to a state file inside a fresh temporary directory,
@@ -71,22 +71,48 @@ public final class FBIDBCommandExecutor {
     }
   }
 
-  public func install_app_stream(_ input: FBProcessInput<AnyObject>, compression: FBCompressionFormat, make_debuggable makeDebuggable: Bool, override_modification_time overrideModificationTime: Bool) async throws -> FBInstalledArtifact {
+  public func install_app_stream(_ input: FBProcessInput<AnyObject>, compression: FBCompressionFormat, make_debuggable makeDebuggable: Bool, override_modification_time overrideModificationTime: Bool, cache_digest cacheDigest: String? = nil) async throws -> FBInstalledArtifact {
     return try await withFBFutureContext(temporaryDirectory.withArchiveExtracted(fromStream: input, compression: compression, overrideModificationTime: overrideModificationTime)) { extractPath in
+      cacheExtractedArtifact(extractPath as URL, digest: cacheDigest)
       return try await installExtractedApp(extractPath as URL, makeDebuggable: makeDebuggable)
     }
   }
 
+  public func install_app_cached(_ digest: String, make_debuggable makeDebuggable: Bool, override_modification_time overrideModificationTime: Bool) async throws -> FBInstalledArtifact {
+    return try await withCachedArtifact(digest, overrideModificationTime: overrideModificationTime) { extractPath in
+      try await installExtractedApp(extractPath, makeDebuggable: makeDebuggable)
+    }
+  }
+
+  public func install_app_manifest(_ entries: [FBContentManifestEntry], blobs: FBProcessInput<AnyObject>?, compression: FBCompressionFormat, make_debuggable makeDebuggable: Bool, override_modification_time overrideModificationTime: Bool) async throws -> FBInstalledArtifact {
+    if let blobs {
+      try await withFBFutureContext(temporaryDirectory.withArchiveExtracted(fromStream: blobs, compression: compression)) { extractPath in
+        try storageManager.content.ingestBlobs(fromDirectory: extractPath as URL)
+      }
+    }
+    return try await withFBFutureContext(temporaryDirectory.withTemporaryDirectory()) { assemblyPath in
+      try storageManager.content.materialize(entries, into: assemblyPath as URL, overrideModificationTime: overrideModificationTime)
+      return try await installExtractedApp(assemblyPath as URL, makeDebuggable: makeDebuggable)
+    }
+  }
+
   public func install_xctest_app_file_path(_ filePath: String, skipSigningBundles: Bool) async throws -> FBInstalledArtifact {
     return try await installXctestFilePath(URL(fileURLWithPath: filePath), skipSigningBundles: skipSigningBundles)
   }
 
-  public func install_xctest_app_stream(_ stream: FBProcessInput<AnyObject>, skipSigningBundles: Bool) async throws -> FBInstalledArtifact {
+  public func install_xctest_app_stream(_ stream: FBProcessInput<AnyObject>, skipSigningBundles: Bool, cache_digest cacheDigest: String? = nil) async throws -> FBInstalledArtifact {
     return try await withFBFutureContext(temporaryDirectory.withArchiveExtracted(fromStream: stream, compression: .GZIP)) { extractPath in
+      cacheExtractedArtifact(extractPath as URL, digest: cacheDigest)
       return try await installXctest(extractPath as URL, skipSigningBundles: skipSigningBundles)
     }
   }
 
+  public func install_xctest_app_cached(_ digest: String, skipSigningBundles: Bool) async throws -> FBInstalledArtifact {
+    return try await withCachedArtifact(digest, overrideModificationTime: false) { extractPath in
+      try await installXctest(extractPath, skipSigningBundles: skipSigningBundles)
+    }
+  }
+
   public func install_dylib_file_path(_ filePath: String) async throws -> FBInstalledArtifact {
     return try await installFile(URL(fileURLWithPath: filePath), intoStorage: storageManager.dylib)
   }
@@ -464,6 +490,18 @@ public final class FBIDBCommandExecutor {
     try await event.sendAsync(on: hid)
   }
 
+  /// Sends `events` as one gesture, with each delay kept relative to the start of the gesture rather
+  /// than to when the send before it returned.
+  public func hid_batch(_ events: [FBSimulatorHIDEvent]) async throws {
+    try await hid_timeline(FBSimulatorHIDTimeline(.composite(events)))
+  }
+
+  /// Sends a gesture that has already been laid out in time, such as one kept to be repeated.
+  public func hid_timeline(_ timeline: FBSimulatorHIDTimeline) async throws {
+    let hid = try await connectToHID()
+    _ = try await hid.deliver(timeline)
+  }
+
   public func set_hardware_keyboard_enabled(_ enabled: Bool) async throws {
     try await simulatorTarget().apply(.hardwareKeyboard(enabled))
   }
@@ -519,6 +557,12 @@ public final class FBIDBCommandExecutor {
     }
   }
 
+  public func file_attributes(_ path: String, containerType: String?) async throws -> FBContainedFileAttributes? {
+    return try await withFileContainer(for: containerType) { container in
+      try await container.attributes(ofFile: path)
+    }
+  }
+
   public func pull_file(_ path: String, containerType: String?) async throws -> Data {
     return try await withFBFutureContext(temporaryDirectory.withTemporaryDirectory()) { url in
       let tempPath = ((url as URL).path as NSString).appendingPathComponent((path as NSString).lastPathComponent)
@@ -751,6 +795,33 @@ public final class FBIDBCommandExecutor {
     return FBInstalledArtifact(name: appBundle.identifier, uuid: appBundle.binary?.uuid as NSUUID?, path: URL(fileURLWithPath: installedApp.bundle.path))
   }
 
+  /// Adds a freshly extracted archive to the host's install cache. The install goes ahead
+  /// regardless, since the cache only saves work for later installs.
+  private func cacheExtractedArtifact(_ extractPath: URL, digest: String?) {
+    guard let digest else {
+      return
+    }
+    do {
+      try storageManager.installCache.insertArtifact(forDigest: digest, from: extractPath)
+    } catch {
+      logger.error().log("Not caching \(digest): \(error)")
+    }
+  }
+
+  private func withCachedArtifact(_ digest: String, overrideModificationTime: Bool, body: (URL) async throws -> FBInstalledArtifact) async throws -> FBInstalledArtifact {
+    return try await withFBFutureContext(temporaryDirectory.withTemporaryDirectory()) { extractPath in
+      let extractURL = extractPath as URL
+      try storageManager.installCache.cloneArtifact(forDigest: digest, into: extractURL)
+      if overrideModificationTime, let enumerator = FileManager.default.enumerator(atPath: extractURL.path) {
+        let now = Date()
+        for case let path as String in enumerator {
+          try? FileManager.default.setAttributes([.modificationDate: now], ofItemAtPath: extractURL.appendingPathComponent(path).path)
+        }
+      }
+      return try await body(extractURL)
+    }
+  }
+
   private func installXctest(_ extractionDirectory: URL, skipSigningBundles: Bool) async throws -> FBInstalledArtifact {
     return try await storageManager.xctest.saveBundleOrTestRunFromBaseDirectoryAsync(extractionDirectory, skipSigningBundles: skipSigningBundles)
   }
@@ -5,6 +5,7 @@
  * LICENSE file in the root directory of this source tree.
  */
 
+import CryptoKit
 import FBControlCore
 import Foundation
 import XCTestBootstrap
@@ -14,6 +15,7 @@ public let IdbApplicationsFolder: String = "idb-applications"
 public let IdbDylibsFolder: String = "idb-dylibs"
 public let IdbDsymsFolder: String = "idb-dsyms"
 public let IdbFrameworksFolder: String = "idb-frameworks"
+public let IdbContentStoreFolder: String = "idb-content-store"
 
 // MARK: - FBInstalledArtifact
 
@@ -440,6 +442,197 @@ public final class FBXCTestBundleStorage: FBBundleStorage {
   }
 }
 
+// MARK: - FBContentManifestEntry
+
+/// One path of a bundle described by content, rather than shipped as an archive.
+public struct FBContentManifestEntry: Sendable {
+
+  public enum Kind: Sendable {
+    case file
+    case directory
+    case symlink
+  }
+
+  public let path: String
+  public let kind: Kind
+  public let digest: String
+  public let mode: UInt16
+  public let symlinkDestination: String
+
+  public init(path: String, kind: Kind, digest: String, mode: UInt16, symlinkDestination: String) {
+    self.path = path
+    self.kind = kind
+    self.digest = digest
+    self.mode = mode
+    self.symlinkDestination = symlinkDestination
+  }
+}
+
+// MARK: - FBContentAddressedStorage
+
+/// Stores file contents by their sha256, so that bundles can be reassembled from a manifest
+/// and only the files that changed between installs need to be uploaded.
+public final class FBContentAddressedStorage: FBIDBStorage {
+
+  public static let defaultMaximumSize: UInt64 = 4 * 1024 * 1024 * 1024
+
+  /// The store evicts the least recently used blobs beyond this size, skipping any used in the last
+  /// `evictionGracePeriod`: an install between asking for its missing digests and materializing may need them.
+  public let maximumSize: UInt64
+  public let evictionGracePeriod: TimeInterval
+
+  public init(target: FBiOSTarget, basePath: URL, queue: DispatchQueue, logger: FBControlCoreLogger, maximumSize: UInt64 = defaultMaximumSize, evictionGracePeriod: TimeInterval = 600) {
+    self.maximumSize = maximumSize
+    self.evictionGracePeriod = evictionGracePeriod
+    super.init(target: target, basePath: basePath, queue: queue, logger: logger)
+  }
+
+  public func blobURL(forDigest digest: String) -> URL {
+    basePath.appendingPathComponent(digest)
+  }
+
+  /// The unique file digests in the manifest that are not in the store, in manifest order.
+  /// Those that are count as used, so they are not evicted before the install materializes them.
+  public func missingDigests(_ entries: [FBContentManifestEntry]) -> [String] {
+    var seen = Set<String>()
+    var missing: [String] = []
+    for entry in entries where entry.kind == .file && seen.insert(entry.digest).inserted {
+      // An invalid digest is not asked for; materializing rejects it.
+      if FBInstallArtifactCache.isValidDigest(entry.digest), !markUsed(blobURL(forDigest: entry.digest)) {
+        missing.append(entry.digest)
+      }
+    }
+    return missing
+  }
+
+  /// Moves every file in `directory`, named by its digest, into the store, then evicts beyond the size bound.
+  /// The directory is client-supplied, so anything but a regular file named by a digest of its contents is rejected.
+  public func ingestBlobs(fromDirectory directory: URL) throws {
+    let fileManager = FileManager.default
+    let urls = try fileManager.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil, options: [])
+    for url in urls {
+      let digest = url.lastPathComponent
+      guard FBInstallArtifactCache.isValidDigest(digest) else {
+        throw FBIDBError.describe("Uploaded content \(digest) is not named by a digest").build()
+      }
+      // Not following links: a link would otherwise be hashed, and stored, as whatever it points to.
+      guard try fileManager.attributesOfItem(atPath: url.path)[.type] as? FileAttributeType == .typeRegular else {
+        throw FBIDBError.describe("Uploaded content for \(digest) is not a regular file").build()
+      }
+      let actual = try Self.digest(ofFileAt: url)
+      guard actual == digest else {
+        throw FBIDBError.describe("Uploaded content for \(digest) has digest \(actual)").build()
+      }
+      let destination = blobURL(forDigest: digest)
+      do {
+        try fileManager.moveItem(at: url, to: destination)
+      } catch let error as CocoaError where error.code == .fileWriteFileExists {
+        // Already stored, perhaps by a concurrent install of the same content; the contents are identical.
+      }
+      markUsed(destination)
+    }
+    logger.log("Ingested \(urls.count) blobs into \(basePath)")
+    evictLeastRecentlyUsed()
+  }
+
+  /// Removes the least recently used blobs until the store is within `maximumSize`.
+  public func evictLeastRecentlyUsed(now: Date = Date()) {
+    let fileManager = FileManager.default
+    guard let names = try? fileManager.contentsOfDirectory(atPath: basePath.path) else {
+      return
+    }
+    var blobs: [(url: URL, size: UInt64, lastUse: Date)] = []
+    for name in names {
+      let url = blobURL(forDigest: name)
+      guard
+        let attributes = try? fileManager.attributesOfItem(atPath: url.path),
+        let size = attributes[.size] as? NSNumber,
+        let lastUse = attributes[.modificationDate] as? Date
+      else {
+        continue
+      }
+      blobs.append((url, size.uint64Value, lastUse))
+    }
+    var total = blobs.reduce(0) { $0 + $1.size }
+    for blob in blobs.sorted(by: { $0.lastUse < $1.lastUse }) where total > maximumSize {
+      if now.timeIntervalSince(blob.lastUse) < evictionGracePeriod {
+        break
+      }
+      guard (try? fileManager.removeItem(at: blob.url)) != nil else {
+        continue
+      }
+      total -= blob.size
+      logger.log("Evicted \(blob.url.lastPathComponent) (\(blob.size) bytes) from the content store")
+    }
+  }
+
+  /// Records a use of the blob at `url` in its modification date, returning whether it is stored.
+  @discardableResult
+  private func markUsed(_ url: URL) -> Bool {
+    (try? FileManager.default.setAttributes([.modificationDate: Date()], ofItemAtPath: url.path)) != nil
+  }
+
+  /// Recreates the manifest's tree inside `directory`, cloning file contents out of the store.
+  public func materialize(_ entries: [FBContentManifestEntry], into directory: URL, overrideModificationTime: Bool) throws {
+    let fileManager = FileManager.default
+    let now = Date()
+    func applyAttributes(_ entry: FBContentManifestEntry, at url: URL) throws {
+      var attributes: [FileAttributeKey: Any] = [.posixPermissions: NSNumber(value: entry.mode & 0o7777)]
+      if overrideModificationTime {
+        attributes[.modificationDate] = now
+      }
+      try fileManager.setAttributes(attributes, ofItemAtPath: url.path)
+    }
+
+    var directories: [(FBContentManifestEntry, URL)] = []
+    var symlinks: [(FBContentManifestEntry, URL)] = []
+    for entry in entries {
+      let components = entry.path.split(separator: "/")
+      guard !entry.path.hasPrefix("/"), !components.isEmpty, !components.contains("..") else {
+        throw FBIDBError.describe("Invalid manifest path \(entry.path)").build()
+      }
+      let destination = directory.appendingPathComponent(entry.path)
+      try fileManager.createDirectory(at: destination.deletingLastPathComponent(), withIntermediateDirectories: true, attributes: nil)
+      switch entry.kind {
+      case .directory:
+        try fileManager.createDirectory(at: destination, withIntermediateDirectories: true, attributes: nil)
+        directories.append((entry, destination))
+      case .symlink:
+        symlinks.append((entry, destination))
+      case .file:
+        guard FBInstallArtifactCache.isValidDigest(entry.digest) else {
+          throw FBIDBError.describe("Invalid digest \(entry.digest) for \(entry.path)").build()
+        }
+        let blob = blobURL(forDigest: entry.digest)
+        guard markUsed(blob) else {
+          throw FBIDBError.describe("Content \(entry.digest) for \(entry.path) was not uploaded").build()
+        }
+        // On APFS this is a clonefile, so no data is duplicated.
+        try fileManager.copyItem(at: blob, to: destination)
+        try applyAttributes(entry, at: destination)
+      }
+    }
+    // Links are created after everything else, so no other entry can be written through one.
+    for (entry, destination) in symlinks {
+      try fileManager.createSymbolicLink(atPath: destination.path, withDestinationPath: entry.symlinkDestination)
+    }
+    // Directory permissions last, deepest first, so a read-only directory can still be populated.
+    for (entry, destination) in directories.reversed() {
+      try applyAttributes(entry, at: destination)
+    }
+  }
+
+  static func digest(ofFileAt url: URL) throws -> String {
+    let handle = try FileHandle(forReadingFrom: url)
+    defer { try? handle.close() }
+    var hasher = SHA256()
+    while let chunk = try handle.read(upToCount: 1024 * 1024), !chunk.isEmpty {
+      hasher.update(data: chunk)
+    }
+    return hasher.finalize().map { String(format: "%02x", $0) }.joined()
+  }
+}
+
 // MARK: - FBIDBStorageManager
 
 public final class FBIDBStorageManager {
@@ -448,18 +641,23 @@ public final class FBIDBStorageManager {
   public let dylib: FBFileStorage
   public let dsym: FBFileStorage
   public let framework: FBBundleStorage
+  public let content: FBContentAddressedStorage
+  /// Shared by every target on the host, so it is not emptied by `clean()`.
+  public let installCache: FBInstallArtifactCache
   public let logger: FBControlCoreLogger
 
-  private init(xctest: FBXCTestBundleStorage, application: FBBundleStorage, dylib: FBFileStorage, dsym: FBFileStorage, framework: FBBundleStorage, logger: FBControlCoreLogger) {
+  private init(xctest: FBXCTestBundleStorage, application: FBBundleStorage, dylib: FBFileStorage, dsym: FBFileStorage, framework: FBBundleStorage, content: FBContentAddressedStorage, installCache: FBInstallArtifactCache, logger: FBControlCoreLogger) {
     self.xctest = xctest
     self.application = application
     self.dylib = dylib
     self.dsym = dsym
     self.framework = framework
+    self.content = content
+    self.installCache = installCache
     self.logger = logger
   }
 
-  public static func manager(forTarget target: FBiOSTarget, logger: FBControlCoreLogger) throws -> FBIDBStorageManager {
+  public static func manager(forTarget target: FBiOSTarget, installCacheSize: UInt64 = FBInstallArtifactCache.defaultMaximumSize, logger: FBControlCoreLogger) throws -> FBIDBStorageManager {
     let queue = DispatchQueue(label: "com.facebook.idb.bundle_storage")
 
     let xctestBasePath = try prepareStoragePath(withName: IdbTestBundlesFolder, target: target)
@@ -477,7 +675,12 @@ public final class FBIDBStorageManager {
     let frameworkBasePath = try prepareStoragePath(withName: IdbFrameworksFolder, target: target)
     let framework = FBBundleStorage(target: target, basePath: frameworkBasePath, queue: queue, logger: logger, relocateLibraries: true)
 
-    return FBIDBStorageManager(xctest: xctest, application: application, dylib: dylib, dsym: dsym, framework: framework, logger: logger)
+    let contentBasePath = try prepareStoragePath(withName: IdbContentStoreFolder, target: target)
+    let content = FBContentAddressedStorage(target: target, basePath: contentBasePath, queue: queue, logger: logger)
+
+    let installCache = FBInstallArtifactCache.hostCache(maximumSize: installCacheSize, logger: logger)
+
+    return FBIDBStorageManager(xctest: xctest, application: application, dylib: dylib, dsym: dsym, framework: framework, content: content, installCache: installCache, logger: logger)
   }
 
   public func clean() throws {
@@ -486,6 +689,7 @@ public final class FBIDBStorageManager {
     try dylib.clean()
     try dsym.clean()
     try framework.clean()
+    try content.clean()
   }
 
   public func interpolateArgumentReplacements(_ arguments: [String]?) -> [String] {
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CryptoKit
+import FBControlCore
+import Foundation
+
+public let IdbInstallArtifactCacheFolder: String = "idb-install-artifacts"
+
+/// A host-wide cache of extracted install archives, keyed by the digest of their contents.
+///
+/// Every companion on a host shares the same cache directory, so a bundle that was uploaded
+/// to one simulator can be installed on its siblings without being uploaded or extracted again.
+/// Each entry is an extracted archive, exactly as the install would have seen it. Installs
+/// consume their extracted directory, so a hit is cloned out of the cache rather than used in place.
+///
+/// Entries are verified against their digest before they are added, so one client cannot
+/// place content under another bundle's digest. The cache is bounded by `maximumSize` and
+/// evicts the least recently used entries, skipping any used in the last `evictionGracePeriod`,
+/// since another companion may be cloning them.
+///
+/// Companions coordinate only through the filesystem: entries are staged and renamed into
+/// place, and removed by renaming them aside first.
+public final class FBInstallArtifactCache: @unchecked Sendable {
+
+  public static let defaultMaximumSize: UInt64 = 8 * 1024 * 1024 * 1024
+
+  public let basePath: URL
+  public let maximumSize: UInt64
+  public let evictionGracePeriod: TimeInterval
+  private let logger: FBControlCoreLogger
+
+  private static let treeDirectoryName = "tree"
+  private static let sizeFileName = "size"
+
+  public init(basePath: URL, maximumSize: UInt64 = defaultMaximumSize, evictionGracePeriod: TimeInterval = 600, logger: FBControlCoreLogger) {
+    self.basePath = basePath
+    self.maximumSize = maximumSize
+    self.evictionGracePeriod = evictionGracePeriod
+    self.logger = logger
+  }
+
+  /// The cache shared by every companion run by the current user.
+  public static func hostCache(maximumSize: UInt64 = defaultMaximumSize, logger: FBControlCoreLogger) -> FBInstallArtifactCache {
+    let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first ?? FileManager.default.temporaryDirectory
+    let basePath = caches.appendingPathComponent("com.facebook.idb").appendingPathComponent(IdbInstallArtifactCacheFolder)
+    return FBInstallArtifactCache(basePath: basePath, maximumSize: maximumSize, logger: logger)
+  }
+
+  public var isEnabled: Bool {
+    maximumSize > 0
+  }
+
+  /// Whether `digest` is cached. A hit counts as a use, so the entry will not be evicted
+  /// before the caller gets to ``cloneArtifact(forDigest:into:)``.
+  public func hasArtifact(forDigest digest: String) -> Bool {
+    guard isEnabled, Self.isValidDigest(digest) else {
+      return false
+    }
+    let entry = entryURL(forDigest: digest)
+    guard FileManager.default.fileExists(atPath: entry.appendingPathComponent(Self.sizeFileName).path) else {
+      return false
+    }
+    try? FileManager.default.setAttributes([.modificationDate: Date()], ofItemAtPath: entry.path)
+    return true
+  }
+
+  /// Clones the cached extraction for `digest` into the empty directory `directory`.
+  public func cloneArtifact(forDigest digest: String, into directory: URL) throws {
+    let tree = entryURL(forDigest: digest).appendingPathComponent(Self.treeDirectoryName)
+    let contents = try FileManager.default.contentsOfDirectory(atPath: tree.path)
+    for name in contents {
+      // On APFS this is a clonefile, so no data is duplicated.
+      try FileManager.default.copyItem(at: tree.appendingPathComponent(name), to: directory.appendingPathComponent(name))
+    }
+    logger.log("Installing \(digest) from the artifact cache at \(basePath)")
+  }
+
+  /// Adds a clone of `extractedDirectory` to the cache as `digest`, then evicts entries
+  /// beyond the size bound. Nothing is added if the contents do not hash to `digest`.
+  public func insertArtifact(forDigest digest: String, from extractedDirectory: URL) throws {
+    guard isEnabled, Self.isValidDigest(digest) else {
+      return
+    }
+    let actual = try Self.digest(ofTreeAt: extractedDirectory)
+    guard actual == digest else {
+      throw FBIDBError.describe("Extracted bundle has digest \(actual), not the \(digest) it was uploaded as").build()
+    }
+    let fileManager = FileManager.default
+    try fileManager.createDirectory(at: basePath, withIntermediateDirectories: true, attributes: nil)
+    let staging = basePath.appendingPathComponent(".staging-\(UUID().uuidString)")
+    defer { try? fileManager.removeItem(at: staging) }
+    let tree = staging.appendingPathComponent(Self.treeDirectoryName)
+    try fileManager.createDirectory(at: tree, withIntermediateDirectories: true, attributes: nil)
+    for name in try fileManager.contentsOfDirectory(atPath: extractedDirectory.path) {
+      try fileManager.copyItem(at: extractedDirectory.appendingPathComponent(name), to: tree.appendingPathComponent(name))
+    }
+    let size = try Self.allocatedSize(ofTreeAt: tree)
+    try Data(String(size).utf8).write(to: staging.appendingPathComponent(Self.sizeFileName))
+
+    // Another companion may have added the same digest since the lookup; its copy is identical.
+    if rename(staging.path, entryURL(forDigest: digest).path) != 0 {
+      logger.log("\(digest) was added to the artifact cache concurrently")
+      return
+    }
+    logger.log("Added \(digest) (\(size) bytes) to the artifact cache at \(basePath)")
+    evictLeastRecentlyUsed()
+  }
+
+  /// Removes the least recently used entries until the cache is within `maximumSize`,
+  /// along with anything left behind by a companion that exited while staging or evicting.
+  public func evictLeastRecentlyUsed(now: Date = Date()) {
+    let fileManager = FileManager.default
+    guard let names = try? fileManager.contentsOfDirectory(atPath: basePath.path) else {
+      return
+    }
+    var entries: [(url: URL, size: UInt64, lastUse: Date)] = []
+    for name in names {
+      let url = basePath.appendingPathComponent(name)
+      if name.hasPrefix(".") {
+        let modified = (try? fileManager.attributesOfItem(atPath: url.path))?[.modificationDate] as? Date
+        if let modified, now.timeIntervalSince(modified) > evictionGracePeriod {
+          try? fileManager.removeItem(at: url)
+        }
+        continue
+      }
+      guard
+        Self.isValidDigest(name),
+        let sizeData = try? Data(contentsOf: url.appendingPathComponent(Self.sizeFileName)),
+        let size = UInt64(String(decoding: sizeData, as: UTF8.self)),
+        let lastUse = (try? fileManager.attributesOfItem(atPath: url.path))?[.modificationDate] as? Date
+      else {
+        continue
+      }
+      entries.append((url, size, lastUse))
+    }
+    var total = entries.reduce(0) { $0 + $1.size }
+    for entry in entries.sorted(by: { $0.lastUse < $1.lastUse }) where total > maximumSize {
+      if now.timeIntervalSince(entry.lastUse) < evictionGracePeriod {
+        break
+      }
+      let trash = basePath.appendingPathComponent(".evicted-\(UUID().uuidString)")
+      guard rename(entry.url.path, trash.path) == 0 else {
+        continue
+      }
+      try? fileManager.removeItem(at: trash)
+      total -= entry.size
+      logger.log("Evicted \(entry.url.lastPathComponent) (\(entry.size) bytes) from the artifact cache")
+    }
+  }
+
+  private func entryURL(forDigest digest: String) -> URL {
+    basePath.appendingPathComponent(digest)
+  }
+
+  /// Digests name directories in the cache, so they must be exactly a sha256 in hex.
+  public static func isValidDigest(_ digest: String) -> Bool {
+    digest.count == 64 && digest.allSatisfy { $0.isHexDigit && !$0.isUppercase }
+  }
+
+  /// The sha256 of every path under `directory`, in the same form as the client's
+  /// `bundle_tree_digest`: a record per path, in order of the path's UTF-8 bytes,
+  /// of the kind, the path and the file's digest and owner-executable bit, or the link's destination.
+  public static func digest(ofTreeAt directory: URL) throws -> String {
+    let fileManager = FileManager.default
+    guard let enumerator = fileManager.enumerator(atPath: directory.path) else {
+      throw FBIDBError.describe("Could not enumerate \(directory)").build()
+    }
+    var records: [(path: String, record: String)] = []
+    while let path = enumerator.nextObject() as? String {
+      let url = directory.appendingPathComponent(path)
+      let attributes = try fileManager.attributesOfItem(atPath: url.path)
+      switch attributes[.type] as? FileAttributeType {
+      case .typeDirectory?:
+        records.append((path, "D\0\(path)\0\0"))
+      case .typeSymbolicLink?:
+        let destination = try fileManager.destinationOfSymbolicLink(atPath: url.path)
+        records.append((path, "L\0\(path)\0\(destination)\0"))
+      case .typeRegular?:
+        let permissions = (attributes[.posixPermissions] as? NSNumber)?.uint16Value ?? 0
+        let executable = permissions & 0o100 != 0 ? "x" : ""
+        records.append((path, "F\0\(path)\0\(try FBContentAddressedStorage.digest(ofFileAt: url))\(executable)\0"))
+      default:
+        continue
+      }
+    }
+    var hasher = SHA256()
+    for (_, record) in records.sorted(by: { $0.path.utf8.lexicographicallyPrecedes($1.path.utf8) }) {
+      hasher.update(data: Data(record.utf8))
+    }
+    return hasher.finalize().map { String(format: "%02x", $0) }.joined()
+  }
+
+  private static func allocatedSize(ofTreeAt directory: URL) throws -> UInt64 {
+    guard let enumerator = FileManager.default.enumerator(at: directory, includingPropertiesForKeys: [.totalFileAllocatedSizeKey], options: []) else {
+      return 0
+    }
+    var size: UInt64 = 0
+    for case let url as URL in enumerator {
+      size += UInt64(try url.resourceValues(forKeys: [.totalFileAllocatedSizeKey]).totalFileAllocatedSize ?? 0)
+    }
+    return size
+  }
+}
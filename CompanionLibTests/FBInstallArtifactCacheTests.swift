@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CompanionLib
+import FBControlCore
+import Foundation
+import XCTest
+
+final class FBInstallArtifactCacheTests: XCTestCase {
+
+  private var root: URL!
+
+  override func setUpWithError() throws {
+    root = FileManager.default.temporaryDirectory.appendingPathComponent("FBInstallArtifactCacheTests-\(UUID().uuidString)")
+    try FileManager.default.createDirectory(at: root, withIntermediateDirectories: true, attributes: nil)
+  }
+
+  override func tearDownWithError() throws {
+    try? FileManager.default.removeItem(at: root)
+  }
+
+  private func makeCache(maximumSize: UInt64 = FBInstallArtifactCache.defaultMaximumSize, evictionGracePeriod: TimeInterval = 0) -> FBInstallArtifactCache {
+    FBInstallArtifactCache(basePath: root.appendingPathComponent("cache"), maximumSize: maximumSize, evictionGracePeriod: evictionGracePeriod, logger: FBControlCoreGlobalConfiguration.defaultLogger)
+  }
+
+  /// The same tree as `BundleDigestTests` in idb/grpc/tests/install_tests.py.
+  private func makeExtraction(named name: String, plist: String = "plist") throws -> URL {
+    let extraction = root.appendingPathComponent(name)
+    let app = extraction.appendingPathComponent("Foo.app")
+    try FileManager.default.createDirectory(at: app.appendingPathComponent("Frameworks"), withIntermediateDirectories: true, attributes: nil)
+    try Data("binary".utf8).write(to: app.appendingPathComponent("Foo"))
+    try FileManager.default.setAttributes([.posixPermissions: 0o755], ofItemAtPath: app.appendingPathComponent("Foo").path)
+    try Data(plist.utf8).write(to: app.appendingPathComponent("Info.plist"))
+    try FileManager.default.setAttributes([.posixPermissions: 0o644], ofItemAtPath: app.appendingPathComponent("Info.plist").path)
+    try FileManager.default.createSymbolicLink(atPath: app.appendingPathComponent("Link").path, withDestinationPath: "Foo")
+    return extraction
+  }
+
+  func testTreeDigestMatchesClient() throws {
+    let extraction = try makeExtraction(named: "extraction")
+    XCTAssertEqual(try FBInstallArtifactCache.digest(ofTreeAt: extraction), "539f3041599a7e8ce8735be03b3b86b27bddc05300d00faa2fc3a83dc0ccf61f")
+  }
+
+  func testInsertedArtifactIsClonedOnHit() throws {
+    let cache = makeCache()
+    let extraction = try makeExtraction(named: "extraction")
+    let digest = try FBInstallArtifactCache.digest(ofTreeAt: extraction)
+    XCTAssertFalse(cache.hasArtifact(forDigest: digest))
+
+    try cache.insertArtifact(forDigest: digest, from: extraction)
+    // The install consumes its extraction, the cache must hold its own copy.
+    try FileManager.default.removeItem(at: extraction)
+    XCTAssertTrue(cache.hasArtifact(forDigest: digest))
+
+    let clone = root.appendingPathComponent("clone")
+    try FileManager.default.createDirectory(at: clone, withIntermediateDirectories: true, attributes: nil)
+    try cache.cloneArtifact(forDigest: digest, into: clone)
+    XCTAssertEqual(try FBInstallArtifactCache.digest(ofTreeAt: clone), digest)
+  }
+
+  func testRejectsContentThatDoesNotMatchDigest() throws {
+    let cache = makeCache()
+    let extraction = try makeExtraction(named: "extraction")
+    let other = try makeExtraction(named: "other", plist: "other")
+    let digest = try FBInstallArtifactCache.digest(ofTreeAt: other)
+
+    XCTAssertThrowsError(try cache.insertArtifact(forDigest: digest, from: extraction))
+    XCTAssertFalse(cache.hasArtifact(forDigest: digest))
+  }
+
+  func testEvictsLeastRecentlyUsed() throws {
+    let first = try makeExtraction(named: "first", plist: "first")
+    let second = try makeExtraction(named: "second", plist: "second")
+    let firstDigest = try FBInstallArtifactCache.digest(ofTreeAt: first)
+    let secondDigest = try FBInstallArtifactCache.digest(ofTreeAt: second)
+
+    try makeCache().insertArtifact(forDigest: firstDigest, from: first)
+    try FileManager.default.setAttributes([.modificationDate: Date(timeIntervalSinceNow: -60)], ofItemAtPath: root.appendingPathComponent("cache").appendingPathComponent(firstDigest).path)
+
+    // Too small for either entry, but the one just added is within its grace period.
+    let cache = makeCache(maximumSize: 1, evictionGracePeriod: 30)
+    try cache.insertArtifact(forDigest: secondDigest, from: second)
+
+    XCTAssertFalse(cache.hasArtifact(forDigest: firstDigest))
+    XCTAssertTrue(cache.hasArtifact(forDigest: secondDigest))
+  }
+
+  func testDisabledCacheStoresNothing() throws {
+    let cache = makeCache(maximumSize: 0)
+    let extraction = try makeExtraction(named: "extraction")
+    let digest = try FBInstallArtifactCache.digest(ofTreeAt: extraction)
+
+    try cache.insertArtifact(forDigest: digest, from: extraction)
+    XCTAssertFalse(cache.hasArtifact(forDigest: digest))
+  }
+}
@@ -82,7 +82,7 @@ public enum CompanionClient {
   /// identity, or nil for plaintext (a Unix domain socket, `.disabled`, or
   /// `.metaIdentity` with no registered provider). Verification is disabled
   /// (present an identity, do not verify the peer).
-  private static func makeClientSSLContext(
+  static func makeClientSSLContext(
     for address: CompanionAddress,
     tls: CompanionClientTLS
   ) throws -> NIOSSLContext? {
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CompanionDiscovery
+import Foundation
+@_implementationOnly import NIOCore
+@_implementationOnly import NIOPosix
+@_implementationOnly import NIOSSL
+
+/// A persistent connection to a companion that many JSON-RPC requests share.
+///
+/// Unlike `CompanionClient`, which opens a connection per request, this opts the
+/// connection in to keep-alive and pipelines: `send` writes the request straight
+/// away, without waiting for earlier requests to be answered, and any number of
+/// callers can await their responses at once. The companion answers each request
+/// as soon as it completes, so responses are matched back to requests by their
+/// `id`, which the connection assigns. TLS is chosen as for `CompanionClient`.
+public final class CompanionConnection: @unchecked Sendable {
+  private let group: MultiThreadedEventLoopGroup
+  private let channel: Channel
+  private let lock = NSLock()
+  // Guarded by `lock`.
+  private let encoder = JSONEncoder()
+  private var nextID = 1
+  private var pending: [Int: CheckedContinuation<JSONRPCResponse, Error>] = [:]
+  private var closed = false
+  private var groupShutDown = false
+
+  private init(group: MultiThreadedEventLoopGroup, channel: Channel) {
+    self.group = group
+    self.channel = channel
+  }
+
+  /// Shuts the event loop group down if the connection is dropped without `close()`.
+  /// Not `syncShutdownGracefully`: the last reference can be released on the group's
+  /// own thread, where waiting for the group to stop would never return.
+  deinit {
+    let shutDown = lock.withLock { groupShutDown }
+    if !shutDown {
+      group.shutdownGracefully { _ in }
+    }
+  }
+
+  /// Connects to `address` and switches the connection to keep-alive.
+  public static func connect(
+    to address: CompanionAddress,
+    tls: CompanionClientTLS = .metaIdentity
+  ) async throws -> CompanionConnection {
+    let sslContext = try CompanionClient.makeClientSSLContext(for: address, tls: tls)
+    let group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+    // The router is handed the connection once it exists, before anything is sent,
+    // so no response can arrive without somewhere to go.
+    let router = ResponseRouter()
+    let bootstrap = ClientBootstrap(group: group)
+      .channelInitializer { channel in
+        var handlers: [ChannelHandler] = []
+        if let sslContext {
+          do {
+            // No serverHostname: peer verification is disabled, as for CompanionClient.
+            handlers.append(try NIOSSLClientHandler(context: sslContext, serverHostname: nil))
+          } catch {
+            return channel.eventLoop.makeFailedFuture(error)
+          }
+        }
+        handlers.append(ByteToMessageHandler(NewlineFrameDecoder()))
+        handlers.append(router)
+        return channel.pipeline.addHandlers(handlers)
+      }
+    do {
+      let channel: Channel
+      switch address {
+      case let .domainSocket(path):
+        channel = try await bootstrap.connect(unixDomainSocketPath: path).get()
+      case let .tcp(host, port):
+        channel = try await bootstrap.connect(host: host, port: port).get()
+      }
+      let connection = CompanionConnection(group: group, channel: channel)
+      router.connection = connection
+      // A notification, so there is no reply to wait for before pipelining.
+      try await connection.write(JSONRPCRequest(method: JSONRPCConnectionHandler.keepAliveMethod))
+      return connection
+    } catch {
+      try? await group.shutdownGracefully()
+      throw error
+    }
+  }
+
+  /// Sends a request and suspends until its response arrives. Safe to call
+  /// concurrently; each request is written as soon as it is sent.
+  public func send(method: String, params: JSONValue? = nil) async throws -> JSONRPCResponse {
+    try await withCheckedThrowingContinuation { continuation in
+      lock.lock()
+      defer { lock.unlock() }
+      guard !closed else {
+        continuation.resume(throwing: CompanionConnectionError.closed)
+        return
+      }
+      let id = nextID
+      nextID += 1
+      let buffer: ByteBuffer
+      do {
+        buffer = try encode(JSONRPCRequest(method: method, params: params, id: .number(Double(id))))
+      } catch {
+        continuation.resume(throwing: error)
+        return
+      }
+      pending[id] = continuation
+      // Written under the lock, so requests go out in the order ids were assigned.
+      channel.writeAndFlush(buffer).whenFailure { [weak self] error in
+        self?.complete(id: id, with: .failure(error))
+      }
+    }
+  }
+
+  /// Closes the connection. Requests still awaiting a response fail with
+  /// `CompanionConnectionError.closed`.
+  public func close() async {
+    try? await channel.close().get()
+    failAll(CompanionConnectionError.closed)
+    let shutDown = lock.withLock {
+      defer { groupShutDown = true }
+      return groupShutDown
+    }
+    if !shutDown {
+      try? await group.shutdownGracefully()
+    }
+  }
+
+  // MARK: - Helpers
+
+  private func write(_ request: JSONRPCRequest) async throws {
+    let buffer = try lock.withLock { try encode(request) }
+    try await channel.writeAndFlush(buffer).get()
+  }
+
+  /// Encodes `request` as one line. Called with `lock` held.
+  private func encode(_ request: JSONRPCRequest) throws -> ByteBuffer {
+    guard let data = try? encoder.encode(request) else {
+      throw CompanionClientError.encodeFailed
+    }
+    var buffer = channel.allocator.buffer(capacity: data.count + 1)
+    buffer.writeBytes(data)
+    buffer.writeInteger(UInt8(ascii: "\n"))
+    return buffer
+  }
+
+  fileprivate func received(_ response: JSONRPCResponse) {
+    guard case let .number(value)? = response.id, let id = Int(exactly: value) else {
+      companionServerLog("CompanionConnection: ignoring response without a request id: \(response)")
+      return
+    }
+    complete(id: id, with: .success(response))
+  }
+
+  private func complete(id: Int, with result: Result<JSONRPCResponse, Error>) {
+    lock.lock()
+    let continuation = pending.removeValue(forKey: id)
+    lock.unlock()
+    continuation?.resume(with: result)
+  }
+
+  fileprivate func failAll(_ error: Error) {
+    lock.lock()
+    closed = true
+    let continuations = pending.values
+    pending.removeAll()
+    lock.unlock()
+    for continuation in continuations {
+      continuation.resume(throwing: error)
+    }
+  }
+}
+
+/// Errors raised by `CompanionConnection`.
+public enum CompanionConnectionError: Error, CustomStringConvertible {
+  /// The connection was closed, by either end, before the response arrived.
+  case closed
+
+  public var description: String {
+    switch self {
+    case .closed:
+      return "The companion connection was closed"
+    }
+  }
+}
+
+/// Decodes each response line and hands it to the connection, failing every
+/// outstanding request once the connection goes away. Runs on the channel's event
+/// loop; the connection does its own locking.
+private final class ResponseRouter: ChannelInboundHandler, @unchecked Sendable {
+  typealias InboundIn = ByteBuffer
+
+  weak var connection: CompanionConnection?
+  private let decoder = JSONDecoder()
+
+  func channelRead(context: ChannelHandlerContext, data: NIOAny) {
+    let buffer = unwrapInboundIn(data)
+    guard
+      let response = try? buffer.withUnsafeReadableBytes({ bytes in
+        try decoder.decode(JSONRPCResponse.self, from: Data(bytes))
+      })
+    else {
+      companionServerLog("CompanionConnection: ignoring non-JSON-RPC line")
+      return
+    }
+    connection?.received(response)
+  }
+
+  func channelInactive(context: ChannelHandlerContext) {
+    connection?.failAll(CompanionConnectionError.closed)
+    context.fireChannelInactive()
+  }
+
+  func errorCaught(context: ChannelHandlerContext, error: Error) {
+    connection?.failAll(error)
+    context.close(promise: nil)
+  }
+}
@@ -38,8 +38,13 @@ public enum CompanionListenTarget: Sendable, Equatable {
 /// A `.domainSocket` server records itself in that version's `CompanionDiscovery`
 /// registry, so a discoverer (e.g. `CompanionManager(version: .v2)`) finds it; a
 /// `.tcp` server is reached by explicit address and is not registered. Incoming
-/// connections are framed as newline-delimited JSON-RPC; for now each received
-/// request is just handed to `onRequest`, which by default prints it.
+/// connections are framed as newline-delimited JSON-RPC; each received request is
+/// handed to `onRequest`, which by default prints it.
+///
+/// A connection answers one request and is closed, unless the client opts in to
+/// keep-alive, after which it can pipeline many requests over the one connection
+/// and receives responses as they complete; see `JSONRPCConnectionHandler` and
+/// `CompanionConnection`. Connections are spread over `eventLoopThreads` threads.
 ///
 /// A `.tcp` listen can enable TLS by supplying a certificate PEM; see
 /// `CompanionListenTarget`.
@@ -55,8 +60,9 @@ public enum CompanionListenTarget: Sendable, Equatable {
 public final class CompanionServer: @unchecked Sendable {
   /// Invoked for every JSON-RPC request received on any connection. Awaited to
   /// completion (the idle countdown is paused for its duration); the returned
-  /// response, if any, is written back to the client before the connection is
-  /// closed. Return nil for a request that warrants no reply.
+  /// response, if any, is written back to the client. Requests from a keep-alive
+  /// connection are handled concurrently. Return nil for a request that warrants
+  /// no reply.
   public typealias RequestHandler = @Sendable (JSONRPCRequest) async -> JSONRPCResponse?
 
   private let udid: String
@@ -124,6 +130,9 @@ public final class CompanionServer: @unchecked Sendable {
   ///   - registry: the registry to record this server in. Defaults to one rooted
   ///     at `version`'s state file; pass an explicit registry to override it
   ///     (e.g. a test fixture with an isolated state file).
+  ///   - eventLoopThreads: how many threads accept connections and read and write
+  ///     them. Requests are processed off these threads, so one is enough unless
+  ///     there are many busy connections. Defaults to 1.
   ///   - onRequest: invoked for each received JSON-RPC request. Defaults to
   ///     printing the request.
   public init(
@@ -132,6 +141,7 @@ public final class CompanionServer: @unchecked Sendable {
     idleShutdownTime: TimeInterval? = nil,
     listen: CompanionListenTarget = .domainSocket,
     registry: CompanionRegistry? = nil,
+    eventLoopThreads: Int = 1,
     onRequest: RequestHandler? = nil
   ) {
     let paths = CompanionPaths(version: version)
@@ -145,7 +155,7 @@ public final class CompanionServer: @unchecked Sendable {
         companionServerLog("CompanionServer received \(request)")
         return nil
       }
-    self.group = MultiThreadedEventLoopGroup(numberOfThreads: 1)
+    self.group = MultiThreadedEventLoopGroup(numberOfThreads: max(1, eventLoopThreads))
   }
 
   /// Binds the configured `listen` target, starts accepting connections, and (for
@@ -171,28 +181,24 @@ public final class CompanionServer: @unchecked Sendable {
     // so the countdown is paused while the request is processed and restarts at
     // the full timeout once it completes.
     let onRequest = self.onRequest
-    let submit: @Sendable (JSONRPCRequest, Channel) -> Void = { request, channel in
+    let submit: JSONRPCConnectionHandler.Submit = { request, completion in
       // Pause the idle countdown synchronously, as the request is read on the
       // event loop, so it cannot fire in the gap before the async task starts.
       monitor?.beginActivity()
       // Detached so the work is not tied to (and cannot be cancelled by) the
-      // connection — the client keeps it open only to read the reply back.
+      // connection. The handler writes the response, and closes a one-request
+      // connection once it has.
       Task.detached {
         defer { monitor?.endActivity() }
-        let response = await onRequest(request)
-        if let response, let data = try? JSONEncoder().encode(response) {
-          var buffer = ByteBufferAllocator().buffer(capacity: data.count + 1)
-          buffer.writeBytes(data)
-          buffer.writeInteger(UInt8(ascii: "\n"))
-          try? await channel.writeAndFlush(buffer).get()
-        }
-        // One request per connection: close once the reply (if any) is sent.
-        try? await channel.close().get()
+        completion(await onRequest(request))
       }
     }
 
     let bootstrap = ServerBootstrap(group: group)
       .serverChannelOption(ChannelOptions.backlog, value: 256)
+      // Lets a keep-alive client half-close to say it has sent its last request,
+      // and still read the responses still in flight.
+      .childChannelOption(ChannelOptions.allowRemoteHalfClosure, value: true)
       .childChannelInitializer { channel in
         var handlers: [ChannelHandler] = []
         // TLS, when configured, must come first so it decrypts before framing.
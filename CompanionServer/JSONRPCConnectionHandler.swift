@@ -8,20 +8,41 @@
 import Foundation
 @_implementationOnly import NIOCore
 
-/// Per-connection handler sitting after `NewlineFrameDecoder`. It decodes the
-/// first line as a `JSONRPCRequest` and hands it (with this connection's channel)
-/// to the server's `submit` closure, which processes it asynchronously, writes the
-/// response back, and closes the connection. The client keeps the connection open
-/// and reads the response, so it is reliably delivered. A malformed line gets no
-/// response and the connection is closed.
+/// Per-connection handler sitting after `NewlineFrameDecoder`. Each line is decoded
+/// as a `JSONRPCRequest` and handed to the server's `submit` closure, which
+/// processes it asynchronously and calls back with the response.
+///
+/// A connection starts in one-request mode: the first response is written and the
+/// connection is closed, which is how `CompanionClient` reads it. A client that
+/// sends the `rpc.keepAlive` notification switches the connection to keep-alive
+/// mode, in which any number of requests can be sent without waiting for
+/// responses. Requests are processed concurrently and each response is written as
+/// soon as it is ready, so responses can arrive out of order and are matched to
+/// their request by `id`. A keep-alive connection is closed once the client has
+/// half-closed it and every response has been written.
+///
+/// All state is touched only on the channel's event loop; responses are hopped
+/// back onto it before being encoded and written.
 final class JSONRPCConnectionHandler: ChannelInboundHandler {
   typealias InboundIn = ByteBuffer
 
-  /// Hands a decoded request and its channel to the server for asynchronous
-  /// processing; the server writes the response and closes the channel.
-  private let submit: @Sendable (JSONRPCRequest, Channel) -> Void
+  /// The notification that switches a connection to keep-alive mode. Method names
+  /// starting with `rpc.` are reserved by JSON-RPC 2.0 for extensions like this.
+  static let keepAliveMethod = "rpc.keepAlive"
 
-  init(submit: @escaping @Sendable (JSONRPCRequest, Channel) -> Void) {
+  /// Hands a decoded request to the server for asynchronous processing. The
+  /// server calls the completion, from any thread, exactly once.
+  typealias Submit = @Sendable (JSONRPCRequest, @escaping @Sendable (JSONRPCResponse?) -> Void) -> Void
+
+  private let submit: Submit
+  // One coder per connection, reused for every line and only used on the event loop.
+  private let decoder = JSONDecoder()
+  private let encoder = JSONEncoder()
+  private var keepAlive = false
+  private var inFlight = 0
+  private var inputClosed = false
+
+  init(submit: @escaping Submit) {
     self.submit = submit
   }
 
@@ -31,21 +52,74 @@ final class JSONRPCConnectionHandler: ChannelInboundHandler {
   }
 
   func channelRead(context: ChannelHandlerContext, data: NIOAny) {
-    var buffer = unwrapInboundIn(data)
-    let bytes = buffer.readBytes(length: buffer.readableBytes) ?? []
-    let payload = Data(bytes)
+    let buffer = unwrapInboundIn(data)
+    let request: JSONRPCRequest
     do {
-      let request = try JSONDecoder().decode(JSONRPCRequest.self, from: payload)
-      // The server owns closing the channel once it has written the response.
-      submit(request, context.channel)
+      request = try buffer.withUnsafeReadableBytes { bytes in
+        try decoder.decode(JSONRPCRequest.self, from: Data(bytes))
+      }
     } catch {
-      companionServerLog("CompanionServer: ignoring non-JSON-RPC line: \(String(decoding: payload, as: UTF8.self))")
-      context.close(promise: nil)
+      let line = String(decoding: buffer.readableBytesView, as: UTF8.self)
+      companionServerLog("CompanionServer: ignoring non-JSON-RPC line: \(line)")
+      if keepAlive {
+        // -32700 is JSON-RPC's parse error. The id could not be read, so it is null.
+        write(JSONRPCResponse(id: .null, error: .object(["code": .number(-32700), "message": .string("Parse error")])), to: context.channel)
+      } else {
+        context.close(promise: nil)
+      }
+      return
+    }
+    if request.method == Self.keepAliveMethod {
+      keepAlive = true
+      if request.id != nil {
+        write(JSONRPCResponse(id: request.id, result: .bool(true)), to: context.channel)
+      }
+      return
+    }
+
+    inFlight += 1
+    let channel = context.channel
+    let handler = NIOLoopBound(self, eventLoop: context.eventLoop)
+    submit(request) { response in
+      channel.eventLoop.execute {
+        handler.value.requestCompleted(response, channel: channel)
+      }
+    }
+  }
+
+  func userInboundEventTriggered(context: ChannelHandlerContext, event: Any) {
+    if case ChannelEvent.inputClosed = event {
+      inputClosed = true
+      // Otherwise the connection is closed once the last response is written.
+      if inFlight == 0 {
+        context.close(promise: nil)
+      }
     }
+    context.fireUserInboundEventTriggered(event)
   }
 
   func errorCaught(context: ChannelHandlerContext, error: Error) {
     companionServerLog("CompanionServer: connection error: \(error)")
     context.close(promise: nil)
   }
+
+  private func requestCompleted(_ response: JSONRPCResponse?, channel: Channel) {
+    inFlight -= 1
+    let written = response.map { write($0, to: channel) } ?? channel.eventLoop.makeSucceededVoidFuture()
+    if !keepAlive || (inputClosed && inFlight == 0) {
+      // Close only once the response has been written out.
+      written.whenComplete { _ in channel.close(promise: nil) }
+    }
+  }
+
+  @discardableResult
+  private func write(_ response: JSONRPCResponse, to channel: Channel) -> EventLoopFuture<Void> {
+    guard let data = try? encoder.encode(response) else {
+      return channel.eventLoop.makeSucceededVoidFuture()
+    }
+    var buffer = channel.allocator.buffer(capacity: data.count + 1)
+    buffer.writeBytes(data)
+    buffer.writeInteger(UInt8(ascii: "\n"))
+    return channel.writeAndFlush(buffer)
+  }
 }
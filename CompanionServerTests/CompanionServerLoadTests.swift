@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CompanionDiscovery
+import CompanionServer
+import Darwin
+import Foundation
+import Testing
+
+/// Load test for the companion server over a Unix domain socket: many keep-alive
+/// connections, each pipelining many requests, against servers with one and with
+/// several event loop threads. Checks every request was answered with its own
+/// response.
+@Suite(.serialized)
+struct CompanionServerLoadTests {
+  private static let connections = 16
+  private static let requestsPerConnection = 500
+
+  @Test(arguments: [1, 4])
+  func pipelinedRequests(eventLoopThreads: Int) async throws {
+    let directory = (NSTemporaryDirectory() as NSString)
+      .appendingPathComponent("companion_server_load_tests_\(UUID().uuidString)")
+    try FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(atPath: directory) }
+    let registry = CompanionRegistry(stateFilePath: (directory as NSString).appendingPathComponent("state"))
+    let udid = "TEST-\(UUID().uuidString)"
+    let path = CompanionPaths(version: .v2).companionSocketPath(forUDID: udid)
+    let server = CompanionServer(
+      udid: udid, version: .v2, registry: registry, eventLoopThreads: eventLoopThreads,
+      onRequest: { request in
+        JSONRPCResponse(id: request.id, result: request.params)
+      })
+    defer { unlink(path) }
+    _ = try await server.start()
+
+    let answered = try await withThrowingTaskGroup(of: Int.self) { group in
+      for _ in 0..<Self.connections {
+        group.addTask {
+          let connection = try await CompanionConnection.connect(to: .domainSocket(path: path))
+          // Every request on the connection is in flight at once.
+          let answered = try await withThrowingTaskGroup(of: Void.self) { requests in
+            for index in 0..<Self.requestsPerConnection {
+              requests.addTask {
+                let response = try await connection.send(method: "echo", params: .number(Double(index)))
+                #expect(response.result == .number(Double(index)))
+              }
+            }
+            return try await requests.reduce(0) { count, _ in count + 1 }
+          }
+          await connection.close()
+          return answered
+        }
+      }
+      return try await group.reduce(0, +)
+    }
+    try await server.close()
+
+    #expect(answered == Self.connections * Self.requestsPerConnection)
+  }
+}
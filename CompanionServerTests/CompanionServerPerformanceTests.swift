@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CompanionDiscovery
+import CompanionServer
+import Darwin
+import Foundation
+import XCTest
+
+/// Measures the companion server over a Unix domain socket under the load `CompanionServerLoadTests`
+/// checks: 16 keep-alive connections each pipelining 500 echo requests, against servers with one and
+/// with four event loop threads. The clock time over the fixed number of requests gives requests per
+/// second, and the latency metric the p50 and p99 time from sending a request to its response.
+final class CompanionServerPerformanceTests: XCTestCase {
+
+  private static let connections = 16
+  private static let requestsPerConnection = 500
+
+  func testPipelinedRequestsOneEventLoopThread() throws {
+    try measurePipelinedRequests(eventLoopThreads: 1)
+  }
+
+  func testPipelinedRequestsFourEventLoopThreads() throws {
+    try measurePipelinedRequests(eventLoopThreads: 4)
+  }
+
+  // MARK: - Helpers
+
+  /// Measures the requests against one server, started outside the measurement so only the
+  /// connections and their requests are timed.
+  private func measurePipelinedRequests(eventLoopThreads: Int) throws {
+    let directory = (NSTemporaryDirectory() as NSString)
+      .appendingPathComponent("companion_server_performance_tests_\(UUID().uuidString)")
+    try FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: true)
+    defer { try? FileManager.default.removeItem(atPath: directory) }
+    let registry = CompanionRegistry(stateFilePath: (directory as NSString).appendingPathComponent("state"))
+    let udid = "TEST-\(UUID().uuidString)"
+    let path = CompanionPaths(version: .v2).companionSocketPath(forUDID: udid)
+    defer { unlink(path) }
+    let server = CompanionServer(
+      udid: udid, version: .v2, registry: registry, eventLoopThreads: eventLoopThreads,
+      onRequest: { request in
+        JSONRPCResponse(id: request.id, result: request.params)
+      })
+    try awaitTask(timeout: 10) { _ = try await server.start() }
+    defer { try? awaitTask(timeout: 10) { try await server.close() } }
+
+    let latencies = LatencyPercentileMetric()
+    measure(metrics: [XCTClockMetric(), latencies]) {
+      do {
+        try awaitTask(timeout: 60) {
+          try await withThrowingTaskGroup(of: Void.self) { group in
+            for _ in 0..<Self.connections {
+              group.addTask {
+                let connection = try await CompanionConnection.connect(to: .domainSocket(path: path))
+                // Every request on the connection is in flight at once.
+                try await withThrowingTaskGroup(of: Void.self) { requests in
+                  for index in 0..<Self.requestsPerConnection {
+                    requests.addTask {
+                      let sent = DispatchTime.now()
+                      let response = try await connection.send(method: "echo", params: .number(Double(index)))
+                      latencies.record(since: sent)
+                      XCTAssertEqual(response.result, .number(Double(index)))
+                    }
+                  }
+                  try await requests.waitForAll()
+                }
+                await connection.close()
+              }
+            }
+            try await group.waitForAll()
+          }
+        }
+      } catch {
+        XCTFail("pipelined requests failed: \(error)")
+      }
+    }
+  }
+
+  /// Runs `body` in a task and waits for it, rethrowing what it throws.
+  private func awaitTask(timeout: TimeInterval, _ body: @escaping @Sendable () async throws -> Void) throws {
+    let done = expectation(description: "done")
+    let failure = Failure()
+    Task {
+      do {
+        try await body()
+      } catch {
+        failure.error = error
+      }
+      done.fulfill()
+    }
+    wait(for: [done], timeout: timeout)
+    if let error = failure.error {
+      throw error
+    }
+  }
+}
+
+/// Carries an error out of the task that raised it.
+///
+// SAFETY: written at most once, by that task, before it fulfils the expectation the reader waits on.
+// patternlint-disable-next-line unchecked-sendable
+private final class Failure: @unchecked Sendable {
+  var error: Error?
+}
+
+/// Reports the p50 and p99 of the request latencies recorded during each measured iteration.
+///
+// SAFETY: `latencies` is guarded by `lock`; XCTest calls the measurement methods from one thread.
+// patternlint-disable-next-line unchecked-sendable
+private final class LatencyPercentileMetric: NSObject, XCTMetric, @unchecked Sendable {
+  private let lock = NSLock()
+  private var latencies: [UInt64] = []
+
+  func record(since start: DispatchTime) {
+    let elapsed = DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds
+    lock.withLock { latencies.append(elapsed) }
+  }
+
+  func willBeginMeasuring() {
+    lock.withLock { latencies.removeAll(keepingCapacity: true) }
+  }
+
+  func didStopMeasuring() {}
+
+  func reportMeasurements(
+    from startTime: XCTPerformanceMeasurementTimestamp,
+    to endTime: XCTPerformanceMeasurementTimestamp
+  ) throws -> [XCTPerformanceMeasurement] {
+    let sorted = lock.withLock { latencies.sorted() }
+    guard !sorted.isEmpty else {
+      return []
+    }
+    func percentile(_ fraction: Double) -> Double {
+      Double(sorted[min(sorted.count - 1, Int(Double(sorted.count) * fraction))]) / 1_000_000
+    }
+    return [
+      XCTPerformanceMeasurement(
+        identifier: "com.facebook.idb.companion-server.latency.p50", displayName: "Latency p50",
+        doubleValue: percentile(0.50), unitSymbol: "ms"),
+      XCTPerformanceMeasurement(
+        identifier: "com.facebook.idb.companion-server.latency.p99", displayName: "Latency p99",
+        doubleValue: percentile(0.99), unitSymbol: "ms"),
+    ]
+  }
+
+  /// The same instance, so the requests record into the metric XCTest reports from.
+  func copy(with zone: NSZone? = nil) -> Any {
+    self
+  }
+}
@@ -100,6 +100,115 @@ struct CompanionServerTests {
     }
   }
 
+  // MARK: - Keep-alive
+
+  @Test
+  func keepAlivePipelinesAndAnswersOutOfOrder() async throws {
+    try await withTemporaryRegistry { registry in
+      let udid = uniqueUDID()
+      let path = CompanionPaths(version: .v2).companionSocketPath(forUDID: udid)
+      // Each request sleeps for the milliseconds in its params, so later requests
+      // finish first.
+      let server = CompanionServer(
+        udid: udid, version: .v2, registry: registry,
+        onRequest: { request in
+          if case let .number(delay)? = request.params {
+            try? await Task.sleep(nanoseconds: UInt64(delay) * 1_000_000)
+          }
+          return JSONRPCResponse(id: request.id, result: request.params)
+        })
+      defer { unlink(path) }
+
+      _ = try await server.start()
+
+      let fd = connect(toSocketPath: path)
+      defer { close(fd) }
+      writeLine(#"{"jsonrpc":"2.0","method":"rpc.keepAlive"}"#, to: fd)
+      writeLine(#"{"jsonrpc":"2.0","method":"sleep","params":400,"id":1}"#, to: fd)
+      writeLine(#"{"jsonrpc":"2.0","method":"sleep","params":200,"id":2}"#, to: fd)
+      writeLine(#"{"jsonrpc":"2.0","method":"sleep","params":0,"id":3}"#, to: fd)
+      // All three are answered on the one connection, each as it completes.
+      let responses = try readLines(fd, count: 3).map { try JSONDecoder().decode(JSONRPCResponse.self, from: $0) }
+      #expect(responses.map(\.id) == [.number(3), .number(2), .number(1)])
+      #expect(responses.map(\.result) == [.number(0), .number(200), .number(400)])
+
+      // Half-closing says no more requests are coming; with none in flight, the
+      // server closes its end.
+      writeLine(#"{"jsonrpc":"2.0","method":"sleep","params":200,"id":4}"#, to: fd)
+      shutdown(fd, SHUT_WR)
+      let last = try JSONDecoder().decode(JSONRPCResponse.self, from: readResponse(fd))
+      #expect(last.id == .number(4))
+
+      try await server.close()
+    }
+  }
+
+  @Test
+  func keepAliveAnswersMalformedLineWithParseError() async throws {
+    try await withTemporaryRegistry { registry in
+      let udid = uniqueUDID()
+      let path = CompanionPaths(version: .v2).companionSocketPath(forUDID: udid)
+      let server = CompanionServer(
+        udid: udid, version: .v2, registry: registry,
+        onRequest: { request in
+          JSONRPCResponse(id: request.id, result: .string(request.method))
+        })
+      defer { unlink(path) }
+
+      _ = try await server.start()
+
+      let fd = connect(toSocketPath: path)
+      defer { close(fd) }
+      writeLine(#"{"jsonrpc":"2.0","method":"rpc.keepAlive","id":0}"#, to: fd)
+      writeLine("not json", to: fd)
+      writeLine(#"{"jsonrpc":"2.0","method":"ping","id":1}"#, to: fd)
+      let responses = try readLines(fd, count: 3).map { try JSONDecoder().decode(JSONRPCResponse.self, from: $0) }
+      #expect(responses[0] == JSONRPCResponse(id: .number(0), result: .bool(true)))
+      // The bad line is answered, and the connection stays usable.
+      #expect(responses[1].id == .null)
+      #expect(responses[1].error == .object(["code": .number(-32700), "message": .string("Parse error")]))
+      #expect(responses[2] == JSONRPCResponse(id: .number(1), result: .string("ping")))
+
+      try await server.close()
+    }
+  }
+
+  @Test
+  func connectionMatchesConcurrentResponsesToRequests() async throws {
+    try await withTemporaryRegistry { registry in
+      let udid = uniqueUDID()
+      let path = CompanionPaths(version: .v2).companionSocketPath(forUDID: udid)
+      let server = CompanionServer(
+        udid: udid, version: .v2, registry: registry,
+        onRequest: { request in
+          // Jitter the completion order.
+          try? await Task.sleep(nanoseconds: UInt64.random(in: 0..<5_000_000))
+          return JSONRPCResponse(id: request.id, result: request.params)
+        })
+      defer { unlink(path) }
+
+      _ = try await server.start()
+
+      let connection = try await CompanionConnection.connect(to: .domainSocket(path: path))
+      let results = try await withThrowingTaskGroup(of: (Int, JSONValue?).self) { group in
+        for index in 0..<200 {
+          group.addTask {
+            (index, try await connection.send(method: "echo", params: .number(Double(index))).result)
+          }
+        }
+        return try await group.reduce(into: [(Int, JSONValue?)]()) { $0.append($1) }
+      }
+      #expect(results.count == 200)
+      #expect(results.allSatisfy { index, result in result == .number(Double(index)) })
+
+      await connection.close()
+      await #expect(throws: CompanionConnectionError.self) {
+        _ = try await connection.send(method: "echo")
+      }
+      try await server.close()
+    }
+  }
+
   // MARK: - Idle shutdown
 
   @Test
@@ -340,6 +449,26 @@ struct CompanionServerTests {
     return data
   }
 
+  /// Reads `count` newline-terminated lines from `fd`, returning each without its
+  /// newline. Throws if the server closes the connection first.
+  private func readLines(_ fd: Int32, count: Int) throws -> [Data] {
+    var lines: [Data] = []
+    var line = Data()
+    var byte: UInt8 = 0
+    while lines.count < count {
+      guard Darwin.read(fd, &byte, 1) == 1 else {
+        throw CocoaError(.fileReadUnknown)
+      }
+      if byte == UInt8(ascii: "\n") {
+        lines.append(line)
+        line = Data()
+      } else {
+        line.append(byte)
+      }
+    }
+    return lines
+  }
+
   /// Writes `line` followed by a newline to `fd`.
   private func writeLine(_ line: String, to fd: Int32) {
     var bytes = Array(line.utf8)
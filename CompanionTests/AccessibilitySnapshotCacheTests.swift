@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+import XCTest
+
+final class AccessibilitySnapshotCacheTests: XCTestCase {
+
+  private typealias Node = AccessibilityTreeDiff.Node
+
+  private static func element(_ label: String, type: String = "Button", y: Double, children: [Node] = []) -> Node {
+    [
+      "AXLabel": label,
+      "type": type,
+      "frame": ["x": 0.0, "y": y, "width": 100.0, "height": 40.0],
+      "children": children,
+    ]
+  }
+
+  private static let base: [Node] = [
+    element(
+      "App", type: "Application", y: 0,
+      children: [
+        element("Title", type: "StaticText", y: 50),
+        element("Login", y: 100),
+        element("Cancel", y: 150),
+      ])
+  ]
+
+  /// Applies a diff as a client holding `base` would: changes, then removals, then insertions in order.
+  private static func apply(_ diff: [String: Any], to base: [Node]) -> [Node] {
+    final class Box {
+      var node: Node
+      var children: [Box]?
+      init(_ node: Node) {
+        self.node = node.filter { $0.key != "children" }
+        children = (node["children"] as? [Node]).map { $0.map(Box.init) }
+      }
+      var foundationObject: Node {
+        var object = node
+        if let children {
+          object["children"] = children.map(\.foundationObject)
+        }
+        return object
+      }
+    }
+    let root = Box(["children": base])
+    var preorder: [Box] = []
+    func visit(_ boxes: [Box]?) {
+      for box in boxes ?? [] {
+        preorder.append(box)
+        visit(box.children)
+      }
+    }
+    visit(root.children)
+    for change in diff["changed"] as? [[String: Any]] ?? [] {
+      let box = preorder[change["node"] as! Int]
+      for (key, value) in change["set"] as? [String: Any] ?? [:] {
+        if key == "children" {
+          box.children = box.children ?? []
+        } else {
+          box.node[key] = value
+        }
+      }
+      for key in change["unset"] as? [String] ?? [] {
+        if key == "children" {
+          box.children = nil
+        } else {
+          box.node[key] = nil
+        }
+      }
+    }
+    let removed = Set((diff["removed"] as? [Int] ?? []).map { ObjectIdentifier(preorder[$0]) })
+    for box in [root] + preorder {
+      box.children = box.children?.filter { !removed.contains(ObjectIdentifier($0)) }
+    }
+    let insertions = (diff["inserted"] as? [[String: Any]] ?? []).sorted { ($0["index"] as! Int) < ($1["index"] as! Int) }
+    for insertion in insertions {
+      let parent = insertion["parent"] as! Int
+      let box = parent == -1 ? root : preorder[parent]
+      box.children = box.children ?? []
+      box.children!.insert(Box(insertion["node"] as! Node), at: insertion["index"] as! Int)
+    }
+    return root.children!.map(\.foundationObject)
+  }
+
+  private func assertRoundTrips(_ tree: [Node], file: StaticString = #filePath, line: UInt = #line) -> [String: Any] {
+    let diff = AccessibilityTreeDiff.diff(from: Self.base, to: tree)
+    XCTAssertEqual(Self.apply(diff, to: Self.base) as NSArray, tree as NSArray, file: file, line: line)
+    return diff
+  }
+
+  func testChangedLabelIsOneChange() {
+    var tree = Self.base
+    var app = tree[0]
+    var children = app["children"] as! [Node]
+    children[1]["AXLabel"] = "Log out"
+    app["children"] = children
+    tree[0] = app
+
+    let diff = assertRoundTrips(tree)
+    let changed = diff["changed"] as! [[String: Any]]
+    XCTAssertEqual(changed.count, 1)
+    XCTAssertEqual(changed.first?["node"] as? Int, 2)
+    XCTAssertEqual(changed.first?["set"] as? NSDictionary, ["AXLabel": "Log out"])
+    XCTAssertEqual((diff["removed"] as! [Int]), [])
+    XCTAssertEqual((diff["inserted"] as! [[String: Any]]).count, 0)
+  }
+
+  func testInsertedRemovedAndReorderedElements() {
+    let tree: [Node] = [
+      Self.element(
+        "App", type: "Application", y: 0,
+        children: [
+          Self.element("Cancel", y: 150),
+          Self.element("Title", type: "StaticText", y: 50),
+          Self.element("Alert", type: "Alert", y: 300, children: [Self.element("OK", y: 320)]),
+        ])
+    ]
+    let diff = assertRoundTrips(tree)
+    // Title moved behind Cancel, so it is reinserted; Login is gone.
+    XCTAssertEqual(Set(diff["removed"] as! [Int]), [1, 2])
+  }
+
+  func testIdenticalTreesHaveAnEmptyDiff() {
+    let diff = assertRoundTrips(Self.base)
+    XCTAssertEqual(diff as NSDictionary, ["changed": [Any](), "removed": [Any](), "inserted": [Any]()])
+  }
+
+  func testDiffsOnlyAgainstTheSessionsLatestVersion() {
+    let cache = AccessibilitySnapshotCache()
+    let first = cache.snapshot(Self.base, session: "a", baseVersion: 0)
+    XCTAssertNil(first.diff)
+
+    let second = cache.snapshot(Self.base, session: "a", baseVersion: first.version)
+    XCTAssertNotNil(second.diff)
+    XCTAssertGreaterThan(second.version, first.version)
+    // The first version has been replaced, and versions are not shared across sessions.
+    XCTAssertNil(cache.snapshot(Self.base, session: "a", baseVersion: first.version).diff)
+    XCTAssertNil(cache.snapshot(Self.base, session: "b", baseVersion: second.version).diff)
+  }
+
+  func testEvictsLeastRecentlyReadSession() {
+    let cache = AccessibilitySnapshotCache(capacity: 2)
+    let a = cache.snapshot(Self.base, session: "a", baseVersion: 0)
+    _ = cache.snapshot(Self.base, session: "b", baseVersion: 0)
+    _ = cache.snapshot(Self.base, session: "c", baseVersion: 0)
+    XCTAssertEqual(cache.count, 2)
+    XCTAssertNil(cache.snapshot(Self.base, session: "a", baseVersion: a.version).diff)
+  }
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+// Uses XCTest to match the existing tests in this target; migrating the whole
+// target to Swift Testing is a separate effort.
+// ast-grep-ignore: swift-testing/swift/no-new-xctest
+import XCTest
+
+/// Measures `FileDrainWriter.drain` over an in-memory stream, as a pull of one large file and as many
+/// pulls of small ones. The clock time over the fixed number of bytes gives bytes per second, and the
+/// memory metric what the message buffers cost: a small pull should not pay for a whole chunk.
+final class FileDrainWriterPerformanceTests: XCTestCase {
+
+  func testLargeDrain() {
+    let input = Data(count: 64 * 1024 * 1024)
+    measureDrains(of: input, count: 1)
+  }
+
+  func testSmallDrains() {
+    let input = Data(count: 1024)
+    measureDrains(of: input, count: 1_000)
+  }
+
+  // MARK: - Helpers
+
+  private func measureDrains(of input: Data, count: Int) {
+    measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+      let done = expectation(description: "drained")
+      Task {
+        do {
+          for _ in 0..<count {
+            let statistics = try await FileDrainWriter.drain(inputStream: InputStream(data: input)) { _ in }
+            XCTAssertEqual(statistics.bytes, input.count)
+          }
+        } catch {
+          XCTFail("drain failed: \(error)")
+        }
+        done.fulfill()
+      }
+      wait(for: [done], timeout: 60)
+    }
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+// Uses XCTest to match the existing tests in this target; migrating the whole
+// target to Swift Testing is a separate effort.
+// ast-grep-ignore: swift-testing/swift/no-new-xctest
+import XCTest
+
+final class FileDrainWriterTests: XCTestCase {
+
+  private func randomData(count: Int) -> Data {
+    var generator = SystemRandomNumberGenerator()
+    return Data((0..<count).map { _ in UInt8.random(in: 0...255, using: &generator) })
+  }
+
+  func testCoalescesReadsUpToMaxChunkSize() async throws {
+    let input = randomData(count: 10_000)
+    var received: [Data] = []
+    let statistics = try await FileDrainWriter.drain(inputStream: InputStream(data: input), maxChunkSize: 4096) { data in
+      received.append(data)
+    }
+
+    XCTAssertEqual(received.map(\.count), [4096, 4096, 1808])
+    XCTAssertEqual(received.reduce(Data(), +), input)
+    XCTAssertEqual(statistics.bytes, 10_000)
+    XCTAssertEqual(statistics.messages, 3)
+  }
+
+  func testEmptyStreamSendsNothing() async throws {
+    var received: [Data] = []
+    let statistics = try await FileDrainWriter.drain(inputStream: InputStream(data: Data()), maxChunkSize: 4096) { data in
+      received.append(data)
+    }
+
+    XCTAssertTrue(received.isEmpty)
+    XCTAssertEqual(statistics.messages, 0)
+  }
+
+  func testExactMultipleOfChunkSize() async throws {
+    let input = randomData(count: 8192)
+    var received: [Data] = []
+    _ = try await FileDrainWriter.drain(inputStream: InputStream(data: input), maxChunkSize: 4096) { data in
+      received.append(data)
+    }
+
+    XCTAssertEqual(received.map(\.count), [4096, 4096])
+    XCTAssertEqual(received.reduce(Data(), +), input)
+  }
+
+  /// The previous implementation sent a message for every 16Kb read.
+  func testDrainSendsFullChunks() async throws {
+    let chunkSize = FileDrainWriter.defaultMaxChunkSize
+    let size = 8 * chunkSize + 1
+    var received: [Int] = []
+    let statistics = try await FileDrainWriter.drain(inputStream: InputStream(data: Data(count: size))) { data in
+      received.append(data.count)
+    }
+
+    XCTAssertEqual(statistics.bytes, size)
+    XCTAssertEqual(received, Array(repeating: chunkSize, count: 8) + [1])
+  }
+
+  func testBufferGrowsAcrossReadsInOneMessage() async throws {
+    let input = randomData(count: 5 * FileDrainWriter.initialBufferSize + 3)
+    var received: [Data] = []
+    _ = try await FileDrainWriter.drain(inputStream: InputStream(data: input)) { data in
+      received.append(data)
+    }
+
+    XCTAssertEqual(received, [input])
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import FBSimulatorControl
+import GRPC
+import IDBGRPCSwift
+import XCTest
+
+final class HIDGestureCacheTests: XCTestCase {
+
+  private static let swipe = Idb_HIDEvent.with {
+    $0.swipe = .with {
+      $0.start = .with { $0.x = 100; $0.y = 600 }
+      $0.end = .with { $0.x = 100; $0.y = 200 }
+      $0.delta = 10
+      $0.duration = 0.4
+    }
+  }
+
+  private static func definition(_ name: String, _ events: [Idb_HIDEvent]) -> Idb_HIDEvent.HIDGestureDefinition {
+    .with {
+      $0.name = name
+      $0.events = events
+    }
+  }
+
+  func testDefinitionIsExpandedOnce() throws {
+    let gestures = HIDGestureCache()
+    try HidMethodHandler.define(Self.definition("scroll", [Self.swipe]), in: gestures)
+
+    let timeline = try XCTUnwrap(gestures.timeline(named: "scroll"))
+    XCTAssertEqual(timeline, FBSimulatorHIDTimeline(.swipe(100, yStart: 600, xEnd: 100, yEnd: 200, delta: 10, duration: 0.4)))
+    XCTAssertGreaterThan(timeline.steps.count, 40)
+    XCTAssertNil(gestures.timeline(named: "other"))
+  }
+
+  func testRedefiningReplacesAndEmptyDefinitionRemoves() throws {
+    let gestures = HIDGestureCache()
+    try HidMethodHandler.define(Self.definition("tap", [Self.swipe]), in: gestures)
+    try HidMethodHandler.define(Self.definition("tap", [.with { $0.shake = .init() }]), in: gestures)
+    XCTAssertEqual(gestures.timeline(named: "tap")?.steps.map(\.event), [.shake])
+
+    try HidMethodHandler.define(Self.definition("tap", []), in: gestures)
+    XCTAssertNil(gestures.timeline(named: "tap"))
+  }
+
+  func testInvalidDefinitionKeepsPreviousGesture() throws {
+    let gestures = HIDGestureCache()
+    try HidMethodHandler.define(Self.definition("scroll", [Self.swipe]), in: gestures)
+    let invalid = Self.definition("scroll", [Self.swipe, .with { $0.delay = .with { $0.duration = -1 } }])
+    XCTAssertThrowsError(try HidMethodHandler.define(invalid, in: gestures))
+    XCTAssertThrowsError(try HidMethodHandler.define(Self.definition("", [Self.swipe]), in: gestures))
+    XCTAssertNotNil(gestures.timeline(named: "scroll"))
+  }
+
+  func testGesturesMayNotBeNested() {
+    let gestures = HIDGestureCache()
+    XCTAssertThrowsError(try HidMethodHandler.define(Self.definition("outer", [.with { $0.gesture = .with { $0.name = "inner" } }]), in: gestures))
+  }
+
+  func testEvictsLeastRecentlyPerformed() {
+    let gestures = HIDGestureCache(capacity: 2)
+    gestures.define("a", timeline: FBSimulatorHIDTimeline(.shake))
+    gestures.define("b", timeline: FBSimulatorHIDTimeline(.lockDevice))
+    XCTAssertNotNil(gestures.timeline(named: "a"))
+    gestures.define("c", timeline: FBSimulatorHIDTimeline(.shake))
+
+    XCTAssertEqual(gestures.count, 2)
+    XCTAssertNotNil(gestures.timeline(named: "a"))
+    XCTAssertNil(gestures.timeline(named: "b"))
+    XCTAssertNotNil(gestures.timeline(named: "c"))
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import FBSimulatorControl
+import GRPC
+import IDBGRPCSwift
+import XCTest
+
+final class HidBatchTests: XCTestCase {
+
+  private static func key(_ keycode: UInt64, _ direction: Idb_HIDEvent.HIDDirection) -> Idb_HIDEvent {
+    .with {
+      $0.press = .with {
+        $0.action = .with { $0.key = .with { $0.keycode = keycode } }
+        $0.direction = direction
+      }
+    }
+  }
+
+  private static func delay(_ duration: Double) -> Idb_HIDEvent {
+    .with { $0.delay = .with { $0.duration = duration } }
+  }
+
+  private static func batch(_ events: [Idb_HIDEvent]) -> Idb_HIDEvent.HIDBatch {
+    .with { $0.events = events }
+  }
+
+  private func assertInvalidArgument(_ batch: Idb_HIDEvent.HIDBatch, containing message: String, file: StaticString = #filePath, line: UInt = #line) {
+    XCTAssertThrowsError(try HidMethodHandler.fbSimulatorHIDEvents(from: batch.events), file: file, line: line) { error in
+      let status = error as? GRPCStatus
+      XCTAssertEqual(status?.code, .invalidArgument, file: file, line: line)
+      XCTAssertTrue(status?.message?.contains(message) ?? false, "\(String(describing: status?.message))", file: file, line: line)
+    }
+  }
+
+  func testConvertsEveryEventInOrder() throws {
+    let events = try HidMethodHandler.fbSimulatorHIDEvents(from: [Self.key(4, .down), Self.delay(0.1), Self.key(4, .up)])
+    XCTAssertEqual(events, [.keyboard(direction: .down, keyCode: 4), .delay(0.1), .keyboard(direction: .up, keyCode: 4)])
+  }
+
+  func testConvertsSwipesAndPinches() throws {
+    let swipe = Idb_HIDEvent.with {
+      $0.swipe = .with {
+        $0.start = .with { $0.x = 0; $0.y = 0 }
+        $0.end = .with { $0.x = 0; $0.y = 100 }
+        $0.delta = 50
+        $0.duration = 0.2
+      }
+    }
+    let pinch = Idb_HIDEvent.with {
+      $0.pinch = .with {
+        $0.center = .with { $0.x = 100; $0.y = 100 }
+        $0.scale = 2
+      }
+    }
+    let events = try HidMethodHandler.fbSimulatorHIDEvents(from: [swipe, pinch])
+    XCTAssertEqual(events.count, 2)
+    XCTAssertEqual(events.first, FBSimulatorHIDEvent.swipe(0, yStart: 0, xEnd: 0, yEnd: 100, delta: 50, duration: 0.2))
+  }
+
+  func testRejectsTheWholeBatchForOneInvalidEvent() {
+    let unrecognizedButton = Idb_HIDEvent.with {
+      $0.press = .with {
+        $0.action = .with { $0.button = .with { $0.button = .UNRECOGNIZED(99) } }
+        $0.direction = .down
+      }
+    }
+    assertInvalidArgument(Self.batch([Self.key(4, .down), unrecognizedButton, Self.key(4, .up)]), containing: "Event 1 of batch")
+  }
+
+  func testRejectsEmptyAndNestedEvents() {
+    assertInvalidArgument(Self.batch([Idb_HIDEvent()]), containing: "Unrecognized request.event")
+    assertInvalidArgument(Self.batch([.with { $0.batch = Self.batch([Self.key(4, .down)]) }]), containing: "nested")
+  }
+
+  func testRejectsDelaysThatCannotBeScheduled() {
+    assertInvalidArgument(Self.batch([Self.delay(-1)]), containing: "Invalid delay")
+    assertInvalidArgument(Self.batch([Self.delay(.infinity)]), containing: "Invalid delay")
+    assertInvalidArgument(Self.batch([Self.delay(.nan)]), containing: "Invalid delay")
+  }
+
+  func testRejectsOversizedBatches() {
+    let events = Array(repeating: Self.delay(0), count: HidMethodHandler.maxBatchEvents + 1)
+    assertInvalidArgument(Self.batch(events), containing: "may not have more than")
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@preconcurrency import FBControlCore
+import XCTest
+
+final class LogFilterTests: XCTestCase {
+
+  private static let springboard = #"{"timestamp":"2024-01-01 12:00:00.000000-0800","threadID":4660,"messageType":"Default","activityIdentifier":0,"processID":57,"processImagePath":"/System/Library/CoreServices/SpringBoard.app/SpringBoard","senderImagePath":"/System/Library/PrivateFrameworks/FrontBoard.framework/FrontBoard","subsystem":"com.apple.FrontBoard","category":"Common","eventMessage":"Bootstrapping scene"}"#
+  private static let locationd = #"{"timestamp":"2024-01-01 12:00:01.000000-0800","threadID":17,"messageType":"Info","activityIdentifier":0,"processID":88,"processImagePath":"/usr/libexec/locationd","subsystem":"com.apple.locationd.Core","category":"Client","eventMessage":"Client connected"}"#
+  private static let syslog = "Oct 16 12:34:56 iPhone SpringBoard(FrontBoard)[57] <Notice>: Bootstrapping scene"
+
+  // MARK: - Parsing
+
+  func testParsesStructuredEntries() {
+    let record = LogRecord.parse(Data(Self.springboard.utf8))
+    XCTAssertNotNil(record.object)
+    XCTAssertEqual(record.subsystem, "com.apple.FrontBoard")
+    XCTAssertEqual(record.category, "Common")
+    XCTAssertEqual(record.processName, "SpringBoard")
+    XCTAssertEqual(record.processIdentifier, 57)
+    XCTAssertEqual(record.message, "Bootstrapping scene")
+  }
+
+  func testParsesSyslogRelayLines() {
+    let record = LogRecord.parse(Data(Self.syslog.utf8))
+    XCTAssertNil(record.object)
+    XCTAssertNil(record.subsystem)
+    XCTAssertEqual(record.processName, "SpringBoard")
+    XCTAssertEqual(record.processIdentifier, 57)
+    XCTAssertEqual(record.message, "Bootstrapping scene")
+  }
+
+  func testParsesOtherTextAsMessage() {
+    let record = LogRecord.parse(Data("Filtering the log data using \"process == 1\"".utf8))
+    XCTAssertNil(record.object)
+    XCTAssertNil(record.processName)
+    XCTAssertEqual(record.message, "Filtering the log data using \"process == 1\"")
+  }
+
+  // MARK: - Matching
+
+  func testEmptyFilterMatchesEverything() throws {
+    let filter = try LogFilter()
+    XCTAssertTrue(filter.isEmpty)
+    XCTAssertFalse(filter.matchesStructuredFields)
+    XCTAssertTrue(filter.matches(LogRecord.parse(Data(Self.springboard.utf8))))
+    XCTAssertTrue(filter.matches(LogRecord.parse(Data("anything".utf8))))
+  }
+
+  func testMatchesAnyValueOfEverySet() throws {
+    let filter = try LogFilter(subsystems: ["com.apple.FrontBoard", "com.apple.locationd.Core"], categories: ["Common"])
+    XCTAssertTrue(filter.matches(LogRecord.parse(Data(Self.springboard.utf8))))
+    XCTAssertFalse(filter.matches(LogRecord.parse(Data(Self.locationd.utf8))))
+  }
+
+  func testMatchesProcessesByNameOrIdentifier() throws {
+    XCTAssertTrue(try LogFilter(processes: ["SpringBoard"]).matches(LogRecord.parse(Data(Self.springboard.utf8))))
+    XCTAssertTrue(try LogFilter(processes: ["88"]).matches(LogRecord.parse(Data(Self.locationd.utf8))))
+    XCTAssertTrue(try LogFilter(processes: ["SpringBoard"]).matches(LogRecord.parse(Data(Self.syslog.utf8))))
+    XCTAssertFalse(try LogFilter(processes: ["locationd", "1"]).matches(LogRecord.parse(Data(Self.springboard.utf8))))
+  }
+
+  func testStructuredFiltersDropTextWithoutThoseFields() throws {
+    let filter = try LogFilter(subsystems: ["com.apple.FrontBoard"])
+    XCTAssertFalse(filter.matches(LogRecord.parse(Data(Self.syslog.utf8))))
+  }
+
+  func testSearchesMessageWithRegex() throws {
+    let filter = try LogFilter(messageRegex: "^Client (dis)?connected$")
+    XCTAssertTrue(filter.matches(LogRecord.parse(Data(Self.locationd.utf8))))
+    XCTAssertFalse(filter.matches(LogRecord.parse(Data(Self.springboard.utf8))))
+    XCTAssertFalse(filter.matchesStructuredFields)
+  }
+
+  func testRejectsInvalidRegex() {
+    XCTAssertThrowsError(try LogFilter(messageRegex: "("))
+  }
+
+  func testRulesOutLinesBeforeParsing() throws {
+    let filter = try LogFilter(subsystems: ["com.apple.FrontBoard"])
+    XCTAssertTrue(filter.mayMatch(line: Data(Self.springboard.utf8)))
+    XCTAssertFalse(filter.mayMatch(line: Data(Self.locationd.utf8)))
+    // A value that JSON may escape cannot be looked for in the raw bytes.
+    XCTAssertTrue(try LogFilter(subsystems: ["a/b"]).mayMatch(line: Data(Self.locationd.utf8)))
+  }
+
+  // MARK: - Output
+
+  func testRendersStructuredEntriesAsText() {
+    let line = Data(Self.springboard.utf8)
+    let rendered = LogFilterStage.render(LogRecord.parse(line), line: line, format: .text)
+    XCTAssertEqual(
+      rendered.map { String(decoding: $0, as: UTF8.self) },
+      "2024-01-01 12:00:00.000000-0800 0x1234 Default 0x0 57 0 SpringBoard: (FrontBoard) [com.apple.FrontBoard:Common] Bootstrapping scene\n")
+  }
+
+  func testRendersNDJSON() throws {
+    let structured = Data(Self.springboard.utf8)
+    XCTAssertEqual(LogFilterStage.render(LogRecord.parse(structured), line: structured, format: .ndjson), structured + Data("\n".utf8))
+
+    let text = Data(Self.syslog.utf8)
+    let rendered = try XCTUnwrap(LogFilterStage.render(LogRecord.parse(text), line: text, format: .ndjson))
+    XCTAssertEqual(rendered.last, UInt8(ascii: "\n"))
+    let object = try XCTUnwrap(JSONSerialization.jsonObject(with: rendered.dropLast()) as? [String: Any])
+    XCTAssertEqual(object["process"] as? String, "SpringBoard")
+    XCTAssertEqual(object["processID"] as? Int, 57)
+    XCTAssertEqual(object["eventMessage"] as? String, "Bootstrapping scene")
+  }
+
+  func testRequestsNDJSONStyle() {
+    XCTAssertEqual(LogFilterStage.argumentsRequestingNDJSON([]), ["--style", "ndjson"])
+    XCTAssertEqual(
+      LogFilterStage.argumentsRequestingNDJSON(["stream", "--style", "json", "--level", "info", "--style=syslog"]),
+      ["stream", "--level", "info", "--style", "ndjson"])
+  }
+
+  func testConsumerFiltersLinesSplitAcrossWrites() throws {
+    final class Lines: @unchecked Sendable {
+      var data = Data()
+    }
+    let lines = Lines()
+    let filter = try LogFilter(subsystems: ["com.apple.locationd.Core"])
+    let consumer = LogFilterStage.consumer(filter: filter, format: .ndjson) { lines.data.append($0) }
+
+    let log = Data([Self.springboard, Self.locationd, Self.springboard, Self.locationd].joined(separator: "\n").utf8) + Data("\n".utf8)
+    for offset in stride(from: 0, to: log.count, by: 37) {
+      consumer.consumeData(log[offset..<min(offset + 37, log.count)])
+    }
+    consumer.consumeEndOfFile()
+
+    XCTAssertEqual(String(decoding: lines.data, as: UTF8.self), Self.locationd + "\n" + Self.locationd + "\n")
+  }
+}
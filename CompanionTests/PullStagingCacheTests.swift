@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+import XCTest
+
+final class PullStagingCacheTests: XCTestCase {
+
+  /// Stages a file in a directory of its own, as the pull handler does.
+  private func stage() throws -> PullStagingCache.StagedFile {
+    let directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString)
+    try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+    let url = directory.appendingPathComponent("file")
+    try Data(count: 16).write(to: url)
+    return PullStagingCache.StagedFile(url: url, size: 16, version: "1")
+  }
+
+  private func waitUntilRemoved(_ staged: PullStagingCache.StagedFile, timeout: TimeInterval) async throws {
+    let deadline = Date().addingTimeInterval(timeout)
+    while FileManager.default.fileExists(atPath: staged.url.path), Date() < deadline {
+      try await Task.sleep(nanoseconds: 10_000_000)
+    }
+  }
+
+  func testIdleFileIsDeletedWithoutAnotherRequest() async throws {
+    let cache = PullStagingCache(idleTimeout: 0.1)
+    let file = try stage()
+    let staged = try await cache.stagedFile(forKey: "a", sourceVersion: "1") { file }
+    XCTAssertTrue(FileManager.default.fileExists(atPath: staged.url.path))
+
+    try await waitUntilRemoved(staged, timeout: 5)
+    XCTAssertFalse(FileManager.default.fileExists(atPath: staged.url.deletingLastPathComponent().path))
+  }
+
+  func testRemoveAllDeletesEveryStagedFile() async throws {
+    let cache = PullStagingCache()
+    let first = try stage()
+    let second = try stage()
+    _ = try await cache.stagedFile(forKey: "a", sourceVersion: "1") { first }
+    _ = try await cache.stagedFile(forKey: "b", sourceVersion: "1") { second }
+
+    await cache.removeAll()
+    XCTAssertFalse(FileManager.default.fileExists(atPath: first.url.path))
+    XCTAssertFalse(FileManager.default.fileExists(atPath: second.url.path))
+  }
+}
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// A single-producer, single-consumer queue of byte chunks with backpressure.
+///
+/// The producer's ``send(_:)`` returns as soon as the chunk is queued, unless the queue
+/// holds more than `highWaterMark` bytes, in which case it suspends until the consumer
+/// has drained it back below the mark. Memory held by the pipe is therefore bounded by
+/// `highWaterMark` plus one chunk, however far the producer gets ahead of the consumer.
+///
+/// Chunks are passed through as the `Data` they were sent as, they are never copied.
+///
+/// Either side can end the pipe: the producer with ``finish(throwing:)`` once it has
+/// sent everything, the consumer with ``cancel(_:)`` if it can no longer take data.
+public final class BoundedBytePipe: @unchecked Sendable {
+
+  /// Counters describing the pipe so far, for logging and benchmarking.
+  public struct Statistics: Equatable, Sendable {
+    public var bytes = 0
+    public var chunks = 0
+    /// How many times ``send(_:)`` suspended because the queue was above the high water mark.
+    public var stalls = 0
+    public var stalledTime: TimeInterval = 0
+    public var queuedBytes = 0
+    public var queuedChunks = 0
+    public var maxQueuedBytes = 0
+    public var maxQueuedChunks = 0
+
+    public init() {}
+  }
+
+  public static let defaultHighWaterMark = 16 * 1024 * 1024
+
+  public let highWaterMark: Int
+
+  private let mutex = FBMutex()
+  private var chunks: [Data] = []
+  private var head = 0
+  private var statistics = Statistics()
+  private var completion: Result<Void, Error>?
+  private var waitingProducer: CheckedContinuation<Void, Error>?
+  private var waitingConsumer: CheckedContinuation<Data?, Error>?
+
+  public init(highWaterMark: Int = defaultHighWaterMark) {
+    self.highWaterMark = max(1, highWaterMark)
+  }
+
+  /// A snapshot of the counters.
+  public var currentStatistics: Statistics {
+    mutex.sync { statistics }
+  }
+
+  /// Queues `data`, suspending while the pipe is above its high water mark.
+  /// Throws the consumer's error if the consumer has cancelled the pipe.
+  public func send(_ data: Data) async throws {
+    if data.isEmpty {
+      return
+    }
+    enum Action {
+      case handOff(CheckedContinuation<Data?, Error>)
+      case queued
+      case stall
+    }
+    let action = try mutex.sync { () throws -> Action in
+      if case let .failure(error) = completion {
+        throw error
+      }
+      precondition(completion == nil, "Sending to a finished pipe")
+      statistics.bytes += data.count
+      statistics.chunks += 1
+      if let consumer = waitingConsumer {
+        waitingConsumer = nil
+        return .handOff(consumer)
+      }
+      chunks.append(data)
+      statistics.queuedBytes += data.count
+      statistics.queuedChunks += 1
+      statistics.maxQueuedBytes = max(statistics.maxQueuedBytes, statistics.queuedBytes)
+      statistics.maxQueuedChunks = max(statistics.maxQueuedChunks, statistics.queuedChunks)
+      return statistics.queuedBytes > highWaterMark ? .stall : .queued
+    }
+    switch action {
+    case let .handOff(consumer):
+      consumer.resume(returning: data)
+    case .queued:
+      return
+    case .stall:
+      let start = Date()
+      defer {
+        let stalled = Date().timeIntervalSince(start)
+        mutex.sync {
+          statistics.stalls += 1
+          statistics.stalledTime += stalled
+        }
+      }
+      try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Void, Error>) in
+        // The consumer may have drained the queue, or cancelled, since the chunk was queued.
+        let resumeNow = mutex.sync { () -> Result<Void, Error>? in
+          if case let .failure(error) = completion {
+            return .failure(error)
+          }
+          if statistics.queuedBytes <= highWaterMark {
+            return .success(())
+          }
+          waitingProducer = continuation
+          return nil
+        }
+        if let resumeNow {
+          continuation.resume(with: resumeNow)
+        }
+      }
+    }
+  }
+
+  /// Returns the next chunk, suspending until one is sent.
+  /// Returns nil once the producer has finished and every chunk has been taken,
+  /// or throws the error the producer finished with.
+  public func next() async throws -> Data? {
+    try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Data?, Error>) in
+      enum Action {
+        case resume(Result<Data?, Error>, CheckedContinuation<Void, Error>?)
+        case wait
+      }
+      let action = mutex.sync { () -> Action in
+        if head < chunks.count {
+          let data = chunks[head]
+          chunks[head] = Data()
+          head += 1
+          if head == chunks.count {
+            chunks.removeAll(keepingCapacity: true)
+            head = 0
+          }
+          statistics.queuedBytes -= data.count
+          statistics.queuedChunks -= 1
+          var producer: CheckedContinuation<Void, Error>?
+          if statistics.queuedBytes <= highWaterMark {
+            producer = waitingProducer
+            waitingProducer = nil
+          }
+          return .resume(.success(data), producer)
+        }
+        switch completion {
+        case .success:
+          return .resume(.success(nil), nil)
+        case let .failure(error):
+          return .resume(.failure(error), nil)
+        case nil:
+          waitingConsumer = continuation
+          return .wait
+        }
+      }
+      if case let .resume(result, producer) = action {
+        producer?.resume()
+        continuation.resume(with: result)
+      }
+    }
+  }
+
+  /// Ends the pipe from the producer side. The consumer receives the queued chunks and
+  /// then nil, or `error` in place of anything still queued if one is given.
+  public func finish(throwing error: Error? = nil) {
+    let consumer = mutex.sync { () -> CheckedContinuation<Data?, Error>? in
+      guard completion == nil else {
+        return nil
+      }
+      if let error {
+        completion = .failure(error)
+        dropQueuedChunks()
+      } else {
+        completion = .success(())
+      }
+      let consumer = waitingConsumer
+      waitingConsumer = nil
+      return consumer
+    }
+    if let error {
+      consumer?.resume(throwing: error)
+    } else {
+      consumer?.resume(returning: nil)
+    }
+  }
+
+  /// Ends the pipe from the consumer side, dropping anything queued.
+  /// A suspended or later ``send(_:)`` throws `error`.
+  public func cancel(_ error: Error) {
+    let (producer, consumer) = mutex.sync { () -> (CheckedContinuation<Void, Error>?, CheckedContinuation<Data?, Error>?) in
+      if case .failure = completion {
+        return (nil, nil)
+      }
+      completion = .failure(error)
+      dropQueuedChunks()
+      defer {
+        waitingProducer = nil
+        waitingConsumer = nil
+      }
+      return (waitingProducer, waitingConsumer)
+    }
+    producer?.resume(throwing: error)
+    consumer?.resume(throwing: error)
+  }
+
+  private func dropQueuedChunks() {
+    chunks.removeAll()
+    head = 0
+    statistics.queuedBytes = 0
+    statistics.queuedChunks = 0
+  }
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// Coalesces many small writes of output into fewer, larger batches for sending.
+///
+/// Producers call ``consume(_:)`` from any thread; it never blocks. A single sender calls
+/// ``nextBatch()``, which returns once `maxBatchBytes` have built up, or once the oldest
+/// unsent byte has waited `maxLatency`, whichever is first. While a batch is being sent more
+/// output builds up, so a slow receiver gets larger batches rather than more of them.
+///
+/// Memory is bounded by `maxBufferedBytes`. Output written while that much is waiting to be
+/// sent is dropped, and the running total of dropped bytes is reported with every batch,
+/// so a receiver knows that, and how much, output is missing.
+public final class CoalescingByteStream: @unchecked Sendable {
+
+  public struct Configuration: Equatable, Sendable {
+    /// The most bytes sent in one batch.
+    public var maxBatchBytes: Int
+    /// How long the first byte of a batch may wait for more to join it. Zero sends whatever is
+    /// available as soon as the sender is ready for it.
+    public var maxLatency: TimeInterval
+    /// The most bytes held waiting to be sent before output is dropped.
+    public var maxBufferedBytes: Int
+
+    public static let defaultMaxBatchBytes = 64 * 1024
+    public static let defaultMaxLatency: TimeInterval = 0.02
+    public static let defaultMaxBufferedBytes = 8 * 1024 * 1024
+
+    public init(
+      maxBatchBytes: Int = defaultMaxBatchBytes,
+      maxLatency: TimeInterval = defaultMaxLatency,
+      maxBufferedBytes: Int = defaultMaxBufferedBytes
+    ) {
+      self.maxBatchBytes = max(1, maxBatchBytes)
+      self.maxLatency = max(0, maxLatency)
+      self.maxBufferedBytes = max(self.maxBatchBytes, maxBufferedBytes)
+    }
+  }
+
+  public struct Batch: Equatable, Sendable {
+    public let data: Data
+    /// The bytes dropped since the stream started, including any dropped before this batch.
+    public let lostBytes: UInt64
+  }
+
+  /// Counters describing the stream so far, for logging and benchmarking.
+  public struct Statistics: Equatable, Sendable {
+    public var consumedBytes = 0
+    public var consumedChunks = 0
+    public var sentBytes = 0
+    public var batches = 0
+    public var lostBytes: UInt64 = 0
+    public var maxBufferedBytes = 0
+
+    public init() {}
+  }
+
+  public let configuration: Configuration
+
+  private let mutex = FBMutex()
+  private var chunks: [Data] = []
+  private var head = 0
+  private var bufferedBytes = 0
+  private var oldestBufferedTime: DispatchTime?
+  private var reportedLostBytes: UInt64 = 0
+  private var finished = false
+  private var statistics = Statistics()
+  private var waitingSender: CheckedContinuation<Void, Never>?
+  private var waitGeneration: UInt64 = 0
+  /// Bumped whenever output is queued or the stream finishes, so a sender can tell if it missed a wakeup.
+  private var version: UInt64 = 0
+
+  public init(configuration: Configuration = Configuration()) {
+    self.configuration = configuration
+  }
+
+  /// A snapshot of the counters.
+  public var currentStatistics: Statistics {
+    mutex.sync { statistics }
+  }
+
+  /// The slots the queue holds, sent or not, so tests can check sent chunks are let go.
+  internal var queueStorageCount: Int {
+    mutex.sync { chunks.count }
+  }
+
+  /// Queues `data` to be sent, or drops it if the stream is full. Output after ``finish()`` is ignored.
+  public func consume(_ data: Data) {
+    if data.isEmpty {
+      return
+    }
+    let sender = mutex.sync { () -> CheckedContinuation<Void, Never>? in
+      guard !finished else {
+        return nil
+      }
+      statistics.consumedBytes += data.count
+      statistics.consumedChunks += 1
+      guard bufferedBytes + data.count <= configuration.maxBufferedBytes else {
+        statistics.lostBytes += UInt64(data.count)
+        return nil
+      }
+      let wasEmpty = bufferedBytes == 0
+      version += 1
+      chunks.append(data)
+      bufferedBytes += data.count
+      statistics.maxBufferedBytes = max(statistics.maxBufferedBytes, bufferedBytes)
+      if wasEmpty {
+        oldestBufferedTime = .now()
+      }
+      // The sender is waiting either for anything at all, or for a full batch.
+      guard wasEmpty || bufferedBytes >= configuration.maxBatchBytes else {
+        return nil
+      }
+      return takeWaitingSender()
+    }
+    sender?.resume()
+  }
+
+  /// Ends the stream. ``nextBatch()`` returns what is still queued, then nil.
+  public func finish() {
+    let sender = mutex.sync { () -> CheckedContinuation<Void, Never>? in
+      finished = true
+      version += 1
+      return takeWaitingSender()
+    }
+    sender?.resume()
+  }
+
+  /// Waits for the next batch to be ready. Returns nil once the stream has finished and
+  /// everything has been returned. Only one sender may call this at a time.
+  public func nextBatch() async -> Batch? {
+    while true {
+      enum Action {
+        case batch(Batch)
+        case end
+        case wait(DispatchTime?, version: UInt64)
+      }
+      let action = mutex.sync { () -> Action in
+        let unreportedLoss = statistics.lostBytes != reportedLostBytes
+        if bufferedBytes >= configuration.maxBatchBytes || (finished && (bufferedBytes > 0 || unreportedLoss)) {
+          return .batch(takeBatch())
+        }
+        if finished {
+          return .end
+        }
+        guard let oldestBufferedTime else {
+          // Report a loss even when nothing has been queued since, rather than waiting for more output.
+          return unreportedLoss ? .batch(takeBatch()) : .wait(nil, version: version)
+        }
+        let deadline = oldestBufferedTime + configuration.maxLatency
+        if deadline <= .now() {
+          return .batch(takeBatch())
+        }
+        return .wait(deadline, version: version)
+      }
+      switch action {
+      case let .batch(batch):
+        return batch
+      case .end:
+        return nil
+      case let .wait(deadline, version):
+        await wait(until: deadline, ifUnchangedSince: version)
+      }
+    }
+  }
+
+  // MARK: Private
+
+  private func wait(until deadline: DispatchTime?, ifUnchangedSince version: UInt64) async {
+    await withCheckedContinuation { (continuation: CheckedContinuation<Void, Never>) in
+      let generation = mutex.sync { () -> UInt64? in
+        guard version == self.version else {
+          return nil
+        }
+        waitGeneration += 1
+        waitingSender = continuation
+        return waitGeneration
+      }
+      guard let generation else {
+        continuation.resume()
+        return
+      }
+      if let deadline {
+        DispatchQueue.global(qos: .userInitiated).asyncAfter(deadline: deadline) { [weak self] in
+          self?.wakeSender(generation: generation)
+        }
+      }
+    }
+  }
+
+  private func wakeSender(generation: UInt64) {
+    let sender = mutex.sync { () -> CheckedContinuation<Void, Never>? in
+      guard generation == waitGeneration else {
+        return nil
+      }
+      return takeWaitingSender()
+    }
+    sender?.resume()
+  }
+
+  /// Must be called with the mutex held.
+  private func takeWaitingSender() -> CheckedContinuation<Void, Never>? {
+    defer { waitingSender = nil }
+    return waitingSender
+  }
+
+  /// Removes up to `maxBatchBytes` from the front of the queue. Must be called with the mutex held.
+  private func takeBatch() -> Batch {
+    var data = Data()
+    if head < chunks.count && chunks[head].count >= configuration.maxBatchBytes {
+      // A large chunk is sent as it is, or split, without first being copied into a new batch.
+      let chunk = chunks[head]
+      data = chunk.prefix(configuration.maxBatchBytes)
+      if chunk.count == data.count {
+        chunks[head] = Data()
+        head += 1
+      } else {
+        chunks[head] = chunk.suffix(from: chunk.startIndex + data.count)
+      }
+    } else {
+      data.reserveCapacity(min(bufferedBytes, configuration.maxBatchBytes))
+      while head < chunks.count && data.count < configuration.maxBatchBytes {
+        let chunk = chunks[head]
+        let taken = min(chunk.count, configuration.maxBatchBytes - data.count)
+        if taken == chunk.count {
+          data.append(chunk)
+          chunks[head] = Data()
+          head += 1
+        } else {
+          data.append(chunk.prefix(taken))
+          chunks[head] = chunk.suffix(from: chunk.startIndex + taken)
+        }
+      }
+    }
+    // Sent chunks are dropped from the front once they are half the queue, so a sender that
+    // never quite catches up does not leave the queue to grow without bound.
+    if head == chunks.count {
+      chunks.removeAll(keepingCapacity: true)
+      head = 0
+    } else if head > chunks.count / 2 {
+      chunks.removeFirst(head)
+      head = 0
+    }
+    bufferedBytes -= data.count
+    // What remains has waited since before this batch was taken, so it is due as soon as the sender is free.
+    oldestBufferedTime = bufferedBytes > 0 ? oldestBufferedTime : nil
+    reportedLostBytes = statistics.lostBytes
+    statistics.sentBytes += data.count
+    statistics.batches += 1
+    return Batch(data: data, lostBytes: reportedLostBytes)
+  }
+}
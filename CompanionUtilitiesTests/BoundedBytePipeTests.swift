@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import CompanionUtilities
+import XCTest
+
+final class BoundedBytePipeTests: XCTestCase {
+
+  private struct TestError: Error {}
+
+  private static func drain(_ pipe: BoundedBytePipe) async throws -> Data {
+    var received = Data()
+    while let data = try await pipe.next() {
+      received.append(data)
+    }
+    return received
+  }
+
+  func testDeliversChunksInOrder() async throws {
+    let pipe = BoundedBytePipe(highWaterMark: 1024)
+    let consumer = Task { try await Self.drain(pipe) }
+
+    var sent = Data()
+    for index in 0..<100 {
+      let chunk = Data(repeating: UInt8(index), count: 100 + index)
+      sent.append(chunk)
+      try await pipe.send(chunk)
+    }
+    pipe.finish()
+
+    let received = try await consumer.value
+    XCTAssertEqual(received, sent)
+    XCTAssertEqual(pipe.currentStatistics.bytes, sent.count)
+    XCTAssertEqual(pipe.currentStatistics.chunks, 100)
+    XCTAssertEqual(pipe.currentStatistics.queuedBytes, 0)
+  }
+
+  func testSendDoesNotWaitBelowHighWaterMark() async throws {
+    let pipe = BoundedBytePipe(highWaterMark: 1024)
+    try await pipe.send(Data(count: 512))
+    try await pipe.send(Data(count: 512))
+
+    let statistics = pipe.currentStatistics
+    XCTAssertEqual(statistics.stalls, 0)
+    XCTAssertEqual(statistics.queuedBytes, 1024)
+    XCTAssertEqual(statistics.queuedChunks, 2)
+  }
+
+  func testSendWaitsAboveHighWaterMarkUntilDrained() async throws {
+    let pipe = BoundedBytePipe(highWaterMark: 1024)
+    try await pipe.send(Data(count: 1024))
+
+    let producer = Task { try await pipe.send(Data(count: 1)) }
+    // The producer cannot complete until the consumer takes the first chunk.
+    try await Task.sleep(nanoseconds: 50_000_000)
+    XCTAssertEqual(pipe.currentStatistics.queuedBytes, 1025)
+
+    let first = try await pipe.next()
+    XCTAssertEqual(first?.count, 1024)
+    try await producer.value
+
+    let statistics = pipe.currentStatistics
+    XCTAssertEqual(statistics.stalls, 1)
+    XCTAssertGreaterThan(statistics.stalledTime, 0)
+    XCTAssertEqual(statistics.maxQueuedBytes, 1025)
+    XCTAssertEqual(statistics.maxQueuedChunks, 2)
+  }
+
+  func testFinishWithErrorFailsConsumer() async throws {
+    let pipe = BoundedBytePipe()
+    try await pipe.send(Data(count: 10))
+    pipe.finish(throwing: TestError())
+
+    do {
+      _ = try await pipe.next()
+      XCTFail("Expected the producer's error")
+    } catch is TestError {}
+  }
+
+  func testCancelFailsWaitingProducer() async throws {
+    let pipe = BoundedBytePipe(highWaterMark: 1)
+    let producer = Task { try await pipe.send(Data(count: 2)) }
+    try await Task.sleep(nanoseconds: 50_000_000)
+    pipe.cancel(TestError())
+
+    do {
+      try await producer.value
+      XCTFail("Expected the consumer's error")
+    } catch is TestError {}
+
+    do {
+      try await pipe.send(Data(count: 1))
+      XCTFail("Expected the consumer's error")
+    } catch is TestError {}
+  }
+
+  /// Pushes 1Gb through a 16Mb pipe to a consumer that is slower than the producer,
+  /// and checks the queue never got more than a chunk past the high-water mark.
+  func testThroughputIsBoundedByHighWaterMark() async throws {
+    let chunkSize = 4 * 1024 * 1024
+    let chunkCount = 256
+    let pipe = BoundedBytePipe()
+    let chunk = Data(count: chunkSize)
+
+    let consumer = Task {
+      var received = 0
+      while let data = try await pipe.next() {
+        received += data.count
+        // Stand in for a slower extractor.
+        await Task.yield()
+      }
+      return received
+    }
+    for _ in 0..<chunkCount {
+      try await pipe.send(chunk)
+    }
+    pipe.finish()
+    let received = try await consumer.value
+
+    let statistics = pipe.currentStatistics
+    XCTAssertEqual(received, chunkSize * chunkCount)
+    XCTAssertLessThanOrEqual(statistics.maxQueuedBytes, pipe.highWaterMark + chunkSize)
+  }
+}
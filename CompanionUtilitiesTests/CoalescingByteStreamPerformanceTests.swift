@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import CompanionUtilities
+import XCTest
+
+/// Measures a synthetic chatty log through a `CoalescingByteStream`: several producer threads
+/// writing short lines as fast as they can, drained by a sender that takes a little time over
+/// each batch, as a network write does. The clock time over the fixed number of lines gives
+/// messages and bytes per second, and the memory metric how much the stream held on the way.
+final class CoalescingByteStreamPerformanceTests: XCTestCase {
+
+  private static let producers = 4
+  private static let linesPerProducer = 50_000
+
+  func testSyntheticLogProducer() {
+    measure(metrics: [XCTClockMetric(), XCTMemoryMetric()]) {
+      let stream = CoalescingByteStream()
+      let drained = expectation(description: "drained")
+      Task {
+        while await stream.nextBatch() != nil {
+          try? await Task.sleep(nanoseconds: 100_000)
+        }
+        let statistics = stream.currentStatistics
+        XCTAssertEqual(statistics.sentBytes + Int(statistics.lostBytes), statistics.consumedBytes)
+        drained.fulfill()
+      }
+      DispatchQueue.concurrentPerform(iterations: Self.producers) { producer in
+        for index in 0..<Self.linesPerProducer {
+          let line = "2024-01-01 00:00:00.000 Simulator[\(producer)] chatty log line \(index)\n"
+          stream.consume(Data(line.utf8))
+        }
+      }
+      stream.finish()
+      wait(for: [drained], timeout: 60)
+    }
+  }
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import CompanionUtilities
+import XCTest
+
+final class CoalescingByteStreamTests: XCTestCase {
+
+  private static func drain(_ stream: CoalescingByteStream) async -> [CoalescingByteStream.Batch] {
+    var batches: [CoalescingByteStream.Batch] = []
+    while let batch = await stream.nextBatch() {
+      batches.append(batch)
+    }
+    return batches
+  }
+
+  func testCoalescesWritesUpToBatchSize() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 100, maxLatency: 10))
+    var sent = Data()
+    for index in 0..<50 {
+      let chunk = Data(repeating: UInt8(index), count: 7)
+      sent.append(chunk)
+      stream.consume(chunk)
+    }
+    stream.finish()
+
+    let batches = await Self.drain(stream)
+    XCTAssertEqual(batches.map(\.data.count), [100, 100, 100, 50])
+    XCTAssertEqual(batches.reduce(into: Data()) { $0.append($1.data) }, sent)
+    XCTAssertEqual(batches.map(\.lostBytes), [0, 0, 0, 0])
+  }
+
+  func testSplitsChunksLargerThanBatchSize() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 100, maxLatency: 10))
+    let chunk = Data((0..<250).map { UInt8($0) })
+    stream.consume(chunk)
+    stream.finish()
+
+    let batches = await Self.drain(stream)
+    XCTAssertEqual(batches.map(\.data.count), [100, 100, 50])
+    XCTAssertEqual(batches.reduce(into: Data()) { $0.append($1.data) }, chunk)
+  }
+
+  func testSendsPartialBatchOnceLatencyElapses() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 1024, maxLatency: 0.05))
+    let start = Date()
+    stream.consume(Data("FOO".utf8))
+    stream.consume(Data("BAR".utf8))
+
+    let batch = await stream.nextBatch()
+    XCTAssertEqual(batch?.data, Data("FOOBAR".utf8))
+    XCTAssertGreaterThanOrEqual(Date().timeIntervalSince(start), 0.05)
+  }
+
+  func testZeroLatencySendsWithoutWaiting() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 1024, maxLatency: 0))
+    let sender = Task { await stream.nextBatch() }
+    stream.consume(Data("FOO".utf8))
+
+    let batch = await sender.value
+    XCTAssertEqual(batch?.data, Data("FOO".utf8))
+  }
+
+  func testFullBatchDoesNotWaitForLatency() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 4, maxLatency: 60))
+    let sender = Task { await stream.nextBatch() }
+    try? await Task.sleep(nanoseconds: 10_000_000)
+    stream.consume(Data("FO".utf8))
+    stream.consume(Data("OBAR".utf8))
+
+    let batch = await sender.value
+    XCTAssertEqual(batch?.data, Data("FOOB".utf8))
+  }
+
+  func testDropsAndCountsOutputBeyondBuffer() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 10, maxLatency: 60, maxBufferedBytes: 20))
+    stream.consume(Data(count: 15))
+    stream.consume(Data(count: 10))
+    stream.consume(Data(count: 5))
+    stream.consume(Data(count: 1))
+
+    var batch = await stream.nextBatch()
+    XCTAssertEqual(batch?.data.count, 10)
+    XCTAssertEqual(batch?.lostBytes, 11)
+
+    // Room has been made, so later output is kept again.
+    stream.consume(Data(count: 3))
+    stream.finish()
+    batch = await stream.nextBatch()
+    XCTAssertEqual(batch?.data.count, 10)
+    XCTAssertEqual(batch?.lostBytes, 11)
+    batch = await stream.nextBatch()
+    XCTAssertEqual(batch?.data.count, 3)
+    batch = await stream.nextBatch()
+    XCTAssertNil(batch)
+
+    let statistics = stream.currentStatistics
+    XCTAssertEqual(statistics.consumedBytes, 34)
+    XCTAssertEqual(statistics.sentBytes, 23)
+    XCTAssertEqual(statistics.lostBytes, 11)
+  }
+
+  func testReportsLossWithNoOutputLeftToSend() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 10, maxLatency: 60, maxBufferedBytes: 10))
+    stream.consume(Data(count: 11))
+
+    // Nothing was kept, but the loss is reported without waiting for more output.
+    let batch = await stream.nextBatch()
+    XCTAssertEqual(batch?.data, Data())
+    XCTAssertEqual(batch?.lostBytes, 11)
+  }
+
+  func testIgnoresOutputAfterFinish() async {
+    let stream = CoalescingByteStream()
+    stream.consume(Data("FOO".utf8))
+    stream.finish()
+    stream.consume(Data("BAR".utf8))
+
+    let batches = await Self.drain(stream)
+    XCTAssertEqual(batches.map(\.data), [Data("FOO".utf8)])
+  }
+
+  func testFinishWakesWaitingSender() async {
+    let stream = CoalescingByteStream()
+    let sender = Task { await Self.drain(stream) }
+    try? await Task.sleep(nanoseconds: 10_000_000)
+    stream.finish()
+
+    let batches = await sender.value
+    XCTAssertEqual(batches, [])
+  }
+
+  /// A synthetic chatty log: many producer threads writing short lines as fast as they can,
+  /// drained by a sender that takes a little time over each message, as a network write does.
+  /// Checks output is coalesced and every byte is either sent or counted as lost.
+  func testThroughputWithSyntheticLogProducer() async {
+    let producers = 4
+    let linesPerProducer = 50_000
+    let stream = CoalescingByteStream()
+
+    let sender = Task { () -> (messages: Int, bytes: Int, lostBytes: UInt64) in
+      var messages = 0
+      var bytes = 0
+      var lostBytes: UInt64 = 0
+      while let batch = await stream.nextBatch() {
+        messages += 1
+        bytes += batch.data.count
+        lostBytes = batch.lostBytes
+        try? await Task.sleep(nanoseconds: 100_000)
+      }
+      return (messages, bytes, lostBytes)
+    }
+
+    DispatchQueue.concurrentPerform(iterations: producers) { producer in
+      for index in 0..<linesPerProducer {
+        stream.consume(Data("2024-01-01 00:00:00.000 Simulator[\(producer)] chatty log line \(index)\n".utf8))
+      }
+    }
+    stream.finish()
+
+    let result = await sender.value
+    let statistics = stream.currentStatistics
+    XCTAssertEqual(statistics.consumedChunks, producers * linesPerProducer)
+    XCTAssertEqual(UInt64(result.bytes) + result.lostBytes, UInt64(statistics.consumedBytes))
+    XCTAssertEqual(result.lostBytes, statistics.lostBytes)
+    XCTAssertLessThan(result.messages * 100, statistics.consumedChunks)
+  }
+
+  /// The sender takes a chunk for every chunk produced, but never empties the queue, so sent
+  /// chunks have to be let go from its front rather than only when it drains.
+  func testQueueStorageIsBoundedWhenSenderNeverCatchesUp() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 1, maxLatency: 0, maxBufferedBytes: 1024))
+    stream.consume(Data([0]))
+    for index in 0..<10_000 {
+      stream.consume(Data([UInt8(truncatingIfNeeded: index)]))
+      let batch = await stream.nextBatch()
+      XCTAssertEqual(batch?.data.count, 1)
+      XCTAssertLessThanOrEqual(stream.queueStorageCount, 4)
+    }
+    stream.finish()
+    let batches = await Self.drain(stream)
+    XCTAssertEqual(batches.map(\.data.count), [1])
+  }
+
+  /// A producer far faster than the sender fills the buffer, and the excess is counted rather than held.
+  func testSlowSenderLosesOutputWithinBound() async {
+    let stream = CoalescingByteStream(configuration: .init(maxBatchBytes: 1024, maxLatency: 0, maxBufferedBytes: 64 * 1024))
+    let sender = Task { () -> UInt64 in
+      var lostBytes: UInt64 = 0
+      while let batch = await stream.nextBatch() {
+        lostBytes = batch.lostBytes
+        try? await Task.sleep(nanoseconds: 1_000_000)
+      }
+      return lostBytes
+    }
+    let line = Data(repeating: UInt8(ascii: "x"), count: 100)
+    for _ in 0..<10_000 {
+      stream.consume(line)
+    }
+    stream.finish()
+
+    let lostBytes = await sender.value
+    let statistics = stream.currentStatistics
+    XCTAssertGreaterThan(lostBytes, 0)
+    XCTAssertEqual(lostBytes, statistics.lostBytes)
+    XCTAssertLessThanOrEqual(statistics.maxBufferedBytes, 64 * 1024)
+    XCTAssertEqual(UInt64(statistics.sentBytes) + lostBytes, UInt64(statistics.consumedBytes))
+  }
+}
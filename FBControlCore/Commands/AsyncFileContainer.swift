@@ -7,6 +7,17 @@
 
 import Foundation
 
+/// What a container can say about a file without copying it out.
+public struct FBContainedFileAttributes: Equatable, Sendable {
+  public let size: UInt64
+  public let modificationDate: Date
+
+  public init(size: UInt64, modificationDate: Date) {
+    self.size = size
+    self.modificationDate = modificationDate
+  }
+}
+
 public protocol AsyncFileContainer: AnyObject {
 
   func copy(fromHost sourcePath: String, toContainer destinationPath: String) async throws
@@ -25,6 +36,10 @@ public protocol AsyncFileContainer: AnyObject {
 
   func contents(ofDirectory path: String) async throws -> [String]
 
+  /// The size and modification date of the regular file at `path`, read in place. `nil` when the
+  /// container can only learn them by copying the file out, or `path` is not a regular file.
+  func attributes(ofFile path: String) async throws -> FBContainedFileAttributes?
+
   /// The path of the container on the host filesystem, if it is backed by a
   /// single real directory. `nil` for containers that don't map to one host path.
   var pathOnHostFileSystem: String? { get }
@@ -37,6 +52,8 @@ public protocol AsyncFileContainer: AnyObject {
 
 public extension AsyncFileContainer {
 
+  func attributes(ofFile path: String) async throws -> FBContainedFileAttributes? { nil }
+
   var pathOnHostFileSystem: String? { nil }
 
   var pathMapping: [String: String]? { nil }
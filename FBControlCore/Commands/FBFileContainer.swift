@@ -314,6 +314,29 @@ public final class FBContainedFile_ContainedRoot: NSObject, AsyncFileContainer {
     }
   }
 
+  public func attributes(ofFile path: String) async throws -> FBContainedFileAttributes? {
+    let box = rootFileBox
+    return try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<FBContainedFileAttributes?, Error>) in
+      queue.async {
+        do {
+          // Anything that can't be read here is left to the copy out, which reports it properly.
+          guard let hostPath = try box.file.file(byAppendingPathComponent: path).pathOnHostFileSystem,
+            let attributes = try? FileManager.default.attributesOfItem(atPath: hostPath),
+            attributes[.type] as? FileAttributeType == .typeRegular,
+            let size = attributes[.size] as? NSNumber,
+            let modificationDate = attributes[.modificationDate] as? Date
+          else {
+            continuation.resume(returning: nil)
+            return
+          }
+          continuation.resume(returning: FBContainedFileAttributes(size: size.uint64Value, modificationDate: modificationDate))
+        } catch {
+          continuation.resume(throwing: error)
+        }
+      }
+    }
+  }
+
 }
 
 /// File container backed by `ProvisioningProfileCommands`.
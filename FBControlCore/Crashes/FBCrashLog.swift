@@ -156,23 +156,15 @@ public class FBCrashLogInfo: NSObject, NSCopying {
       throw FBCrashLogError.fileEmpty(path: crashPath)
     }
 
-    guard let crashString = String(data: crashFileData, encoding: .utf8) else {
-      throw FBCrashLogError.stringExtractionFailed(path: crashPath)
-    }
-
-    let parser = getPreferredCrashLogParser(forCrashString: crashString)
-    return try fromCrashLogString(crashString, crashPath: crashPath, parser: parser)
+    return try fromCrashLogData(crashFileData, crashPath: crashPath)
   }
 
   @objc(isParsableCrashLog:)
   public class func isParsableCrashLog(_ data: Data) -> Bool {
     #if canImport(Darwin)
-    guard let crashString = String(data: data, encoding: .utf8) else {
-      return false
-    }
-    let parser = getPreferredCrashLogParser(forCrashString: crashString)
+    // Only whether the header fields are there matters, so the thread and image sections are skipped.
     do {
-      _ = try fromCrashLogString(crashString, crashPath: "", parser: parser)
+      _ = try fromCrashLogData(data, crashPath: "", headerOnly: true)
       return true
     } catch {
       return false
@@ -304,15 +296,8 @@ public class FBCrashLogInfo: NSObject, NSCopying {
 
   // MARK: Private
 
-  private class func getPreferredCrashLogParser(forCrashString crashString: String) -> FBCrashLogParser {
-    if !crashString.isEmpty && crashString.first == "{" {
-      return FBConcatedJSONCrashLogParser()
-    } else {
-      return FBPlainTextCrashLogParser()
-    }
-  }
-
-  private class func fromCrashLogString(_ crashString: String, crashPath: String, parser: FBCrashLogParser) throws -> FBCrashLogInfo {
+  /// JSON reports are parsed from their bytes as they are; only plain text ones are decoded to a string.
+  private class func fromCrashLogData(_ data: Data, crashPath: String, headerOnly: Bool = false) throws -> FBCrashLogInfo {
     var executablePath: NSString = NSString()
     var identifier: NSString = NSString()
     var processName: NSString = NSString()
@@ -324,19 +309,38 @@ public class FBCrashLogInfo: NSObject, NSCopying {
     var crashedThreadDescription: NSString = NSString()
 
     var parseError: NSError?
-    parser.parseCrashLog(
-      from: crashString,
-      executablePathOut: &executablePath,
-      identifierOut: &identifier,
-      processNameOut: &processName,
-      parentProcessNameOut: &parentProcessName,
-      processIdentifierOut: &processIdentifier,
-      parentProcessIdentifierOut: &parentProcessIdentifier,
-      dateOut: &date,
-      exceptionDescription: &exceptionDescription,
-      crashedThreadDescription: &crashedThreadDescription,
-      error: &parseError
-    )
+    if data.first == UInt8(ascii: "{") {
+      FBConcatedJSONCrashLogParser(headerOnly: headerOnly).parseCrashLog(
+        fromData: data,
+        executablePathOut: &executablePath,
+        identifierOut: &identifier,
+        processNameOut: &processName,
+        parentProcessNameOut: &parentProcessName,
+        processIdentifierOut: &processIdentifier,
+        parentProcessIdentifierOut: &parentProcessIdentifier,
+        dateOut: &date,
+        exceptionDescription: &exceptionDescription,
+        crashedThreadDescription: &crashedThreadDescription,
+        error: &parseError
+      )
+    } else {
+      guard let crashString = String(data: data, encoding: .utf8) else {
+        throw FBCrashLogError.stringExtractionFailed(path: crashPath)
+      }
+      FBPlainTextCrashLogParser().parseCrashLog(
+        from: crashString,
+        executablePathOut: &executablePath,
+        identifierOut: &identifier,
+        processNameOut: &processName,
+        parentProcessNameOut: &parentProcessName,
+        processIdentifierOut: &processIdentifier,
+        parentProcessIdentifierOut: &parentProcessIdentifier,
+        dateOut: &date,
+        exceptionDescription: &exceptionDescription,
+        crashedThreadDescription: &crashedThreadDescription,
+        error: &parseError
+      )
+    }
 
     if let parseError {
       throw FBCrashLogError.parseFailed(underlying: parseError)
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// An index of the crash logs in a set of directories, persisted to disk.
+///
+/// Each file is recorded with its modification date and size along with the header
+/// fields parsed from it, or with none if it could not be parsed. `update()` only
+/// stats the files in the directories, and only reads and parses those that are new
+/// or have changed since they were indexed, so keeping the index current costs a
+/// directory listing rather than a read of every crash log.
+///
+/// The index file is only a cache: it is written atomically, and a missing, corrupt
+/// or outdated one is rebuilt from the directories. Processes share an index file for
+/// the same directories, so saving takes a lock on it and merges this index into what
+/// is on disk, rather than dropping the entries other processes have written since
+/// this one loaded it.
+final class FBCrashLogIndex {
+
+  // MARK: Types
+
+  struct Entry: Codable {
+    let modificationDate: Date
+    let size: UInt64
+    /// The parsed header, or nil if the file is not a parsable crash log.
+    let header: Header?
+  }
+
+  struct Header: Codable {
+    let executablePath: String
+    let identifier: String
+    let processName: String
+    let processIdentifier: pid_t
+    let parentProcessName: String
+    let parentProcessIdentifier: pid_t
+    let date: Date
+    let processType: UInt
+    let exceptionDescription: String?
+    let crashedThreadDescription: String?
+  }
+
+  private struct Contents: Codable {
+    let version: Int
+    let entries: [String: Entry]
+  }
+
+  /// Bumped whenever `Entry` or the parsing it records changes, so stale indexes are rebuilt.
+  private static let version = 1
+
+  // MARK: Properties
+
+  let directories: [String]
+  let indexPath: String?
+  private let logger: (any FBControlCoreLogger)?
+  private var entries: [String: Entry]
+  private var infos: [String: FBCrashLogInfo] = [:]
+  /// Paths removed since the last save, to be removed from the file on disk too.
+  private var removedPaths: Set<String> = []
+
+  // MARK: Initializers
+
+  /// Loads the index at `indexPath`, if there is a valid one. With no `indexPath` the
+  /// index is only kept in memory.
+  init(directories: [String], indexPath: String?, logger: (any FBControlCoreLogger)?) {
+    self.directories = directories
+    self.indexPath = indexPath
+    self.logger = logger
+    self.entries = Self.load(indexPath: indexPath) ?? [:]
+  }
+
+  /// The default place to keep the index for `directories`, in the user's caches directory.
+  static func defaultIndexPath(forDirectories directories: [String]) -> String {
+    let caches = FileManager.default.urls(for: .cachesDirectory, in: .userDomainMask).first ?? FileManager.default.temporaryDirectory
+    // FNV-1a, so that each set of directories gets its own stable file name.
+    var hash: UInt64 = 0xcbf2_9ce4_8422_2325
+    for byte in directories.joined(separator: "\n").utf8 {
+      hash = (hash ^ UInt64(byte)) &* 0x100_0000_01b3
+    }
+    return
+      caches
+      .appendingPathComponent("com.facebook.idb")
+      .appendingPathComponent("crash_log_index")
+      .appendingPathComponent(String(format: "%016llx.json", hash))
+      .path
+  }
+
+  // MARK: Public
+
+  /// Brings the index up to date with the directories, persisting it if anything
+  /// changed. Returns the crash logs that were added or changed, and those whose
+  /// files have gone.
+  func update() -> (added: [FBCrashLogInfo], removed: [FBCrashLogInfo]) {
+    var seen = Set<String>()
+    var added: [FBCrashLogInfo] = []
+    var changed = false
+    for directory in directories {
+      guard let names = try? FileManager.default.contentsOfDirectory(atPath: directory) else {
+        continue
+      }
+      for name in names where !name.hasPrefix(".") {
+        let path = (directory as NSString).appendingPathComponent(name)
+        seen.insert(path)
+        switch updateEntry(atPath: path) {
+        case .unchanged:
+          break
+        case let .updated(info):
+          changed = true
+          if let info {
+            added.append(info)
+          }
+        }
+      }
+    }
+    var removed: [FBCrashLogInfo] = []
+    // Files ingested individually from elsewhere are not the directories' to remove.
+    for path in entries.keys where !seen.contains(path) && directories.contains((path as NSString).deletingLastPathComponent) {
+      if let info = info(atPath: path) {
+        removed.append(info)
+      }
+      entries.removeValue(forKey: path)
+      infos.removeValue(forKey: path)
+      removedPaths.insert(path)
+      changed = true
+    }
+    if changed {
+      save()
+    }
+    return (added, removed)
+  }
+
+  /// Indexes the single file at `path`, returning its crash log if it is one.
+  func update(path: String) -> FBCrashLogInfo? {
+    if case .updated = updateEntry(atPath: path) {
+      save()
+    }
+    return info(atPath: path)
+  }
+
+  /// The crash log for an indexed file, or nil if it is not indexed or not parsable.
+  func info(atPath path: String) -> FBCrashLogInfo? {
+    if let info = infos[path] {
+      return info
+    }
+    guard let header = entries[path]?.header else {
+      return nil
+    }
+    let info = FBCrashLogInfo(
+      crashPath: path,
+      executablePath: header.executablePath,
+      identifier: header.identifier,
+      processName: header.processName,
+      processIdentifier: header.processIdentifier,
+      parentProcessName: header.parentProcessName,
+      parentProcessIdentifier: header.parentProcessIdentifier,
+      date: header.date,
+      processType: FBCrashLogInfoProcessType(rawValue: header.processType),
+      exceptionDescription: header.exceptionDescription,
+      crashedThreadDescription: header.crashedThreadDescription
+    )
+    infos[path] = info
+    return info
+  }
+
+  /// Every indexed crash log.
+  var allInfos: [FBCrashLogInfo] {
+    entries.keys.compactMap(info(atPath:))
+  }
+
+  /// When the file at `path` was last modified, as of the last update.
+  func modificationDate(atPath path: String) -> Date? {
+    entries[path]?.modificationDate
+  }
+
+  // MARK: Private
+
+  private enum EntryUpdate {
+    case unchanged
+    case updated(FBCrashLogInfo?)
+  }
+
+  private func updateEntry(atPath path: String) -> EntryUpdate {
+    guard let attributes = try? FileManager.default.attributesOfItem(atPath: path),
+      attributes[.type] as? FileAttributeType == .typeRegular,
+      let modificationDate = attributes[.modificationDate] as? Date
+    else {
+      return .unchanged
+    }
+    let size = (attributes[.size] as? NSNumber)?.uint64Value ?? 0
+    if let existing = entries[path], existing.modificationDate == modificationDate, existing.size == size {
+      return .unchanged
+    }
+    let info: FBCrashLogInfo?
+    do {
+      info = try FBCrashLogInfo.fromCrashLog(atPath: path)
+    } catch {
+      logger?.log("Could not obtain crash info for \(path): \(error)")
+      info = nil
+    }
+    entries[path] = Entry(modificationDate: modificationDate, size: size, header: info.map(Header.init(info:)))
+    infos[path] = info
+    removedPaths.remove(path)
+    return .updated(info)
+  }
+
+  private static func load(indexPath: String?) -> [String: Entry]? {
+    guard let indexPath,
+      let data = FileManager.default.contents(atPath: indexPath),
+      let contents = try? JSONDecoder().decode(Contents.self, from: data),
+      contents.version == version
+    else {
+      return nil
+    }
+    return contents.entries
+  }
+
+  /// Writes the index, merged with the one on disk under an exclusive lock so that
+  /// concurrent saves from other processes are not lost. The merged entries are only
+  /// written, not taken into this index: `update()` reports the files it has not
+  /// indexed itself as added, which those from other processes must still be.
+  private func save() {
+    guard let indexPath else {
+      return
+    }
+    do {
+      try FileManager.default.createDirectory(atPath: (indexPath as NSString).deletingLastPathComponent, withIntermediateDirectories: true, attributes: nil)
+      let lockDescriptor = open(indexPath + ".lock", O_CREAT | O_RDWR | O_CLOEXEC, 0o644)
+      guard lockDescriptor >= 0 else {
+        throw POSIXError(POSIXErrorCode(rawValue: errno) ?? .EIO)
+      }
+      // Closing the descriptor releases the lock.
+      defer { close(lockDescriptor) }
+      guard flock(lockDescriptor, LOCK_EX) == 0 else {
+        throw POSIXError(POSIXErrorCode(rawValue: errno) ?? .EIO)
+      }
+      var merged = Self.load(indexPath: indexPath) ?? [:]
+      for path in removedPaths {
+        merged.removeValue(forKey: path)
+      }
+      merged.merge(entries) { onDisk, ours in
+        onDisk.modificationDate > ours.modificationDate ? onDisk : ours
+      }
+      let data = try JSONEncoder().encode(Contents(version: Self.version, entries: merged))
+      try data.write(to: URL(fileURLWithPath: indexPath), options: .atomic)
+      removedPaths.removeAll()
+    } catch {
+      logger?.log("Failed to save crash log index to \(indexPath): \(error)")
+    }
+  }
+}
+
+extension FBCrashLogIndex.Header {
+  init(info: FBCrashLogInfo) {
+    self.init(
+      executablePath: info.executablePath,
+      identifier: info.identifier,
+      processName: info.processName,
+      processIdentifier: info.processIdentifier,
+      parentProcessName: info.parentProcessName,
+      parentProcessIdentifier: info.parentProcessIdentifier,
+      date: info.date,
+      processType: info.processType.rawValue,
+      exceptionDescription: info.exceptionDescription,
+      crashedThreadDescription: info.crashedThreadDescription
+    )
+  }
+}
@@ -13,11 +13,18 @@ public class FBCrashLogNotifier {
 
   public let store: FBCrashLogStore
   internal var sinceDate: Date
+  private let waitersLock = NSLock()
+  // Guarded by `waitersLock`.
+  private var waiterCount = 0
 
   // MARK: Initializers
 
-  internal init(logger: any FBControlCoreLogger) {
-    self.store = FBCrashLogStore.store(forDirectories: FBCrashLogInfo.diagnosticReportsPaths, logger: logger)
+  internal convenience init(logger: any FBControlCoreLogger) {
+    self.init(store: FBCrashLogStore.store(forDirectories: FBCrashLogInfo.diagnosticReportsPaths, logger: logger))
+  }
+
+  internal init(store: FBCrashLogStore) {
+    self.store = store
     self.sinceDate = Date()
   }
 
@@ -36,23 +43,57 @@ public class FBCrashLogNotifier {
     return true
   }
 
+  /// The next crash log written to the diagnostic reports directories that matches
+  /// `predicate`. Answered by the store's index as the directories change, so waiting
+  /// does not re-read the crash logs already there. The store only watches the
+  /// directories while there is a wait outstanding.
   public func nextCrashLog(forPredicate predicate: NSPredicate) -> FBFuture<FBCrashLogInfo> {
     _ = startListening(true)
+    let sinceDate = self.sinceDate
+    let store = self.store
+    beginWaiting()
 
-    let queue = DispatchQueue(label: "com.facebook.fbcontrolcore.crashlogfetch")
-    let result = FBFuture<AnyObject>.onQueue(
-      queue,
-      resolveUntil: {
-        let crashInfo =
-          (FBCrashLogInfo.crashInfo(afterDate: self.sinceDate, logger: nil) as NSArray)
-          .filtered(using: predicate)
-          .first as? FBCrashLogInfo
-        guard let crashInfo else {
-          return FBControlCoreError.describe("Crash Log Info for \(predicate) could not be obtained").failFuture()
-        }
-        _ = self.store.ingestCrashLog(atPath: crashInfo.crashPath)
-        return FBFuture(result: crashInfo)
+    let newCrashLogPredicate = NSPredicate { evaluatedObject, _ in
+      guard let crashLog = evaluatedObject as? FBCrashLogInfo,
+        FBCrashLogNotifier.crashLogExtensions.contains((crashLog.crashPath as NSString).pathExtension),
+        let modificationDate = store.modificationDate(ofCrashLog: crashLog)
+      else {
+        return false
+      }
+      return modificationDate >= sinceDate
+    }
+    return store.nextCrashLog(
+      forMatchingPredicate: NSCompoundPredicate(andPredicateWithSubpredicates: [newCrashLogPredicate, predicate]),
+      includingIngested: true
+    )
+    .onQueue(
+      DispatchQueue.global(qos: .utility),
+      notifyOfCompletion: { [self] _ in
+        endWaiting()
       })
-    return unsafeBitCast(result, to: FBFuture<FBCrashLogInfo>.self)
   }
+
+  // MARK: Private
+
+  // Watching starts and stops under the lock, so a wait beginning as the last one ends
+  // cannot have its watch stopped under it.
+  private func beginWaiting() {
+    waitersLock.withLock {
+      waiterCount += 1
+      if waiterCount == 1 {
+        store.startWatching()
+      }
+    }
+  }
+
+  private func endWaiting() {
+    waitersLock.withLock {
+      waiterCount -= 1
+      if waiterCount == 0 {
+        store.stopWatching()
+      }
+    }
+  }
+
+  private static let crashLogExtensions: Set<String> = ["crash", "ips"]
 }
@@ -19,13 +19,36 @@ public protocol FBCrashLogParser: NSObjectProtocol {
 /// 1. The layout can be changed by apple easily
 /// 2. Json structure itself can be easily changed
 /// 3. Crashes is not often happening operation of idb
-/// we prefer reliability over performance gain here and parse all json strings finding the fields that we need in all of json entries
+/// we prefer reliability over performance gain here and parse all json strings finding the fields that we need in all of json entries.
+/// The exception is a header-only parser, which steps over the thread and image sections without parsing them.
 public class FBConcatedJSONCrashLogParser: NSObject, FBCrashLogParser {
 
+  /// The sections that are only needed for the crashed thread description.
+  private static let threadAndImageKeys: Set<String> = ["threads", "usedImages"]
+
+  private let skippedKeys: Set<String>
+
+  public override init() {
+    self.skippedKeys = []
+    super.init()
+  }
+
+  /// A parser that, when `headerOnly`, leaves the crashed thread description empty in exchange
+  /// for not parsing the thread and image sections, which are most of a large report.
+  public init(headerOnly: Bool) {
+    self.skippedKeys = headerOnly ? FBConcatedJSONCrashLogParser.threadAndImageKeys : []
+    super.init()
+  }
+
   public func parseCrashLog(from str: String, executablePathOut: AutoreleasingUnsafeMutablePointer<NSString>, identifierOut: AutoreleasingUnsafeMutablePointer<NSString>, processNameOut: AutoreleasingUnsafeMutablePointer<NSString>, parentProcessNameOut: AutoreleasingUnsafeMutablePointer<NSString>, processIdentifierOut: UnsafeMutablePointer<pid_t>, parentProcessIdentifierOut: UnsafeMutablePointer<pid_t>, dateOut: AutoreleasingUnsafeMutablePointer<NSDate>, exceptionDescription: AutoreleasingUnsafeMutablePointer<NSString>, crashedThreadDescription: AutoreleasingUnsafeMutablePointer<NSString>, error: NSErrorPointer) {
+    parseCrashLog(fromData: Data(str.utf8), executablePathOut: executablePathOut, identifierOut: identifierOut, processNameOut: processNameOut, parentProcessNameOut: parentProcessNameOut, processIdentifierOut: processIdentifierOut, parentProcessIdentifierOut: parentProcessIdentifierOut, dateOut: dateOut, exceptionDescription: exceptionDescription, crashedThreadDescription: crashedThreadDescription, error: error)
+  }
+
+  /// Parses the report straight from its bytes, without decoding them into a string first.
+  public func parseCrashLog(fromData data: Data, executablePathOut: AutoreleasingUnsafeMutablePointer<NSString>, identifierOut: AutoreleasingUnsafeMutablePointer<NSString>, processNameOut: AutoreleasingUnsafeMutablePointer<NSString>, parentProcessNameOut: AutoreleasingUnsafeMutablePointer<NSString>, processIdentifierOut: UnsafeMutablePointer<pid_t>, parentProcessIdentifierOut: UnsafeMutablePointer<pid_t>, dateOut: AutoreleasingUnsafeMutablePointer<NSDate>, exceptionDescription: AutoreleasingUnsafeMutablePointer<NSString>, crashedThreadDescription: AutoreleasingUnsafeMutablePointer<NSString>, error: NSErrorPointer) {
     let parsedReport: [String: Any]
     do {
-      parsedReport = try FBConcatedJsonParser.parseConcatenatedJSON(from: str)
+      parsedReport = try FBConcatedJsonParser.parseConcatenatedJSON(from: data, skippingKeys: skippedKeys)
     } catch let parseError {
       error?.pointee = parseError as NSError
       return
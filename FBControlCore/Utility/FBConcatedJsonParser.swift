@@ -7,73 +7,246 @@
 
 import Foundation
 
+/// The ways a concatenated JSON document can be malformed, with the byte offset at which it was noticed.
+public enum FBConcatedJsonParserError: Error {
+  case unexpectedByte(UInt8, offset: Int)
+  case unexpectedEnd
+  case notAnObject(offset: Int)
+}
+
+extension FBConcatedJsonParserError: LocalizedError {
+  public var errorDescription: String? {
+    switch self {
+    case let .unexpectedByte(byte, offset):
+      return "Unexpected '\(Character(Unicode.Scalar(byte)))' at offset \(offset) of concatenated JSON"
+    case .unexpectedEnd:
+      return "Concatenated JSON ended part way through a value"
+    case let .notAnObject(offset):
+      return "Value at offset \(offset) of concatenated JSON is not an object"
+    }
+  }
+}
+
+/// Parses documents made of several JSON objects one after the other, such as .ips crash reports.
+///
+/// The objects are found in one pass over the UTF-8 bytes, and each is handed to
+/// `JSONSerialization` in place, without being copied out. Members whose keys are in
+/// `skippingKeys` are stepped over without being parsed at all, which makes reading the
+/// header fields of a report with large thread and image sections cheap.
 public final class FBConcatedJsonParser {
 
+  /// Parses every object in `str`, merging their members. Where objects share a key, the later one wins.
   public class func parseConcatenatedJSON(from str: String) throws -> [String: Any] {
-    var bracketCounter = 0
-    var characterEscaped = false
-    var inString = false
-    var parseError: Error?
+    try parseConcatenatedJSON(from: Data(str.utf8))
+  }
+
+  /// Parses every object in `data`, merging their members and leaving out those keyed by
+  /// `skippingKeys`. Where objects share a key, the later one wins.
+  public class func parseConcatenatedJSON(from data: Data, skippingKeys: Set<String> = []) throws -> [String: Any] {
+    try data.withUnsafeBytes { (rawBuffer: UnsafeRawBufferPointer) throws -> [String: Any] in
+      let bytes = rawBuffer.bindMemory(to: UInt8.self)
+      var scanner = JSONByteScanner(bytes: bytes)
+      var concatenatedJson: [String: Any] = [:]
+      while true {
+        scanner.skipWhitespace()
+        if scanner.isAtEnd {
+          return concatenatedJson
+        }
+        let start = scanner.index
+        guard scanner.peek == .openBrace else {
+          throw FBConcatedJsonParserError.unexpectedByte(scanner.peek, offset: start)
+        }
+        if skippingKeys.isEmpty {
+          let range = try scanner.scanValue()
+          guard let object = try JSONByteScanner.parse(range, in: bytes) as? [String: Any] else {
+            throw FBConcatedJsonParserError.notAnObject(offset: start)
+          }
+          concatenatedJson.merge(object) { _, new in new }
+        } else {
+          try scanner.scanMembers { key, range in
+            if !skippingKeys.contains(key) {
+              concatenatedJson[key] = try JSONByteScanner.parse(range, in: bytes)
+            }
+          }
+        }
+      }
+    }
+  }
+}
 
-    var concatenatedJson: [String: Any] = [:]
-    var json = ""
+private extension UInt8 {
+  static let openBrace = UInt8(ascii: "{")
+  static let closeBrace = UInt8(ascii: "}")
+  static let openBracket = UInt8(ascii: "[")
+  static let closeBracket = UInt8(ascii: "]")
+  static let quote = UInt8(ascii: "\"")
+  static let backslash = UInt8(ascii: "\\")
+  static let colon = UInt8(ascii: ":")
+  static let comma = UInt8(ascii: ",")
 
-    str.enumerateSubstrings(
-      in: str.startIndex..<str.endIndex,
-      options: .byComposedCharacterSequences
-    ) { substring, _, _, stop in
-      guard let c = substring else { return }
+  var isJSONWhitespace: Bool {
+    self == 0x20 || self == 0x0A || self == 0x0D || self == 0x09
+  }
+}
 
-      let escaped = characterEscaped
-      characterEscaped = false
+/// Steps over JSON values byte by byte, tracking only what is needed to find where each ends:
+/// string and escape state, and container depth.
+private struct JSONByteScanner {
+  let bytes: UnsafeBufferPointer<UInt8>
+  var index = 0
 
-      if escaped {
-        json.append(c)
-        return
-      }
+  init(bytes: UnsafeBufferPointer<UInt8>) {
+    self.bytes = bytes
+  }
+
+  var isAtEnd: Bool {
+    index >= bytes.count
+  }
+
+  var peek: UInt8 {
+    bytes[index]
+  }
+
+  mutating func skipWhitespace() {
+    while index < bytes.count && bytes[index].isJSONWhitespace {
+      index += 1
+    }
+  }
 
-      if !inString {
-        if c == "\n" { return }
-        if c == "{" {
-          bracketCounter += 1
-        } else if c == "}" {
-          bracketCounter -= 1
+  /// Steps over the value starting at `index`, returning the range of its bytes.
+  mutating func scanValue() throws -> Range<Int> {
+    let start = index
+    guard !isAtEnd else {
+      throw FBConcatedJsonParserError.unexpectedEnd
+    }
+    switch peek {
+    case .quote:
+      try scanString()
+    case .openBrace, .openBracket:
+      try scanContainer()
+    default:
+      // A number, true, false or null runs until the next delimiter.
+      while index < bytes.count {
+        let byte = bytes[index]
+        if byte.isJSONWhitespace || byte == .comma || byte == .closeBrace || byte == .closeBracket {
+          break
         }
+        index += 1
       }
+      if index == start {
+        throw FBConcatedJsonParserError.unexpectedByte(bytes[start], offset: start)
+      }
+    }
+    return start..<index
+  }
 
-      if c == "\\" {
-        characterEscaped = true
+  /// Steps over the members of the object starting at `index`, calling `body` with each key
+  /// and the range of its value.
+  mutating func scanMembers(_ body: (String, Range<Int>) throws -> Void) throws {
+    try expect(.openBrace)
+    skipWhitespace()
+    if !isAtEnd && peek == .closeBrace {
+      index += 1
+      return
+    }
+    while true {
+      skipWhitespace()
+      guard !isAtEnd else {
+        throw FBConcatedJsonParserError.unexpectedEnd
+      }
+      guard peek == .quote else {
+        throw FBConcatedJsonParserError.unexpectedByte(peek, offset: index)
       }
-      if c == "\"" {
-        inString = !inString
+      let key = try self.key(in: scanValue())
+      try expect(.colon)
+      skipWhitespace()
+      try body(key, scanValue())
+      skipWhitespace()
+      guard !isAtEnd else {
+        throw FBConcatedJsonParserError.unexpectedEnd
       }
+      switch peek {
+      case .comma:
+        index += 1
+      case .closeBrace:
+        index += 1
+        return
+      default:
+        throw FBConcatedJsonParserError.unexpectedByte(peek, offset: index)
+      }
+    }
+  }
 
-      json.append(c)
+  /// Parses the value in `range` of `bytes` where it lies, without copying it.
+  static func parse(_ range: Range<Int>, in bytes: UnsafeBufferPointer<UInt8>) throws -> Any {
+    guard let baseAddress = bytes.baseAddress else {
+      throw FBConcatedJsonParserError.unexpectedEnd
+    }
+    let data = Data(bytesNoCopy: UnsafeMutableRawPointer(mutating: baseAddress + range.lowerBound), count: range.count, deallocator: .none)
+    return try JSONSerialization.jsonObject(with: data, options: [.fragmentsAllowed])
+  }
 
-      if bracketCounter == 0 {
-        do {
-          guard let data = json.data(using: .utf8) else {
-            stop = true
-            return
-          }
-          let parsed = try JSONSerialization.jsonObject(with: data, options: [])
-          guard let dict = parsed as? [String: Any] else {
-            stop = true
-            return
-          }
-          concatenatedJson.merge(dict) { _, new in new }
-        } catch {
-          parseError = error
-          stop = true
-        }
-        json = ""
+  // MARK: Private
+
+  private mutating func expect(_ byte: UInt8) throws {
+    skipWhitespace()
+    guard !isAtEnd else {
+      throw FBConcatedJsonParserError.unexpectedEnd
+    }
+    guard peek == byte else {
+      throw FBConcatedJsonParserError.unexpectedByte(peek, offset: index)
+    }
+    index += 1
+  }
+
+  private mutating func scanString() throws {
+    index += 1
+    while index < bytes.count {
+      switch bytes[index] {
+      case .backslash:
+        index += 2
+      case .quote:
+        index += 1
+        return
+      default:
+        index += 1
       }
     }
+    throw FBConcatedJsonParserError.unexpectedEnd
+  }
 
-    if let error = parseError {
-      throw error
+  private mutating func scanContainer() throws {
+    var depth = 0
+    while index < bytes.count {
+      switch bytes[index] {
+      case .quote:
+        try scanString()
+        continue
+      case .openBrace, .openBracket:
+        depth += 1
+      case .closeBrace, .closeBracket:
+        depth -= 1
+        if depth == 0 {
+          index += 1
+          return
+        }
+      default:
+        break
+      }
+      index += 1
     }
+    throw FBConcatedJsonParserError.unexpectedEnd
+  }
 
-    return concatenatedJson
+  /// The key whose quoted string is in `range`. Only keys with escapes go through `JSONSerialization`.
+  private func key(in range: Range<Int>) throws -> String {
+    let contents = UnsafeBufferPointer(rebasing: bytes[(range.lowerBound + 1)..<(range.upperBound - 1)])
+    if !contents.contains(.backslash) {
+      return String(decoding: contents, as: UTF8.self)
+    }
+    guard let key = try Self.parse(range, in: bytes) as? String else {
+      throw FBConcatedJsonParserError.unexpectedByte(bytes[range.lowerBound], offset: range.lowerBound)
+    }
+    return key
   }
 }
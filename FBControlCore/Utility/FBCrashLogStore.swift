@@ -9,49 +9,95 @@ import Foundation
 
 private let FBCrashLogAppeared = NSNotification.Name("FBCrashLogAppeared")
 
+/// Keeps the crash logs in a set of directories, as `FBCrashLogInfo`s that can be queried.
+///
+/// The store is backed by an `FBCrashLogIndex`, so ingesting the directories again only
+/// reads the crash logs that are new or have changed. Once `startWatching` is called the
+/// store also ingests crash logs as they appear, on directory change notifications where
+/// the platform has them and by polling otherwise. Each newly ingested crash log is
+/// posted to the waiters from `nextCrashLog(forMatchingPredicate:)`.
 public class FBCrashLogStore: NSObject {
 
   // MARK: Properties
 
+  public static let defaultPollInterval: TimeInterval = 2
+
   private let directories: [String]
   private let logger: any FBControlCoreLogger
-  private let ingestedCrashLogs: NSMutableDictionary
   private let queue: DispatchQueue
+  private let lock = NSLock()
+  // Guarded by `lock`.
+  private let index: FBCrashLogIndex
+  private var ingestedCrashLogs: [String: FBCrashLogInfo] = [:]
+  private var prunedCrashLogNames: Set<String> = []
+  private var watchSources: [any DispatchSourceProtocol]?
 
   // MARK: Initializers
 
   public class func store(forDirectories directories: [String], logger: any FBControlCoreLogger) -> Self {
-    return self.init(directories: directories, logger: logger)
+    return self.init(directories: directories, indexPath: FBCrashLogIndex.defaultIndexPath(forDirectories: directories), logger: logger)
+  }
+
+  /// A store whose index is kept at `indexPath`, or only in memory if it is nil.
+  public class func store(forDirectories directories: [String], indexPath: String?, logger: any FBControlCoreLogger) -> Self {
+    return self.init(directories: directories, indexPath: indexPath, logger: logger)
   }
 
-  required init(directories: [String], logger: any FBControlCoreLogger) {
+  required init(directories: [String], indexPath: String?, logger: any FBControlCoreLogger) {
     self.directories = directories
     self.logger = logger
-    self.ingestedCrashLogs = NSMutableDictionary()
+    self.index = FBCrashLogIndex(directories: directories, indexPath: indexPath, logger: logger)
     self.queue = DispatchQueue(label: "com.facebook.fbcontrolcore.crash_store")
     super.init()
   }
 
+  deinit {
+    watchSources?.forEach { $0.cancel() }
+  }
+
   // MARK: Ingestion
 
+  /// Brings the store up to date with the directories, returning the crash logs that
+  /// were not ingested before. Crash logs whose files have gone are dropped.
   @discardableResult public func ingestAllExistingInDirectory() -> [FBCrashLogInfo] {
-    var ingested: [FBCrashLogInfo] = []
-    for directory in directories {
-      let crashLogs = ingestCrashLogInDirectory(directory)
-      ingested.append(contentsOf: crashLogs)
+    let ingested: [FBCrashLogInfo] = lock.withLock {
+      let (added, removed) = index.update()
+      for crashLog in removed where ingestedCrashLogs[crashLog.name]?.crashPath == crashLog.crashPath {
+        ingestedCrashLogs.removeValue(forKey: crashLog.name)
+      }
+      // A crash log rewritten in place replaces the one ingested from it.
+      for crashLog in added where ingestedCrashLogs[crashLog.name]?.crashPath == crashLog.crashPath {
+        ingestedCrashLogs[crashLog.name] = crashLog
+      }
+      var ingested: [FBCrashLogInfo] = []
+      for crashLog in index.allInfos where ingestedCrashLogs[crashLog.name] == nil && !prunedCrashLogNames.contains(crashLog.name) {
+        ingestedCrashLogs[crashLog.name] = crashLog
+        ingested.append(crashLog)
+      }
+      return ingested
     }
+    ingested.forEach(notifyOfIngestion)
     return ingested
   }
 
   public func ingestCrashLog(atPath path: String) -> FBCrashLogInfo? {
-    if hasIngestedCrashLog(withName: (path as NSString).lastPathComponent) {
-      return nil
+    let crashLog: FBCrashLogInfo? = lock.withLock {
+      let name = (path as NSString).lastPathComponent
+      if ingestedCrashLogs[name] != nil {
+        return nil
+      }
+      guard let crashLog = index.update(path: path) else {
+        logger.log("Could not obtain crash info for \(path)")
+        return nil
+      }
+      ingestedCrashLogs[name] = crashLog
+      prunedCrashLogNames.remove(name)
+      return crashLog
     }
-    guard let crashLog = try? FBCrashLogInfo.fromCrashLog(atPath: path) else {
-      logger.log("Could not obtain crash info for \(path)")
-      return nil
+    if let crashLog {
+      notifyOfIngestion(crashLog)
     }
-    return ingestCrashLog(crashLog)
+    return crashLog
   }
 
   public func ingestCrashLogData(_ data: Data, name: String) -> FBCrashLogInfo? {
@@ -78,54 +124,125 @@ public class FBCrashLogStore: NSObject {
 
   public func removeCrashLog(atPath path: String) -> FBCrashLogInfo? {
     let key = (path as NSString).lastPathComponent
-    guard let crashLog = ingestedCrashLog(withName: key) else {
-      return nil
+    return lock.withLock {
+      ingestedCrashLogs.removeValue(forKey: key)
     }
-    ingestedCrashLogs.removeObject(forKey: key)
-    return crashLog
+  }
+
+  // MARK: Watching
+
+  /// Starts ingesting crash logs as they appear in the directories, after ingesting
+  /// those already there. Directory change notifications are used where available;
+  /// the directories are also polled every `pollInterval`, which catches directories
+  /// created later and platforms without notifications. Calling it again does nothing.
+  public func startWatching(pollInterval: TimeInterval = FBCrashLogStore.defaultPollInterval) {
+    let alreadyWatching: Bool = lock.withLock {
+      if watchSources != nil {
+        return true
+      }
+      watchSources = []
+      return false
+    }
+    if alreadyWatching {
+      return
+    }
+    ingestAllExistingInDirectory()
+
+    var sources: [any DispatchSourceProtocol] = []
+    #if canImport(Darwin)
+    for directory in directories {
+      let fileDescriptor = open(directory, O_EVTONLY)
+      guard fileDescriptor >= 0 else {
+        continue
+      }
+      let source = DispatchSource.makeFileSystemObjectSource(fileDescriptor: fileDescriptor, eventMask: [.write, .rename, .delete], queue: queue)
+      source.setEventHandler { [weak self] in
+        self?.ingestAllExistingInDirectory()
+      }
+      source.setCancelHandler {
+        close(fileDescriptor)
+      }
+      source.resume()
+      sources.append(source)
+    }
+    #endif
+    let timer = DispatchSource.makeTimerSource(queue: queue)
+    timer.schedule(deadline: .now() + pollInterval, repeating: pollInterval)
+    timer.setEventHandler { [weak self] in
+      self?.ingestAllExistingInDirectory()
+    }
+    timer.resume()
+    sources.append(timer)
+    lock.withLock {
+      watchSources = sources
+    }
+  }
+
+  /// Whether `startWatching` has been called without a `stopWatching` since.
+  public var isWatching: Bool {
+    lock.withLock { watchSources != nil }
+  }
+
+  public func stopWatching() {
+    let sources = lock.withLock {
+      defer { watchSources = nil }
+      return watchSources ?? []
+    }
+    sources.forEach { $0.cancel() }
   }
 
   // MARK: Fetching
 
   public func ingestedCrashLog(withName name: String) -> FBCrashLogInfo? {
-    return ingestedCrashLogs[name] as? FBCrashLogInfo
+    return lock.withLock { ingestedCrashLogs[name] }
   }
 
   public func allIngestedCrashLogs() -> [FBCrashLogInfo] {
-    return ingestedCrashLogs.allValues.compactMap { $0 as? FBCrashLogInfo }
+    return lock.withLock { Array(ingestedCrashLogs.values) }
+  }
+
+  /// When the file of an ingested crash log was last modified, as of its ingestion.
+  public func modificationDate(ofCrashLog crashLog: FBCrashLogInfo) -> Date? {
+    return lock.withLock { index.modificationDate(atPath: crashLog.crashPath) }
   }
 
   public func nextCrashLog(forMatchingPredicate predicate: NSPredicate) -> FBFuture<FBCrashLogInfo> {
+    nextCrashLog(forMatchingPredicate: predicate, includingIngested: false)
+  }
+
+  /// The next crash log ingested that matches `predicate`. With `includingIngested`, a
+  /// matching crash log that has already been ingested resolves it straight away.
+  public func nextCrashLog(forMatchingPredicate predicate: NSPredicate, includingIngested: Bool) -> FBFuture<FBCrashLogInfo> {
     fbFutureFromAsync { [self] in
-      try await nextCrashLogAsync(forMatchingPredicate: predicate)
+      try await nextCrashLogAsync(forMatchingPredicate: predicate, includingIngested: includingIngested)
     }
   }
 
   // MARK: - Async
 
-  fileprivate func nextCrashLogAsync(forMatchingPredicate predicate: NSPredicate) async throws -> FBCrashLogInfo {
-    let holder = ObserverHolder()
+  fileprivate func nextCrashLogAsync(forMatchingPredicate predicate: NSPredicate, includingIngested: Bool) async throws -> FBCrashLogInfo {
+    let waiter = CrashLogWaiter()
     nonisolated(unsafe) let predicateRef = predicate
     let box = try await withTaskCancellationHandler {
       try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<CrashLogResultBox, Error>) in
-        holder.observer = NotificationCenter.default.addObserver(
-          forName: FBCrashLogAppeared,
-          object: nil,
-          queue: .main
-        ) { notification in
-          guard let crashLog = notification.object as? FBCrashLogInfo else { return }
-          if !predicateRef.evaluate(with: crashLog) { return }
-          if let obs = holder.observer {
-            NotificationCenter.default.removeObserver(obs)
-            holder.observer = nil
-          }
-          continuation.resume(returning: CrashLogResultBox(crashLog))
+        waiter.wait(continuation)
+        waiter.observe(
+          NotificationCenter.default.addObserver(
+            forName: FBCrashLogAppeared,
+            object: nil,
+            queue: .main
+          ) { notification in
+            guard let crashLog = notification.object as? FBCrashLogInfo else { return }
+            if !predicateRef.evaluate(with: crashLog) { return }
+            waiter.finish(.success(CrashLogResultBox(crashLog)))
+          })
+        // Looked for after observing, so one ingested in between is not missed.
+        if includingIngested, let crashLog = ingestedCrashLogs(matchingPredicate: predicateRef).first {
+          waiter.finish(.success(CrashLogResultBox(crashLog)))
         }
       }
     } onCancel: {
-      if let obs = holder.observer {
-        NotificationCenter.default.removeObserver(obs)
-      }
+      waiter.finish(.failure(CancellationError()))
     }
     return box.value
   }
@@ -134,52 +251,83 @@ public class FBCrashLogStore: NSObject {
     return allIngestedCrashLogs().filter(predicate.evaluate(with:))
   }
 
+  /// Removes the matching crash logs from the store. They stay out of it when the
+  /// directories are ingested again, unless they are explicitly ingested.
   public func pruneCrashLogs(matchingPredicate predicate: NSPredicate) -> [FBCrashLogInfo] {
-    var keys: [String] = []
-    var crashLogs: [FBCrashLogInfo] = []
-    for crashLog in allIngestedCrashLogs() {
-      if !predicate.evaluate(with: crashLog) {
-        continue
+    let crashLogs = ingestedCrashLogs(matchingPredicate: predicate)
+    lock.withLock {
+      for crashLog in crashLogs {
+        ingestedCrashLogs.removeValue(forKey: crashLog.name)
+        prunedCrashLogNames.insert(crashLog.name)
       }
-      keys.append(crashLog.name)
-      crashLogs.append(crashLog)
     }
-    ingestedCrashLogs.removeObjects(forKeys: keys)
     return crashLogs
   }
 
   // MARK: Private
 
   private func hasIngestedCrashLog(withName key: String) -> Bool {
-    return ingestedCrashLogs[key] != nil
+    return ingestedCrashLog(withName: key) != nil
   }
 
-  private func ingestCrashLog(_ crashLog: FBCrashLogInfo) -> FBCrashLogInfo {
+  private func notifyOfIngestion(_ crashLog: FBCrashLogInfo) {
     logger.log("Ingesting Crash Log \(crashLog)")
-    ingestedCrashLogs[crashLog.name] = crashLog
     NotificationCenter.default.post(name: FBCrashLogAppeared, object: crashLog)
-    return crashLog
   }
 
-  private class ObserverHolder: @unchecked Sendable {
-    var observer: NSObjectProtocol?
-  }
+  /// Resumes a crash log wait exactly once, whichever of a matching notification, an
+  /// already ingested crash log or cancellation comes first, and stops observing.
+  private final class CrashLogWaiter: @unchecked Sendable {
+    private let lock = NSLock()
+    private var continuation: CheckedContinuation<CrashLogResultBox, Error>?
+    private var observer: NSObjectProtocol?
+    private var result: Result<CrashLogResultBox, Error>?
 
-  private final class CrashLogResultBox: @unchecked Sendable {
-    let value: FBCrashLogInfo
-    init(_ value: FBCrashLogInfo) { self.value = value }
-  }
+    func wait(_ continuation: CheckedContinuation<CrashLogResultBox, Error>) {
+      let result: Result<CrashLogResultBox, Error>? = lock.withLock {
+        if self.result == nil {
+          self.continuation = continuation
+        }
+        return self.result
+      }
+      if let result {
+        continuation.resume(with: result)
+      }
+    }
 
-  private func ingestCrashLogInDirectory(_ directory: String) -> [FBCrashLogInfo] {
-    guard let contents = try? FileManager.default.contentsOfDirectory(atPath: directory) else {
-      return []
+    func observe(_ observer: NSObjectProtocol) {
+      let finished: Bool = lock.withLock {
+        if result == nil {
+          self.observer = observer
+        }
+        return result != nil
+      }
+      if finished {
+        NotificationCenter.default.removeObserver(observer)
+      }
     }
-    var ingested: [FBCrashLogInfo] = []
-    for path in contents {
-      if let crash = ingestCrashLog(atPath: (directory as NSString).appendingPathComponent(path)) {
-        ingested.append(crash)
+
+    func finish(_ result: Result<CrashLogResultBox, Error>) {
+      let (continuation, observer): (CheckedContinuation<CrashLogResultBox, Error>?, NSObjectProtocol?) = lock.withLock {
+        guard self.result == nil else {
+          return (nil, nil)
+        }
+        self.result = result
+        defer {
+          self.continuation = nil
+          self.observer = nil
+        }
+        return (self.continuation, self.observer)
+      }
+      if let observer {
+        NotificationCenter.default.removeObserver(observer)
       }
+      continuation?.resume(with: result)
     }
-    return ingested
+  }
+
+  private final class CrashLogResultBox: @unchecked Sendable {
+    let value: FBCrashLogInfo
+    init(_ value: FBCrashLogInfo) { self.value = value }
   }
 }
@@ -30,6 +30,7 @@
 /**
  A data buffer that is only mutated through consuming data.
  Has a capacity set, if the capacity is reached, the bytes will be dropped from the beginning of the buffer.
+ The capacity is allocated up-front as a ring, so writing to a full buffer does not move the bytes that are retained.
 
  @param capacity the capacity in bytes of the buffer.
  @return a FBDataBuffer implementation.
@@ -9,10 +9,12 @@
 
 #import "FBControlCore-SwiftImport.h"
 
+#import <os/lock.h>
+#import <string.h>
+
 @interface FBDataBuffer_Accumilating : NSObject <FBDataConsumer, FBAccumulatingBuffer>
 
 @property (nonatomic, readwrite, strong) NSMutableData *buffer;
-@property (nonatomic, readonly, assign) size_t capacity;
 @property (nonatomic, readonly, strong) FBMutableFuture<NSNull *> *finishedConsumingFuture;
 
 @end
@@ -23,10 +25,10 @@
 
 - (instancetype)init
 {
-  return [self initWithBackingBuffer:NSMutableData.new capacity:0];
+  return [self initWithBackingBuffer:NSMutableData.new];
 }
 
-- (instancetype)initWithBackingBuffer:(NSMutableData *)buffer capacity:(size_t)capacity
+- (instancetype)initWithBackingBuffer:(NSMutableData *)buffer
 {
   self = [super init];
   if (!self) {
@@ -34,7 +36,6 @@
   }
 
   _buffer = buffer;
-  _capacity = capacity;
   _finishedConsumingFuture = FBMutableFuture.future;
 
   return self;
@@ -73,12 +74,6 @@
       return;
     }
     [self.buffer appendData:data];
-    if (self.capacity > 0) {
-      NSInteger overrun = (NSInteger) self.buffer.length - (NSInteger) self.capacity;
-      if (overrun > 0) {
-        [self.buffer replaceBytesInRange:NSMakeRange(0, (NSUInteger) overrun) withBytes:NULL length:0];
-      }
-    }
   }
 }
 
@@ -101,6 +96,164 @@
 
 @end
 
+/**
+ A fixed-capacity accumulating buffer that keeps the most recent bytes.
+ The storage is allocated once, and a write is at most two copies into it, however full the buffer is, so the retained bytes are never moved to make room.
+ As there is no re-entrancy, an unfair lock guards the storage rather than @synchronized.
+ */
+@interface FBDataBuffer_Ring : NSObject <FBDataConsumer, FBAccumulatingBuffer>
+
+@property (nonatomic, readonly, assign) size_t capacity;
+@property (nonatomic, readonly, strong) FBMutableFuture<NSNull *> *finishedConsumingFuture;
+
+@end
+
+@implementation FBDataBuffer_Ring
+{
+  os_unfair_lock _lock;
+  uint8_t *_bytes;
+  size_t _start;
+  size_t _length;
+  BOOL _finished;
+}
+
+#pragma mark Initializers
+
+- (instancetype)initWithCapacity:(size_t)capacity
+{
+  self = [super init];
+  if (!self) {
+    return nil;
+  }
+
+  _capacity = capacity;
+  _finishedConsumingFuture = FBMutableFuture.future;
+  _lock = OS_UNFAIR_LOCK_INIT;
+  _bytes = malloc(capacity);
+
+  return self;
+}
+
+- (void)dealloc
+{
+  free(_bytes);
+}
+
+#pragma mark NSObject
+
+- (NSString *)description
+{
+  os_unfair_lock_lock(&_lock);
+  size_t length = _length;
+  os_unfair_lock_unlock(&_lock);
+  return [NSString stringWithFormat:@"Ring Buffer %zu of %zu Bytes", length, self.capacity];
+}
+
+#pragma mark FBAccumilatingLineBuffer
+
+- (NSData *)data
+{
+  os_unfair_lock_lock(&_lock);
+  if (_finished) {
+    // Nothing is written after the end of file, so the bytes are lent out rather than copied.
+    // They are made contiguous once, and each view keeps the ring, and so the storage, alive.
+    [self makeContiguous];
+    FBDataBuffer_Ring *ring = self;
+    NSData *view = [[NSData alloc] initWithBytesNoCopy:_bytes + _start length:_length deallocator:^(void *bytes, NSUInteger length) {
+      (void) ring;
+    }];
+    os_unfair_lock_unlock(&_lock);
+    return view;
+  }
+  NSMutableData *data = [NSMutableData dataWithLength:_length];
+  size_t head = MIN(_length, _capacity - _start);
+  memcpy(data.mutableBytes, _bytes + _start, head);
+  memcpy((uint8_t *) data.mutableBytes + head, _bytes, _length - head);
+  os_unfair_lock_unlock(&_lock);
+  return data;
+}
+
+- (NSArray<NSString *> *)lines
+{
+  NSString *output = [[NSString alloc] initWithData:self.data encoding:NSUTF8StringEncoding];
+  return [output componentsSeparatedByCharactersInSet:NSCharacterSet.newlineCharacterSet];
+}
+
+#pragma mark FBDataConsumer
+
+- (void)consumeData:(NSData *)data
+{
+  os_unfair_lock_lock(&_lock);
+  if (_finished) {
+    os_unfair_lock_unlock(&_lock);
+    return;
+  }
+  [data enumerateByteRangesUsingBlock:^(const void *bytes, NSRange byteRange, BOOL *stop) {
+    [self appendBytes:bytes length:byteRange.length];
+  }];
+  os_unfair_lock_unlock(&_lock);
+}
+
+- (void)consumeEndOfFile
+{
+  os_unfair_lock_lock(&_lock);
+  BOOL alreadyFinished = _finished;
+  _finished = YES;
+  os_unfair_lock_unlock(&_lock);
+  if (alreadyFinished) {
+    return;
+  }
+  [self.finishedConsumingFuture resolveWithResult:NSNull.null];
+}
+
+#pragma mark FBDataConsumerLifecycle
+
+- (FBFuture<NSNull *> *)finishedConsuming
+{
+  return self.finishedConsumingFuture;
+}
+
+#pragma mark Private
+
+- (void)makeContiguous
+{
+  if (_start + _length <= _capacity) {
+    return;
+  }
+  uint8_t *bytes = malloc(_capacity);
+  size_t head = _capacity - _start;
+  memcpy(bytes, _bytes + _start, head);
+  memcpy(bytes + head, _bytes, _length - head);
+  free(_bytes);
+  _bytes = bytes;
+  _start = 0;
+}
+
+- (void)appendBytes:(const uint8_t *)bytes length:(size_t)length
+{
+  // Of a write at least as large as the buffer, only the tail survives, so the rest is never copied.
+  if (length >= _capacity) {
+    memcpy(_bytes, bytes + (length - _capacity), _capacity);
+    _start = 0;
+    _length = _capacity;
+    return;
+  }
+  // Write after the newest byte, wrapping around over the oldest ones if need be.
+  size_t end = (_start + _length) % _capacity;
+  size_t first = MIN(length, _capacity - end);
+  memcpy(_bytes + end, bytes, first);
+  memcpy(_bytes, bytes + first, length - first);
+  size_t total = _length + length;
+  if (total > _capacity) {
+    _start = (_start + (total - _capacity)) % _capacity;
+    _length = _capacity;
+  } else {
+    _length = total;
+  }
+}
+
+@end
+
 @interface FBDataBuffer_Terminal_Forwarder : NSObject <FBDataBuffer_Forwarder>
 
 @property (nonatomic, readonly, copy) NSData *terminal;
@@ -204,7 +357,17 @@
 
 @end
 
+/**
+ Consumed bytes are not removed from the front of the backing buffer as they are consumed, which would move everything after them each time.
+ Instead a read offset is advanced, and the consumed prefix is only dropped once it is at least as large as the unconsumed remainder, so each byte is moved a bounded number of times.
+ Searching for a terminal picks up where a previous unsuccessful search for the same terminal finished, so a line arriving in many chunks is only scanned once.
+ */
 @implementation FBDataBuffer_Consumable
+{
+  NSUInteger _readOffset;
+  NSData *_scannedTerminal;
+  NSUInteger _scannedLength;
+}
 
 #pragma mark Initializers
 
@@ -229,13 +392,25 @@
   }
 }
 
+#pragma mark FBAccumilatingLineBuffer
+
+- (NSData *)data
+{
+  @synchronized(self) {
+    return [self.buffer subdataWithRange:NSMakeRange(_readOffset, self.buffer.length - _readOffset)];
+  }
+}
+
 #pragma mark FBConsumableBuffer
 
 - (nonnull NSData *)consumeCurrentData
 {
   @synchronized(self) {
     NSData *data = self.data;
-    self.buffer.data = NSData.data;
+    self.buffer.length = 0;
+    _readOffset = 0;
+    _scannedTerminal = nil;
+    _scannedLength = 0;
     return data;
   }
 }
@@ -249,15 +424,11 @@
 - (nullable NSData *)consumeLength:(NSUInteger)length
 {
   @synchronized(self) {
-    if (length > self.buffer.length) {
-      return nil;
-    }
-    NSRange range = NSMakeRange(0, length);
-    NSData *data = [self.buffer subdataWithRange:range];
-    if (!data) {
+    if (length > self.buffer.length - _readOffset) {
       return nil;
     }
-    [self.buffer replaceBytesInRange:range withBytes:"" length:0];
+    NSData *data = [self.buffer subdataWithRange:NSMakeRange(_readOffset, length)];
+    [self advanceReadOffset:length];
     return data;
   }
 }
@@ -265,15 +436,12 @@
 - (nullable NSData *)consumeUntil:(NSData *)terminal
 {
   @synchronized(self) {
-    if (self.buffer.length == 0) {
-      return nil;
-    }
-    NSRange terminalRange = [self.buffer rangeOfData:terminal options:0 range:NSMakeRange(0, self.buffer.length)];
-    if (terminalRange.location == NSNotFound) {
+    NSUInteger location = [self locationOfTerminal:terminal];
+    if (location == NSNotFound) {
       return nil;
     }
-    NSData *data = [self.buffer subdataWithRange:NSMakeRange(0, terminalRange.location)];
-    [self.buffer replaceBytesInRange:NSMakeRange(0, terminalRange.location + terminal.length) withBytes:"" length:0];
+    NSData *data = [self.buffer subdataWithRange:NSMakeRange(_readOffset, location)];
+    [self advanceReadOffset:location + terminal.length];
     return data;
   }
 }
@@ -367,6 +535,44 @@
   return [self consume:consumer onQueue:nil untilTerminal:terminal error:error];
 }
 
+- (NSUInteger)locationOfTerminal:(NSData *)terminal
+{
+  NSUInteger terminalLength = terminal.length;
+  NSUInteger available = self.buffer.length - _readOffset;
+  if (terminalLength == 0 || available < terminalLength) {
+    return NSNotFound;
+  }
+  const uint8_t *bytes = (const uint8_t *) self.buffer.bytes + _readOffset;
+  NSUInteger scanned = [terminal isEqualToData:_scannedTerminal] ? _scannedLength : 0;
+  const uint8_t *found = NULL;
+  if (terminalLength == 1) {
+    found = memchr(bytes + scanned, *(const uint8_t *) terminal.bytes, available - scanned);
+  } else {
+    found = memmem(bytes + scanned, available - scanned, terminal.bytes, terminalLength);
+  }
+  if (!found) {
+    // The last bytes may yet be the start of a terminal completed by the next write.
+    _scannedTerminal = [terminal copy];
+    _scannedLength = available - (terminalLength - 1);
+    return NSNotFound;
+  }
+  return (NSUInteger) (found - bytes);
+}
+
+- (void)advanceReadOffset:(NSUInteger)length
+{
+  _readOffset += length;
+  _scannedLength = _scannedLength > length ? _scannedLength - length : 0;
+  NSUInteger remaining = self.buffer.length - _readOffset;
+  if (remaining == 0) {
+    self.buffer.length = 0;
+    _readOffset = 0;
+  } else if (_readOffset >= remaining) {
+    [self.buffer replaceBytesInRange:NSMakeRange(0, _readOffset) withBytes:NULL length:0];
+    _readOffset = 0;
+  }
+}
+
 @end
 
 @implementation FBDataBuffer
@@ -381,12 +587,12 @@
 + (id<FBAccumulatingBuffer>)accumulatingBufferWithCapacity:(size_t)capacity
 {
   NSParameterAssert(capacity > 0);
-  return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:NSMutableData.data capacity:capacity];
+  return [[FBDataBuffer_Ring alloc] initWithCapacity:capacity];
 }
 
 + (id<FBAccumulatingBuffer>)accumulatingBufferForMutableData:(NSMutableData *)data
 {
-  return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:data capacity:0];
+  return [[FBDataBuffer_Accumilating alloc] initWithBackingBuffer:data];
 }
 
 + (id<FBConsumableBuffer>)consumableBuffer
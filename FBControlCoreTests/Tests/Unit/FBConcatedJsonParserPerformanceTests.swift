@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import FBControlCore
+import XCTest
+
+/// Measures parsing .ips reports of the sizes seen in practice, where the thread section of a
+/// process with many threads runs to megabytes. The corpus is grown from the .ips fixture by
+/// repeating its threads, so it has the layout and formatting of a real report.
+final class FBConcatedJsonParserPerformanceTests: XCTestCase {
+
+  private static let corpusSizes = [16 * 1024, 256 * 1024, 1024 * 1024, 8 * 1024 * 1024]
+
+  func testParseCorpus() throws {
+    let corpus = try Self.corpusSizes.map(Self.report(approximateSize:))
+    measure {
+      for report in corpus {
+        XCTAssertEqual(try? FBConcatedJsonParser.parseConcatenatedJSON(from: report)["procName"] as? String, "xctest3")
+      }
+    }
+  }
+
+  func testParseCorpusHeaderOnly() throws {
+    let corpus = try Self.corpusSizes.map(Self.report(approximateSize:))
+    measure {
+      for report in corpus {
+        let parsed = try? FBConcatedJsonParser.parseConcatenatedJSON(from: report, skippingKeys: ["threads", "usedImages"])
+        XCTAssertEqual(parsed?["procName"] as? String, "xctest3")
+      }
+    }
+  }
+
+  func testCrashLogInfoFromLargeReport() throws {
+    let path = (NSTemporaryDirectory() as NSString).appendingPathComponent("FBConcatedJsonParserPerformanceTests_\(UUID().uuidString).ips")
+    try Self.report(approximateSize: 8 * 1024 * 1024).write(to: URL(fileURLWithPath: path))
+    defer { try? FileManager.default.removeItem(atPath: path) }
+    measure {
+      XCTAssertEqual(try? FBCrashLogInfo.fromCrashLog(atPath: path).processName, "xctest3")
+    }
+  }
+
+  // MARK: - Helpers
+
+  /// The .ips fixture with its threads repeated until the report is about `approximateSize` bytes.
+  private static func report(approximateSize: Int) throws -> Data {
+    let fixture = try Data(contentsOf: URL(fileURLWithPath: TestFixtures.appCrashWithJSONFormat))
+    guard let newline = fixture.firstIndex(of: UInt8(ascii: "\n")),
+      var body = try JSONSerialization.jsonObject(with: fixture[(newline + 1)...]) as? [String: Any],
+      let threads = body["threads"] as? [Any]
+    else {
+      throw NSError(domain: "Fixture is not a two part .ips report", code: 0)
+    }
+    let threadsSize = try JSONSerialization.data(withJSONObject: threads, options: [.prettyPrinted]).count
+    let repeats = max(1, (approximateSize - fixture.count) / max(threadsSize, 1) + 1)
+    body["threads"] = Array(repeating: threads, count: repeats).flatMap { $0 }
+
+    var report = Data(fixture[...newline])
+    report.append(try JSONSerialization.data(withJSONObject: body, options: [.prettyPrinted]))
+    return report
+  }
+}
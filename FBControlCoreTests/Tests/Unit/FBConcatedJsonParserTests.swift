@@ -52,6 +52,47 @@ class FBConcatedJsonParserTests: XCTestCase {
     XCTAssertThrowsError(try parse(string: json))
   }
 
+  func testThrowsTruncatedJson() throws {
+    let json = """
+      {"hello": "world"}
+      {"second": ["value"
+      """
+    XCTAssertThrowsError(try parse(string: json))
+    XCTAssertThrowsError(try FBConcatedJsonParser.parseConcatenatedJSON(from: Data(json.utf8), skippingKeys: ["hello"]))
+  }
+
+  func testSkippingKeysLeavesOutTheirValues() throws {
+    let json = """
+      {"hello": "world", "threads": [{"frames": [{"symbol": "}{"}]}, "x{"], "count": 2}
+      {"second": {"nested": [1, true, null]}, "usedImages": {}}
+      """
+    let parsed = try FBConcatedJsonParser.parseConcatenatedJSON(from: Data(json.utf8), skippingKeys: ["threads", "usedImages"])
+    XCTAssertEqual(Set(parsed.keys), ["hello", "count", "second"])
+    XCTAssertEqual(parsed["hello"] as? String, "world")
+    XCTAssertEqual(parsed["count"] as? Int, 2)
+    XCTAssertEqual((parsed["second"] as? [String: Any])?["nested"] as? [NSObject], [1 as NSNumber, true as NSNumber, NSNull()])
+  }
+
+  func testMultiByteAndEscapedKeys() throws {
+    let json = #"""
+      {"h\u00e9llo": "w\u00f6rld 🎉", "ключ": "значение"}
+      """#
+    for skippingKeys: Set<String> in [[], ["unused"]] {
+      let parsed = try FBConcatedJsonParser.parseConcatenatedJSON(from: Data(json.utf8), skippingKeys: skippingKeys)
+      XCTAssertEqual(parsed["héllo"] as? String, "wörld 🎉")
+      XCTAssertEqual(parsed["ключ"] as? String, "значение")
+    }
+  }
+
+  func testSkippingKeysMatchesFullParseOfReport() throws {
+    let data = try Data(contentsOf: URL(fileURLWithPath: TestFixtures.appCrashWithJSONFormat))
+    let full = try FBConcatedJsonParser.parseConcatenatedJSON(from: data)
+    let header = try FBConcatedJsonParser.parseConcatenatedJSON(from: data, skippingKeys: ["threads", "usedImages"])
+    XCTAssertNotNil(full["threads"])
+    XCTAssertEqual(Set(full.keys).subtracting(header.keys), ["threads", "usedImages"])
+    XCTAssertEqual(NSDictionary(dictionary: header), NSDictionary(dictionary: full.filter { header[$0.key] != nil }))
+  }
+
   private func parse(string: String) throws -> [String: String] {
     guard let json = try FBConcatedJsonParser.parseConcatenatedJSON(from: string) as? [String: String] else {
       throw NSError(domain: "Json parsed with incorrect type", code: 0)
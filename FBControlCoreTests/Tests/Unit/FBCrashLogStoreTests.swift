@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import FBControlCore
+import XCTest
+
+final class FBCrashLogStoreTests: XCTestCase {
+
+  private var directory: String!
+  private var indexPath: String!
+
+  override func setUpWithError() throws {
+    try super.setUpWithError()
+    let base = (NSTemporaryDirectory() as NSString).appendingPathComponent("FBCrashLogStoreTests_\(UUID().uuidString)")
+    directory = (base as NSString).appendingPathComponent("DiagnosticReports")
+    indexPath = (base as NSString).appendingPathComponent("index.json")
+    try FileManager.default.createDirectory(atPath: directory, withIntermediateDirectories: true, attributes: nil)
+  }
+
+  override func tearDownWithError() throws {
+    try? FileManager.default.removeItem(atPath: (directory as NSString).deletingLastPathComponent)
+    try super.tearDownWithError()
+  }
+
+  // MARK: - Ingestion
+
+  func testIngestsOnlyCrashLogsNotIngestedBefore() throws {
+    let store = makeStore()
+    try addCrashLog(named: "first.crash")
+    XCTAssertEqual(store.ingestAllExistingInDirectory().map(\.name), ["first.crash"])
+
+    try addCrashLog(named: "second.crash")
+    XCTAssertEqual(store.ingestAllExistingInDirectory().map(\.name), ["second.crash"])
+    XCTAssertEqual(store.ingestAllExistingInDirectory(), [])
+    XCTAssertEqual(Set(store.allIngestedCrashLogs().map(\.name)), ["first.crash", "second.crash"])
+  }
+
+  func testPersistedIndexAnswersWithoutReadingCrashLogs() throws {
+    try addCrashLog(named: "first.crash")
+    XCTAssertEqual(makeStore().ingestAllExistingInDirectory().count, 1)
+
+    // Unchanged files are only stat-ed, so an unreadable one is answered from the index.
+    let path = (directory as NSString).appendingPathComponent("first.crash")
+    try FileManager.default.setAttributes([.posixPermissions: 0], ofItemAtPath: path)
+    defer { try? FileManager.default.setAttributes([.posixPermissions: 0o644], ofItemAtPath: path) }
+
+    let ingested = makeStore().ingestAllExistingInDirectory()
+    XCTAssertEqual(ingested.map(\.name), ["first.crash"])
+    XCTAssertEqual(ingested.first?.identifier, "TableSearch")
+    XCTAssertEqual(ingested.first?.processIdentifier, 37083)
+    XCTAssertEqual(ingested.first?.processType, .application)
+  }
+
+  func testStoresSharingAnIndexKeepEachOthersEntries() throws {
+    let otherDirectory = ((directory as NSString).deletingLastPathComponent as NSString).appendingPathComponent("OtherReports")
+    try FileManager.default.createDirectory(atPath: otherDirectory, withIntermediateDirectories: true, attributes: nil)
+    // Both load the index before either saves, as two companions started together would.
+    let store = makeStore()
+    let otherStore = FBCrashLogStore.store(forDirectories: [otherDirectory], indexPath: indexPath, logger: FBControlCoreLoggerDouble())
+    try addCrashLog(named: "first.crash")
+    XCTAssertEqual(store.ingestAllExistingInDirectory().count, 1)
+    let data = try Data(contentsOf: URL(fileURLWithPath: TestFixtures.appCrashPathWithDefaultDeviceSet))
+    try data.write(to: URL(fileURLWithPath: (otherDirectory as NSString).appendingPathComponent("second.crash")))
+    XCTAssertEqual(otherStore.ingestAllExistingInDirectory().count, 1)
+
+    // The first store's entry survived the second's save, so it is answered from the index.
+    let path = (directory as NSString).appendingPathComponent("first.crash")
+    try FileManager.default.setAttributes([.posixPermissions: 0], ofItemAtPath: path)
+    defer { try? FileManager.default.setAttributes([.posixPermissions: 0o644], ofItemAtPath: path) }
+    XCTAssertEqual(makeStore().ingestAllExistingInDirectory().map(\.name), ["first.crash"])
+  }
+
+  func testUnparsableFilesAreIndexedButNotIngested() throws {
+    let store = makeStore()
+    try Data("not a crash log".utf8).write(to: URL(fileURLWithPath: (directory as NSString).appendingPathComponent("garbage.crash")))
+    XCTAssertEqual(store.ingestAllExistingInDirectory(), [])
+    XCTAssertEqual(makeStore().ingestAllExistingInDirectory(), [])
+  }
+
+  func testRemovedCrashLogsAreDropped() throws {
+    let store = makeStore()
+    try addCrashLog(named: "first.crash")
+    store.ingestAllExistingInDirectory()
+    try FileManager.default.removeItem(atPath: (directory as NSString).appendingPathComponent("first.crash"))
+    store.ingestAllExistingInDirectory()
+    XCTAssertEqual(store.allIngestedCrashLogs(), [])
+  }
+
+  func testPrunedCrashLogsStayPruned() throws {
+    let store = makeStore()
+    try addCrashLog(named: "first.crash")
+    try addCrashLog(named: "second.crash")
+    store.ingestAllExistingInDirectory()
+
+    let pruned = store.pruneCrashLogs(matchingPredicate: FBCrashLogInfo.predicate(forName: "first.crash"))
+    XCTAssertEqual(pruned.map(\.name), ["first.crash"])
+    store.ingestAllExistingInDirectory()
+    XCTAssertEqual(store.allIngestedCrashLogs().map(\.name), ["second.crash"])
+  }
+
+  // MARK: - Watching
+
+  func testWatchingIngestsNewCrashLogs() throws {
+    let store = makeStore()
+    store.startWatching(pollInterval: 0.1)
+    defer { store.stopWatching() }
+
+    let future = store.nextCrashLog(forMatchingPredicate: FBCrashLogInfo.predicate(forName: "new.crash"))
+    try addCrashLog(named: "other.crash")
+    try addCrashLog(named: "new.crash")
+
+    let crashLog = try future.`await`(withTimeout: 5)
+    XCTAssertEqual(crashLog.name, "new.crash")
+    XCTAssertNotNil(store.ingestedCrashLog(withName: "other.crash"))
+  }
+
+  func testNotifierOnlyResolvesWithCrashLogsWrittenAfterTheCall() throws {
+    try addCrashLog(named: "old.crash")
+    let notifier = FBCrashLogNotifier(store: makeStore())
+    defer { notifier.store.stopWatching() }
+
+    // Modification dates can be coarse, so make sure the new one is written later.
+    Thread.sleep(forTimeInterval: 1.1)
+    let future = notifier.nextCrashLog(forPredicate: FBCrashLogInfo.predicate(forIdentifier: "TableSearch"))
+    try addCrashLog(named: "new.crash")
+
+    let crashLog = try future.`await`(withTimeout: 5)
+    XCTAssertEqual(crashLog.name, "new.crash")
+  }
+
+  func testNotifierStopsWatchingOnceNothingIsWaiting() throws {
+    let notifier = FBCrashLogNotifier(store: makeStore())
+    defer { notifier.store.stopWatching() }
+
+    let first = notifier.nextCrashLog(forPredicate: FBCrashLogInfo.predicate(forName: "first.crash"))
+    let second = notifier.nextCrashLog(forPredicate: FBCrashLogInfo.predicate(forName: "second.crash"))
+    XCTAssertTrue(notifier.store.isWatching)
+
+    try addCrashLog(named: "first.crash")
+    _ = try first.`await`(withTimeout: 5)
+    second.cancel()
+    let stopped = expectation(for: NSPredicate { _, _ in !notifier.store.isWatching }, evaluatedWith: self)
+    wait(for: [stopped], timeout: 5)
+  }
+
+  // MARK: - Helpers
+
+  private func makeStore() -> FBCrashLogStore {
+    FBCrashLogStore.store(forDirectories: [directory], indexPath: indexPath, logger: FBControlCoreLoggerDouble())
+  }
+
+  /// Writes a copy of a fixture, so that it is modified now rather than when the fixture was.
+  private func addCrashLog(named name: String) throws {
+    let data = try Data(contentsOf: URL(fileURLWithPath: TestFixtures.appCrashPathWithDefaultDeviceSet))
+    try data.write(to: URL(fileURLWithPath: (directory as NSString).appendingPathComponent(name)))
+  }
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import FBControlCore
+import XCTest
+
+/// Measures the buffers under the loads seen when streaming process output: many small
+/// writes into a bounded buffer, and many lines drained from a consumable buffer as they
+/// arrive. Each has a counterpart measuring `ReferenceBuffer`, which does what the buffers
+/// did before they kept a ring and a read offset, so the two can be compared in one run.
+final class FBDataBufferPerformanceTests: XCTestCase {
+
+  private static let capacity = 64 * 1024
+  private static let chunks = (0..<20_000).map { Data("chunk \($0) of process output\n".utf8) }
+  private static let output: Data = chunks.reduce(into: Data()) { $0.append($1) }
+
+  func testBoundedAccumulation() {
+    measure {
+      let buffer = FBDataBuffer.accumulatingBuffer(withCapacity: Self.capacity)
+      for chunk in Self.chunks {
+        buffer.consumeData(chunk)
+      }
+      XCTAssertEqual(buffer.data().count, Self.capacity)
+    }
+  }
+
+  func testBoundedAccumulationReference() {
+    measure {
+      let buffer = ReferenceBuffer(capacity: Self.capacity)
+      for chunk in Self.chunks {
+        buffer.append(chunk)
+      }
+      XCTAssertEqual(buffer.data.count, Self.capacity)
+    }
+  }
+
+  func testLineConsumptionOfLargeWrite() {
+    measure {
+      let buffer = FBDataBuffer.consumableBuffer()
+      buffer.consumeData(Self.output)
+      var count = 0
+      while buffer.consumeLineData() != nil {
+        count += 1
+      }
+      XCTAssertEqual(count, Self.chunks.count)
+    }
+  }
+
+  func testLineConsumptionOfLargeWriteReference() {
+    measure {
+      let buffer = ReferenceBuffer(capacity: 0)
+      buffer.append(Self.output)
+      var count = 0
+      while buffer.consumeUntil(FBDataBuffer.newlineTerminal()) != nil {
+        count += 1
+      }
+      XCTAssertEqual(count, Self.chunks.count)
+    }
+  }
+
+  func testForwardingLinesFromSmallWrites() {
+    // Writes that split lines, as reads from a pipe do.
+    let writes = stride(from: 0, to: Self.output.count, by: 13).map { Self.output[$0..<min($0 + 13, Self.output.count)] }
+    measure {
+      var count = 0
+      let consumer = FBBlockDataConsumer.synchronousDataConsumer { _ in count += 1 }
+      let buffer = FBDataBuffer.consumableBufferForwarding(to: consumer, on: nil, terminal: FBDataBuffer.newlineTerminal())
+      for write in writes {
+        buffer.consumeData(write)
+      }
+      XCTAssertEqual(count, Self.chunks.count)
+    }
+  }
+
+  func testTerminalSearchInLongLine() {
+    // One long line arriving a little at a time, searched for on every write.
+    let writes = Array(repeating: Data(repeating: UInt8(ascii: "x"), count: 64), count: 8 * 1024)
+    measure {
+      let buffer = FBDataBuffer.consumableBuffer()
+      for write in writes {
+        buffer.consumeData(write)
+        XCTAssertNil(buffer.consumeLineData())
+      }
+      buffer.consumeData(FBDataBuffer.newlineTerminal())
+      XCTAssertEqual(buffer.consumeLineData()?.count, 64 * 8 * 1024)
+    }
+  }
+
+  func testTerminalSearchInLongLineReference() {
+    let writes = Array(repeating: Data(repeating: UInt8(ascii: "x"), count: 64), count: 8 * 1024)
+    measure {
+      let buffer = ReferenceBuffer(capacity: 0)
+      for write in writes {
+        buffer.append(write)
+        XCTAssertNil(buffer.consumeUntil(FBDataBuffer.newlineTerminal()))
+      }
+      buffer.append(FBDataBuffer.newlineTerminal())
+      XCTAssertEqual(buffer.consumeUntil(FBDataBuffer.newlineTerminal())?.count, 64 * 8 * 1024)
+    }
+  }
+}
+
+/// The approach the buffers used to take: bytes are appended to a mutable data, and removed
+/// from its front when the capacity is exceeded or when they are consumed.
+private final class ReferenceBuffer {
+  private let buffer = NSMutableData()
+  private let capacity: Int
+  private let lock = NSLock()
+
+  init(capacity: Int) {
+    self.capacity = capacity
+  }
+
+  var data: Data {
+    lock.withLock { buffer as Data }
+  }
+
+  func append(_ data: Data) {
+    lock.withLock {
+      buffer.append(data)
+      let overrun = buffer.length - capacity
+      if capacity > 0 && overrun > 0 {
+        buffer.replaceBytes(in: NSRange(location: 0, length: overrun), withBytes: nil, length: 0)
+      }
+    }
+  }
+
+  func consumeUntil(_ terminal: Data) -> Data? {
+    lock.withLock {
+      let range = buffer.range(of: terminal, options: [], in: NSRange(location: 0, length: buffer.length))
+      if range.location == NSNotFound {
+        return nil
+      }
+      let data = buffer.subdata(with: NSRange(location: 0, length: range.location))
+      buffer.replaceBytes(in: NSRange(location: 0, length: range.location + terminal.count), withBytes: nil, length: 0)
+      return data
+    }
+  }
+}
@@ -46,6 +46,41 @@ final class FBDataConsumerTests: XCTestCase {
     XCTAssertTrue(consumer.finishedConsuming.hasCompleted)
   }
 
+  func testLineBufferAccumulationWithCapacityWrapsAround() {
+    let consumer = FBDataBuffer.accumulatingBuffer(withCapacity: 8)
+    var expected = Data()
+    for index in 0..<100 {
+      let chunk = Data("\(index),".utf8)
+      consumer.consumeData(chunk)
+      expected.append(chunk)
+      XCTAssertEqual(consumer.data(), expected.suffix(8))
+    }
+    consumer.consumeData(Data("0123456789".utf8))
+    XCTAssertEqual(consumer.data(), Data("23456789".utf8))
+
+    consumer.consumeEndOfFile()
+    consumer.consumeData(Data("NOPE".utf8))
+    XCTAssertEqual(consumer.data(), Data("23456789".utf8))
+  }
+
+  func testFinishedRingLendsItsBytesWithoutCopying() {
+    // Large enough that Swift's Data references the bytes rather than holding them inline.
+    let consumer = FBDataBuffer.accumulatingBuffer(withCapacity: 64)
+    var expected = Data()
+    for index in 0..<40 {
+      let chunk = Data("\(index),".utf8)
+      consumer.consumeData(chunk)
+      expected.append(chunk)
+    }
+    XCTAssertEqual(consumer.data(), expected.suffix(64))
+
+    consumer.consumeEndOfFile()
+    let first = consumer.data()
+    let second = consumer.data()
+    XCTAssertEqual(first, expected.suffix(64))
+    XCTAssertEqual(first.withUnsafeBytes(\.baseAddress), second.withUnsafeBytes(\.baseAddress))
+  }
+
   func testLineBufferedConsumer() {
     var lines: [String] = []
     let consumer = FBBlockDataConsumer.synchronousLineConsumer { line in
@@ -256,6 +291,48 @@ final class FBDataConsumerTests: XCTestCase {
     XCTAssertEqual(consumer.consumeCurrentData(), Data())
   }
 
+  func testTerminalSplitAcrossWrites() {
+    let consumer = FBDataBuffer.consumableBuffer()
+    consumer.consumeData(Data("FOO$".utf8))
+    XCTAssertNil(consumer.consume(until: Data("$$".utf8)))
+    consumer.consumeData(Data("$BAR$".utf8))
+    XCTAssertEqual(consumer.consume(until: Data("$$".utf8)), Data("FOO".utf8))
+    XCTAssertNil(consumer.consume(until: Data("$$".utf8)))
+    // A search for a different terminal does not rely on the previous one.
+    consumer.consumeData(Data("\n$".utf8))
+    XCTAssertEqual(consumer.consumeLineString(), "BAR$")
+    XCTAssertNil(consumer.consume(until: Data("$$".utf8)))
+    consumer.consumeData(Data("$".utf8))
+    XCTAssertEqual(consumer.consume(until: Data("$$".utf8)), Data())
+    XCTAssertNil(consumer.consume(until: Data()))
+  }
+
+  func testInterleavedConsumptionOfManyLines() {
+    let consumer = FBDataBuffer.consumableBuffer()
+    let lines = (0..<1000).map { "LINE \($0)" }
+    var pending = Data(lines.joined(separator: "\n").utf8)
+    pending.append(Data("\n".utf8))
+    // Feed the lines in chunks that do not line up with them, consuming as they arrive.
+    var consumed: [String] = []
+    while !pending.isEmpty {
+      consumer.consumeData(pending.prefix(7))
+      pending = pending.dropFirst(7)
+      if consumed.count % 10 == 9, consumer.data().contains(UInt8(ascii: "\n")), let header = consumer.consumeLength(5) {
+        XCTAssertEqual(header, Data("LINE ".utf8))
+        guard let rest = consumer.consumeLineString() else {
+          XCTFail("Expected a line after its prefix")
+          return
+        }
+        consumed.append("LINE " + rest)
+      }
+      while let line = consumer.consumeLineString() {
+        consumed.append(line)
+      }
+    }
+    XCTAssertEqual(consumed, lines)
+    XCTAssertEqual(consumer.consumeCurrentData(), Data())
+  }
+
   func testFutureTerminalConsumption() {
     let consumer = FBDataBuffer.notifyingBuffer()
     let queue = DispatchQueue.global(qos: .userInitiated)
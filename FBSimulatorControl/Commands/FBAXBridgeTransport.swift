@@ -18,8 +18,9 @@ import Foundation
 ///   over a reused Unix-domain socket, so warm reads avoid that cost — the path a long-lived host
 ///   process (companion, `ui shell`, a streaming hit-test server) should use.
 ///
-/// `read` returns the guest's raw JSON response bytes (a `Sendable` `Data`, so it crosses the actor
-/// boundary cleanly); the conformer parses the `{ "ok", "tree" | "error" }` envelope.
+/// `read` returns the guest's raw response bytes (a `Sendable` `Data`, so it crosses the actor boundary
+/// cleanly); the conformer parses the `{ "ok", "tree" | "error" }` envelope. Those bytes are JSON, or an
+/// `FBAXWireBinary` frame on a persistent connection that negotiated it — `FBAXTreeRead` accepts both.
 /// Selects how a frontmost read resolves the foreground app. Raw values are the wire values the guest's
 /// `method` request key accepts.
 public enum FBAXBridgeFrontmostMethod: String, Sendable, CaseIterable {
@@ -129,6 +130,10 @@ protocol FBAXBridgeTransport {
   /// hit-test that resolves the element and its owning app in-guest in one round-trip, with no walk and
   /// no separate frontmost pid query. The response carries the owning pid alongside the hit node.
   func hitTest(x: Double, y: Double, attributes: [String]?) async throws -> Data
+  /// Hit-tests every one of `points` in a single round trip (the guest `hittest-batch` verb), answering
+  /// each as `hitTest(x:y:attributes:)` would. For callers that probe many points in a row, which would
+  /// otherwise pay a round trip apiece; `FBAXTreeRead.hitTests(fromBatchResponse:count:)` reads it.
+  func hitTest(points: [CGPoint], attributes: [String]?) async throws -> Data
   /// Sends one point-addressed write (the guest `perform` or `setvalue` verb) and returns its envelope.
   ///
   /// One entry point rather than one per verb: the guest splits them because performing an action and
@@ -180,6 +185,16 @@ struct FBAXBridgeOneshotTransport: FBAXBridgeTransport {
     )
   }
 
+  /// The points as `x,y;x,y`: argv takes each field as a single value, and neither separator can occur
+  /// in a number.
+  func hitTest(points: [CGPoint], attributes: [String]?) async throws -> Data {
+    try await spawn(
+      ["accessibility", FBAXWire.Verb.hitTestBatch.rawValue]
+        + FBAXWire.Request.points.argument(points.map { "\(Double($0.x)),\(Double($0.y))" }.joined(separator: ";"))
+        + Self.attributeArgument(attributes)
+    )
+  }
+
   /// Sent only for a non-default traversal, so a default read's argv stays byte-identical to what a guest
   /// predating the field expects.
   static func traversalArgument(_ traversal: FBAXTraversal) -> [String] {
@@ -237,9 +252,10 @@ struct FBAXBridgeOneshotTransport: FBAXBridgeTransport {
 // MARK: - Persistent transport
 
 /// Spawns `accessibility serve <socket>` once and reads over a reused Unix-domain socket. An actor so
-/// the connection is established exactly once under concurrent callers, and reads are serialized (the
-/// guest handles one request at a time). Memoized per simulator via `commandCache`, so a long-lived
-/// host process amortizes the spawn+warmup across every read.
+/// the connection is established exactly once under concurrent callers; the callers' requests then
+/// pipeline over it (see `FBAXBridgeConnection`) rather than queueing on the actor. Memoized per
+/// simulator via `commandCache`, so a long-lived host process amortizes the spawn+warmup across every
+/// read.
 actor FBAXBridgePersistentTransport: FBAXBridgeTransport {
   private weak var simulator: FBSimulator?
   private var connectionTask: Task<FBAXBridgeConnection, Error>?
@@ -297,6 +313,19 @@ actor FBAXBridgePersistentTransport: FBAXBridgeTransport {
         ]))
   }
 
+  func hitTest(points: [CGPoint], attributes: [String]?) async throws -> Data {
+    try await roundTripWithRecovery(
+      Self.adding(
+        attributes: attributes,
+        explainUnreachable: false,
+        traversal: .viewHierarchy,
+        automationMode: nil,
+        to: [
+          FBAXWire.Request.verb.key: FBAXWire.Verb.hitTestBatch.rawValue,
+          FBAXWire.Request.points.key: points.map { [Double($0.x), Double($0.y)] },
+        ]))
+  }
+
   /// Adds the attribute list to a request payload, or leaves the payload untouched for a default read —
   /// an absent field is what makes that read's bytes identical to a host that predates the field.
   static func adding(
@@ -430,14 +459,9 @@ actor FBAXBridgePersistentTransport: FBAXBridgeTransport {
     // Spawn into the booted launchd domain (`.default`) so the guest joins the simulator's mach
     // namespace and can reach app AX servers — the same domain the one-shot describe uses.
     let process = try await simulator.launchProcess(configuration)
+    let fileDescriptor: Int32
     do {
-      let fileDescriptor = try await FBAXBridgeConnection.connect(path: socketPath, timeout: 10)
-      return FBAXBridgeConnection(
-        fileDescriptor: fileDescriptor,
-        process: process,
-        socketPath: socketPath,
-        logger: simulator.logger
-      )
+      fileDescriptor = try await FBAXBridgeConnection.connect(path: socketPath, timeout: 10)
     } catch {
       // Connecting failed, so the `FBAXBridgeConnection` that tears the serve down on deinit was never
       // created — reap the just-spawned serve here so it does not leak as an orphan.
@@ -449,26 +473,62 @@ actor FBAXBridgePersistentTransport: FBAXBridgeTransport {
       )
       throw error
     }
+    let connection = FBAXBridgeConnection(
+      fileDescriptor: fileDescriptor,
+      process: process,
+      socketPath: socketPath,
+      logger: simulator.logger
+    )
+    // From here the connection owns the serve: a failed negotiate releases it, which tears it down.
+    let (encoding, framing) = try await connection.negotiate()
+    simulator.logger?.log("axbridge serve \(process.processIdentifier) sends \(encoding.rawValue) responses in \(framing.rawValue) frames")
+    return connection
   }
 }
 
 // MARK: - Connection
 
 /// A connected Unix-domain socket to a running `accessibility serve` guest, plus the retained guest
-/// process handle (retaining it keeps the serve process alive). Frames are 4-byte big-endian length +
-/// JSON. Blocking socket I/O runs on a dedicated serial queue so it never blocks a cooperative thread,
-/// and the serial queue also guarantees request/response frames never interleave.
+/// process handle (retaining it keeps the serve process alive). Frames are a 4-byte big-endian length +
+/// payload, or, once `negotiate` settles on `FBAXWire.Framing.lengthAndId`, the length followed by a
+/// 4-byte big-endian request id the guest echoes back. Payloads are a JSON request, and a JSON or
+/// negotiated `FBAXWireBinary` response.
 ///
-// SAFETY: the stored properties are immutable and only read; all socket I/O is serialized on the
-// private `queue`, which processes one request/response frame pair at a time, so no mutable state is
-// shared across threads. Mirrors the `@unchecked Sendable` convention in FBRemoteInvoking.
+/// Requests pipeline: `roundTrip` writes its frame and suspends, and any number of callers can be in
+/// flight on the one connection at once. Writes go through a serial queue so frames never interleave,
+/// and a single reader drains responses on a second queue for as long as any request is outstanding,
+/// resuming each caller with the frame carrying its id. Against a guest that sends no ids the reader
+/// routes by position instead, which is sound because such a guest answers strictly in the order it was
+/// asked. Both queues run blocking socket I/O, so neither ever blocks a cooperative thread.
+///
+/// A failed write or read, or a response for a request that is not in flight, leaves the stream in an
+/// unknown state: every outstanding request is failed with the same error, and so is every later one,
+/// which is what tells the persistent transport to drop the connection and establish a fresh serve.
+///
+// SAFETY: the socket, process and path are immutable. The in-flight table, the send order, the id
+// counter, the framing and the failure are only touched under `lock`. Frames are only written on
+// `writeQueue`, enqueued under the lock so they reach the socket in send order, and only read on
+// `readQueue`, by at most one reader at a time (`reading`). Mirrors the `@unchecked Sendable` convention
+// in FBRemoteInvoking.
 // patternlint-disable-next-line unchecked-sendable
 final class FBAXBridgeConnection: @unchecked Sendable {
   private let fileDescriptor: Int32
-  private let process: FBSubprocess<AnyObject, AnyObject, AnyObject>
+  /// The serve process the connection keeps alive, or nil for a connection to a guest it did not spawn
+  /// — a test's fake one — whose teardown is then only the socket.
+  private let process: FBSubprocess<AnyObject, AnyObject, AnyObject>?
   private let socketPath: String
   private let logger: (any FBControlCoreLogger)?
-  private let queue = DispatchQueue(label: "com.facebook.FBSimulatorControl.axbridge.connection")
+  private let writeQueue = DispatchQueue(label: "com.facebook.FBSimulatorControl.axbridge.connection.write")
+  private let readQueue = DispatchQueue(label: "com.facebook.FBSimulatorControl.axbridge.connection.read")
+
+  private let lock = NSLock()
+  private var framing = FBAXWire.Framing.length
+  private var inFlight: [UInt32: CheckedContinuation<Data, Error>] = [:]
+  /// The in-flight ids in the order their frames were enqueued — the order an id-less guest answers in.
+  private var sendOrder: [UInt32] = []
+  private var lastRequestId: UInt32 = 0
+  private var reading = false
+  private var failure: Error?
 
   /// Per-`recv` deadline (SO_RCVTIMEO), so a hung or dead guest cannot wedge a round trip forever.
   ///
@@ -476,11 +536,12 @@ final class FBAXBridgeConnection: @unchecked Sendable {
   /// deadline, so every chunk that arrives resets it. Only a guest that says nothing at all for the
   /// deadline trips it, after which the recovery path drops and re-establishes the connection.
   /// Deliberately not derived from read cost, which varies by orders of magnitude across applications.
+  /// The reader only waits while a request is in flight, so an idle connection never trips it.
   private static let receiveTimeoutSeconds = 30
 
   init(
     fileDescriptor: Int32,
-    process: FBSubprocess<AnyObject, AnyObject, AnyObject>,
+    process: FBSubprocess<AnyObject, AnyObject, AnyObject>?,
     socketPath: String,
     logger: (any FBControlCoreLogger)?
   ) {
@@ -516,33 +577,135 @@ final class FBAXBridgeConnection: @unchecked Sendable {
 
   deinit {
     // Best-effort teardown when the reader holding this connection is released (e.g. the host process
-    // exits gracefully).
+    // exits gracefully). Nothing can be in flight by now: the queued writes and the reader each retain
+    // the connection until they finish.
     Self.teardown(
       fileDescriptor: fileDescriptor,
-      processIdentifier: process.processIdentifier,
+      processIdentifier: process?.processIdentifier ?? 0,
       socketPath: socketPath,
       logger: logger
     )
   }
 
+  /// Sends one request and returns its response, alongside whatever else is in flight.
   func roundTrip(_ requestData: Data) async throws -> Data {
-    // Single-resume by construction: the serial queue block resumes the continuation exactly once
-    // (success or error) with no timeout/cancellation racing the completion, so a plain checked
-    // continuation is safe here (unlike the DTX receipt path, which needs AssertingSafeContinuation
-    // to arbitrate a receipt/deadline/cancel three-way race).
+    // Single-resume by construction: the continuation is resumed by whoever removes it from `inFlight`
+    // under the lock — the reader with its response, or `fail` with the error — and removal happens
+    // exactly once, so a plain checked continuation is safe here (unlike the DTX receipt path, which
+    // needs AssertingSafeContinuation to arbitrate a receipt/deadline/cancel three-way race).
     try await withCheckedThrowingContinuation { (continuation: CheckedContinuation<Data, Error>) in
-      queue.async { [fileDescriptor, process] in
+      lock.lock()
+      if let failure {
+        lock.unlock()
+        continuation.resume(throwing: failure)
+        return
+      }
+      lastRequestId &+= 1
+      let requestId = lastRequestId
+      inFlight[requestId] = continuation
+      sendOrder.append(requestId)
+      let startReading = !reading
+      reading = true
+      let header = framing == .lengthAndId ? requestId : nil
+      // Enqueued under the lock, so the frames reach the socket in `sendOrder`.
+      writeQueue.async { [self] in
         do {
-          try FBAXBridgeConnection.writeFrame(fileDescriptor, requestData)
-          let responseData = try FBAXBridgeConnection.readFrame(fileDescriptor, guest: process)
-          continuation.resume(returning: responseData)
+          try Self.writeFrame(fileDescriptor, requestData, requestId: header)
         } catch {
-          continuation.resume(throwing: error)
+          fail(error)
+        }
+      }
+      lock.unlock()
+      if startReading {
+        readQueue.async { [self] in
+          readResponses()
         }
       }
     }
   }
 
+  /// Drains response frames until nothing is in flight, handing each to the request it answers.
+  private func readResponses() {
+    while true {
+      let framing = lock.withLock { self.framing }
+      let frame: (requestId: UInt32?, payload: Data)
+      do {
+        frame = try Self.readFrame(fileDescriptor, framing: framing, guest: process)
+      } catch {
+        fail(error)
+        return
+      }
+      let (continuation, more) = lock.withLock { () -> (CheckedContinuation<Data, Error>?, Bool) in
+        guard let requestId = frame.requestId ?? sendOrder.first,
+          let continuation = inFlight.removeValue(forKey: requestId)
+        else {
+          return (nil, false)
+        }
+        if let index = sendOrder.firstIndex(of: requestId) {
+          sendOrder.remove(at: index)
+        }
+        reading = !inFlight.isEmpty
+        return (continuation, reading)
+      }
+      guard let continuation else {
+        let answered = frame.requestId.map { "request \($0)" } ?? "no request"
+        fail(FBAXBridgeError.guestFailure("the guest answered \(answered), which is not in flight"))
+        return
+      }
+      continuation.resume(returning: frame.payload)
+      if !more {
+        return
+      }
+    }
+  }
+
+  /// Fails every request in flight, and every later one, with `error`. The first failure is the one
+  /// reported: anything after it is a consequence.
+  private func fail(_ error: Error) {
+    let continuations = lock.withLock { () -> [CheckedContinuation<Data, Error>] in
+      if failure == nil {
+        failure = error
+      }
+      let continuations = sendOrder.compactMap { inFlight[$0] }
+      inFlight.removeAll()
+      sendOrder.removeAll()
+      reading = false
+      return continuations
+    }
+    // Wakes a reader still blocked in `recv` for a write that failed, so it does not sit out the deadline
+    // on a connection nobody will use again.
+    shutdown(fileDescriptor, SHUT_RDWR)
+    for continuation in continuations {
+      continuation.resume(throwing: failure ?? error)
+    }
+  }
+
+  /// Settles the response encoding and the frame header for the rest of the connection, offering the
+  /// binary encoding and request ids. A guest predating `negotiate` answers it as an unsupported verb and
+  /// a guest that declines answers `json` and `length`; either way the connection keeps that default.
+  /// Only a transport failure throws, since then the connection is no use for anything else either.
+  ///
+  /// Must be the only request in flight: its response arrives in the old framing and every frame after
+  /// it in the new one. The host does not hold on to the encoding: a binary response announces itself
+  /// with `FBAXWireBinary.magic`, which no JSON response can start with.
+  func negotiate() async throws -> (encoding: FBAXWire.Encoding, framing: FBAXWire.Framing) {
+    let request: [String: Any] = [
+      FBAXWire.Request.verb.key: FBAXWire.Verb.negotiate.rawValue,
+      FBAXWire.Request.encodings.key: [FBAXWire.Encoding.binary.rawValue],
+      FBAXWire.Request.framings.key: [FBAXWire.Framing.lengthAndId.rawValue],
+    ]
+    let response = try await roundTrip(try JSONSerialization.data(withJSONObject: request))
+    guard let object = try? JSONSerialization.jsonObject(with: response) as? [String: Any],
+      (object[FBAXWire.Envelope.ok.rawValue] as? Bool) == true
+    else {
+      return (.json, .length)
+    }
+    let encoding = (object[FBAXWire.Envelope.encoding.rawValue] as? String).flatMap(FBAXWire.Encoding.init(rawValue:)) ?? .json
+    let framing = (object[FBAXWire.Envelope.framing.rawValue] as? String).flatMap(FBAXWire.Framing.init(rawValue:)) ?? .length
+    lock.withLock { self.framing = framing }
+    return (encoding, framing)
+  }
+
   /// Connects to the guest's UDS, retrying until it binds (the guest spawns asynchronously) or the
   /// timeout elapses. Runs on a background queue so the blocking retry never occupies a cooperative
   /// thread.
@@ -598,23 +761,37 @@ final class FBAXBridgeConnection: @unchecked Sendable {
 
   // MARK: - Framing
 
-  static func writeFrame(_ fileDescriptor: Int32, _ payload: Data) throws {
-    try writeAll(fileDescriptor, encodeLength(payload.count))
-    try writeAll(fileDescriptor, payload)
+  /// Writes one frame, with `requestId` in its header when the connection negotiated one.
+  static func writeFrame(_ fileDescriptor: Int32, _ payload: Data, requestId: UInt32? = nil) throws {
+    var header = encodeLength(payload.count)
+    if let requestId {
+      header += encodeLength(Int(requestId))
+    }
+    try writeAll(fileDescriptor, header + payload)
   }
 
   static func readFrame(
     _ fileDescriptor: Int32,
     guest: FBSubprocess<AnyObject, AnyObject, AnyObject>?
   ) throws -> Data {
-    let header = try readAll(fileDescriptor, count: 4, guest: guest)
+    try readFrame(fileDescriptor, framing: .length, guest: guest).payload
+  }
+
+  /// Reads one frame in `framing`, returning the request id its header carried, if it carried one.
+  static func readFrame(
+    _ fileDescriptor: Int32,
+    framing: FBAXWire.Framing,
+    guest: FBSubprocess<AnyObject, AnyObject, AnyObject>?
+  ) throws -> (requestId: UInt32?, payload: Data) {
+    let header = try readAll(fileDescriptor, count: framing == .lengthAndId ? 8 : 4, guest: guest)
     let length = decodeLength(header)
-    // The guest always sends a non-empty JSON envelope and never writes frames above this cap (keep
+    // The guest always sends a non-empty envelope and never writes frames above this cap (keep
     // the two in step), so a length outside the range means a desynced or corrupt stream.
     guard length > 0, length < 16 * 1024 * 1024 else {
       throw FBAXBridgeError.guestFailure("invalid response frame length \(length)")
     }
-    return try readAll(fileDescriptor, count: length, guest: guest)
+    let requestId = framing == .lengthAndId ? UInt32(decodeLength(header.dropFirst(4))) : nil
+    return (requestId, try readAll(fileDescriptor, count: length, guest: guest))
   }
 
   private static func encodeLength(_ count: Int) -> Data {
@@ -625,7 +802,7 @@ final class FBAXBridgeConnection: @unchecked Sendable {
   }
 
   private static func decodeLength(_ data: Data) -> Int {
-    let bytes = [UInt8](data)
+    let bytes = [UInt8](data.prefix(4))
     return (Int(bytes[0]) << 24) | (Int(bytes[1]) << 16) | (Int(bytes[2]) << 8) | Int(bytes[3])
   }
 
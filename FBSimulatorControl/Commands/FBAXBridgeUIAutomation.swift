@@ -89,10 +89,20 @@ final class FBAXBridgeUIAutomation: FBAXTreeReader, @unchecked Sendable {
   private func translatingBackendErrors<T>(_ body: () async throws -> T) async throws -> T {
     do {
       return try await body()
-    } catch let FBAXBridgeError.applicationUnavailable(pid) {
-      throw FBUIAutomationError.applicationUnavailable(backend: backend, pid: pid)
-    } catch let FBAXBridgeError.applicationNotResponding(pid) {
-      throw FBUIAutomationError.applicationNotResponding(backend: backend, pid: pid)
+    } catch {
+      throw translatedBackendError(error)
+    }
+  }
+
+  /// The translation itself, for an error that is carried rather than thrown — one point of a batch.
+  private func translatedBackendError(_ error: Error) -> Error {
+    switch error {
+    case let FBAXBridgeError.applicationUnavailable(pid):
+      return FBUIAutomationError.applicationUnavailable(backend: backend, pid: pid)
+    case let FBAXBridgeError.applicationNotResponding(pid):
+      return FBUIAutomationError.applicationNotResponding(backend: backend, pid: pid)
+    default:
+      return error
     }
   }
 
@@ -180,17 +190,77 @@ final class FBAXBridgeUIAutomation: FBAXTreeReader, @unchecked Sendable {
       guard let hit = try FBAXTreeRead(hitTestResponse: response) else {
         return nil
       }
-      let element = FBAXTreeWalk.buildPlatformElementTree(from: hit.tree, pid: hit.pid)
-      var formatted = FBAXNodeSerializer.formattedDescription(
-        ofElement: element, token: "", nestedFormat: options.nestedFormat, keys: options.serializationKeys, collector: nil
+      return elementsResponse(forHit: hit, at: point, options: options)
+    }
+  }
+
+  /// Hit-tests each of `points`, answering per point what `hitTest(at:options:)` would have: a response,
+  /// `nil` for empty space, or the error for a point whose application failed, which fails that point
+  /// alone. For a caller probing many points in a row, such as a coverage grid looking for remote content.
+  ///
+  /// One round trip against a guest that knows `hittest-batch`. Against one predating it the points go
+  /// as single hit-tests all at once, which over a persistent connection still pipeline rather than
+  /// waiting on each other. Throws only when the batch as a whole fails.
+  func hitTests(
+    at points: [CGPoint],
+    options: FBAccessibilityRequestOptions
+  ) async throws -> [Result<FBAccessibilityElementsResponse?, Error>] {
+    let hits = try await translatingBackendErrors {
+      let response = try await transport.hitTest(
+        points: points, attributes: FBAXWire.Node.fetchList(for: options.serializationKeys)
       )
-      // The hit element is the one the caller named, so it is exempt; its descendants honour the filter.
-      if let children = formatted.children {
-        formatted.children = options.filter.apply(to: children)
+      return try FBAXTreeRead.hitTests(fromBatchResponse: response, count: points.count)
+    }
+    guard let hits else {
+      return await singleHitTests(at: points, options: options)
+    }
+    return zip(points, hits).map { point, hit in
+      hit
+        .map { $0.map { elementsResponse(forHit: $0, at: point, options: options) } }
+        .mapError(translatedBackendError)
+    }
+  }
+
+  /// `hitTests(at:options:)` for a guest without the batch verb: every point in flight at once, answered
+  /// in the order asked.
+  private func singleHitTests(
+    at points: [CGPoint],
+    options: FBAccessibilityRequestOptions
+  ) async -> [Result<FBAccessibilityElementsResponse?, Error>] {
+    await withTaskGroup(of: (Int, Result<FBAccessibilityElementsResponse?, Error>).self) { group in
+      for (index, point) in points.enumerated() {
+        group.addTask {
+          do {
+            return (index, .success(try await self.hitTest(at: point, options: options)))
+          } catch {
+            return (index, .failure(error))
+          }
+        }
+      }
+      var results = [Result<FBAccessibilityElementsResponse?, Error>](repeating: .success(nil), count: points.count)
+      for await (index, result) in group {
+        results[index] = result
       }
-      return FBAccessibilityElementsResponse(elements: .single(formatted))
-        .withProvenance(backend: backend.name, target: .point(point))
+      return results
+    }
+  }
+
+  /// The response for the element a hit-test found at `point`.
+  private func elementsResponse(
+    forHit hit: FBAXTreeRead,
+    at point: CGPoint,
+    options: FBAccessibilityRequestOptions
+  ) -> FBAccessibilityElementsResponse {
+    let element = FBAXTreeWalk.rootElement(of: hit)
+    var formatted = FBAXNodeSerializer.formattedDescription(
+      ofElement: element, token: "", nestedFormat: options.nestedFormat, keys: options.serializationKeys, collector: nil
+    )
+    // The hit element is the one the caller named, so it is exempt; its descendants honour the filter.
+    if let children = formatted.children {
+      formatted.children = options.filter.apply(to: children)
     }
+    return FBAccessibilityElementsResponse(elements: .single(formatted))
+      .withProvenance(backend: backend.name, target: .point(point))
   }
 
   func wait(
@@ -210,7 +280,7 @@ final class FBAXBridgeUIAutomation: FBAXTreeReader, @unchecked Sendable {
         // where the single fetch is unmeasured, and a wait's cost is dominated by the poll interval.
         let read = try await self.readRawTree(for: .frontmost, attributes: nil, explainUnreachable: false, traversal: .viewHierarchy)
         let elements = FBAXTreeWalk.describeAllElements(
-          fromTree: read.tree, keys: FBAXKeys.defaultSet.union([key.serializationKey]), nestedFormat: false, pid: read.pid
+          fromRead: read, keys: FBAXKeys.defaultSet.union([key.serializationKey]), nestedFormat: false
         )
         return FBAXTreeWalk.matchingElement(inElements: elements, markerValue: markerValue, key: key) != nil ? true : nil
       } catch let error as FBAXBridgeError {
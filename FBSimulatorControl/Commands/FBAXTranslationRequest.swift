@@ -233,71 +233,105 @@ final class FBAXTranslationRequest {
     let maxPoints = remoteOptions.maxPoints
     var pointCount: UInt = 0
 
-    var y = stepSize
-    while y < region.size.height - stepSize {
-      var x = stepSize
-      while x < region.size.width - stepSize {
-        if maxPoints > 0, pointCount >= maxPoints {
-          break
-        }
+    for point in Self.candidatePoints(in: region, stepSize: stepSize, uncoveredBy: coverageGrid) {
+      if maxPoints > 0, pointCount >= maxPoints {
+        break
+      }
 
-        let point = CGPoint(x: region.origin.x + x, y: region.origin.y + y)
+      // A remote element discovered since the candidates were chosen may cover this point now.
+      if let coverageGrid, coverageGrid.isFilled(at: point) {
+        continue
+      }
 
-        // Skip points already covered by native accessibility elements.
-        if let coverageGrid, coverageGrid.isFilled(at: point) {
-          x += stepSize
-          continue
-        }
+      pointCount += 1
 
-        pointCount += 1
+      guard let hitTranslation = translator.object(at: point, displayId: 0, bridgeDelegateToken: token) else {
+        continue
+      }
+      hitTranslation.bridgeDelegateToken = token
+      let hitPid = hitTranslation.pid
 
-        guard let hitTranslation = translator.object(at: point, displayId: 0, bridgeDelegateToken: token) else {
-          x += stepSize
-          continue
-        }
-        hitTranslation.bridgeDelegateToken = token
-        let hitPid = hitTranslation.pid
+      // Skip PIDs already seen in the main traversal, and the frontmost app itself.
+      if seenPids.contains(hitPid) || hitPid <= 0 || hitPid == frontmostPid {
+        continue
+      }
 
-        // Skip PIDs already seen in the main traversal, and the frontmost app itself.
-        if seenPids.contains(hitPid) || hitPid <= 0 || hitPid == frontmostPid {
-          x += stepSize
-          continue
-        }
+      guard let hitElement = translator.macPlatformElement(fromTranslation: hitTranslation) as? FBAXPlatformElement else {
+        continue
+      }
 
-        guard let hitElement = translator.macPlatformElement(fromTranslation: hitTranslation) as? FBAXPlatformElement else {
-          x += stepSize
-          continue
-        }
+      let hitFrame = hitElement.axFrame()
+      let hitFrameKey = "\(hitFrame.origin.x),\(hitFrame.origin.y),\(hitFrame.size.width),\(hitFrame.size.height)"
+      if discoveredFrames.contains(hitFrameKey) {
+        continue
+      }
+      discoveredFrames.insert(hitFrameKey)
 
-        let hitFrame = hitElement.axFrame()
-        let hitFrameKey = "\(hitFrame.origin.x),\(hitFrame.origin.y),\(hitFrame.size.width),\(hitFrame.size.height)"
-        if discoveredFrames.contains(hitFrameKey) {
-          x += stepSize
-          continue
-        }
-        discoveredFrames.insert(hitFrameKey)
+      coverageGrid?.markFilled(with: hitFrame)
 
-        coverageGrid?.markFilled(with: hitFrame)
+      let discovered = FBAXNodeSerializer.decoratedElement(
+        forElement: hitElement,
+        token: token,
+        keys: keysWithFrame,
+        collector: collector,
+        seenPids: nil, // already filtered
+        isRemote: true
+      )
+      discoveredElements.append(discovered)
+    }
 
-        let discovered = FBAXNodeSerializer.decoratedElement(
-          forElement: hitElement,
-          token: token,
-          keys: keysWithFrame,
-          collector: collector,
-          seenPids: nil, // already filtered
-          isRemote: true
-        )
-        discoveredElements.append(discovered)
+    return discoveredElements
+  }
 
-        x += stepSize
-      }
-      if maxPoints > 0, pointCount >= maxPoints {
-        break
+  /// The points of the sampling lattice over `region` — every `stepSize` points, short of its edges —
+  /// that are worth a hit-test, row by row.
+  ///
+  /// Without a grid that is every lattice point. With one, points in cells the grid has filled are left
+  /// out; points off the grid, which it cannot cover, are kept. The grid's uncovered regions say which of
+  /// its rows and columns have an empty cell at all, so a lattice row or column that is covered
+  /// throughout is dropped whole. Each remaining lattice row and column is mapped to its grid row and
+  /// column once, so the test per point is a single bit.
+  static func candidatePoints(in region: CGRect, stepSize: CGFloat, uncoveredBy grid: FBAccessibilityCoverageGrid?) -> [CGPoint] {
+    // Accumulated rather than multiplied out, so the lattice is exactly the one the hit-test loop has
+    // always sampled.
+    func offsets(across length: CGFloat) -> [CGFloat] {
+      var offsets: [CGFloat] = []
+      var offset = stepSize
+      while offset < length - stepSize {
+        offsets.append(offset)
+        offset += stepSize
       }
-      y += stepSize
+      return offsets
+    }
+    let xs = offsets(across: region.size.width).map { region.origin.x + $0 }
+    let ys = offsets(across: region.size.height).map { region.origin.y + $0 }
+    guard let grid else {
+      return ys.flatMap { y in xs.map { x in CGPoint(x: x, y: y) } }
     }
 
-    return discoveredElements
+    var openRows = [Bool](repeating: false, count: Int(grid.height))
+    var openColumns = [Bool](repeating: false, count: Int(grid.width))
+    for region in grid.uncoveredRegions() {
+      openRows.replaceSubrange(region.row..<(region.row + region.rows), with: repeatElement(true, count: region.rows))
+      openColumns.replaceSubrange(region.column..<(region.column + region.columns), with: repeatElement(true, count: region.columns))
+    }
+    let columns = xs.map { x in (x, grid.column(containing: x)) }.filter { _, column in
+      column.map { openColumns[$0] } ?? true
+    }
+    var points: [CGPoint] = []
+    for y in ys {
+      let row = grid.row(containing: y)
+      if let row, !openRows[row] {
+        continue
+      }
+      for (x, column) in columns {
+        if let row, let column, grid.isFilled(column: column, row: row) {
+          continue
+        }
+        points.append(CGPoint(x: x, y: y))
+      }
+    }
+    return points
   }
 
   // Process remote-content discovery and merge with the main elements.
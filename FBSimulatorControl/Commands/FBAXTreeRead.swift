@@ -17,12 +17,16 @@ import Foundation
 /// once, in the shared `describeTree`, over this value — so a `.marker` poll that reads without
 /// describing does not re-run either.
 ///
-// SAFETY: immutable after init; `tree` is a parsed JSON/DTX value graph (Foundation value types),
-// never mutated after construction and read-only at the serialize site — safe to hand across the remote
-// backend's actor boundary. Mirrors the `@unchecked Sendable` convention used elsewhere in this module.
+// SAFETY: immutable after init; `tree` is a parsed JSON/DTX value graph (Foundation value types) and
+// `decodedRoot` an element tree with only `let` storage, neither mutated after construction and both
+// read-only at the serialize site — safe to hand across the remote backend's actor boundary. Mirrors the
+// `@unchecked Sendable` convention used elsewhere in this module.
 // patternlint-disable-next-line unchecked-sendable
 struct FBAXTreeRead: @unchecked Sendable {
   let tree: [String: Any]
+  /// The tree already built into elements, when the guest sent it as `FBAXWireBinary`; `tree` is then
+  /// empty. Read through `FBAXTreeWalk`'s read-taking functions, which use whichever is there.
+  var decodedRoot: FBRemoteAutomationPlatformElement?
   let pid: pid_t
   let truncated: Bool
   let modal: FBAccessibilityModalInfo?
@@ -40,11 +44,11 @@ struct FBAXTreeRead: @unchecked Sendable {
 /// Where a guest-backed read's time went, from both sides of the boundary.
 ///
 /// `residual` is the round trip less the guest's walk. It lumps spawn or connect, the guest's bind,
-/// its JSON encoding and the IPC, undivided — neither side can split them.
+/// its encoding and the IPC, undivided — neither side can split them.
 struct FBAXReadTimings: Equatable {
   /// Wall time of the whole transport call, host-side: request out, guest work, response back.
   let roundTrip: CFAbsoluteTime
-  /// Decoding the guest's JSON, host-side.
+  /// Decoding the guest's response, host-side: its JSON, or its binary tree straight into elements.
   let decode: CFAbsoluteTime
   /// The guest's own walk, as it reported it.
   let traverse: CFAbsoluteTime?
@@ -59,7 +63,7 @@ struct FBAXReadTimings: Equatable {
   }
 }
 
-// MARK: - Guest JSON response parsing
+// MARK: - Guest response parsing
 
 /// Parses the guest's `{ "ok": Bool, "tree": {...} | "error": String }` response envelope into a read.
 extension FBAXTreeRead {
@@ -68,6 +72,51 @@ extension FBAXTreeRead {
     self.init(tree: tree, pid: pid, truncated: truncated, modal: modal, automation: nil)
   }
 
+  /// A read of `tree`, in whichever form the guest sent it.
+  private init(
+    tree: Tree, pid: pid_t, truncated: Bool, modal: FBAccessibilityModalInfo?,
+    automation: FBAccessibilityAutomationState?
+  ) {
+    switch tree {
+    case let .attributes(attributes):
+      self.init(tree: attributes, pid: pid, truncated: truncated, modal: modal, automation: automation)
+    case let .element(root):
+      self.init(tree: [:], decodedRoot: root, pid: pid, truncated: truncated, modal: modal, automation: automation)
+    }
+  }
+
+  /// A response's tree as it arrived: parsed JSON, or decoded from a binary frame.
+  private enum Tree {
+    case attributes([String: Any])
+    case element(FBRemoteAutomationPlatformElement)
+  }
+
+  /// The envelope of a response, and the still-encoded tree when the guest sent the binary form. Nil when
+  /// the bytes are neither.
+  private static func envelope(fromResponse data: Data) -> (response: [String: Any], binary: FBAXWireBinary.Frame?)? {
+    let binary = FBAXWireBinary.isBinary(data) ? try? FBAXWireBinary.Frame(data) : nil
+    guard FBAXWireBinary.isBinary(data) == (binary != nil),
+      let object = try? JSONSerialization.jsonObject(with: binary?.envelope ?? data),
+      let response = object as? [String: Any]
+    else {
+      return nil
+    }
+    return (response, binary)
+  }
+
+  /// The tree an `ok` response carries, or nil when it carries none. A binary tree is decoded here, once the
+  /// envelope has named the process its elements belong to.
+  private static func tree(
+    fromResponse response: [String: Any],
+    binary: FBAXWireBinary.Frame?,
+    pid: pid_t
+  ) throws -> Tree? {
+    if let binary {
+      return .element(try binary.root(pid: pid))
+    }
+    return (response[FBAXWire.Envelope.tree.rawValue] as? [String: Any]).map(Tree.attributes)
+  }
+
   /// The guest's reported phases, or nil from a guest predating them.
   static func guestPhases(fromResponse response: [String: Any]) -> (traverse: CFAbsoluteTime?, machRoundTrips: Int64?) {
     guard let phases = response[FBAXWire.Envelope.phases.rawValue] as? [String: Any] else {
@@ -97,8 +146,8 @@ extension FBAXTreeRead {
   /// than "nothing there". `truncated` defaults to `false` when the guest omits it (an older guest, or
   /// a complete walk).
   init(wholeTreeResponse data: Data, pid: pid_t) throws {
-    let response = try Self.validatedResponse(fromResponse: data, pid: pid)
-    guard let tree = try Self.node(fromValidatedResponse: response, pid: pid) else {
+    let (response, binary) = try Self.validatedResponse(fromResponse: data, pid: pid)
+    guard let tree = try Self.node(fromValidatedResponse: response, binary: binary, pid: pid) else {
       throw FBAXBridgeError.guestFailure("pid \(pid): empty response to a whole-tree read")
     }
     let truncated = (response[FBAXWire.Envelope.truncated.rawValue] as? Bool) ?? false
@@ -118,22 +167,26 @@ extension FBAXTreeRead {
   /// (`guestFailure`). `method` is the strategy the caller selected, named in the error when the
   /// strategy itself is what could not answer.
   init(frontmostResponse data: Data, method: FBAXBridgeFrontmostMethod) throws {
-    guard let object = try? JSONSerialization.jsonObject(with: data), let response = object as? [String: Any] else {
+    guard let (response, binary) = Self.envelope(fromResponse: data) else {
       throw FBAXBridgeError.guestFailure("unparseable fused frontmost describe response")
     }
     guard (response[FBAXWire.Envelope.ok.rawValue] as? Bool) == true else {
       throw Self.failure(fromResponse: response, pid: nil, frontmostMethod: method)
     }
-    guard let tree = response[FBAXWire.Envelope.tree.rawValue] as? [String: Any] else {
-      throw FBAXBridgeError.guestFailure("fused frontmost describe response without a tree")
-    }
     // `exactly:` inside the guard, so a pid too large for a `pid_t` is a response the parser rejects
-    // rather than a value the conversion traps on.
+    // rather than a value the conversion traps on. Read before the tree, which a binary response builds
+    // into elements already tagged with it.
     guard let reported = response[FBAXWire.Envelope.pid.rawValue] as? Int,
       let pid = pid_t(exactly: reported), pid > 0
     else {
+      guard binary != nil || response[FBAXWire.Envelope.tree.rawValue] is [String: Any] else {
+        throw FBAXBridgeError.guestFailure("fused frontmost describe response without a tree")
+      }
       throw FBAXBridgeError.guestFailure("fused frontmost describe response without a resolved pid")
     }
+    guard let tree = try Self.tree(fromResponse: response, binary: binary, pid: pid) else {
+      throw FBAXBridgeError.guestFailure("fused frontmost describe response without a tree")
+    }
     let truncated = (response[FBAXWire.Envelope.truncated.rawValue] as? Bool) ?? false
     self.init(
       tree: tree, pid: pid, truncated: truncated, modal: Self.modal(fromResponse: response),
@@ -148,16 +201,49 @@ extension FBAXTreeRead {
   /// guest's kind, so a caller can tell empty space from an app that did not answer from a broken
   /// reader. A hit is a single element, so it carries no truncation flag or modal.
   init?(hitTestResponse data: Data) throws {
-    guard let object = try? JSONSerialization.jsonObject(with: data), let response = object as? [String: Any] else {
+    guard let (response, binary) = Self.envelope(fromResponse: data) else {
       throw FBAXBridgeError.guestFailure("unparseable hit-test response")
     }
+    try self.init(hitTestEnvelope: response, binary: binary)
+  }
+
+  /// Parses a `hittest-batch` response into one answer per point, in the order the points were sent.
+  /// Each is exactly what `init?(hitTestResponse:)` makes of a single hit-test there — a read, `nil` for
+  /// empty space, or the classified failure — so a point whose application did not answer fails that
+  /// point and not its neighbours.
+  ///
+  /// `nil` when the guest refused the batch as a bad request, which is how a guest predating the verb
+  /// answers it; the caller can still hit-test the points one at a time. Any other failure of the batch
+  /// as a whole throws, as does an answer for a different number of points than were asked about.
+  static func hitTests(fromBatchResponse data: Data, count: Int) throws -> [Result<FBAXTreeRead?, Error>]? {
+    guard let (response, _) = envelope(fromResponse: data) else {
+      throw FBAXBridgeError.guestFailure("unparseable hit-test batch response")
+    }
+    guard (response[FBAXWire.Envelope.ok.rawValue] as? Bool) == true else {
+      if (response[FBAXWire.Envelope.errorKind.rawValue] as? String) == FBAXWire.ErrorKind.badRequest.rawValue {
+        return nil
+      }
+      throw Self.failure(fromResponse: response, pid: nil, frontmostMethod: nil)
+    }
+    // Only a response carrying a tree is ever binary, and a batch carries its trees inside `results`, so
+    // each one is a JSON envelope whatever the connection negotiated.
+    guard let results = response[FBAXWire.Envelope.results.rawValue] as? [[String: Any]], results.count == count else {
+      throw FBAXBridgeError.guestFailure("hit-test batch response does not answer each of its \(count) points")
+    }
+    return results.map { result in
+      Result { try FBAXTreeRead(hitTestEnvelope: result, binary: nil) }
+    }
+  }
+
+  /// A hit-test read from its parsed envelope, shared by the single and batch parsers.
+  private init?(hitTestEnvelope response: [String: Any], binary: FBAXWireBinary.Frame?) throws {
     guard (response[FBAXWire.Envelope.ok.rawValue] as? Bool) == true else {
       throw Self.failure(fromResponse: response, pid: nil, frontmostMethod: nil)
     }
     if (response[FBAXWire.Envelope.empty.rawValue] as? Bool) == true {
       return nil
     }
-    guard let node = response[FBAXWire.Envelope.tree.rawValue] as? [String: Any] else {
+    guard binary != nil || response[FBAXWire.Envelope.tree.rawValue] is [String: Any] else {
       throw FBAXBridgeError.guestFailure("hit-test ok response without a tree or empty flag")
     }
     guard let reported = response[FBAXWire.Envelope.pid.rawValue] as? Int,
@@ -165,7 +251,10 @@ extension FBAXTreeRead {
     else {
       throw FBAXBridgeError.guestFailure("hit-test response without an owning pid")
     }
-    self.init(tree: node, pid: pid, truncated: false, modal: nil)
+    guard let node = try Self.tree(fromResponse: response, binary: binary, pid: pid) else {
+      throw FBAXBridgeError.guestFailure("hit-test ok response without a tree or empty flag")
+    }
+    self.init(tree: node, pid: pid, truncated: false, modal: nil, automation: nil)
   }
 
   /// Parses a write envelope (`perform` or `setvalue`), answering whether the write landed or found
@@ -177,7 +266,7 @@ extension FBAXTreeRead {
   /// application that has gone, or is not answering, means the same thing whether the request read or
   /// wrote, and classifying it twice is how the two would come to disagree.
   static func writeLanded(fromResponse data: Data) throws -> Bool {
-    guard let object = try? JSONSerialization.jsonObject(with: data), let response = object as? [String: Any] else {
+    guard let (response, _) = envelope(fromResponse: data) else {
       throw FBAXBridgeError.guestFailure("unparseable write response")
     }
     guard (response[FBAXWire.Envelope.ok.rawValue] as? Bool) == true else {
@@ -201,14 +290,17 @@ extension FBAXTreeRead {
 
   /// Parses the guest JSON and validates its `ok`/error framing, returning the top-level response
   /// dictionary of a successful response. A failed response throws whatever the guest's kind says it is.
-  private static func validatedResponse(fromResponse data: Data, pid: pid_t) throws -> [String: Any] {
-    guard let object = try? JSONSerialization.jsonObject(with: data), let response = object as? [String: Any] else {
+  private static func validatedResponse(
+    fromResponse data: Data,
+    pid: pid_t
+  ) throws -> (response: [String: Any], binary: FBAXWireBinary.Frame?) {
+    guard let (response, binary) = envelope(fromResponse: data) else {
       throw FBAXBridgeError.guestFailure("pid \(pid): unparseable guest response")
     }
     guard (response[FBAXWire.Envelope.ok.rawValue] as? Bool) == true else {
       throw Self.failure(fromResponse: response, pid: pid, frontmostMethod: nil)
     }
-    return response
+    return (response, binary)
   }
 
   /// The typed error a failed guest response means, from the kind the guest tagged it with.
@@ -266,11 +358,15 @@ extension FBAXTreeRead {
 
   /// The node a successful response carries, or `nil` for a successful *empty* result
   /// (`{ ok: true, empty: true }`) — which only a hit-test produces.
-  private static func node(fromValidatedResponse response: [String: Any], pid: pid_t) throws -> [String: Any]? {
+  private static func node(
+    fromValidatedResponse response: [String: Any],
+    binary: FBAXWireBinary.Frame?,
+    pid: pid_t
+  ) throws -> Tree? {
     if (response[FBAXWire.Envelope.empty.rawValue] as? Bool) == true {
       return nil
     }
-    guard let tree = response[FBAXWire.Envelope.tree.rawValue] as? [String: Any] else {
+    guard let tree = try tree(fromResponse: response, binary: binary, pid: pid) else {
       throw FBAXBridgeError.guestFailure("pid \(pid): ok response without a tree or empty flag")
     }
     return tree
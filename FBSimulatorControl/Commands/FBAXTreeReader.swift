@@ -154,9 +154,7 @@ extension FBAXTreeReader {
       // A marker read walks the whole tree to find one element, so it costs the same per-node
       // hit-testing a describe-all does while returning far less.
       await warnIfReachabilityAcrossTree(markerKeys)
-      let elements = FBAXTreeWalk.describeAllElements(
-        fromTree: read.tree, keys: markerKeys, nestedFormat: false, pid: read.pid
-      )
+      let elements = FBAXTreeWalk.describeAllElements(fromRead: read, keys: markerKeys, nestedFormat: false)
       guard let match = FBAXTreeWalk.matchingElement(inElements: elements, markerValue: value, key: key) else {
         throw FBUIAutomationError.elementNotFound(backend: backend, key: key.rawValue, value: value)
       }
@@ -167,7 +165,7 @@ extension FBAXTreeReader {
         .withProvenance(
           backend: backend.name,
           target: query.targetDescriptor,
-          screen: FBAXTreeWalk.screenInfo(fromTree: read.tree),
+          screen: FBAXTreeWalk.screenInfo(fromRead: read),
           truncated: read.truncated
         )
     case .frontmost, .application:
@@ -196,9 +194,9 @@ extension FBAXTreeReader {
       await warnIfReachabilityAcrossTree(options.serializationKeys)
       let serializeStarted = CFAbsoluteTimeGetCurrent()
       let walked = FBAXTreeWalk.describeAllElements(
-        fromTree: read.tree, keys: options.serializationKeys, nestedFormat: options.nestedFormat, pid: read.pid
+        fromRead: read, keys: options.serializationKeys, nestedFormat: options.nestedFormat
       )
-      let screen = FBAXTreeWalk.screenInfo(fromTree: read.tree)
+      let screen = FBAXTreeWalk.screenInfo(fromRead: read)
       let elements = try await refiningInteractable(
         options.filter.apply(to: walked), screen: screen, options: options
       )
@@ -360,10 +358,9 @@ extension FBAXTreeReader {
       // Unfiltered, like the marker branch of `describeTree`: a write resolves the element the caller
       // named, and a caller's `--filter` is about what a read reports, not about what exists to act on.
       let elements = FBAXTreeWalk.describeAllElements(
-        fromTree: read.tree,
+        fromRead: read,
         keys: FBAXKeys.defaultSet.union([key.serializationKey]),
-        nestedFormat: false,
-        pid: read.pid
+        nestedFormat: false
       )
       guard let match = FBAXTreeWalk.matchingElement(inElements: elements, markerValue: value, key: key) else {
         throw FBUIAutomationError.elementNotFound(backend: backend, key: key.rawValue, value: value)
@@ -24,15 +24,72 @@ enum FBAXTreeWalk {
   /// caller that wants the whole tree as well as the reported subset — a coverage calculation, say —
   /// can have both from one walk.
   static func describeAllElements(fromTree tree: [String: Any], keys: Set<FBAXKeys>, nestedFormat: Bool, pid: pid_t) -> [FBAccessibilityDocumentElement] {
-    let root = buildPlatformElementTree(from: tree, pid: pid)
-    return FBAXNodeSerializer.recursiveDescription(
-      fromElement: root,
-      token: "",
-      nestedFormat: nestedFormat,
-      keys: keys,
-      collector: nil,
-      seenPids: nil
-    )
+    describeAllElements(fromRoot: buildPlatformElementTree(from: tree, pid: pid), keys: keys, nestedFormat: nestedFormat)
+  }
+
+  /// Serializes a guest read, from whichever form its tree arrived in. A binary response was decoded
+  /// straight into elements, so it goes to the serializer without an attribute-dictionary pass.
+  static func describeAllElements(fromRead read: FBAXTreeRead, keys: Set<FBAXKeys>, nestedFormat: Bool) -> [FBAccessibilityDocumentElement] {
+    describeAllElements(fromRoot: rootElement(of: read), keys: keys, nestedFormat: nestedFormat)
+  }
+
+  /// The element tree a guest read describes: the decoded one when the guest sent it, else one built
+  /// from the parsed JSON.
+  static func rootElement(of read: FBAXTreeRead) -> FBRemoteAutomationPlatformElement {
+    read.decodedRoot ?? buildPlatformElementTree(from: read.tree, pid: read.pid)
+  }
+
+  /// Subtrees with fewer nodes than this are serialized on the calling thread, where handing them to
+  /// another would cost more than it saves.
+  static let concurrentSubtreeThreshold = 256
+
+  private static func describeAllElements(fromRoot root: FBRemoteAutomationPlatformElement, keys: Set<FBAXKeys>, nestedFormat: Bool) -> [FBAccessibilityDocumentElement] {
+    var subtreeSizes: [ObjectIdentifier: Int] = [:]
+    countNodes(root, into: &subtreeSizes)
+    return describeSubtree(root, keys: keys, nestedFormat: nestedFormat, subtreeSizes: subtreeSizes)
+  }
+
+  /// Serializes `element`'s subtree, its children's subtrees concurrently when there are several and
+  /// enough nodes beneath them to be worth it. An already-read tree is immutable and reading it makes no
+  /// XPC calls, so its subtrees can be serialized on any thread; the live translator tree cannot, and
+  /// never comes here. Each child's output is put back in its place, so the result is the serial walk's.
+  private static func describeSubtree(
+    _ element: FBRemoteAutomationPlatformElement,
+    keys: Set<FBAXKeys>,
+    nestedFormat: Bool,
+    subtreeSizes: [ObjectIdentifier: Int]
+  ) -> [FBAccessibilityDocumentElement] {
+    let children = element.children
+    guard children.count > 1, subtreeSizes[ObjectIdentifier(element), default: 0] >= concurrentSubtreeThreshold else {
+      return FBAXNodeSerializer.recursiveDescription(
+        fromElement: element,
+        token: "",
+        nestedFormat: nestedFormat,
+        keys: keys,
+        collector: nil,
+        seenPids: nil
+      )
+    }
+    let described = FBConcurrentCollectionOperations.map(children) { child in
+      describeSubtree(child as! FBRemoteAutomationPlatformElement, keys: keys, nestedFormat: nestedFormat, subtreeSizes: subtreeSizes)
+    }
+    let descendants = described.flatMap { $0 as! [FBAccessibilityDocumentElement] }
+    var node = FBAXNodeSerializer.decoratedElement(forElement: element, token: "", keys: keys, collector: nil, seenPids: nil, isRemote: false)
+    guard nestedFormat else {
+      return [node] + descendants
+    }
+    node.children = descendants
+    return [node]
+  }
+
+  @discardableResult
+  private static func countNodes(_ element: FBRemoteAutomationPlatformElement, into sizes: inout [ObjectIdentifier: Int]) -> Int {
+    var count = 1
+    for child in element.children {
+      count += countNodes(child, into: &sizes)
+    }
+    sizes[ObjectIdentifier(element)] = count
+    return count
   }
 
   /// The bounds a whole-tree read's frames are relative to, taken from the root node's own frame — for
@@ -42,7 +99,18 @@ enum FBAXTreeWalk {
   /// Reads the frame through the same element type the serializer uses, so this cannot disagree with
   /// the frames on the elements it describes.
   static func screenInfo(fromTree tree: [String: Any]) -> FBAccessibilityScreenInfo? {
-    let root = FBRemoteAutomationPlatformElement(attributes: tree, children: [], pid: 0)
+    screenInfo(fromRoot: FBRemoteAutomationPlatformElement(attributes: tree, children: [], pid: 0))
+  }
+
+  /// `screenInfo(fromTree:)` for a guest read, in whichever form its tree arrived.
+  static func screenInfo(fromRead read: FBAXTreeRead) -> FBAccessibilityScreenInfo? {
+    if let root = read.decodedRoot {
+      return screenInfo(fromRoot: root)
+    }
+    return screenInfo(fromTree: read.tree)
+  }
+
+  private static func screenInfo(fromRoot root: FBRemoteAutomationPlatformElement) -> FBAccessibilityScreenInfo? {
     let frame = root.axFrame()
     guard frame.width > 0, frame.height > 0 else {
       return nil
@@ -129,6 +129,39 @@ enum FBAXWire {
     case modal
     case automation
     case phases
+    /// The response encoding a `negotiate` settled on for the rest of the connection.
+    case encoding
+    /// The frame header a `negotiate` settled on for the rest of the connection.
+    case framing
+    /// A `hittest-batch` response's per-point answers, in the order the points were sent. Each is the
+    /// envelope a single `hittest` at that point would have answered, failures included.
+    case results
+  }
+
+  /// The response encodings a persistent connection can negotiate. Requests are always JSON; only a
+  /// response carrying a tree is ever sent any other way, because the tree is the only part large
+  /// enough to be worth it.
+  ///
+  /// A connection is JSON until a `negotiate` says otherwise, and a guest predating the verb answers it
+  /// as an unsupported one — so an older guest is simply read as JSON.
+  enum Encoding: String, CaseIterable {
+    case json
+    /// `FBAXWireBinary`: the envelope as JSON, the tree in a compact binary form.
+    case binary = "binary-v1"
+  }
+
+  /// The frame headers a persistent connection can negotiate. Every connection starts on `length`: a
+  /// 4-byte big-endian payload length. `lengthAndId` follows it with a 4-byte big-endian request id that
+  /// the guest echoes on the response, so a host with several requests in flight can tell whose answer
+  /// arrived without parsing it.
+  ///
+  /// The id lives in the header rather than the envelope because the envelope of a tree read is most of
+  /// the frame, and the host would otherwise parse it once to route it and again to read it. A guest
+  /// predating the field keeps `length`; it answers strictly in order, so the host routes its frames by
+  /// position instead.
+  enum Framing: String, CaseIterable {
+    case length
+    case lengthAndId = "length-id"
   }
 
   /// Keys of the envelope's `phases` object — what the guest measured of its own work. The host's own
@@ -175,6 +208,13 @@ enum FBAXWire {
     case setValue = "setvalue"
     /// Asks a persistent `serve` guest to exit. Only a `serve` process has anything to answer.
     case shutdown
+    /// Settles the response encoding for the rest of a `serve` connection, from the ones the host offers
+    /// in `Request.encodings`, and the frame header from the ones it offers in `Request.framings`.
+    case negotiate
+    /// Hit-tests every point in `Request.points` in one round trip, answering each as `hittest` would.
+    /// Exists for callers that probe many points in a row — a coverage grid looking for remote content —
+    /// which would otherwise pay a round trip apiece.
+    case hitTestBatch = "hittest-batch"
   }
 
   /// The fields of a request, in both spellings the guest accepts them in.
@@ -207,6 +247,13 @@ enum FBAXWire {
     case value
     case assertKey
     case assertValue
+    /// The response encodings a `negotiate` offers, most preferred first, as `Encoding` raw values.
+    case encodings
+    /// The frame headers a `negotiate` offers, most preferred first, as `Framing` raw values.
+    case framings
+    /// A `hittest-batch`'s points: `[x, y]` pairs over the socket, and `x,y;x,y` on argv, which takes
+    /// each field as a single value.
+    case points
 
     /// The JSON object key the persistent transport sends this field under.
     var key: String { rawValue }
@@ -231,6 +278,9 @@ enum FBAXWire {
       case .value: "--value"
       case .assertKey: "--assert-key"
       case .assertValue: "--assert-value"
+      case .encodings: "--encodings"
+      case .framings: "--framings"
+      case .points: "--points"
       }
     }
 
@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import FBControlCore
+import Foundation
+
+/// The binary form of a guest response, sent on a `serve` connection that negotiated
+/// `FBAXWire.Encoding.binary`. The guest's encoder is `FBAXBridgeSerializeBinaryResponse` in
+/// `SimulatorFrameworkBridge/AccessibilityService.m`; the two share no header, so the layout below is the
+/// contract, and both sides change together or not at all.
+///
+/// In JSON every node repeats each `XC_kAXXCAttribute*` key in full, a screen of table cells repeats the
+/// same few types and labels hundreds of times, and the host parses all of it into dictionaries only to
+/// walk them once. Here each key and each string crosses the wire once per response and is named by index
+/// after that, and the host decodes the tree straight into `FBRemoteAutomationPlatformElement`s.
+///
+///     frame    := magic envelope keys strings node
+///     magic    := "FBAX" 0x01
+///     envelope := varint length, then the response envelope as JSON, without its `tree`
+///     keys     := varint count, then each key as a varint length and its UTF-8 bytes
+///     strings  := the same, for string values
+///     node     := varint count, then count × (varint key index, value),
+///                 then varint count, then count × node for the children
+///     value    := a `Tag` byte, then its payload
+///
+/// Varints are unsigned LEB128 and integers are zigzag-encoded first. Doubles are little-endian IEEE 754,
+/// so geometry keeps the non-finite coordinates JSON can only send as null.
+///
+/// Only the tree is binary. The envelope is a few hundred bytes whatever the screen, and keeping it JSON
+/// keeps every envelope field and failure kind parsed by the one parser in `FBAXTreeRead`.
+enum FBAXWireBinary {
+
+  /// The first bytes of a binary response. JSON cannot begin with them, which is what lets a reader tell
+  /// the two apart without being told which was negotiated.
+  static let magic = Data("FBAX".utf8) + Data([1])
+
+  /// The deepest nesting a frame may carry, counting elements and the arrays and dictionaries inside their
+  /// values alike. The guest bounds its walk far below this; the cap is here so a corrupt frame cannot
+  /// recurse the host off its stack.
+  static let maxDepth = 512
+
+  enum Tag: UInt8 {
+    case null = 0
+    case `false` = 1
+    case `true` = 2
+    /// A zigzag varint.
+    case integer = 3
+    case double = 4
+    /// A varint index into the string table.
+    case string = 5
+    /// Four doubles: x, y, width, height. Only under `FBAXWire.Node.frame`.
+    case rect = 6
+    /// Two doubles: x, y. Only under the point attributes.
+    case point = 7
+    /// An element's attributes without a child list. Only under `FBAXWire.Node.explainedBy`.
+    case element = 8
+    /// A varint count, then that many values.
+    case array = 9
+    /// A varint count, then that many (varint key index, value) pairs.
+    case dictionary = 10
+  }
+
+  static func isBinary(_ data: Data) -> Bool {
+    data.starts(with: magic)
+  }
+
+  // MARK: - Decoded attributes
+
+  /// The attribute keys of one frame, shared by every element decoded from it.
+  final class KeyTable {
+    let names: [String]
+    let indices: [String: Int]
+
+    init(names: [String]) {
+      self.names = names
+      // A frame that names a key twice is malformed, but harmless: the first index wins and the other is
+      // never looked up.
+      indices = Dictionary(names.enumerated().map { ($1, $0) }, uniquingKeysWith: { first, _ in first })
+    }
+  }
+
+  /// One element's attributes as the frame carried them: indices into the frame's key table rather than a
+  /// dictionary per element. An element has a dozen attributes at most, so a scan finds one as quickly as
+  /// a hash would.
+  struct Attributes {
+    let keys: KeyTable
+    let entries: [(key: Int, value: Any)]
+
+    subscript(key: String) -> Any? {
+      guard let index = keys.indices[key] else {
+        return nil
+      }
+      return entries.first { $0.key == index }?.value
+    }
+  }
+
+  // MARK: - Decoding
+
+  /// A binary response, split into its envelope and its still-encoded tree. The tree is decoded only once
+  /// the envelope has said the read succeeded and which process it belongs to.
+  struct Frame {
+    let envelope: Data
+    private let data: Data
+    private let treeOffset: Int
+
+    init(_ data: Data) throws {
+      guard FBAXWireBinary.isBinary(data) else {
+        throw FBAXWireBinary.malformed("missing magic")
+      }
+      // Offsets are into the buffer `withUnsafeBytes` hands over, which starts at this response's first
+      // byte whatever slice of a larger buffer `data` is.
+      let (envelope, treeOffset) = try data.withUnsafeBytes { bytes -> (Data, Int) in
+        var reader = Reader(bytes: bytes, offset: FBAXWireBinary.magic.count)
+        let length = try reader.count()
+        let envelope = Data(bytes[reader.offset..<(reader.offset + length)])
+        reader.offset += length
+        return (envelope, reader.offset)
+      }
+      self.envelope = envelope
+      self.data = data
+      self.treeOffset = treeOffset
+    }
+
+    /// Decodes the tree into elements, every one tagged with the owning application's `pid`.
+    func root(pid: pid_t) throws -> FBRemoteAutomationPlatformElement {
+      try data.withUnsafeBytes { bytes in
+        var reader = Reader(bytes: bytes, offset: treeOffset)
+        let keys = KeyTable(names: try reader.table())
+        let strings = try reader.table()
+        var decoder = Decoder(reader: reader, keys: keys, strings: strings, pid: pid)
+        let root = try decoder.element(depth: 0)
+        guard decoder.reader.offset == bytes.count else {
+          throw FBAXWireBinary.malformed("\(bytes.count - decoder.reader.offset) bytes after the tree")
+        }
+        return root
+      }
+    }
+  }
+
+  fileprivate static func malformed(_ reason: String) -> FBAXBridgeError {
+    .guestFailure("malformed binary response: \(reason)")
+  }
+
+  private struct Reader {
+    let bytes: UnsafeRawBufferPointer
+    var offset: Int
+
+    mutating func byte() throws -> UInt8 {
+      guard offset < bytes.count else {
+        throw FBAXWireBinary.malformed("truncated at byte \(offset)")
+      }
+      defer { offset += 1 }
+      return bytes[offset]
+    }
+
+    mutating func varint() throws -> UInt64 {
+      var value: UInt64 = 0
+      var shift: UInt64 = 0
+      while true {
+        let byte = try self.byte()
+        guard shift < 64 else {
+          throw FBAXWireBinary.malformed("overlong varint at byte \(offset)")
+        }
+        value |= UInt64(byte & 0x7f) << shift
+        if byte & 0x80 == 0 {
+          return value
+        }
+        shift += 7
+      }
+    }
+
+    /// A length or element count. Nothing in a frame takes less than a byte, so a count larger than the
+    /// bytes left is a corrupt frame rather than an allocation to attempt.
+    mutating func count() throws -> Int {
+      let value = try varint()
+      guard value <= UInt64(bytes.count - offset) else {
+        throw FBAXWireBinary.malformed("count \(value) exceeds the \(bytes.count - offset) bytes left")
+      }
+      return Int(value)
+    }
+
+    mutating func index(below count: Int) throws -> Int {
+      let value = try varint()
+      guard value < UInt64(count) else {
+        throw FBAXWireBinary.malformed("index \(value) outside a table of \(count)")
+      }
+      return Int(value)
+    }
+
+    mutating func double() throws -> Double {
+      guard offset + 8 <= bytes.count else {
+        throw FBAXWireBinary.malformed("truncated double at byte \(offset)")
+      }
+      let bits = bytes.loadUnaligned(fromByteOffset: offset, as: UInt64.self)
+      offset += 8
+      return Double(bitPattern: UInt64(littleEndian: bits))
+    }
+
+    mutating func table() throws -> [String] {
+      let count = try self.count()
+      var table: [String] = []
+      table.reserveCapacity(count)
+      for _ in 0..<count {
+        let length = try self.count()
+        table.append(String(decoding: UnsafeRawBufferPointer(rebasing: bytes[offset..<(offset + length)]), as: UTF8.self))
+        offset += length
+      }
+      return table
+    }
+  }
+
+  private struct Decoder {
+    var reader: Reader
+    let keys: KeyTable
+    let strings: [String]
+    let pid: pid_t
+
+    mutating func element(depth: Int) throws -> FBRemoteAutomationPlatformElement {
+      guard depth <= FBAXWireBinary.maxDepth else {
+        throw FBAXWireBinary.malformed("elements nested deeper than \(FBAXWireBinary.maxDepth)")
+      }
+      let attributes = try self.attributes(depth: depth)
+      let count = try reader.count()
+      var children: [FBRemoteAutomationPlatformElement] = []
+      children.reserveCapacity(count)
+      for _ in 0..<count {
+        children.append(try element(depth: depth + 1))
+      }
+      return FBRemoteAutomationPlatformElement(decoded: attributes, children: children, pid: pid)
+    }
+
+    mutating func attributes(depth: Int) throws -> Attributes {
+      let count = try reader.count()
+      var entries: [(key: Int, value: Any)] = []
+      entries.reserveCapacity(count)
+      for _ in 0..<count {
+        let key = try reader.index(below: keys.names.count)
+        entries.append((key, try value(depth: depth)))
+      }
+      return Attributes(keys: keys, entries: entries)
+    }
+
+    /// A value, as the Foundation type JSON would have parsed it to, so an element reads the same whichever
+    /// encoding carried it. Geometry arrives as the `NSValue` the element's accessors already accept.
+    mutating func value(depth: Int) throws -> Any {
+      let raw = try reader.byte()
+      guard let tag = Tag(rawValue: raw) else {
+        throw FBAXWireBinary.malformed("unknown tag \(raw) at byte \(reader.offset - 1)")
+      }
+      switch tag {
+      case .null:
+        return NSNull()
+      case .false:
+        return NSNumber(value: false)
+      case .true:
+        return NSNumber(value: true)
+      case .integer:
+        let zigzag = try reader.varint()
+        return NSNumber(value: Int64(bitPattern: zigzag >> 1) ^ -Int64(bitPattern: zigzag & 1))
+      case .double:
+        return NSNumber(value: try reader.double())
+      case .string:
+        return strings[try reader.index(below: strings.count)]
+      case .rect:
+        let x = try reader.double(), y = try reader.double()
+        let width = try reader.double(), height = try reader.double()
+        return NSValue(rect: NSRect(x: x, y: y, width: width, height: height))
+      case .point:
+        let x = try reader.double(), y = try reader.double()
+        return NSValue(point: NSPoint(x: x, y: y))
+      case .element:
+        return try attributes(depth: nested(depth))
+      case .array:
+        let depth = try nested(depth)
+        let count = try reader.count()
+        var array: [Any] = []
+        array.reserveCapacity(count)
+        for _ in 0..<count {
+          array.append(try value(depth: depth))
+        }
+        return array
+      case .dictionary:
+        let depth = try nested(depth)
+        let count = try reader.count()
+        var dictionary: [String: Any] = [:]
+        for _ in 0..<count {
+          let key = keys.names[try reader.index(below: keys.names.count)]
+          dictionary[key] = try value(depth: depth)
+        }
+        return dictionary
+      }
+    }
+
+    /// The depth of a value nested one level inside another at `depth`. Arrays and dictionaries count as
+    /// well as elements: any of them can be nested without a child list.
+    private func nested(_ depth: Int) throws -> Int {
+      guard depth < FBAXWireBinary.maxDepth else {
+        throw FBAXWireBinary.malformed("values nested deeper than \(FBAXWireBinary.maxDepth)")
+      }
+      return depth + 1
+    }
+  }
+
+  // MARK: - Encoding
+
+  /// Encodes a response as the guest does: the envelope as JSON, and its `tree` in the binary form. A
+  /// response without a tree has nothing worth encoding, and stays JSON.
+  ///
+  /// The guest's encoder is the one that runs in production. This mirrors it over the same Foundation
+  /// values, so the host's decoding can be tested and measured against frames shaped like the guest's
+  /// without a guest to produce them.
+  static func encode(response: [String: Any]) throws -> Data {
+    guard let tree = response[FBAXWire.Envelope.tree.rawValue] as? [String: Any] else {
+      return try JSONSerialization.data(withJSONObject: response)
+    }
+    var envelope = response
+    envelope[FBAXWire.Envelope.tree.rawValue] = nil
+    let envelopeData = try JSONSerialization.data(withJSONObject: envelope)
+
+    var encoder = Encoder()
+    encoder.node(tree)
+    var data = magic
+    Encoder.varint(UInt64(envelopeData.count), into: &data)
+    data.append(envelopeData)
+    Encoder.table(encoder.keys.order, into: &data)
+    Encoder.table(encoder.strings.order, into: &data)
+    data.append(encoder.nodes)
+    return data
+  }
+
+  private struct Interner {
+    var order: [String] = []
+    var indices: [String: Int] = [:]
+
+    mutating func index(of string: String) -> Int {
+      if let index = indices[string] {
+        return index
+      }
+      indices[string] = order.count
+      order.append(string)
+      return order.count - 1
+    }
+  }
+
+  private struct Encoder {
+    var keys = Interner()
+    var strings = Interner()
+    var nodes = Data()
+
+    static func varint(_ value: UInt64, into data: inout Data) {
+      var value = value
+      repeat {
+        let byte = UInt8(value & 0x7f)
+        value >>= 7
+        data.append(value == 0 ? byte : byte | 0x80)
+      } while value != 0
+    }
+
+    static func double(_ value: Double, into data: inout Data) {
+      withUnsafeBytes(of: value.bitPattern.littleEndian) { data.append(contentsOf: $0) }
+    }
+
+    static func table(_ table: [String], into data: inout Data) {
+      varint(UInt64(table.count), into: &data)
+      for string in table {
+        let bytes = Data(string.utf8)
+        varint(UInt64(bytes.count), into: &data)
+        data.append(bytes)
+      }
+    }
+
+    mutating func node(_ node: [String: Any]) {
+      attributes(node)
+      let children = (node[FBAXWire.Node.children.rawValue] as? [Any] ?? []).compactMap { $0 as? [String: Any] }
+      Self.varint(UInt64(children.count), into: &nodes)
+      for child in children {
+        self.node(child)
+      }
+    }
+
+    mutating func attributes(_ node: [String: Any]) {
+      let attributes = node.filter { $0.key != FBAXWire.Node.children.rawValue }
+      Self.varint(UInt64(attributes.count), into: &nodes)
+      for (key, value) in attributes {
+        Self.varint(UInt64(keys.index(of: key)), into: &nodes)
+        self.value(value, key: key)
+      }
+    }
+
+    mutating func value(_ value: Any, key: String?) {
+      switch value {
+      case let string as String:
+        tag(.string)
+        Self.varint(UInt64(strings.index(of: string)), into: &nodes)
+      case let number as NSNumber:
+        if CFGetTypeID(number) == CFBooleanGetTypeID() {
+          tag(number.boolValue ? .true : .false)
+        } else if CFNumberIsFloatType(number) {
+          // As the JSON sanitizer would: only geometry may carry a non-finite number.
+          guard number.doubleValue.isFinite else {
+            tag(.null)
+            return
+          }
+          tag(.double)
+          Self.double(number.doubleValue, into: &nodes)
+        } else {
+          let integer = number.int64Value
+          tag(.integer)
+          Self.varint(UInt64(bitPattern: (integer << 1) ^ (integer >> 63)), into: &nodes)
+        }
+      case let dictionary as [String: Any]:
+        self.dictionary(dictionary, key: key)
+      case let array as [Any]:
+        tag(.array)
+        Self.varint(UInt64(array.count), into: &nodes)
+        for element in array {
+          self.value(element, key: nil)
+        }
+      default:
+        tag(.null)
+      }
+    }
+
+    /// A dictionary by the key it is under, as the guest's coercion recognises geometry: a value that only
+    /// happens to have the shape of a rectangle is not reinterpreted as one.
+    mutating func dictionary(_ dictionary: [String: Any], key: String?) {
+      var rect = CGRect.zero
+      var point = CGPoint.zero
+      if key == FBAXWire.Node.frame.rawValue,
+        CGRectMakeWithDictionaryRepresentation(Self.restoringNonFinite(dictionary) as CFDictionary, &rect)
+      {
+        tag(.rect)
+        for component in [rect.origin.x, rect.origin.y, rect.size.width, rect.size.height] {
+          Self.double(Double(component), into: &nodes)
+        }
+      } else if key == FBAXWire.Node.visiblePoint.rawValue || key == FBAXWire.Node.centerPoint.rawValue,
+        CGPointMakeWithDictionaryRepresentation(dictionary as CFDictionary, &point)
+      {
+        tag(.point)
+        Self.double(Double(point.x), into: &nodes)
+        Self.double(Double(point.y), into: &nodes)
+      } else if key == FBAXWire.Node.explainedBy.rawValue {
+        tag(.element)
+        attributes(dictionary)
+      } else {
+        tag(.dictionary)
+        Self.varint(UInt64(dictionary.count), into: &nodes)
+        for (key, value) in dictionary {
+          Self.varint(UInt64(keys.index(of: key)), into: &nodes)
+          self.value(value, key: key)
+        }
+      }
+    }
+
+    /// A frame recorded as JSON carries its non-finite edges as null; the guest encodes from the
+    /// rectangle itself, which still has them.
+    private static func restoringNonFinite(_ dictionary: [String: Any]) -> [String: Any] {
+      dictionary.mapValues { $0 is NSNull ? NSNumber(value: Double.infinity) : $0 }
+    }
+
+    private mutating func tag(_ tag: Tag) {
+      nodes.append(tag.rawValue)
+    }
+  }
+}
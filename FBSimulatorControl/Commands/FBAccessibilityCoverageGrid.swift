@@ -16,6 +16,10 @@ import Foundation
 /// Filled from a serialized read rather than during the walk that produced it, so every backend gets
 /// the same calculation from the same input. It stays mutable because remote-content discovery marks
 /// into a live grid as it hit-tests, and asks it which points are already covered.
+///
+/// Cells are bits, a row at a time in whole 64-bit words, so a frame is marked a word per row rather
+/// than a cell at a time. The filled count is kept as cells are marked — the popcount of the bits each
+/// word gains — so the ratio is read without a rescan however often discovery asks for it.
 final class FBAccessibilityCoverageGrid {
 
   let screenBounds: CGRect
@@ -23,7 +27,12 @@ final class FBAccessibilityCoverageGrid {
   let width: UInt
   let height: UInt
 
-  private var grid: [UInt8]
+  /// Row-major; each row starts on a word boundary, and the bits past `width` in its last word stay clear.
+  private var words: [UInt64]
+  private let wordsPerRow: Int
+
+  /// Cells marked filled so far.
+  private(set) var filledCellCount = 0
 
   /// Default grid cell size in points.
   static let defaultCellSize: CGFloat = 10.0
@@ -41,7 +50,9 @@ final class FBAccessibilityCoverageGrid {
     self.cellSize = resolvedCellSize
     self.width = computedWidth
     self.height = computedHeight
-    self.grid = [UInt8](repeating: 0, count: Int(computedWidth * computedHeight))
+    let computedWordsPerRow = (Int(computedWidth) + 63) / 64
+    self.wordsPerRow = computedWordsPerRow
+    self.words = [UInt64](repeating: 0, count: computedWordsPerRow * Int(computedHeight))
   }
 
   /// Mark cells covered by the given frame.
@@ -70,25 +81,34 @@ final class FBAccessibilityCoverageGrid {
       return
     }
 
-    let rowWidth = Int(width)
     for y in minY...maxY {
-      let rowStart = y * rowWidth
-      for x in minX...maxX {
-        grid[rowStart + x] = 1
-      }
+      filledCellCount += Self.fillSpan(&words, rowStart: y * wordsPerRow, first: minX, last: maxX)
     }
   }
 
   /// Whether the cell containing the given point is filled. NO if empty or out of bounds.
   func isFilled(at point: CGPoint) -> Bool {
-    let relativeX = point.x - screenBounds.origin.x
-    let relativeY = point.y - screenBounds.origin.y
-    let cellX = Int(floor(relativeX / cellSize))
-    let cellY = Int(floor(relativeY / cellSize))
-    guard cellX >= 0, cellX < Int(width), cellY >= 0, cellY < Int(height) else {
+    guard let column = column(containing: point.x), let row = row(containing: point.y) else {
       return false
     }
-    return grid[cellY * Int(width) + cellX] != 0
+    return isFilled(column: column, row: row)
+  }
+
+  /// Whether the cell at `column`, `row` is filled. Both must be on the grid.
+  func isFilled(column: Int, row: Int) -> Bool {
+    words[row * wordsPerRow + (column >> 6)] & (1 << UInt64(column & 63)) != 0
+  }
+
+  /// The column of the cell containing screen coordinate `x`, or nil when it is off the grid.
+  func column(containing x: CGFloat) -> Int? {
+    let column = Int(floor((x - screenBounds.origin.x) / cellSize))
+    return column >= 0 && column < Int(width) ? column : nil
+  }
+
+  /// The row of the cell containing screen coordinate `y`, or nil when it is off the grid.
+  func row(containing y: CGFloat) -> Int? {
+    let row = Int(floor((y - screenBounds.origin.y) / cellSize))
+    return row >= 0 && row < Int(height) ? row : nil
   }
 
   /// Mark every element's frame, and its descendants'.
@@ -136,10 +156,132 @@ final class FBAccessibilityCoverageGrid {
     guard totalCells > 0 else {
       return -1
     }
-    let filledCells = grid.reduce(into: 0) { count, cell in
-      if cell != 0 { count += 1 }
+    return CGFloat(filledCellCount) / CGFloat(totalCells)
+  }
+
+  // MARK: - Uncovered regions
+
+  /// A rectangle of empty cells: its position and size in cells, and the part of the screen it spans.
+  struct Region: Equatable {
+    let column: Int
+    let row: Int
+    let columns: Int
+    let rows: Int
+    let rect: CGRect
+  }
+
+  /// The empty cells as rectangles, so a caller looking for uncovered content can visit the empty areas
+  /// directly rather than testing every point of the screen.
+  ///
+  /// The rectangles tile the empty cells: disjoint, and between them covering every one. Each starts at
+  /// the first empty cell not yet taken, in row-major order, and grows right and then down as far as it
+  /// will go, so an empty area is reported in few, large pieces. The truly maximal empty rectangles of a
+  /// grid overlap one another and can number in the square of its cells, which is more than discovery
+  /// wants to visit.
+  ///
+  /// A snapshot: cells marked while iterating do not change the regions it yields.
+  func uncoveredRegions() -> UncoveredRegions {
+    UncoveredRegions(grid: self)
+  }
+
+  struct UncoveredRegions: Sequence, IteratorProtocol {
+    /// The grid's cells, plus every cell already handed out in a region.
+    private var taken: [UInt64]
+    private let wordsPerRow: Int
+    private let width: Int
+    private let height: Int
+    private let screenBounds: CGRect
+    private let cellSize: CGFloat
+    /// No row above this has an untaken cell.
+    private var row = 0
+
+    fileprivate init(grid: FBAccessibilityCoverageGrid) {
+      taken = grid.words
+      wordsPerRow = grid.wordsPerRow
+      width = Int(grid.width)
+      height = Int(grid.height)
+      screenBounds = grid.screenBounds
+      cellSize = grid.cellSize
+    }
+
+    mutating func next() -> Region? {
+      while row < height {
+        guard let column = firstClear(inRow: row) else {
+          row += 1
+          continue
+        }
+        let end = firstSet(inRow: row, from: column)
+        var rows = 1
+        while row + rows < height, isClear(row: row + rows, first: column, last: end - 1) {
+          rows += 1
+        }
+        for taking in row..<(row + rows) {
+          _ = FBAccessibilityCoverageGrid.fillSpan(&taken, rowStart: taking * wordsPerRow, first: column, last: end - 1)
+        }
+        let rect = CGRect(
+          x: screenBounds.origin.x + CGFloat(column) * cellSize,
+          y: screenBounds.origin.y + CGFloat(row) * cellSize,
+          width: CGFloat(end - column) * cellSize,
+          height: CGFloat(rows) * cellSize
+        ).intersection(screenBounds)
+        return Region(column: column, row: row, columns: end - column, rows: rows, rect: rect)
+      }
+      return nil
+    }
+
+    private func firstClear(inRow row: Int) -> Int? {
+      let rowStart = row * wordsPerRow
+      for word in 0..<wordsPerRow {
+        let clear = ~taken[rowStart + word] & FBAccessibilityCoverageGrid.spanMask(word: word, first: 0, last: width - 1)
+        if clear != 0 {
+          return (word << 6) + clear.trailingZeroBitCount
+        }
+      }
+      return nil
+    }
+
+    /// The first taken column at or after `column`, or `width` when the rest of the row is clear.
+    private func firstSet(inRow row: Int, from column: Int) -> Int {
+      let rowStart = row * wordsPerRow
+      for word in (column >> 6)..<wordsPerRow {
+        let set = taken[rowStart + word] & FBAccessibilityCoverageGrid.spanMask(word: word, first: column, last: width - 1)
+        if set != 0 {
+          return (word << 6) + set.trailingZeroBitCount
+        }
+      }
+      return width
+    }
+
+    private func isClear(row: Int, first: Int, last: Int) -> Bool {
+      let rowStart = row * wordsPerRow
+      return ((first >> 6)...(last >> 6)).allSatisfy { word in
+        taken[rowStart + word] & FBAccessibilityCoverageGrid.spanMask(word: word, first: first, last: last) == 0
+      }
+    }
+  }
+
+  // MARK: - Bits
+
+  /// Sets columns `first...last` of the row whose first word is `rowStart`, returning how many of them
+  /// were not already set.
+  fileprivate static func fillSpan(_ words: inout [UInt64], rowStart: Int, first: Int, last: Int) -> Int {
+    var added = 0
+    for word in (first >> 6)...(last >> 6) {
+      let mask = spanMask(word: word, first: first, last: last)
+      added += (mask & ~words[rowStart + word]).nonzeroBitCount
+      words[rowStart + word] |= mask
+    }
+    return added
+  }
+
+  /// The bits of a row's `word`th word that fall within columns `first...last`; zero when none do.
+  fileprivate static func spanMask(word: Int, first: Int, last: Int) -> UInt64 {
+    guard word >= first >> 6, word <= last >> 6 else {
+      return 0
     }
-    return CGFloat(filledCells) / CGFloat(totalCells)
+    let low = word == first >> 6 ? UInt64(first & 63) : 0
+    let high = word == last >> 6 ? UInt64(last & 63) : 63
+    return (~UInt64(0) >> (63 - high)) & (~UInt64(0) << low)
   }
 }
 
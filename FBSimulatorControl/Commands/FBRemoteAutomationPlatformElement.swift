@@ -14,12 +14,36 @@ import Foundation
 /// `FBAXPlatformElement` and not `FBAXWritableElement`: the remote projection cannot be acted on, so
 /// element actions are kept off it by the type system rather than by silently no-op'd accessors.
 final class FBRemoteAutomationPlatformElement: FBAXPlatformElement {
-  private let attributes: [String: Any]
+  /// The attributes in whichever form the read delivered them. Every accessor reads through the
+  /// subscript, so the two cannot answer differently for the same values.
+  private enum Attributes {
+    /// A parsed JSON or DTX node: the remote-automation session, and a guest read sent as JSON.
+    case dictionary([String: Any])
+    /// A guest read sent in `FBAXWireBinary`, decoded without a dictionary per element.
+    case decoded(FBAXWireBinary.Attributes)
+
+    subscript(key: String) -> Any? {
+      switch self {
+      case let .dictionary(attributes):
+        attributes[key]
+      case let .decoded(attributes):
+        attributes[key]
+      }
+    }
+  }
+
+  private let attributes: Attributes
   private let childElements: [FBRemoteAutomationPlatformElement]
   private let pid: pid_t
 
   init(attributes: [String: Any], children: [FBRemoteAutomationPlatformElement], pid: pid_t) {
-    self.attributes = attributes
+    self.attributes = .dictionary(attributes)
+    self.childElements = children
+    self.pid = pid
+  }
+
+  init(decoded attributes: FBAXWireBinary.Attributes, children: [FBRemoteAutomationPlatformElement], pid: pid_t) {
+    self.attributes = .decoded(attributes)
     self.childElements = children
     self.pid = pid
   }
@@ -116,16 +140,23 @@ final class FBRemoteAutomationPlatformElement: FBAXPlatformElement {
   /// What the guest's hit-test at this element's centre found, when the read asked it to look. Nil when
   /// it did not ask, when the element is reachable, or when nothing answered.
   func axExplainedBy() -> FBAXPlatformElement? {
-    guard let attributes = self.attributes[FBAXWire.Node.explainedBy.rawValue] as? [String: Any] else {
-      return nil
+    switch attributes[FBAXWire.Node.explainedBy.rawValue] {
+    case let explanation as [String: Any]:
+      FBRemoteAutomationPlatformElement(attributes: explanation, children: [], pid: pid)
+    case let explanation as FBAXWireBinary.Attributes:
+      FBRemoteAutomationPlatformElement(decoded: explanation, children: [], pid: pid)
+    default:
+      nil
     }
-    return FBRemoteAutomationPlatformElement(attributes: attributes, children: [], pid: pid)
   }
   func axCustomActionNames() -> [String] { [] }
   func axActionNames() -> [String] { [] }
   func axTraits() -> [String]? { nil }
   func axChildren() -> [FBAXPlatformElement] { childElements }
 
+  /// `axChildren()` as the concrete type, for walks that stay within an already-read tree.
+  var children: [FBRemoteAutomationPlatformElement] { childElements }
+
   var axTranslationPid: pid_t { pid }
   func axSetBridgeDelegateToken(_ token: String?) {}
 
@@ -26,7 +26,6 @@ public final class FBSimulatorCrashLogCommands: NSObject {
 
   private weak var simulator: FBSimulator?
   private let notifier: FBCrashLogNotifier
-  private var hasPerformedInitialIngestion: Bool = false
 
   // MARK: - Initializers
 
@@ -50,10 +49,8 @@ public final class FBSimulatorCrashLogCommands: NSObject {
   }
 
   fileprivate func crashesAsync(matching predicate: NSPredicate, useCache: Bool) async throws -> [FBCrashLogInfo] {
-    if !hasPerformedInitialIngestion {
-      notifier.store.ingestAllExistingInDirectory()
-      hasPerformedInitialIngestion = true
-    }
+    // Incremental, so only crash logs that are new since the last call are read.
+    notifier.store.ingestAllExistingInDirectory()
     return notifier.store.ingestedCrashLogs(matchingPredicate: predicate)
   }
 
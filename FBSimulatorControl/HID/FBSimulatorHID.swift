@@ -296,6 +296,31 @@ public final class FBSimulatorHID: CustomStringConvertible, @unchecked Sendable
     }
   }
 
+  /// Sends a timeline's primitives, each at its offset from when this was called, and returns once its
+  /// duration has elapsed. Reports whether any primitive reached the HID transport.
+  ///
+  /// Like `FBSimulatorHIDEvent.sendAsync(on:)` this does not drain; a caller that tears the connection
+  /// down afterwards calls `flush()` itself.
+  public func deliver(_ timeline: FBSimulatorHIDTimeline) async throws -> Bool {
+    let clock = ContinuousClock()
+    let start = clock.now
+    func wait(until offset: TimeInterval) async throws {
+      let deadline = start + .nanoseconds(Int64(offset * 1_000_000_000))
+      if deadline > clock.now {
+        try await Task.sleep(until: deadline, clock: clock)
+      }
+    }
+    var wroteToTransport = false
+    for step in timeline.steps {
+      try await wait(until: step.offset)
+      if try await deliver(step.event) {
+        wroteToTransport = true
+      }
+    }
+    try await wait(until: timeline.duration)
+    return wroteToTransport
+  }
+
   // MARK: CustomStringConvertible
 
   public var description: String {
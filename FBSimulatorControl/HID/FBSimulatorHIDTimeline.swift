@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import Foundation
+
+/// A HID event laid out in time: the primitives it sends, each at its offset from the start of the event.
+///
+/// Delivering a `.composite` one sub-event at a time sleeps for each `.delay` only once the sends
+/// before it have returned, so the time those sends take is added to every delay, and a long gesture
+/// such as typed text falls further behind with every primitive. A timeline folds the delays into
+/// offsets up front, so `FBSimulatorHID.deliver(_:)` sends each primitive at its offset from when
+/// delivery began, and a send that runs long is caught up on rather than carried forward.
+public struct FBSimulatorHIDTimeline: Equatable, Sendable {
+
+  public struct Step: Equatable, Sendable {
+    /// Seconds from the start of the timeline.
+    public let offset: TimeInterval
+    /// A primitive: never a `.delay` or a `.composite`.
+    public let event: FBSimulatorHIDEvent
+  }
+
+  /// The primitives, in the order they are sent.
+  public let steps: [Step]
+  /// Seconds from the start of the timeline to its end, including any trailing delay.
+  public let duration: TimeInterval
+
+  /// Flattens `event`, however deeply its composites are nested. Negative delays count as zero, as
+  /// they do when delivered one at a time.
+  public init(_ event: FBSimulatorHIDEvent) {
+    var steps: [Step] = []
+    var offset: TimeInterval = 0
+    func append(_ event: FBSimulatorHIDEvent) {
+      switch event {
+      case let .delay(duration):
+        offset += max(0, duration)
+      case let .composite(events):
+        events.forEach(append)
+      case .touch, .button, .keyboard, .twoFingerTouch, .trackpad,
+        .deviceOrientation, .lockDevice, .shake, .toggleInCallStatusBar:
+        steps.append(Step(offset: offset, event: event))
+      }
+    }
+    append(event)
+    self.steps = steps
+    self.duration = offset
+  }
+}
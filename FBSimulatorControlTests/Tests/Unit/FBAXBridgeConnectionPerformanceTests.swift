@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import FBControlCore
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// Measures 500 hit-tests over one `serve` connection to `FBAXFakeGuest` — the shape of a coverage grid
+/// probing for remote content — three ways: one round trip at a time, all of them in flight at once, and
+/// one `hittest-batch`. The fake answers instantly, so what is measured is the connection's own cost per
+/// hit-test: framing, the hops between queues, and the waiting that pipelining and batching remove.
+final class FBAXBridgeConnectionPerformanceTests: XCTestCase {
+
+  private static let hitTests = 500
+
+  private static let points = (0..<hitTests).map { CGPoint(x: ($0 % 25) * 16, y: ($0 / 25) * 40) }
+
+  func testSerialHitTests() throws {
+    try measureHitTests { connection in
+      for point in Self.points {
+        let response = try await connection.roundTrip(try FBAXFakeGuest.hitTestRequest(x: Double(point.x), y: Double(point.y)))
+        XCTAssertNotNil(try FBAXTreeRead(hitTestResponse: response))
+      }
+    }
+  }
+
+  func testPipelinedHitTests() throws {
+    try measureHitTests { connection in
+      let labels = try await FBAXBridgeConnectionTests.hitTestConcurrently(connection, count: Self.hitTests)
+      XCTAssertEqual(labels.count, Self.hitTests)
+    }
+  }
+
+  func testBatchedHitTests() throws {
+    try measureHitTests { connection in
+      let response = try await connection.roundTrip(try FBAXFakeGuest.hitTestBatchRequest(points: Self.points))
+      XCTAssertEqual(try FBAXTreeRead.hitTests(fromBatchResponse: response, count: Self.hitTests)?.count, Self.hitTests)
+    }
+  }
+
+  // MARK: - Helpers
+
+  /// Measures `body` against one connection, established outside the measurement so only the hit-tests
+  /// are timed.
+  private func measureHitTests(_ body: @escaping @Sendable (FBAXBridgeConnection) async throws -> Void) throws {
+    let guest = try FBAXFakeGuest()
+    let connected = expectation(description: "connected")
+    let connection = Connected()
+    Task {
+      connection.value = try? await guest.connect()
+      connected.fulfill()
+    }
+    wait(for: [connected], timeout: 10)
+    let established = try XCTUnwrap(connection.value)
+    measure {
+      let done = expectation(description: "hit-tests")
+      Task {
+        do {
+          try await body(established)
+        } catch {
+          XCTFail("hit-tests failed: \(error)")
+        }
+        done.fulfill()
+      }
+      wait(for: [done], timeout: 60)
+    }
+  }
+}
+
+/// Carries the connection out of the task that established it.
+///
+// SAFETY: written once, by that task, before it fulfils the expectation the reader waits on.
+// patternlint-disable-next-line unchecked-sendable
+private final class Connected: @unchecked Sendable {
+  var value: FBAXBridgeConnection?
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import FBControlCore
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// Many requests in flight on one `serve` connection. Driven against `FBAXFakeGuest` on a real Unix
+/// socket rather than a mock, because what is under test is the framing: that each caller gets the
+/// frame that answers it, whichever order the frames arrive in, and that a stream in an unknown state
+/// fails everyone waiting on it rather than handing anybody somebody else's answer.
+final class FBAXBridgeConnectionTests: XCTestCase {
+
+  func testConcurrentRequestsAreEachAnsweredWithTheirOwnResponse() async throws {
+    let connection = try await FBAXFakeGuest().connect()
+    let labels = try await Self.hitTestConcurrently(connection, count: 64)
+    XCTAssertEqual(labels, Self.expectedLabels(count: 64))
+  }
+
+  // The fake holds every answer back until eight requests have arrived, so this only completes if all
+  // eight are in flight at once — and it answers them newest first, so only routing by id gets them right.
+  func testResponsesAnsweredOutOfOrderAreRoutedByRequestId() async throws {
+    let connection = try await FBAXFakeGuest(reversingGroupsOf: 8).connect()
+    let labels = try await Self.hitTestConcurrently(connection, count: 32)
+    XCTAssertEqual(labels, Self.expectedLabels(count: 32))
+  }
+
+  // A guest predating `negotiate` sends no ids, but answers strictly in the order it was asked, so the
+  // host still pipelines and routes its answers by position.
+  func testAGuestWithoutRequestIdsIsRoutedInOrder() async throws {
+    let guest = try FBAXFakeGuest(predatesNegotiate: true)
+    let fileDescriptor = try await FBAXBridgeConnection.connect(path: guest.path, timeout: 5)
+    let connection = FBAXBridgeConnection(fileDescriptor: fileDescriptor, process: nil, socketPath: guest.path, logger: nil)
+    let negotiated = try await connection.negotiate()
+    XCTAssertEqual(negotiated.encoding, .json)
+    XCTAssertEqual(negotiated.framing, .length)
+
+    let labels = try await Self.hitTestConcurrently(connection, count: 64)
+    XCTAssertEqual(labels, Self.expectedLabels(count: 64))
+  }
+
+  func testASocketClosedUnderPipelinedRequestsFailsEachOfThem() async throws {
+    let connection = try await FBAXFakeGuest(reversingGroupsOf: 4, closingAfter: 3).connect()
+    let failures = await withTaskGroup(of: Error?.self) { group in
+      for index in 0..<3 {
+        group.addTask {
+          do {
+            _ = try await connection.roundTrip(try FBAXFakeGuest.hitTestRequest(x: Double(index), y: 0))
+            return nil
+          } catch {
+            return error
+          }
+        }
+      }
+      return await group.reduce(into: [Error]()) { failures, failure in
+        if let failure {
+          failures.append(failure)
+        }
+      }
+    }
+    XCTAssertEqual(failures.count, 3, "every request in flight must fail with the connection")
+    for failure in failures {
+      guard case FBAXBridgeError.guestFailure = failure else {
+        return XCTFail("expected a guestFailure, got: \(failure)")
+      }
+    }
+    // The connection stays failed, which is what tells the transport to establish a fresh serve.
+    do {
+      _ = try await connection.roundTrip(try FBAXFakeGuest.hitTestRequest(x: 0, y: 0))
+      XCTFail("a failed connection must not be reused")
+    } catch FBAXBridgeError.guestFailure {
+    }
+  }
+
+  // An answer naming a request nobody sent means the stream is not what the host thinks it is, so it is
+  // failed rather than guessed at.
+  func testAResponseForNoRequestInFlightFailsTheConnection() async throws {
+    let connection = try await FBAXFakeGuest(idOffset: 1_000).connect()
+    do {
+      _ = try await connection.roundTrip(try FBAXFakeGuest.hitTestRequest(x: 1, y: 2))
+      XCTFail("an answer to no request in flight must fail the round trip")
+    } catch let FBAXBridgeError.guestFailure(message) {
+      XCTAssertTrue(message.contains("not in flight"), message)
+    }
+  }
+
+  func testAHitTestBatchIsAnsweredPointByPoint() async throws {
+    let connection = try await FBAXFakeGuest().connect()
+    let points = (0..<10).map { CGPoint(x: $0 * 10, y: $0 * 20) }
+    let response = try await connection.roundTrip(try FBAXFakeGuest.hitTestBatchRequest(points: points))
+    let hits = try XCTUnwrap(FBAXTreeRead.hitTests(fromBatchResponse: response, count: points.count))
+    XCTAssertEqual(
+      try hits.map { FBAXTreeWalk.rootElement(of: try XCTUnwrap($0.get())).axLabel() },
+      points.map { Optional(FBAXFakeGuest.label(x: Double($0.x), y: Double($0.y))) }
+    )
+  }
+
+  // A guest predating the batch verb refuses it as a bad request, which the parser reports as absent so
+  // the caller can fall back to single hit-tests.
+  func testAHitTestBatchToAnOlderGuestIsReportedAsUnsupported() async throws {
+    let guest = try FBAXFakeGuest(predatesNegotiate: true)
+    let fileDescriptor = try await FBAXBridgeConnection.connect(path: guest.path, timeout: 5)
+    let connection = FBAXBridgeConnection(fileDescriptor: fileDescriptor, process: nil, socketPath: guest.path, logger: nil)
+    let response = try await connection.roundTrip(try FBAXFakeGuest.hitTestBatchRequest(points: [.zero]))
+    XCTAssertNil(try FBAXTreeRead.hitTests(fromBatchResponse: response, count: 1))
+  }
+
+  // MARK: - Helpers
+
+  private static func expectedLabels(count: Int) -> [String] {
+    (0..<count).map { FBAXFakeGuest.label(x: Double($0), y: Double($0 * 2)) }
+  }
+
+  /// Hit-tests `count` points at once on `connection`, returning each hit's label in point order.
+  static func hitTestConcurrently(_ connection: FBAXBridgeConnection, count: Int) async throws -> [String] {
+    try await withThrowingTaskGroup(of: (Int, String?).self) { group in
+      for index in 0..<count {
+        group.addTask {
+          let response = try await connection.roundTrip(
+            try FBAXFakeGuest.hitTestRequest(x: Double(index), y: Double(index * 2))
+          )
+          let hit = try FBAXTreeRead(hitTestResponse: response)
+          return (index, hit.flatMap { FBAXTreeWalk.rootElement(of: $0).axLabel() })
+        }
+      }
+      var labels = [String](repeating: "", count: count)
+      for try await (index, label) in group {
+        labels[index] = label ?? ""
+      }
+      return labels
+    }
+  }
+}
@@ -635,6 +635,32 @@ final class FBAXBridgeReadsTests: XCTestCase {
     }
   }
 
+  func testHitTestBatchAnswersEachPointAsASingleHitTestWould() throws {
+    let data = try envelope([
+      "ok": true,
+      "results": [
+        ["ok": true, "tree": [FBAXWire.Node.identifier.rawValue: "a"], "pid": 8865],
+        ["ok": true, "empty": true],
+        ["ok": false, "error": "gone", "error_kind": "application_unavailable", "pid": 8865],
+      ],
+    ])
+    let hits = try XCTUnwrap(FBAXTreeRead.hitTests(fromBatchResponse: data, count: 3))
+    XCTAssertEqual(try hits[0].get()?.pid, 8865)
+    XCTAssertNil(try hits[1].get())
+    // One point's failure is classified as it would be alone, and fails only that point.
+    XCTAssertThrowsError(try hits[2].get()) { error in
+      guard case FBAXBridgeError.applicationUnavailable(pid: 8865) = error else {
+        return XCTFail("expected the point's own failure kind, got: \(error)")
+      }
+    }
+  }
+
+  // An answer that does not line up with the points asked about cannot be matched to them at all.
+  func testHitTestBatchThrowsWhenAPointGoesUnanswered() throws {
+    let data = try envelope(["ok": true, "results": [["ok": true, "empty": true]]])
+    XCTAssertThrowsError(try FBAXTreeRead.hitTests(fromBatchResponse: data, count: 2))
+  }
+
   // MARK: - FBAXTreeRead fused frontmost tree parsing
 
   func testFrontmostTreeParsesTreeAndResolvedPid() throws {
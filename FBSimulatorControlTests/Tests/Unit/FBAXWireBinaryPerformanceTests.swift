@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import FBControlCore
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// Measures a whole-tree read's host-side cost in each encoding, from response bytes to the serialized
+/// elements, at the tree sizes the guest's node budget allows. The corpus is a list screen repeated until
+/// it reaches the size: sections of cells whose types, labels and keys repeat the way a real screen's do,
+/// which is what the binary encoding's tables exist to exploit.
+final class FBAXWireBinaryPerformanceTests: XCTestCase {
+
+  private static let nodeCounts = [500, 2_000, 5_000]
+
+  func testEncodeCorpus() throws {
+    let corpus = Self.nodeCounts.map(Self.response(nodes:))
+    measure {
+      for response in corpus {
+        XCTAssertNotNil(try? FBAXWireBinary.encode(response: response))
+      }
+    }
+  }
+
+  func testDecodeBinaryCorpus() throws {
+    let corpus = try Self.nodeCounts.map { try FBAXWireBinary.encode(response: Self.response(nodes: $0)) }
+    measure {
+      for (data, nodes) in zip(corpus, Self.nodeCounts) {
+        XCTAssertEqual(Self.describe(data)?.count, nodes)
+      }
+    }
+  }
+
+  /// The baseline the binary decode replaces: the same trees parsed from JSON into dictionaries, then
+  /// walked into elements.
+  func testDecodeJSONCorpus() throws {
+    let corpus = try Self.nodeCounts.map { try JSONSerialization.data(withJSONObject: Self.response(nodes: $0)) }
+    measure {
+      for (data, nodes) in zip(corpus, Self.nodeCounts) {
+        XCTAssertEqual(Self.describe(data)?.count, nodes)
+      }
+    }
+  }
+
+  func testBinaryCorpusIsSmallerThanJSON() throws {
+    for nodes in Self.nodeCounts {
+      let response = Self.response(nodes: nodes)
+      let binary = try FBAXWireBinary.encode(response: response)
+      let json = try JSONSerialization.data(withJSONObject: response)
+      XCTAssertLessThan(binary.count * 3, json.count, "\(nodes) nodes: \(binary.count) binary bytes, \(json.count) JSON bytes")
+    }
+  }
+
+  // MARK: - Helpers
+
+  private static func describe(_ data: Data) -> [FBAccessibilityDocumentElement]? {
+    guard let read = try? FBAXTreeRead(wholeTreeResponse: data, pid: 42) else {
+      return nil
+    }
+    return FBAXTreeWalk.describeAllElements(fromRead: read, keys: FBAXKeys.defaultSet, nestedFormat: false)
+  }
+
+  /// A whole-tree response of exactly `nodes` elements: an application holding sections of ten cells,
+  /// each cell a label, a detail value and a chevron.
+  private static func response(nodes: Int) -> [String: Any] {
+    var remaining = nodes - 1
+    var sections: [[String: Any]] = []
+    var y = 0.0
+    while remaining > 0 {
+      var cells: [[String: Any]] = []
+      remaining -= 1
+      for row in 0..<10 where remaining > 0 {
+        let leaves = min(3, remaining - 1)
+        let children = (0..<leaves).map { leaf in
+          node(
+            type: [48, 48, 43][leaf], label: ["Wi-Fi", "Connected", "Chevron"][leaf],
+            frame: CGRect(x: [16, 240, 360][leaf], y: y + 12, width: 100, height: 20)
+          )
+        }
+        var cell = node(type: 75, label: "Row \(row)", frame: CGRect(x: 0, y: y, width: 390, height: 44), children: children)
+        cell[FBAXWire.Node.identifier.rawValue] = "com.apple.settings.section.row.\(row)"
+        cells.append(cell)
+        remaining -= 1 + leaves
+        y += 44
+      }
+      sections.append(node(type: 74, label: "Section", frame: CGRect(x: 0, y: y, width: 390, height: 440), children: cells))
+    }
+    let root = node(type: 2, label: "Settings", frame: CGRect(x: 0, y: 0, width: 390, height: 844), children: sections)
+    return ["ok": true, "pid": 42, "tree": root]
+  }
+
+  private static func node(type: Int, label: String, frame: CGRect, children: [[String: Any]] = []) -> [String: Any] {
+    [
+      FBAXWire.Node.elementType.rawValue: type,
+      FBAXWire.Node.automationType.rawValue: type,
+      FBAXWire.Node.label.rawValue: label,
+      FBAXWire.Node.frame.rawValue: CGRectCreateDictionaryRepresentation(frame) as NSDictionary,
+      FBAXWire.Node.children.rawValue: children,
+    ]
+  }
+}
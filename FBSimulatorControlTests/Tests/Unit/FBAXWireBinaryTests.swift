@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import FBControlCore
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// The binary response encoding a `serve` connection negotiates. What matters is that it is invisible
+/// above `FBAXTreeRead`: a tree sent either way must describe identically, and a frame that is not what it
+/// claims must fail the read the way an unparseable JSON response does. The guest's encoder is pinned
+/// separately, in `AccessibilityServiceTests`; these frames come from the host's mirror of it.
+final class FBAXWireBinaryTests: XCTestCase {
+
+  private static func frame(_ rect: CGRect) -> NSDictionary {
+    CGRectCreateDictionaryRepresentation(rect) as NSDictionary
+  }
+
+  /// A settings-shaped screen: a table of cells sharing a type and carrying the reachability keys, one
+  /// of them covered by an explained blocker.
+  private static func tree() -> [String: Any] {
+    let cells: [[String: Any]] = (0..<20).map { row in
+      var cell: [String: Any] = [
+        FBAXWire.Node.label.rawValue: "Row \(row % 5)",
+        FBAXWire.Node.identifier.rawValue: "com.apple.settings.row.\(row)",
+        FBAXWire.Node.automationType.rawValue: 75,
+        FBAXWire.Node.frame.rawValue: frame(CGRect(x: 0, y: 100 + 44 * row, width: 390, height: 44)),
+        FBAXWire.Node.isVisible.rawValue: row != 3,
+        FBAXWire.Node.visiblePoint.rawValue: CGPointCreateDictionaryRepresentation(CGPoint(x: 195, y: 122 + 44 * row)) as NSDictionary,
+        FBAXWire.Node.children.rawValue: [
+          [
+            FBAXWire.Node.label.rawValue: "Chevron",
+            FBAXWire.Node.automationType.rawValue: 43,
+            FBAXWire.Node.value.rawValue: Double(row) / 2,
+            FBAXWire.Node.children.rawValue: [[String: Any]](),
+          ] as [String: Any]
+        ],
+      ]
+      if row == 3 {
+        cell[FBAXWire.Node.explainedBy.rawValue] = [
+          FBAXWire.Node.label.rawValue: "Banner",
+          FBAXWire.Node.automationType.rawValue: 4,
+          FBAXWire.Node.frame.rawValue: frame(CGRect(x: 0, y: 220, width: 390, height: 60)),
+        ] as [String: Any]
+      }
+      return cell
+    }
+    return [
+      FBAXWire.Node.label.rawValue: "Settings",
+      FBAXWire.Node.automationType.rawValue: 2,
+      FBAXWire.Node.frame.rawValue: frame(CGRect(x: 0, y: 0, width: 390, height: 844)),
+      FBAXWire.Node.children.rawValue: cells,
+    ]
+  }
+
+  private static func response(_ tree: [String: Any], pid: Int = 42) -> [String: Any] {
+    ["ok": true, "pid": pid, "truncated": true, "tree": tree]
+  }
+
+  private static let keys = FBAXKeys.defaultSet.union([.interactable, .occludedBy])
+
+  func testABinaryReadDescribesExactlyAsTheJSONReadOfTheSameTree() throws {
+    let response = Self.response(Self.tree())
+    let json = try FBAXTreeRead(wholeTreeResponse: try JSONSerialization.data(withJSONObject: response), pid: 42)
+    let binary = try FBAXTreeRead(wholeTreeResponse: try FBAXWireBinary.encode(response: response), pid: 42)
+
+    XCTAssertNil(json.decodedRoot)
+    XCTAssertNotNil(binary.decodedRoot)
+    XCTAssertTrue(binary.tree.isEmpty, "a decoded read does not also carry the dictionaries")
+    XCTAssertTrue(binary.truncated, "the envelope is read the same way whatever carried the tree")
+    for nestedFormat in [false, true] {
+      XCTAssertEqual(
+        FBAXTreeWalk.describeAllElements(fromRead: binary, keys: Self.keys, nestedFormat: nestedFormat),
+        FBAXTreeWalk.describeAllElements(fromRead: json, keys: Self.keys, nestedFormat: nestedFormat)
+      )
+    }
+    XCTAssertEqual(FBAXTreeWalk.screenInfo(fromRead: binary)?.width, 390)
+  }
+
+  // The frontmost pid is only known from the envelope, and the elements are built while decoding, so
+  // the envelope has to be read first for them to be tagged with it.
+  func testAFrontmostBinaryReadTagsElementsWithThePidFromTheEnvelope() throws {
+    let data = try FBAXWireBinary.encode(response: Self.response(Self.tree(), pid: 8865))
+    let read = try FBAXTreeRead(frontmostResponse: data, method: .windowServer)
+    XCTAssertEqual(read.pid, 8865)
+    XCTAssertEqual(FBAXTreeWalk.rootElement(of: read).axTranslationPid, 8865)
+    XCTAssertEqual(FBAXTreeWalk.rootElement(of: read).axChildren().first?.axTranslationPid, 8865)
+  }
+
+  func testABinaryHitTestReadsTheHitElement() throws {
+    let cell = (Self.tree()[FBAXWire.Node.children.rawValue] as! [[String: Any]])[3]
+    let hit = try XCTUnwrap(FBAXTreeRead(hitTestResponse: try FBAXWireBinary.encode(response: Self.response(cell, pid: 7))))
+    let element = FBAXTreeWalk.rootElement(of: hit)
+    XCTAssertEqual(element.axLabel(), "Row 3")
+    XCTAssertEqual(element.axExplainedBy()?.axLabel(), "Banner")
+    XCTAssertEqual(element.axHittablePoint(), CGPoint(x: 195, y: 254))
+  }
+
+  // JSON has to send an off-screen element's infinite edge as null and the host restores it; the binary
+  // frame carries the double itself.
+  func testANonFiniteFrameEdgeSurvives() throws {
+    let tree: [String: Any] = [
+      FBAXWire.Node.label.rawValue: "Offscreen",
+      FBAXWire.Node.frame.rawValue: Self.frame(CGRect(x: CGFloat.infinity, y: 0, width: 10, height: 20)),
+    ]
+    let read = try FBAXTreeRead(wholeTreeResponse: try FBAXWireBinary.encode(response: Self.response(tree)), pid: 42)
+    let frame = FBAXTreeWalk.rootElement(of: read).axFrame()
+    XCTAssertEqual(frame.origin.x, .infinity)
+    XCTAssertEqual(frame.size.height, 20)
+  }
+
+  func testKeysAndStringsCrossTheWireOnce() throws {
+    let response = Self.response(Self.tree())
+    let binary = try FBAXWireBinary.encode(response: response)
+    let json = try JSONSerialization.data(withJSONObject: response)
+    XCTAssertEqual(binary.count(of: Data(FBAXWire.Node.label.rawValue.utf8)), 1)
+    XCTAssertEqual(binary.count(of: Data("Chevron".utf8)), 1)
+    XCTAssertLessThan(binary.count * 3, json.count)
+  }
+
+  // Failures carry no tree, so they stay JSON and keep their kinds.
+  func testAResponseWithoutATreeIsEncodedAsJSON() throws {
+    let response: [String: Any] = ["ok": false, "error": "gone", "error_kind": "application_unavailable"]
+    let data = try FBAXWireBinary.encode(response: response)
+    XCTAssertFalse(FBAXWireBinary.isBinary(data))
+    XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data, pid: 42)) { error in
+      guard case FBAXBridgeError.applicationUnavailable = error else {
+        return XCTFail("expected the tagged failure to survive, got: \(error)")
+      }
+    }
+  }
+
+  func testATruncatedFrameIsAGuestFailure() throws {
+    let data = try FBAXWireBinary.encode(response: Self.response(Self.tree()))
+    for length in [FBAXWireBinary.magic.count + 1, data.count / 2, data.count - 1] {
+      XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data.prefix(length), pid: 42)) { error in
+        guard case FBAXBridgeError.guestFailure = error else {
+          return XCTFail("a frame cut at \(length) should be a guestFailure, got: \(error)")
+        }
+      }
+    }
+  }
+
+  func testTrailingBytesAndUnknownTagsAreGuestFailures() throws {
+    var data = try FBAXWireBinary.encode(response: Self.response([FBAXWire.Node.label.rawValue: "x"]))
+    XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data + Data([0]), pid: 42))
+    // The root's only value tag is the frame's third-to-last byte: tag, string index, child count.
+    data[data.count - 3] = 0xff
+    XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data, pid: 42)) { error in
+      guard case let FBAXBridgeError.guestFailure(message) = error else {
+        return XCTFail("an unknown tag should be a guestFailure, got: \(error)")
+      }
+      XCTAssertTrue(message.contains("unknown tag"), message)
+    }
+  }
+
+  // A frame nested past the cap is refused rather than decoded recursively off the host's stack.
+  func testNestingIsBounded() throws {
+    var tree: [String: Any] = [FBAXWire.Node.label.rawValue: "leaf"]
+    for _ in 0...FBAXWireBinary.maxDepth {
+      tree = [FBAXWire.Node.children.rawValue: [tree]]
+    }
+    let data = try FBAXWireBinary.encode(response: Self.response(tree))
+    XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data, pid: 42))
+  }
+
+  // Arrays and dictionaries nest without a child list, so they are bounded by the same cap.
+  func testNestedAttributeValuesAreBounded() throws {
+    var array: Any = "leaf"
+    var dictionary: Any = "leaf"
+    for _ in 0...FBAXWireBinary.maxDepth {
+      array = [array]
+      dictionary = [FBAXWire.Node.label.rawValue: dictionary]
+    }
+    for value in [array, dictionary] {
+      let data = try FBAXWireBinary.encode(response: Self.response([FBAXWire.Node.value.rawValue: value]))
+      XCTAssertThrowsError(try FBAXTreeRead(wholeTreeResponse: data, pid: 42)) { error in
+        guard case let FBAXBridgeError.guestFailure(message) = error else {
+          return XCTFail("an over-deep value should be a guestFailure, got: \(error)")
+        }
+        XCTAssertTrue(message.contains("nested deeper"), message)
+      }
+    }
+  }
+}
+
+private extension Data {
+  func count(of needle: Data) -> Int {
+    var count = 0
+    var start = startIndex
+    while let found = range(of: needle, in: start..<endIndex) {
+      count += 1
+      start = found.upperBound
+    }
+    return count
+  }
+}
@@ -151,6 +151,8 @@ final class FBAXWireContractTests: XCTestCase {
       .perform: "perform",
       .setValue: "setvalue",
       .shutdown: "shutdown",
+      .negotiate: "negotiate",
+      .hitTestBatch: "hittest-batch",
     ]
     XCTAssertEqual(Set(FBAXWire.Verb.allCases), Set(expected.keys), "every verb must have its wire value pinned")
     for (verb, wireValue) in expected {
@@ -199,6 +201,9 @@ final class FBAXWireContractTests: XCTestCase {
       .value: ("value", "--value"),
       .assertKey: ("assertKey", "--assert-key"),
       .assertValue: ("assertValue", "--assert-value"),
+      .encodings: ("encodings", "--encodings"),
+      .framings: ("framings", "--framings"),
+      .points: ("points", "--points"),
     ]
     XCTAssertEqual(Set(FBAXWire.Request.allCases), Set(expected.keys), "every request field must have its spellings pinned")
     for (field, spelling) in expected {
@@ -214,6 +219,41 @@ final class FBAXWireContractTests: XCTestCase {
     XCTAssertEqual(FBAXWire.Request.maxNodes.argument("5000"), ["--max-nodes", "5000"])
   }
 
+  // MARK: - Response encodings
+
+  // The names a `negotiate` offers and the guest answers with. A guest that does not recognise a name
+  // settles on JSON, so a misspelling here is not an error anywhere — it is every read silently staying on
+  // the slower encoding.
+  func testEncodingWireValues() {
+    let expected: [FBAXWire.Encoding: String] = [
+      .json: "json",
+      .binary: "binary-v1",
+    ]
+    XCTAssertEqual(Set(FBAXWire.Encoding.allCases), Set(expected.keys), "every encoding must have its wire value pinned")
+    for (encoding, wireValue) in expected {
+      XCTAssertEqual(encoding.rawValue, wireValue)
+    }
+    XCTAssertEqual(FBAXWire.Envelope.encoding.rawValue, "encoding")
+    XCTAssertEqual(FBAXWireBinary.magic, Data("FBAX".utf8) + Data([1]))
+  }
+
+  // MARK: - Frame headers
+
+  // Like an encoding, a framing the guest does not recognise is declined rather than refused, so a
+  // misspelling here leaves every connection routing responses by position.
+  func testFramingWireValues() {
+    let expected: [FBAXWire.Framing: String] = [
+      .length: "length",
+      .lengthAndId: "length-id",
+    ]
+    XCTAssertEqual(Set(FBAXWire.Framing.allCases), Set(expected.keys), "every framing must have its wire value pinned")
+    for (framing, wireValue) in expected {
+      XCTAssertEqual(framing.rawValue, wireValue)
+    }
+    XCTAssertEqual(FBAXWire.Envelope.framing.rawValue, "framing")
+    XCTAssertEqual(FBAXWire.Envelope.results.rawValue, "results")
+  }
+
   // MARK: - Write requests
 
   // The two transports send the same write in different shapes, so the shapes are pinned together: a
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// Measures the coverage grid at iPad Pro resolutions — the largest screens a read covers, so the most
+/// cells per row and per grid — over a read at the node budget: 3000 element-sized frames scattered so
+/// that gaps remain, which is the case remote-content discovery exists for.
+final class FBAccessibilityCoverageGridPerformanceTests: XCTestCase {
+
+  /// 12.9-inch in both orientations, and 11-inch, in points.
+  private static let screens = [
+    CGRect(x: 0, y: 0, width: 1024, height: 1366),
+    CGRect(x: 0, y: 0, width: 1366, height: 1024),
+    CGRect(x: 0, y: 0, width: 834, height: 1194),
+  ]
+
+  private static let frames = screens.map { screen -> [CGRect] in
+    var generator = SeededGenerator()
+    return (0..<FBAXReadLimits.maxReadNodes).map { _ in
+      CGRect(
+        x: CGFloat.random(in: 0..<screen.width, using: &generator),
+        y: CGFloat.random(in: 0..<screen.height, using: &generator),
+        width: CGFloat.random(in: 8..<160, using: &generator),
+        height: CGFloat.random(in: 8..<44, using: &generator)
+      )
+    }
+  }
+
+  func testMarkingAReadAtTheNodeBudget() {
+    measure {
+      for (screen, frames) in zip(Self.screens, Self.frames) {
+        let grid = FBAccessibilityCoverageGrid(screenBounds: screen)
+        for frame in frames {
+          grid?.markFilled(with: frame)
+        }
+        XCTAssertGreaterThan(grid?.filledCellCount ?? 0, 0)
+      }
+    }
+  }
+
+  /// Discovery reads the ratio before and after it marks what it found; a caller polling it while
+  /// marking reads it far more often than that.
+  func testReadingTheRatioAfterEveryMark() {
+    measure {
+      for (screen, frames) in zip(Self.screens, Self.frames) {
+        let grid = FBAccessibilityCoverageGrid(screenBounds: screen)
+        var ratio: CGFloat = 0
+        for frame in frames {
+          grid?.markFilled(with: frame)
+          ratio = grid?.coverageRatio() ?? 0
+        }
+        XCTAssertGreaterThan(ratio, 0)
+      }
+    }
+  }
+
+  func testQueryingEveryCell() throws {
+    let grids = try zip(Self.screens, Self.frames).map { try Self.grid(screen: $0, frames: $1) }
+    measure {
+      for grid in grids {
+        var filled = 0
+        for row in 0..<Int(grid.height) {
+          let y = grid.screenBounds.minY + (CGFloat(row) + 0.5) * grid.cellSize
+          for column in 0..<Int(grid.width) {
+            let x = grid.screenBounds.minX + (CGFloat(column) + 0.5) * grid.cellSize
+            filled += grid.isFilled(at: CGPoint(x: x, y: y)) ? 1 : 0
+          }
+        }
+        XCTAssertEqual(filled, grid.filledCellCount)
+      }
+    }
+  }
+
+  func testIteratingTheUncoveredRegions() throws {
+    let grids = try zip(Self.screens, Self.frames).map { try Self.grid(screen: $0, frames: $1) }
+    measure {
+      for grid in grids {
+        let cells = grid.uncoveredRegions().reduce(0) { $0 + $1.columns * $1.rows }
+        XCTAssertEqual(cells + grid.filledCellCount, Int(grid.width * grid.height))
+      }
+    }
+  }
+
+  func testChoosingDiscoveryCandidates() throws {
+    let grids = try zip(Self.screens, Self.frames).map { try Self.grid(screen: $0, frames: $1) }
+    measure {
+      for grid in grids {
+        XCTAssertFalse(FBAXTranslationRequest.candidatePoints(in: grid.screenBounds, stepSize: 10, uncoveredBy: grid).isEmpty)
+      }
+    }
+  }
+
+  // MARK: - Helpers
+
+  private static func grid(screen: CGRect, frames: [CGRect]) throws -> FBAccessibilityCoverageGrid {
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: screen))
+    for frame in frames {
+      grid.markFilled(with: frame)
+    }
+    return grid
+  }
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+@testable import FBSimulatorControl
+import Foundation
+import XCTest
+
+/// The packed grid against a one-byte-per-cell oracle that marks cell by cell, the way the grid used to.
+/// Widths either side of a 64-cell word boundary are used throughout, since that is where a span mask or
+/// a row's padding bits would go wrong.
+final class FBAccessibilityCoverageGridTests: XCTestCase {
+
+  private static let screens = [
+    CGRect(x: 0, y: 0, width: 390, height: 844),
+    CGRect(x: 0, y: 0, width: 640, height: 200),
+    CGRect(x: 0, y: 0, width: 641, height: 200),
+    CGRect(x: 20, y: -40, width: 1366, height: 1024),
+  ]
+
+  func testMarkingAgreesWithTheCellByCellOracle() throws {
+    for screen in Self.screens {
+      let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: screen))
+      var oracle = Oracle(grid: grid)
+      var generator = SeededGenerator()
+      for frame in Self.frames(over: screen, count: 60, using: &generator) {
+        grid.markFilled(with: frame)
+        oracle.mark(frame)
+        XCTAssertEqual(grid.filledCellCount, oracle.filledCount, "\(screen) after \(frame)")
+      }
+      XCTAssertEqual(grid.coverageRatio(), CGFloat(oracle.filledCount) / CGFloat(oracle.cells.count))
+      for row in 0..<oracle.height {
+        for column in 0..<oracle.width {
+          let centre = CGPoint(
+            x: screen.minX + (CGFloat(column) + 0.5) * grid.cellSize, y: screen.minY + (CGFloat(row) + 0.5) * grid.cellSize
+          )
+          XCTAssertEqual(grid.isFilled(at: centre), oracle.cells[row * oracle.width + column], "\(screen) cell \(column),\(row)")
+        }
+      }
+    }
+  }
+
+  // A frame ending exactly on a cell boundary still marks the cell it ends on, as it always has.
+  func testAFrameMarksTheCellItsFarEdgeLandsOn() throws {
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: CGRect(x: 0, y: 0, width: 100, height: 100)))
+    grid.markFilled(with: CGRect(x: 0, y: 0, width: 20, height: 10))
+    XCTAssertEqual(grid.filledCellCount, 6)
+    XCTAssertTrue(grid.isFilled(at: CGPoint(x: 25, y: 15)))
+    XCTAssertFalse(grid.isFilled(at: CGPoint(x: 35, y: 5)))
+  }
+
+  func testRemarkingACoveredAreaCountsNothingTwice() throws {
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: CGRect(x: 0, y: 0, width: 1024, height: 1366)))
+    grid.markFilled(with: CGRect(x: 0, y: 0, width: 1024, height: 1366))
+    grid.markFilled(with: CGRect(x: 100, y: 100, width: 300, height: 300))
+    XCTAssertEqual(grid.coverageRatio(), 1)
+    XCTAssertFalse(grid.isFilled(at: CGPoint(x: 2000, y: 10)), "off the grid is never covered")
+  }
+
+  // The regions tile the empty cells exactly, and none of them could grow right along its first row.
+  func testUncoveredRegionsTileTheEmptyCells() throws {
+    for screen in Self.screens {
+      let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: screen))
+      var oracle = Oracle(grid: grid)
+      var generator = SeededGenerator()
+      for frame in Self.frames(over: screen, count: 25, using: &generator) {
+        grid.markFilled(with: frame)
+        oracle.mark(frame)
+      }
+      var claimed = oracle.cells
+      for region in grid.uncoveredRegions() {
+        for row in region.row..<(region.row + region.rows) {
+          for column in region.column..<(region.column + region.columns) {
+            XCTAssertFalse(claimed[row * oracle.width + column], "\(screen) cell \(column),\(row) is filled or in two regions")
+            claimed[row * oracle.width + column] = true
+          }
+        }
+        let right = region.column + region.columns
+        // Filled, or taken by an earlier region: this one's own cells end before `right`.
+        XCTAssertTrue(right == oracle.width || claimed[region.row * oracle.width + right], "\(region) stops short")
+        XCTAssertEqual(region.rect, Self.rect(of: region, in: grid))
+      }
+      XCTAssertTrue(claimed.allSatisfy { $0 }, "\(screen): every empty cell is in a region")
+    }
+  }
+
+  func testAnEmptyGridIsOneRegionAndAFullOneIsNone() throws {
+    let screen = CGRect(x: 0, y: 0, width: 834, height: 1194)
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: screen))
+    XCTAssertEqual(grid.uncoveredRegions().map(\.rect), [screen])
+    grid.markFilled(with: screen)
+    XCTAssertEqual(Array(grid.uncoveredRegions()), [])
+  }
+
+  func testRegionsAreASnapshot() throws {
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: CGRect(x: 0, y: 0, width: 100, height: 100)))
+    grid.markFilled(with: CGRect(x: 0, y: 0, width: 45, height: 100))
+    var regions = grid.uncoveredRegions()
+    grid.markFilled(with: CGRect(x: 0, y: 0, width: 100, height: 100))
+    XCTAssertEqual(regions.next()?.rect, CGRect(x: 50, y: 0, width: 50, height: 100))
+    XCTAssertNil(regions.next())
+  }
+
+  // Discovery's candidates are the lattice points it would have tried before, in the same row-major
+  // order, less those already covered, whether one at a time or in whole covered rows and columns; the
+  // points off the grid are kept. Order matters under `maxPoints`.
+  func testDiscoveryCandidatesAreTheUncoveredLatticePointsInLatticeOrder() throws {
+    let screen = CGRect(x: 0, y: 0, width: 390, height: 844)
+    let grid = try XCTUnwrap(FBAccessibilityCoverageGrid(screenBounds: screen))
+    grid.markFilled(with: CGRect(x: 0, y: 0, width: 390, height: 300))
+    grid.markFilled(with: CGRect(x: 120, y: 500, width: 100, height: 120))
+    // Covers the lattice column at x = 300 from top to bottom, so it is dropped whole.
+    grid.markFilled(with: CGRect(x: 295, y: 0, width: 10, height: 844))
+    for region in [screen, CGRect(x: 200, y: 600, width: 400, height: 400)] {
+      let lattice = FBAXTranslationRequest.candidatePoints(in: region, stepSize: 50, uncoveredBy: nil)
+      let candidates = FBAXTranslationRequest.candidatePoints(in: region, stepSize: 50, uncoveredBy: grid)
+      XCTAssertEqual(candidates, lattice.filter { !grid.isFilled(at: $0) })
+    }
+    XCTAssertEqual(FBAXTranslationRequest.candidatePoints(in: screen, stepSize: 50, uncoveredBy: nil).first, CGPoint(x: 50, y: 50))
+  }
+
+  // MARK: - Helpers
+
+  /// A grid of one flag per cell, marked the way the grid marked before it was packed.
+  private struct Oracle {
+    let width: Int
+    let height: Int
+    let bounds: CGRect
+    let cellSize: CGFloat
+    var cells: [Bool]
+
+    init(grid: FBAccessibilityCoverageGrid) {
+      width = Int(grid.width)
+      height = Int(grid.height)
+      bounds = grid.screenBounds
+      cellSize = grid.cellSize
+      cells = [Bool](repeating: false, count: width * height)
+    }
+
+    var filledCount: Int {
+      cells.filter { $0 }.count
+    }
+
+    mutating func mark(_ frame: CGRect) {
+      guard !frame.isEmpty, !frame.isNull else {
+        return
+      }
+      let x = frame.origin.x - bounds.origin.x
+      let y = frame.origin.y - bounds.origin.y
+      let minX = max(0, Int(floor(x / cellSize)))
+      let minY = max(0, Int(floor(y / cellSize)))
+      let maxX = min(width - 1, Int(floor((x + frame.size.width) / cellSize)))
+      let maxY = min(height - 1, Int(floor((y + frame.size.height) / cellSize)))
+      guard minX <= maxX, minY <= maxY else {
+        return
+      }
+      for y in minY...maxY {
+        for x in minX...maxX {
+          cells[y * width + x] = true
+        }
+      }
+    }
+  }
+
+  private static func rect(of region: FBAccessibilityCoverageGrid.Region, in grid: FBAccessibilityCoverageGrid) -> CGRect {
+    CGRect(
+      x: grid.screenBounds.minX + CGFloat(region.column) * grid.cellSize,
+      y: grid.screenBounds.minY + CGFloat(region.row) * grid.cellSize,
+      width: CGFloat(region.columns) * grid.cellSize,
+      height: CGFloat(region.rows) * grid.cellSize
+    ).intersection(grid.screenBounds)
+  }
+
+  /// Element-sized frames scattered over `screen` and a little past it, some straddling its edges.
+  static func frames(over screen: CGRect, count: Int, using generator: inout SeededGenerator) -> [CGRect] {
+    (0..<count).map { _ in
+      CGRect(
+        x: screen.minX + CGFloat.random(in: -40..<screen.width, using: &generator),
+        y: screen.minY + CGFloat.random(in: -40..<screen.height, using: &generator),
+        width: CGFloat.random(in: 0..<(screen.width / 2), using: &generator),
+        height: CGFloat.random(in: 0..<120, using: &generator)
+      )
+    }
+  }
+}
+
+/// A fixed-seed generator, so every run marks the same frames.
+struct SeededGenerator: RandomNumberGenerator {
+  private var state: UInt64 = 0x9e37_79b9_7f4a_7c15
+
+  mutating func next() -> UInt64 {
+    state = state &* 6_364_136_223_846_793_005 &+ 1_442_695_040_888_963_407
+    return state ^ (state >> 29)
+  }
+}
@@ -270,6 +270,35 @@ final class FBAccessibilitySerializationTests: XCTestCase {
     return try FBAXTranslationRequest(kind: .frontmostApplication).run(match, options: options, isMarkerMatch: true)
   }
 
+  // MARK: - Concurrent subtree serialization
+
+  /// A read tree large enough that `FBAXTreeWalk` serializes sibling subtrees concurrently, with every
+  /// node labelled by its path so any reordering shows.
+  private static func wideTree(path: String = "0", depth: Int = 0) -> [String: Any] {
+    let fanOuts = [4, 4, 20]
+    let fanOut = depth < fanOuts.count ? fanOuts[depth] : 0
+    return [
+      FBAXWire.Node.label.rawValue: path,
+      FBAXWire.Node.children.rawValue: (0..<fanOut).map { wideTree(path: "\(path).\($0)", depth: depth + 1) },
+    ]
+  }
+
+  func testConcurrentSubtreeSerializationMatchesTheSerialWalk() {
+    let tree = Self.wideTree()
+    for nestedFormat in [false, true] {
+      let serial = FBAXNodeSerializer.recursiveDescription(
+        fromElement: FBAXTreeWalk.buildPlatformElementTree(from: tree, pid: 7),
+        token: "",
+        nestedFormat: nestedFormat,
+        keys: FBAXKeys.defaultSet,
+        collector: nil,
+        seenPids: nil
+      )
+      let concurrent = FBAXTreeWalk.describeAllElements(fromTree: tree, keys: FBAXKeys.defaultSet, nestedFormat: nestedFormat, pid: 7)
+      XCTAssertEqual(concurrent, serial)
+    }
+  }
+
   // MARK: - The ax marker read's shape
 
   // A marker read resolves one element, so it serializes as one element — the same shape every other
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+@testable import FBSimulatorControl
+// Matches the existing XCTest-based FBSimulatorControl unit suite (FBSimulatorHIDEventPanTests et al.).
+// ast-grep-ignore: swift-testing/swift/no-new-xctest
+import XCTest
+
+/// Coverage of `FBSimulatorHIDTimeline` — how an event is flattened into primitives at offsets, which
+/// is what lets a batch be sent without each send's latency adding to the delays after it.
+final class FBSimulatorHIDTimelineTests: XCTestCase {
+
+  func testFoldsDelaysIntoOffsets() {
+    let timeline = FBSimulatorHIDTimeline(.tapAt(x: 1, y: 2, duration: 0.5))
+    XCTAssertEqual(timeline.steps.map(\.offset), [0, 0.5])
+    XCTAssertEqual(timeline.steps.map(\.event), [.touch(direction: .down, x: 1, y: 2), .touch(direction: .up, x: 1, y: 2)])
+    XCTAssertEqual(timeline.duration, 0.5)
+  }
+
+  func testFlattensNestedComposites() {
+    let event = FBSimulatorHIDEvent.composite([
+      .shortKeyPress(4),
+      .delay(0.25),
+      .composite([.shortKeyPress(5), .delay(0.5), .composite([.shortKeyPress(6)])]),
+    ])
+    let timeline = FBSimulatorHIDTimeline(event)
+    XCTAssertEqual(timeline.steps.count, 6)
+    XCTAssertEqual(timeline.steps.map(\.offset), [0, 0, 0.25, 0.25, 0.75, 0.75])
+    XCTAssertTrue(timeline.steps.allSatisfy { $0.event.subEvents == nil })
+  }
+
+  func testKeepsTrailingDelayInDuration() {
+    let timeline = FBSimulatorHIDTimeline(.composite([.shake, .delay(1)]))
+    XCTAssertEqual(timeline.steps.map(\.offset), [0])
+    XCTAssertEqual(timeline.duration, 1)
+  }
+
+  func testNegativeDelaysCountAsZero() {
+    let timeline = FBSimulatorHIDTimeline(.composite([.shake, .delay(-1), .lockDevice]))
+    XCTAssertEqual(timeline.steps.map(\.offset), [0, 0])
+    XCTAssertEqual(timeline.duration, 0)
+  }
+
+  func testSwipeSpansItsDuration() {
+    let timeline = FBSimulatorHIDTimeline(.swipe(0, yStart: 0, xEnd: 0, yEnd: 100, delta: 10, duration: 1.2))
+    let offsets = timeline.steps.map(\.offset)
+    XCTAssertEqual(offsets, offsets.sorted())
+    XCTAssertEqual(timeline.duration, 1.2, accuracy: 0.000001)
+  }
+}
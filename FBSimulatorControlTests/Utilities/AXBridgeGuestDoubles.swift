@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) Meta Platforms, Inc. and affiliates.
+ *
+ * This source code is licensed under the MIT license found in the
+ * LICENSE file in the root directory of this source tree.
+ */
+
+import CoreGraphics
+import Darwin
+import FBControlCore
+@testable import FBSimulatorControl
+import Foundation
+
+// MARK: - Fake serve guest
+
+/// An `accessibility serve` guest on a real Unix-domain socket: it negotiates, frames and answers
+/// hit-tests the way the guest does, so an `FBAXBridgeConnection` can be driven end to end without a
+/// simulator. It serves a single client on a queue of its own, until that client goes away.
+///
+/// A hit-test is answered with an element labelled by `label(x:y:)` of its point, so a test can tell
+/// which request a response answers without the fake having to remember.
+///
+// SAFETY: every stored property is immutable after init; the listener and the accepted connection are
+// only used by the one serving block.
+// patternlint-disable-next-line unchecked-sendable
+final class FBAXFakeGuest: @unchecked Sendable {
+
+  let path: String
+  private let listener: Int32
+  private let predatesNegotiate: Bool
+  private let reversingGroupsOf: Int
+  private let closingAfter: Int?
+  private let idOffset: UInt32
+
+  /// - Parameters:
+  ///   - predatesNegotiate: answers `negotiate` and `hittest-batch` as unsupported verbs and frames by
+  ///     length alone, as a guest built before either existed does.
+  ///   - reversingGroupsOf: holds answers back until this many requests have arrived, then sends them
+  ///     newest first. Only a host with that many requests in flight gets any answer at all, and only
+  ///     one routing by request id gets the right ones.
+  ///   - closingAfter: closes the connection on reading this many requests, answering none of them.
+  ///   - idOffset: added to each echoed request id, so every answer names a request nobody sent.
+  init(
+    predatesNegotiate: Bool = false,
+    reversingGroupsOf: Int = 1,
+    closingAfter: Int? = nil,
+    idOffset: UInt32 = 0
+  ) throws {
+    // Under /tmp with a short name: `sun_path` is 104 bytes, which the per-user temp directory alone
+    // goes most of the way to filling.
+    path = "/tmp/axg-\(UInt32.random(in: 0..<0xffff_ffff)).sock"
+    self.predatesNegotiate = predatesNegotiate
+    self.reversingGroupsOf = reversingGroupsOf
+    self.closingAfter = closingAfter
+    self.idOffset = idOffset
+    listener = socket(AF_UNIX, SOCK_STREAM, 0)
+    var address = sockaddr_un()
+    address.sun_family = sa_family_t(AF_UNIX)
+    _ = withUnsafeMutablePointer(to: &address.sun_path) { raw in
+      path.withCString { strcpy(UnsafeMutableRawPointer(raw).assumingMemoryBound(to: CChar.self), $0) }
+    }
+    let bound = withUnsafePointer(to: &address) { raw in
+      raw.withMemoryRebound(to: sockaddr.self, capacity: 1) {
+        Darwin.bind(listener, $0, socklen_t(MemoryLayout<sockaddr_un>.size)) == 0
+      }
+    }
+    guard bound, listen(listener, 1) == 0 else {
+      close(listener)
+      throw FBAXBridgeError.guestFailure("the fake guest could not listen on \(path)")
+    }
+    DispatchQueue.global().async { [self] in
+      serve()
+    }
+  }
+
+  /// Connects to the fake the way the persistent transport connects to a spawned serve, negotiating
+  /// before handing the connection back.
+  func connect() async throws -> FBAXBridgeConnection {
+    let fileDescriptor = try await FBAXBridgeConnection.connect(path: path, timeout: 5)
+    let connection = FBAXBridgeConnection(fileDescriptor: fileDescriptor, process: nil, socketPath: path, logger: nil)
+    _ = try await connection.negotiate()
+    return connection
+  }
+
+  static func label(x: Double, y: Double) -> String {
+    "\(x),\(y)"
+  }
+
+  /// The request payload for a single hit-test, as the persistent transport sends it.
+  static func hitTestRequest(x: Double, y: Double) throws -> Data {
+    try JSONSerialization.data(withJSONObject: [
+      FBAXWire.Request.verb.key: FBAXWire.Verb.hitTest.rawValue,
+      FBAXWire.Request.x.key: x,
+      FBAXWire.Request.y.key: y,
+    ])
+  }
+
+  /// The request payload for a batch hit-test, as the persistent transport sends it.
+  static func hitTestBatchRequest(points: [CGPoint]) throws -> Data {
+    try JSONSerialization.data(withJSONObject: [
+      FBAXWire.Request.verb.key: FBAXWire.Verb.hitTestBatch.rawValue,
+      FBAXWire.Request.points.key: points.map { [Double($0.x), Double($0.y)] },
+    ])
+  }
+
+  // MARK: - Serving
+
+  private func serve() {
+    let connection = accept(listener, nil, nil)
+    close(listener)
+    guard connection >= 0 else { return }
+    defer { close(connection) }
+    var requestIds = false
+    var received = 0
+    var held: [(requestId: UInt32?, response: [String: Any])] = []
+    while let frame = Self.readFrame(connection, requestIds: requestIds),
+      let request = try? JSONSerialization.jsonObject(with: frame.payload) as? [String: Any]
+    {
+      let requestId = frame.requestId
+      let verb = request[FBAXWire.Request.verb.key] as? String
+      if verb == FBAXWire.Verb.negotiate.rawValue, !predatesNegotiate {
+        let offered = request[FBAXWire.Request.framings.key] as? [String] ?? []
+        let negotiated = offered.contains(FBAXWire.Framing.lengthAndId.rawValue)
+        let response: [String: Any] = [
+          FBAXWire.Envelope.ok.rawValue: true,
+          FBAXWire.Envelope.encoding.rawValue: FBAXWire.Encoding.json.rawValue,
+          FBAXWire.Envelope.framing.rawValue: negotiated ? FBAXWire.Framing.lengthAndId.rawValue : FBAXWire.Framing.length.rawValue,
+        ]
+        guard Self.writeFrame(connection, requestId: requestId, response: response) else { return }
+        requestIds = negotiated
+        continue
+      }
+      received += 1
+      if received == closingAfter {
+        return
+      }
+      held.append((requestId.map { $0 &+ idOffset }, answer(request)))
+      guard held.count == reversingGroupsOf else { continue }
+      for (requestId, response) in held.reversed() {
+        guard Self.writeFrame(connection, requestId: requestId, response: response) else { return }
+      }
+      held = []
+    }
+  }
+
+  private func answer(_ request: [String: Any]) -> [String: Any] {
+    switch request[FBAXWire.Request.verb.key] as? String {
+    case FBAXWire.Verb.hitTest.rawValue:
+      return Self.hit(x: request[FBAXWire.Request.x.key] as? Double ?? 0, y: request[FBAXWire.Request.y.key] as? Double ?? 0)
+    case FBAXWire.Verb.hitTestBatch.rawValue where !predatesNegotiate:
+      let points = request[FBAXWire.Request.points.key] as? [[Double]] ?? []
+      return [
+        FBAXWire.Envelope.ok.rawValue: true,
+        FBAXWire.Envelope.results.rawValue: points.map { Self.hit(x: $0[0], y: $0[1]) },
+      ]
+    default:
+      return [
+        FBAXWire.Envelope.ok.rawValue: false,
+        FBAXWire.Envelope.error.rawValue: "unsupported verb: \(request[FBAXWire.Request.verb.key] ?? "(nil)")",
+        FBAXWire.Envelope.errorKind.rawValue: FBAXWire.ErrorKind.badRequest.rawValue,
+      ]
+    }
+  }
+
+  private static func hit(x: Double, y: Double) -> [String: Any] {
+    [
+      FBAXWire.Envelope.ok.rawValue: true,
+      FBAXWire.Envelope.pid.rawValue: 42,
+      FBAXWire.Envelope.tree.rawValue: [
+        FBAXWire.Node.label.rawValue: label(x: x, y: y),
+        FBAXWire.Node.automationType.rawValue: 9,
+        FBAXWire.Node.frame.rawValue: CGRectCreateDictionaryRepresentation(CGRect(x: x - 10, y: y - 10, width: 20, height: 20)) as NSDictionary,
+      ] as [String: Any],
+    ]
+  }
+
+  // MARK: - Framing
+
+  private static func readFrame(_ connection: Int32, requestIds: Bool) -> (requestId: UInt32?, payload: Data)? {
+    guard let header = readAll(connection, count: requestIds ? 8 : 4) else {
+      return nil
+    }
+    let length = Int(bigEndian(header[0..<4]))
+    guard let payload = readAll(connection, count: length) else {
+      return nil
+    }
+    return (requestIds ? bigEndian(header[4..<8]) : nil, Data(payload))
+  }
+
+  private static func writeFrame(_ connection: Int32, requestId: UInt32?, response: [String: Any]) -> Bool {
+    guard let payload = try? JSONSerialization.data(withJSONObject: response) else {
+      return false
+    }
+    var frame = bigEndianBytes(UInt32(payload.count))
+    if let requestId {
+      frame += bigEndianBytes(requestId)
+    }
+    frame += payload
+    return frame.withUnsafeBytes { raw in
+      var offset = 0
+      while offset < raw.count {
+        let written = send(connection, raw.baseAddress! + offset, raw.count - offset, 0)
+        guard written > 0 else { return false }
+        offset += written
+      }
+      return true
+    }
+  }
+
+  private static func readAll(_ connection: Int32, count: Int) -> [UInt8]? {
+    var buffer = [UInt8](repeating: 0, count: count)
+    var offset = 0
+    while offset < count {
+      let got = buffer.withUnsafeMutableBytes { recv(connection, $0.baseAddress! + offset, count - offset, 0) }
+      guard got > 0 else { return nil }
+      offset += got
+    }
+    return buffer
+  }
+
+  private static func bigEndian(_ bytes: ArraySlice<UInt8>) -> UInt32 {
+    bytes.reduce(0) { ($0 << 8) | UInt32($1) }
+  }
+
+  private static func bigEndianBytes(_ value: UInt32) -> [UInt8] {
+    [UInt8((value >> 24) & 0xff), UInt8((value >> 16) & 0xff), UInt8((value >> 8) & 0xff), UInt8(value & 0xff)]
+  }
+}
@@ -92,4 +92,14 @@ NSDictionary<NSString *, id> *FBAXBridgeHandleRequest(NSDictionary<NSString *, i
  */
 NSData *FBAXBridgeSerializeResponse(NSDictionary<NSString *, id> *response);
 
+/**
+ * Serializes a response in the binary form a `serve` connection can negotiate: a magic, the envelope as
+ * `FBAXBridgeSerializeResponse` writes it less its tree, then the tree with every attribute key and string
+ * value written once and named by index after that. A response without a tree is written as JSON.
+ *
+ * The host's decoder is `FBAXWireBinary`, which documents the layout. Non-finite geometry is kept, where
+ * JSON has to send it as null; a tree that cannot be encoded degrades to the JSON response.
+ */
+NSData *FBAXBridgeSerializeBinaryResponse(NSDictionary<NSString *, id> *response);
+
 NS_ASSUME_NONNULL_END
@@ -109,6 +109,10 @@ static NSString *const kNodeAttributeReadFailures = @"FBAttributeReadFailures";
 static NSString *const kResponseShutdown = @"shutdown";
 static NSString *const kRequestX = @"x";
 static NSString *const kRequestY = @"y";
+// A `hittest-batch`'s points, as `[x, y]` pairs, and its answers: one `hittest` envelope per point, in the
+// order the points were sent.
+static NSString *const kRequestPoints = @"points";
+static NSString *const kResponseResults = @"results";
 // Selects how a fused frontmost read (a `describe` with no pid) resolves the foreground app. Optional;
 // defaults to `window-server` (the authoritative query).
 static NSString *const kRequestMethod = @"method";
@@ -194,6 +198,8 @@ static NSString *const kAlertControllerClassPrefix = @"_UIAlertController";
 
 static NSString *const kVerbDescribe = @"describe";
 static NSString *const kVerbHitTest = @"hittest";
+// Every point in one request, for a host probing many in a row — one round trip instead of one apiece.
+static NSString *const kVerbHitTestBatch = @"hittest-batch";
 // Asks a `serve` process to exit. Answered before exiting so the caller learns it was honoured, and
 // honoured only by `serve` — a one-shot `describe` has nothing to shut down and says so.
 //
@@ -203,6 +209,24 @@ static NSString *const kVerbHitTest = @"hittest";
 static NSString *const kVerbShutdown = @"shutdown";
 // Set by the shutdown verb and read by the serve loop after the response is written.
 static BOOL gShutdownRequested = NO;
+// Settles the response encoding for the rest of a `serve` connection. Answered by the serve loop rather
+// than the dispatcher, since only a connection has a rest to settle — a one-shot `describe` answers it as
+// an unsupported verb, which is also how a guest predating it answers, and either way the host reads JSON.
+static NSString *const kVerbNegotiate = @"negotiate";
+// The encodings a `negotiate` offers, and the one it settled on. JSON is what every connection starts
+// with; the binary form is `FBAXBridgeSerializeBinaryResponse`.
+static NSString *const kRequestEncodings = @"encodings";
+static NSString *const kResponseEncoding = @"encoding";
+static NSString *const kEncodingJSON = @"json";
+static NSString *const kEncodingBinary = @"binary-v1";
+// The frame headers a `negotiate` offers, and the one it settled on. Every connection starts on `length`,
+// the 4-byte big-endian payload length; `length-id` follows it with a 4-byte big-endian request id that
+// the response echoes, so a host with several requests in flight can route each answer without parsing
+// it. The serve loop still answers one request at a time and in order — the id is the host's to use.
+static NSString *const kRequestFramings = @"framings";
+static NSString *const kResponseFraming = @"framing";
+static NSString *const kFramingLength = @"length";
+static NSString *const kFramingLengthAndId = @"length-id";
 // Two write verbs rather than one: performing a semantic action and setting an attribute are separate
 // runtime calls that take different arguments, and fusing them would leave every request carrying a field
 // the other kind ignores.
@@ -1098,6 +1122,34 @@ static NSDictionary *FBAXBridgeHitTest(id<FBAXRuntime> runtime, NSDictionary *re
   };
 }
 
+// Answers `hittest-batch`: `FBAXBridgeHitTest` at each point in turn, with the rest of the request shared.
+// A point's failure is that point's answer, not the batch's — one application that does not answer must not
+// cost the host the points around it — so only a request that is malformed as a whole is refused.
+static NSDictionary *FBAXBridgeHitTestBatch(id<FBAXRuntime> runtime, NSDictionary *request)
+{
+  NSArray *points = [request[kRequestPoints] isKindOfClass:NSArray.class] ? request[kRequestPoints] : nil;
+  if (!points) {
+    return FBAXBridgeTaggedErrorResponse(@"hittest-batch requires a points array", kErrorKindBadRequest, nil);
+  }
+  for (id point in points) {
+    if (![point isKindOfClass:NSArray.class] || [point count] != 2 || ![point[0] isKindOfClass:NSNumber.class]
+        || ![point[1] isKindOfClass:NSNumber.class]) {
+      return FBAXBridgeTaggedErrorResponse(@"each hittest-batch point must be an [x, y] pair", kErrorKindBadRequest, nil);
+    }
+  }
+  NSMutableDictionary<NSString *, id> *single = [request mutableCopy];
+  [single removeObjectForKey:kRequestPoints];
+  NSMutableArray<NSDictionary *> *results = [NSMutableArray arrayWithCapacity:points.count];
+  for (NSArray<NSNumber *> *point in points) {
+    @autoreleasepool {
+      single[kRequestX] = point[0];
+      single[kRequestY] = point[1];
+      [results addObject:FBAXBridgeHitTest(runtime, [single copy])];
+    }
+  }
+  return @{kResponseOk : @YES, kResponseResults : results};
+}
+
 #pragma mark - Writes
 
 // The semantic action a wire name asks for. Answers NO for a name this guest does not know, leaving
@@ -1343,6 +1395,7 @@ static NSDictionary<NSString *, id> *FBAXBridgeDispatchRequest(NSDictionary<NSSt
   NSString *verb = [requestedVerb isKindOfClass:NSString.class] ? requestedVerb : nil;
   BOOL isDescribe = [verb isEqualToString:kVerbDescribe];
   BOOL isHitTest = [verb isEqualToString:kVerbHitTest];
+  BOOL isHitTestBatch = [verb isEqualToString:kVerbHitTestBatch];
   BOOL isPerform = [verb isEqualToString:kVerbPerform];
   BOOL isSetValue = [verb isEqualToString:kVerbSetValue];
   if ([verb isEqualToString:kVerbShutdown]) {
@@ -1351,7 +1404,7 @@ static NSDictionary<NSString *, id> *FBAXBridgeDispatchRequest(NSDictionary<NSSt
     gShutdownRequested = YES;
     return @{kResponseOk : @YES, kResponseShutdown : @YES};
   }
-  if (!isDescribe && !isHitTest && !isPerform && !isSetValue) {
+  if (!isDescribe && !isHitTest && !isHitTestBatch && !isPerform && !isSetValue) {
     return FBAXBridgeTaggedErrorResponse(
       [NSString stringWithFormat:@"unsupported verb: %@", requestedVerb ?: @"(nil)"],
       kErrorKindBadRequest,
@@ -1389,6 +1442,9 @@ static NSDictionary<NSString *, id> *FBAXBridgeDispatchRequest(NSDictionary<NSSt
   if (isHitTest) {
     return FBAXBridgeHitTest(runtime, request);
   }
+  if (isHitTestBatch) {
+    return FBAXBridgeHitTestBatch(runtime, request);
+  }
 
   // The write verbs are point-addressed for the same reason: a one-shot guest exits between requests, so an
   // element handle cannot survive one. Naming the target and acting on it in a single request is what makes
@@ -1574,6 +1630,254 @@ static NSDictionary<NSString *, id> *FBAXBridgeDispatchRequest(NSDictionary<NSSt
   return response;
 }
 
+#pragma mark - Binary encoding
+
+// The first bytes of a binary response. JSON cannot begin with them, so the host tells the encodings apart
+// without tracking which was negotiated.
+static const uint8_t kBinaryMagic[] = {'F', 'B', 'A', 'X', 1};
+
+// One byte ahead of each value. The host decoder is `FBAXWireBinary` in FBSimulatorControl, whose doc
+// comment carries the full layout; the two share no header, so these numbers are the contract.
+typedef NS_ENUM(uint8_t, FBAXBinaryTag) {
+  FBAXBinaryTagNull = 0,
+  FBAXBinaryTagFalse = 1,
+  FBAXBinaryTagTrue = 2,
+  FBAXBinaryTagInteger = 3,
+  FBAXBinaryTagDouble = 4,
+  FBAXBinaryTagString = 5,
+  FBAXBinaryTagRect = 6,
+  FBAXBinaryTagPoint = 7,
+  FBAXBinaryTagElement = 8,
+  FBAXBinaryTagArray = 9,
+  FBAXBinaryTagDictionary = 10,
+};
+
+// Unsigned LEB128.
+static void FBAXBinaryAppendVarint(NSMutableData *data, uint64_t value)
+{
+  uint8_t bytes[10];
+  size_t length = 0;
+  do {
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    bytes[length++] = value == 0 ? byte : (byte | 0x80);
+  } while (value != 0);
+  [data appendBytes:bytes length:length];
+}
+
+// Little-endian IEEE 754, whatever the host byte order, and non-finite values pass through: a frame edge
+// of an off-screen element keeps the infinity JSON could only send as null.
+static void FBAXBinaryAppendDouble(NSMutableData *data, double value)
+{
+  uint64_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  bits = CFSwapInt64HostToLittle(bits);
+  [data appendBytes:&bits length:sizeof(bits)];
+}
+
+static void FBAXBinaryAppendTable(NSMutableData *data, NSArray<NSString *> *table)
+{
+  FBAXBinaryAppendVarint(data, table.count);
+  for (NSString *string in table) {
+    NSData *bytes = [string dataUsingEncoding:NSUTF8StringEncoding] ?: [NSData data];
+    FBAXBinaryAppendVarint(data, bytes.length);
+    [data appendData:bytes];
+  }
+}
+
+// The index of `string` in `table`, appending it on first sight.
+static NSUInteger FBAXBinaryIntern(NSString *string,
+                                   NSMutableArray<NSString *> *table,
+                                   NSMutableDictionary<NSString *, NSNumber *> *indices)
+{
+  NSNumber *index = indices[string];
+  if (index) {
+    return index.unsignedIntegerValue;
+  }
+  indices[string] = @(table.count);
+  [table addObject:string];
+  return table.count - 1;
+}
+
+// Encodes one tree, interning every key and string value it meets. The tables are written ahead of the
+// nodes but are only complete once the whole tree has been seen, so the nodes go to a buffer of their own.
+@interface FBAXBinaryEncoder : NSObject
+
+@property (nonatomic, readonly) NSMutableArray<NSString *> *keys;
+@property (nonatomic, readonly) NSMutableArray<NSString *> *strings;
+@property (nonatomic, readonly) NSMutableData *nodes;
+
+- (void)encodeNode:(NSDictionary<NSString *, id> *)node;
+
+@end
+
+@implementation FBAXBinaryEncoder {
+  NSMutableDictionary<NSString *, NSNumber *> *_keyIndices;
+  NSMutableDictionary<NSString *, NSNumber *> *_stringIndices;
+}
+
+- (instancetype)init
+{
+  self = [super init];
+  if (self) {
+    _keys = [NSMutableArray array];
+    _strings = [NSMutableArray array];
+    _nodes = [NSMutableData data];
+    _keyIndices = [NSMutableDictionary dictionary];
+    _stringIndices = [NSMutableDictionary dictionary];
+  }
+  return self;
+}
+
+- (void)appendTag:(FBAXBinaryTag)tag
+{
+  [_nodes appendBytes:&tag length:sizeof(tag)];
+}
+
+- (void)encodeNode:(NSDictionary<NSString *, id> *)node
+{
+  [self encodeAttributes:node];
+  id children = node[kAXChildren];
+  NSMutableArray<NSDictionary *> *childNodes = [NSMutableArray array];
+  if ([children isKindOfClass:NSArray.class]) {
+    for (id child in children) {
+      if ([child isKindOfClass:NSDictionary.class]) {
+        [childNodes addObject:child];
+      }
+    }
+  }
+  FBAXBinaryAppendVarint(_nodes, childNodes.count);
+  for (NSDictionary *child in childNodes) {
+    [self encodeNode:child];
+  }
+}
+
+- (void)encodeAttributes:(NSDictionary<NSString *, id> *)node
+{
+  FBAXBinaryAppendVarint(_nodes, node.count - (node[kAXChildren] ? 1 : 0));
+  for (NSString *key in node) {
+    if ([key isEqualToString:kAXChildren]) {
+      continue;
+    }
+    FBAXBinaryAppendVarint(_nodes, FBAXBinaryIntern(key, _keys, _keyIndices));
+    [self encodeValue:node[key] key:key];
+  }
+}
+
+- (void)encodeValue:(id)value key:(NSString *_Nullable)key
+{
+  if ([value isKindOfClass:NSString.class]) {
+    [self appendTag:FBAXBinaryTagString];
+    FBAXBinaryAppendVarint(_nodes, FBAXBinaryIntern(value, _strings, _stringIndices));
+  } else if ([value isKindOfClass:NSNumber.class]) {
+    CFNumberRef number = (__bridge CFNumberRef)value;
+    if (CFGetTypeID(number) == CFBooleanGetTypeID()) {
+      [self appendTag:[value boolValue] ? FBAXBinaryTagTrue : FBAXBinaryTagFalse];
+    } else if (CFNumberIsFloatType(number)) {
+      // As `FBAXBridgeJSONSafeNumber` would: only geometry carries a non-finite number to the host.
+      if (!isfinite([value doubleValue])) {
+        [self appendTag:FBAXBinaryTagNull];
+        return;
+      }
+      [self appendTag:FBAXBinaryTagDouble];
+      FBAXBinaryAppendDouble(_nodes, [value doubleValue]);
+    } else {
+      int64_t integer = [value longLongValue];
+      [self appendTag:FBAXBinaryTagInteger];
+      FBAXBinaryAppendVarint(_nodes, ((uint64_t)integer << 1) ^ (uint64_t)(integer >> 63));
+    }
+  } else if ([value isKindOfClass:NSDictionary.class]) {
+    [self encodeDictionary:value key:key];
+  } else if ([value isKindOfClass:NSArray.class]) {
+    NSArray *array = value;
+    [self appendTag:FBAXBinaryTagArray];
+    FBAXBinaryAppendVarint(_nodes, array.count);
+    for (id element in array) {
+      [self encodeValue:element key:nil];
+    }
+  } else {
+    [self appendTag:FBAXBinaryTagNull];
+  }
+}
+
+// Geometry is recognised by the key it is under, as `FBAXBridgeJSONSafeValue` recognises it: a dictionary
+// that merely has the shape of a rectangle is not reinterpreted as one.
+- (void)encodeDictionary:(NSDictionary<NSString *, id> *)dictionary key:(NSString *_Nullable)key
+{
+  CGRect rect = CGRectZero;
+  CGPoint point = CGPointZero;
+  if ([key isEqualToString:kAXFrame]
+      && CGRectMakeWithDictionaryRepresentation((__bridge CFDictionaryRef)dictionary, &rect)) {
+    [self appendTag:FBAXBinaryTagRect];
+    FBAXBinaryAppendDouble(_nodes, rect.origin.x);
+    FBAXBinaryAppendDouble(_nodes, rect.origin.y);
+    FBAXBinaryAppendDouble(_nodes, rect.size.width);
+    FBAXBinaryAppendDouble(_nodes, rect.size.height);
+  } else if (key && FBAXBridgeIsPointAttribute(key)
+             && CGPointMakeWithDictionaryRepresentation((__bridge CFDictionaryRef)dictionary, &point)) {
+    [self appendTag:FBAXBinaryTagPoint];
+    FBAXBinaryAppendDouble(_nodes, point.x);
+    FBAXBinaryAppendDouble(_nodes, point.y);
+  } else if ([key isEqualToString:kNodeExplainedBy]) {
+    [self appendTag:FBAXBinaryTagElement];
+    [self encodeAttributes:dictionary];
+  } else {
+    [self appendTag:FBAXBinaryTagDictionary];
+    FBAXBinaryAppendVarint(_nodes, dictionary.count);
+    for (NSString *nestedKey in dictionary) {
+      FBAXBinaryAppendVarint(_nodes, FBAXBinaryIntern(nestedKey, _keys, _keyIndices));
+      [self encodeValue:dictionary[nestedKey] key:nestedKey];
+    }
+  }
+}
+
+@end
+
+NSData *FBAXBridgeSerializeBinaryResponse(NSDictionary<NSString *, id> *response)
+{
+  id tree = response[kResponseTree];
+  if (![tree isKindOfClass:NSDictionary.class]) {
+    return FBAXBridgeSerializeResponse(response);
+  }
+  FBAXBinaryEncoder *encoder = [FBAXBinaryEncoder new];
+  @try {
+    [encoder encodeNode:tree];
+  } @catch (NSException *exception) {
+    // The same guard `FBAXBridgeSerializeResponse` keeps: a response that cannot be written this way is
+    // written the other way, never allowed to sever the connection.
+    NSLog(@"[AccessibilityService] binary response encoding raised: %@; sending JSON", exception);
+    return FBAXBridgeSerializeResponse(response);
+  }
+  NSMutableDictionary<NSString *, id> *envelope = [response mutableCopy];
+  [envelope removeObjectForKey:kResponseTree];
+  NSData *envelopeData = FBAXBridgeSerializeResponse(envelope);
+
+  NSMutableData *data = [NSMutableData dataWithBytes:kBinaryMagic length:sizeof(kBinaryMagic)];
+  FBAXBinaryAppendVarint(data, envelopeData.length);
+  [data appendData:envelopeData];
+  FBAXBinaryAppendTable(data, encoder.keys);
+  FBAXBinaryAppendTable(data, encoder.strings);
+  [data appendData:encoder.nodes];
+  return data;
+}
+
+// Answers `negotiate`: binary when the host offers it, JSON otherwise, and request ids in the frame header
+// when the host offers them. A host that offers nothing this guest knows is not an error — it has simply
+// asked for the defaults. The framing applies from the frame after this response, which the caller
+// writes in the framing the request arrived in.
+static NSDictionary *FBAXBridgeNegotiateResponse(NSDictionary *request, BOOL *binaryResponses, BOOL *requestIds)
+{
+  id offered = request[kRequestEncodings];
+  *binaryResponses = [offered isKindOfClass:NSArray.class] && [offered containsObject:kEncodingBinary];
+  id framings = request[kRequestFramings];
+  *requestIds = [framings isKindOfClass:NSArray.class] && [framings containsObject:kFramingLengthAndId];
+  return @{
+    kResponseOk : @YES,
+    kResponseEncoding : *binaryResponses ? kEncodingBinary : kEncodingJSON,
+    kResponseFraming : *requestIds ? kFramingLengthAndId : kFramingLength,
+  };
+}
+
 #pragma mark - Persistent serve transport
 
 // The `serve` accept queue. The loop handles one client at a time, so the queue exists only to hold a
@@ -1625,15 +1929,19 @@ static BOOL FBAXBridgeReadFully(int fd, void *buffer, size_t length)
 
 // Serves the transport-agnostic request handler over a Unix-domain socket so a host client can reuse
 // one warm process for many reads (the ~30x amortization). The framing is a 4-byte big-endian length
-// prefix followed by a JSON request/response object — the same envelope the oneshot path emits. The
+// prefix (plus a 4-byte request id echoed on the response, once the connection has negotiated
+// `length-id`) followed by a JSON request/response object — the same envelope the oneshot path emits —
+// or, once the connection has negotiated it, a response from `FBAXBridgeSerializeBinaryResponse`. The
 // host binds/connects the same `/tmp` path (host and this in-simulator process share the filesystem
 // namespace as the same user, so no data-container translation is needed).
 //
 // This intentionally serves one client at a time, serially: the host holds a single long-lived
 // connection for the session, so requests are processed one-by-one over that connection with a
 // blocking read between them (the read blocks waiting for the next command — the expected interactive
-// idle, not a stall). When the client disconnects, the inner read returns EOF and the outer loop
-// re-`accept`s, allowing a reconnect. The process is torn down by the host at end of session.
+// idle, not a stall). The host may pipeline several requests without waiting for their answers; they
+// queue in the socket buffer and are answered in the order they arrived. When the client disconnects,
+// the inner read returns EOF and the outer loop re-`accept`s, allowing a reconnect. The process is torn
+// down by the host at end of session.
 static int FBAXBridgeServe(NSString *socketPath)
 {
   int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
@@ -1694,16 +2002,19 @@ static int FBAXBridgeServe(NSString *socketPath)
     // `poll` then reaps the serve if no new client arrives.
     struct timeval recvTimeout = {.tv_sec = kIdleTimeoutSeconds, .tv_usec = 0};
     setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &recvTimeout, sizeof(recvTimeout));
+    // Per connection: a host that reconnects may be an older one that never negotiates.
+    BOOL binaryResponses = NO;
+    BOOL requestIds = NO;
     while (YES) {
       // A pool per request. `serve` never returns, so the process-lifetime pool `main` opens is never
       // popped: without this, every tree, node dictionary and attribute string autoreleased while
       // answering a request is held until the serve exits.
       @autoreleasepool {
-        uint32_t frameLength = 0;
-        if (!FBAXBridgeReadFully(connection, &frameLength, sizeof(frameLength))) {
+        uint32_t header[2] = {0, 0};
+        if (!FBAXBridgeReadFully(connection, header, requestIds ? sizeof(header) : sizeof(header[0]))) {
           break;
         }
-        frameLength = ntohl(frameLength);
+        uint32_t frameLength = ntohl(header[0]);
         if (frameLength == 0 || frameLength > kMaxFrameBytes) {
           break;
         }
@@ -1712,17 +2023,27 @@ static int FBAXBridgeServe(NSString *socketPath)
           break;
         }
         id parsed = [NSJSONSerialization JSONObjectWithData:requestData options:0 error:NULL];
-        NSDictionary *response = [parsed isKindOfClass:NSDictionary.class]
-        ? FBAXBridgeHandleRequest(parsed)
-        : FBAXBridgeTaggedErrorResponse(@"malformed request frame", kErrorKindBadRequest, nil);
-        NSData *responseData = FBAXBridgeSerializeResponse(response);
-        uint32_t responseLength = htonl((uint32_t)responseData.length);
-        if (!FBAXBridgeWriteFully(connection, &responseLength, sizeof(responseLength))) {
+        NSDictionary *response = nil;
+        BOOL negotiatedRequestIds = requestIds;
+        if (![parsed isKindOfClass:NSDictionary.class]) {
+          response = FBAXBridgeTaggedErrorResponse(@"malformed request frame", kErrorKindBadRequest, nil);
+        } else if ([parsed[kRequestVerb] isEqual:kVerbNegotiate]) {
+          response = FBAXBridgeNegotiateResponse(parsed, &binaryResponses, &negotiatedRequestIds);
+        } else {
+          response = FBAXBridgeHandleRequest(parsed);
+        }
+        NSData *responseData = binaryResponses
+        ? FBAXBridgeSerializeBinaryResponse(response)
+        : FBAXBridgeSerializeResponse(response);
+        // The request's own id, already in network order, goes straight back.
+        header[0] = htonl((uint32_t)responseData.length);
+        if (!FBAXBridgeWriteFully(connection, header, requestIds ? sizeof(header) : sizeof(header[0]))) {
           break;
         }
         if (!FBAXBridgeWriteFully(connection, responseData.bytes, responseData.length)) {
           break;
         }
+        requestIds = negotiatedRequestIds;
         if (gShutdownRequested) {
           // After the write, so the caller is told the shutdown was honoured rather than seeing the
           // socket close under it — which is the shape of a crash, not a reap.
@@ -1746,6 +2067,15 @@ static int FBAXBridgeServe(NSString *socketPath)
 
 #pragma mark - Argv front-end
 
+// Parses the whole of `string` as one number, so `1x` or an empty field is refused rather than read
+// as 0 the way `-doubleValue` would.
+static BOOL FBAXBridgeScanCoordinate(NSString *string, double *value)
+{
+  NSScanner *scanner = [NSScanner scannerWithString:string];
+  scanner.charactersToBeSkipped = nil;
+  return [scanner scanDouble:value] && scanner.isAtEnd;
+}
+
 int handleAccessibilityAction(NSString *action, NSArray<NSString *> *arguments)
 {
   if ([action isEqualToString:kActionServe]) {
@@ -1759,6 +2089,8 @@ int handleAccessibilityAction(NSString *action, NSArray<NSString *> *arguments)
 
   NSMutableDictionary<NSString *, id> *request = [NSMutableDictionary dictionary];
   request[kRequestVerb] = action;
+  // Set when a flag's value cannot be parsed; answered in place of the request.
+  NSDictionary *badRequest = nil;
   for (NSUInteger i = 0; i + 1 < arguments.count; i += 2) {
     NSString *flag = arguments[i];
     NSString *argValue = arguments[i + 1];
@@ -1794,10 +2126,41 @@ int handleAccessibilityAction(NSString *action, NSArray<NSString *> *arguments)
       request[kRequestAssertKey] = argValue;
     } else if ([flag isEqualToString:@"--assert-value"]) {
       request[kRequestAssertValue] = argValue;
+    } else if ([flag isEqualToString:@"--points"]) {
+      // `x,y;x,y`, since argv takes each field as one value. The socket transport sends `[x, y]` pairs.
+      // A pair that is not two numbers refuses the request, rather than hit-testing fewer points than
+      // were asked for and leaving the answers misaligned with the caller's points.
+      NSMutableArray<NSArray<NSNumber *> *> *points = [NSMutableArray array];
+      for (NSString *pair in [argValue componentsSeparatedByString:@";"]) {
+        NSArray<NSString *> *coordinates = [pair componentsSeparatedByString:@","];
+        double x = 0, y = 0;
+        if (coordinates.count != 2
+            || !FBAXBridgeScanCoordinate(coordinates[0], &x)
+            || !FBAXBridgeScanCoordinate(coordinates[1], &y)) {
+          badRequest = FBAXBridgeTaggedErrorResponse(
+            [NSString stringWithFormat:@"--points must be `x,y` pairs separated by `;`, got '%@'", pair],
+            kErrorKindBadRequest,
+            nil
+          );
+          break;
+        }
+        [points addObject:@[@(x), @(y)]];
+      }
+      request[kRequestPoints] = points;
+    } else if ([flag isEqualToString:@"--encodings"]) {
+      // Comma-separated, as `--attributes` is. There is no connection to negotiate over, so the flag
+      // simply selects this one response's encoding.
+      request[kRequestEncodings] = [argValue componentsSeparatedByString:@","];
     }
   }
 
-  NSDictionary *response = FBAXBridgeHandleRequest(request);
+  NSDictionary *response = badRequest ?: FBAXBridgeHandleRequest(request);
+  if ([request[kRequestEncodings] containsObject:kEncodingBinary]) {
+    // No trailing newline: a binary frame is read to its last byte.
+    NSData *binary = FBAXBridgeSerializeBinaryResponse(response);
+    fwrite(binary.bytes, 1, binary.length, stdout);
+    return [response[kResponseOk] boolValue] ? 0 : 1;
+  }
   NSData *json = FBAXBridgeSerializeResponse(response);
   fwrite(json.bytes, 1, json.length, stdout);
   fputc('\n', stdout);
@@ -1843,6 +2206,9 @@ NSDictionary<NSString *, NSString *> *FBAXBridgeWireConstantsForTesting(void)
     @"request.value" : kRequestValue,
     @"request.assertKey" : kRequestAssertKey,
     @"request.assertValue" : kRequestAssertValue,
+    @"request.encodings" : kRequestEncodings,
+    @"request.framings" : kRequestFramings,
+    @"request.points" : kRequestPoints,
     @"envelope.ok" : kResponseOk,
     @"envelope.tree" : kResponseTree,
     @"envelope.error" : kResponseError,
@@ -1860,6 +2226,13 @@ NSDictionary<NSString *, NSString *> *FBAXBridgeWireConstantsForTesting(void)
     @"envelope.modal" : kResponseModal,
     @"envelope.automation" : kResponseAutomation,
     @"envelope.phases" : kResponsePhases,
+    @"envelope.encoding" : kResponseEncoding,
+    @"envelope.framing" : kResponseFraming,
+    @"envelope.results" : kResponseResults,
+    @"encoding.json" : kEncodingJSON,
+    @"encoding.binary" : kEncodingBinary,
+    @"framing.length" : kFramingLength,
+    @"framing.lengthAndId" : kFramingLengthAndId,
     @"phases.traverse" : kPhaseTraverse,
     @"phases.machRoundTrips" : kPhaseMachRoundTrips,
     @"automation.enabled" : kAutomationEnabled,
@@ -1873,9 +2246,11 @@ NSDictionary<NSString *, NSString *> *FBAXBridgeWireConstantsForTesting(void)
     @"modal.alertControllerClassPrefix" : kAlertControllerClassPrefix,
     @"verb.describe" : kVerbDescribe,
     @"verb.hittest" : kVerbHitTest,
+    @"verb.hittestBatch" : kVerbHitTestBatch,
     @"verb.perform" : kVerbPerform,
     @"verb.setvalue" : kVerbSetValue,
     @"verb.shutdown" : kVerbShutdown,
+    @"verb.negotiate" : kVerbNegotiate,
     @"action.press" : kActionPress,
     @"action.scrollUp" : kActionScrollUp,
     @"action.scrollDown" : kActionScrollDown,
@@ -409,6 +409,45 @@ typedef struct FBAXPair {
   XCTAssertNil(failed[@"error_kind"]);
 }
 
+// A batch is the single hit-test at each point, in order. A point's failure is that point's answer: the
+// batch around it still succeeds, so one application that does not answer costs the host nothing else.
+- (void)testHitTestBatchAnswersEachPointInOrder
+{
+  _runtime.hitTestOutcome = [FBAXHitTestOutcome hit:[FBAXFakeElement readable:@"XCUIElementTypeButton"]
+                             owningProcessIdentifier:kAppPid];
+  NSDictionary *response = FBAXBridgeHandleRequest(
+    @{@"verb" : @"hittest-batch", @"points" : @[@[@1, @2], @[@3, @4], @[@5, @6]]}
+  );
+  XCTAssertEqualObjects(response[@"ok"], @YES);
+  NSArray<NSDictionary *> *results = response[@"results"];
+  XCTAssertEqual(results.count, 3u);
+  for (NSDictionary *result in results) {
+    XCTAssertEqualObjects(result[@"pid"], @(kAppPid));
+    XCTAssertEqualObjects(result[@"tree"][kAXElementType], @"XCUIElementTypeButton");
+  }
+  XCTAssertEqual(_runtime.hitTestCount, 3u);
+  XCTAssertEqual(_runtime.lastHitTestPoint.x, 5, @"the points are hit-tested in the order sent");
+  XCTAssertEqual(_runtime.lastHitTestPoint.y, 6);
+
+  _runtime.hitTestOutcome = [FBAXHitTestOutcome applicationNotResponding];
+  NSDictionary *failing = FBAXBridgeHandleRequest(@{@"verb" : @"hittest-batch", @"points" : @[@[@1, @2]]});
+  XCTAssertEqualObjects(failing[@"ok"], @YES, @"a point's failure does not fail the batch");
+  XCTAssertEqualObjects(failing[@"results"][0][@"error_kind"], @"application_not_responding");
+}
+
+// A malformed point refuses the whole batch before anything is hit-tested: answering the points that did
+// parse would leave the host matching answers to the wrong points.
+- (void)testHitTestBatchWithAMalformedPointIsABadRequest
+{
+  _runtime.hitTestOutcome = [FBAXHitTestOutcome empty];
+  for (id points in @[@[@[@1, @2], @[@3]], @[@[@1, @"2"]], @[@"1,2"], @"1,2"]) {
+    NSDictionary *response = FBAXBridgeHandleRequest(@{@"verb" : @"hittest-batch", @"points" : points});
+    XCTAssertEqualObjects(response[@"ok"], @NO, @"%@", points);
+    XCTAssertEqualObjects(response[@"error_kind"], @"bad_request", @"%@", points);
+  }
+  XCTAssertEqual(_runtime.hitTestCount, 0u);
+}
+
 #pragma mark - The default frontmost method
 
 // A fused frontmost read that names no method gets the authoritative frontmost: the window server's, which
@@ -110,6 +110,75 @@ static NSDictionary *FBAXTestsParse(NSData *data)
   XCTAssertNotNil(parsed[@"error"]);
 }
 
+#pragma mark - Binary responses
+
+static NSUInteger FBAXTestsOccurrences(NSData *data, NSString *string)
+{
+  NSData *needle = [string dataUsingEncoding:NSUTF8StringEncoding];
+  NSUInteger count = 0;
+  NSRange remaining = NSMakeRange(0, data.length);
+  while (YES) {
+    NSRange found = [data rangeOfData:needle options:0 range:remaining];
+    if (found.location == NSNotFound) {
+      return count;
+    }
+    count++;
+    remaining = NSMakeRange(NSMaxRange(found), data.length - NSMaxRange(found));
+  }
+}
+
+// The host tells a binary response from JSON by its first bytes alone, and reads the envelope that
+// follows with its JSON parser; the tree is kept out of the envelope.
+- (void)testBinaryResponseIsTheMagicThenTheEnvelopeWithoutItsTree
+{
+  NSMutableDictionary *response = [FBAXTestsFrameResponse(CGRectMake(16, 293, 370, 52)) mutableCopy];
+  response[@"pid"] = @20475;
+  NSData *data = FBAXBridgeSerializeBinaryResponse(response);
+
+  const uint8_t magic[] = {'F', 'B', 'A', 'X', 1};
+  XCTAssertGreaterThan(data.length, sizeof(magic));
+  XCTAssertEqual(memcmp(data.bytes, magic, sizeof(magic)), 0);
+  const uint8_t *bytes = data.bytes;
+  NSUInteger length = bytes[sizeof(magic)];
+  XCTAssertLessThan(length, 0x80u, @"a short envelope's length is a one-byte varint");
+  NSDictionary *envelope = FBAXTestsParse([data subdataWithRange:NSMakeRange(sizeof(magic) + 1, length)]);
+  XCTAssertEqualObjects(envelope, (@{@"ok" : @YES, @"pid" : @20475}));
+}
+
+// The point of the encoding: a key or string repeated across every node crosses the wire once.
+- (void)testBinaryResponseWritesARepeatedKeyAndLabelOnce
+{
+  NSMutableArray *children = [NSMutableArray array];
+  for (NSUInteger index = 0; index < 50; index++) {
+    [children addObject:@{@"XC_kAXXCAttributeLabel" : @"Cell", @"XC_kAXXCAttributeElementType" : @"Cell"}];
+  }
+  NSDictionary *response = @{
+    @"ok" : @YES,
+    @"tree" : @{@"XC_kAXXCAttributeLabel" : @"root", @"XC_kAXXCAttributeChildren" : children},
+  };
+  NSData *binary = FBAXBridgeSerializeBinaryResponse(response);
+  NSData *json = FBAXBridgeSerializeResponse(response);
+  XCTAssertEqual(FBAXTestsOccurrences(binary, @"XC_kAXXCAttributeLabel"), 1u);
+  XCTAssertEqual(FBAXTestsOccurrences(binary, @"Cell"), 1u);
+  XCTAssertLessThan(binary.length * 4, json.length);
+}
+
+// Only a tree is worth encoding; everything else stays JSON, so an error reads the same either way.
+- (void)testBinaryResponseWithoutATreeIsJSON
+{
+  NSDictionary *response = @{@"ok" : @NO, @"error" : @"nope", @"error_kind" : @"bad_request"};
+  XCTAssertEqualObjects(FBAXBridgeSerializeBinaryResponse(response), FBAXBridgeSerializeResponse(response));
+}
+
+// Only a `serve` connection has anything to negotiate, so the dispatcher answers the verb as the guests
+// predating it do — which is what sends the host back to JSON.
+- (void)testNegotiateOutsideAServeConnectionIsAnUnsupportedVerb
+{
+  NSDictionary *response = FBAXBridgeHandleRequest(@{@"verb" : @"negotiate", @"encodings" : @[@"binary-v1"]});
+  XCTAssertEqualObjects(response[@"ok"], @NO);
+  XCTAssertEqualObjects(response[@"error_kind"], @"bad_request");
+}
+
 #pragma mark - Request validation
 
 // A request frame is JSON decoded off the wire, so `verb` arrives as whatever type the host sent — a
@@ -227,6 +296,9 @@ static NSDictionary *FBAXTestsParse(NSData *data)
     @"request.value" : @"value",
     @"request.assertKey" : @"assertKey",
     @"request.assertValue" : @"assertValue",
+    @"request.encodings" : @"encodings",
+    @"request.framings" : @"framings",
+    @"request.points" : @"points",
     @"envelope.ok" : @"ok",
     @"envelope.tree" : @"tree",
     @"envelope.error" : @"error",
@@ -244,6 +316,13 @@ static NSDictionary *FBAXTestsParse(NSData *data)
     @"envelope.modal" : @"modal",
     @"envelope.automation" : @"automation",
     @"envelope.phases" : @"phases",
+    @"envelope.encoding" : @"encoding",
+    @"envelope.framing" : @"framing",
+    @"envelope.results" : @"results",
+    @"encoding.json" : @"json",
+    @"encoding.binary" : @"binary-v1",
+    @"framing.length" : @"length",
+    @"framing.lengthAndId" : @"length-id",
     @"phases.traverse" : @"traverse_ms",
     @"phases.machRoundTrips" : @"mach_round_trips",
     @"automation.enabled" : @"enabled",
@@ -257,9 +336,11 @@ static NSDictionary *FBAXTestsParse(NSData *data)
     @"modal.alertControllerClassPrefix" : @"_UIAlertController",
     @"verb.describe" : @"describe",
     @"verb.hittest" : @"hittest",
+    @"verb.hittestBatch" : @"hittest-batch",
     @"verb.perform" : @"perform",
     @"verb.setvalue" : @"setvalue",
     @"verb.shutdown" : @"shutdown",
+    @"verb.negotiate" : @"negotiate",
     @"action.press" : @"press",
     @"action.scrollUp" : @"scroll-up",
     @"action.scrollDown" : @"scroll-down",
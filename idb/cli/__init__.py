@@ -6,11 +6,13 @@
 
 # pyre-strict
 
+import json
 import logging
 import os
 from abc import ABCMeta, abstractmethod
 from argparse import ArgumentParser, Namespace
-from collections.abc import AsyncGenerator
+from collections.abc import AsyncGenerator, Callable
+from typing import TypeVar
 
 from idb.common import plugin
 from idb.common.command import Command
@@ -27,10 +29,14 @@ from idb.common.types import (
     LoggingMetadata,
     TCPAddress,
 )
+from idb.grpc.channel_pool import ChannelPool
 from idb.grpc.client import Client as GrpcClient
+from idb.grpc.group import ClientGroup, DEFAULT_PARALLELISM, TargetResult
 from idb.grpc.management import ClientManager as GrpcClientManager
 from idb.utils.contextlib import asynccontextmanager
 
+_T = TypeVar("_T")
+
 
 def _parse_address(value: str) -> Address:
     values = value.rsplit(":", 1)
@@ -50,7 +56,7 @@ def _get_management_client(logger: logging.Logger, args: Namespace) -> ClientMan
 
 @asynccontextmanager
 async def _get_client(
-    args: Namespace, logger: logging.Logger
+    args: Namespace, logger: logging.Logger, channel_pool: ChannelPool
 ) -> AsyncGenerator[GrpcClient, None]:
     companion = vars(args).get("companion")
     if companion is not None:
@@ -62,7 +68,7 @@ async def _get_client(
             yield client
     else:
         async with GrpcClientManager(
-            logger=logger, companion_path=args.companion_path
+            logger=logger, companion_path=args.companion_path, channel_pool=channel_pool
         ).from_udid(udid=vars(args).get("udid")) as client:
             yield client
 
@@ -125,20 +131,101 @@ class BaseCommand(Command, metaclass=ABCMeta):
         raise Exception("subclass")
 
 
+def report_group_results(
+    results: list[TargetResult[_T]],
+    as_json: bool,
+    describe: Callable[[_T], dict[str, object]],
+    summarize: Callable[[_T], str],
+) -> None:
+    for result in results:
+        if as_json:
+            output: dict[str, object] = {
+                "udid": result.udid,
+                "duration": round(result.duration, 3),
+            }
+            if result.error is not None:
+                output["error"] = str(result.error)
+            elif result.value is not None:
+                output.update(describe(result.value))
+            print(json.dumps(output))
+        elif result.error is not None:
+            print(f"{result.udid}: Failed after {result.duration:.2f}s: {result.error}")
+        else:
+            summary = summarize(result.value) if result.value is not None else "Done"
+            print(f"{result.udid}: {summary} in {result.duration:.2f}s")
+    failures = [result.udid for result in results if result.error is not None]
+    if failures:
+        raise IdbException(
+            f"Failed on {len(failures)} of {len(results)} targets: {', '.join(failures)}"
+        )
+
+
 # A command that vends the IdbClient interface.
 class ClientCommand(BaseCommand):
+    # Commands that set this can run against several targets at once, when
+    # --udid is given more than once, by implementing run_with_group.
+    supports_client_group: bool = False
+
     def add_parser_arguments(self, parser: ArgumentParser) -> None:
-        parser.add_argument(
-            "--udid",
-            help="Udid of target, can also be set with the IDB_UDID env var",
-            default=os.environ.get("IDB_UDID"),
-        )
+        if self.supports_client_group:
+            parser.add_argument(
+                "--udid",
+                help="Udid of target, can be given more than once to run against several targets. Can also be set with the IDB_UDID env var",
+                action="append",
+                default=None,
+            )
+            parser.add_argument(
+                "--parallelism",
+                help="When running against several targets, how many to run against at once",
+                type=int,
+                default=DEFAULT_PARALLELISM,
+            )
+        else:
+            parser.add_argument(
+                "--udid",
+                help="Udid of target, can also be set with the IDB_UDID env var",
+                default=os.environ.get("IDB_UDID"),
+            )
         super().add_parser_arguments(parser)
 
     async def _run_impl(self, args: Namespace) -> None:
+        # Shared by every client the command makes, and closed when it is done.
+        channel_pool = ChannelPool(logger=self.logger)
+        try:
+            await self._run_with_channel_pool(args=args, channel_pool=channel_pool)
+        finally:
+            channel_pool.close()
+
+    async def _run_with_channel_pool(
+        self, args: Namespace, channel_pool: ChannelPool
+    ) -> None:
+        if self.supports_client_group:
+            udids = args.udid or (
+                [os.environ["IDB_UDID"]] if os.environ.get("IDB_UDID") else []
+            )
+            if len(udids) > 1:
+                if vars(args).get("companion") is not None:
+                    raise IdbException(
+                        "--companion can't be combined with more than one --udid"
+                    )
+                group = ClientGroup(
+                    manager=GrpcClientManager(
+                        logger=self.logger,
+                        companion_path=args.companion_path,
+                        channel_pool=channel_pool,
+                    ),
+                    udids=udids,
+                    parallelism=args.parallelism,
+                    logger=self.logger,
+                )
+                await self.run_with_group(args=args, group=group)
+                return
+            args.udid = udids[0] if udids else None
         address: Address | None = None
         try:
-            async with _get_client(args=args, logger=self.logger) as client:
+            async with _get_client(
+                args=args, logger=self.logger, channel_pool=channel_pool
+            ) as client:
                 address = client.address
                 await self.run_with_client(args=args, client=client)
         except IdbConnectionException as ex:
@@ -157,6 +244,9 @@ class ClientCommand(BaseCommand):
     async def run_with_client(self, args: Namespace, client: Client) -> None:
         pass
 
+    async def run_with_group(self, args: Namespace, group: ClientGroup) -> None:
+        raise IdbException(f"{self.name} can only be run against one target at a time")
+
 
 # A command that vends the ClientManagerface
 class ManagementCommand(BaseCommand):
@@ -10,16 +10,19 @@ import json
 from argparse import ArgumentParser, Namespace
 from typing import Optional
 
-from idb.cli import ClientCommand
+from idb.cli import ClientCommand, report_group_results
 from idb.common.format import (
     human_format_installed_app_info,
     json_format_installed_app_info,
 )
-from idb.common.types import Client, Compression, InstalledArtifact
+from idb.common.types import Client, Compression, IdbException, InstalledArtifact
+from idb.grpc.group import ClientGroup
 from idb.utils.typing import none_throws
 
 
 class AppInstallCommand(ClientCommand):
+    supports_client_group = True
+
     @property
     def description(self) -> str:
         return "Install an application"
@@ -43,6 +46,20 @@ class AppInstallCommand(ClientCommand):
             default=None,
             required=False,
         )
+        parser.add_argument(
+            "--delta",
+            help="If set, .app bundles are sent to a remote companion as a manifest of file hashes, and only files the companion does not already have are uploaded. Speeds up re-installing large apps where few files change.",
+            action="store_true",
+            default=None,
+            required=False,
+        )
+        parser.add_argument(
+            "--cache",
+            help="If set, the bundle is identified to a remote companion by a hash of its contents, and is not uploaded if a companion on the same host has installed it before. Speeds up installing one bundle on many simulators.",
+            action="store_true",
+            default=None,
+            required=False,
+        )
         parser.add_argument(
             "bundle_path",
             help="Path to the .app/.ipa to install. Note that .app bundles will usually be faster to install than .ipa files.",
@@ -60,6 +77,8 @@ class AppInstallCommand(ClientCommand):
             make_debuggable=args.make_debuggable,
             compression=compression,
             override_modification_time=args.override_mtime,
+            delta=args.delta,
+            cache=args.cache,
         ):
             artifact = info
             progress = info.progress
@@ -80,6 +99,29 @@ class AppInstallCommand(ClientCommand):
                 f"Installed: {none_throws(artifact).name} {none_throws(artifact).uuid}"
             )
 
+    async def run_with_group(self, args: Namespace, group: ClientGroup) -> None:
+        if args.delta or args.cache:
+            raise IdbException(
+                "--delta and --cache can't be used when installing on more than one target"
+            )
+        results = await group.install(
+            bundle_path=args.bundle_path,
+            make_debuggable=args.make_debuggable,
+            compression=(
+                Compression[args.compression] if args.compression is not None else None
+            ),
+            override_modification_time=args.override_mtime,
+        )
+        report_group_results(
+            results,
+            as_json=args.json,
+            describe=lambda artifact: {
+                "installedAppBundleId": artifact.name,
+                "uuid": artifact.uuid,
+            },
+            summarize=lambda artifact: f"Installed: {artifact.name} {artifact.uuid}",
+        )
+
 
 class AppUninstallCommand(ClientCommand):
     @property
@@ -304,13 +304,23 @@ class FSPullCommand(FSCommand):
             type=str,
         )
         parser.add_argument("dst", help="Local destination path", type=str)
+        parser.add_argument(
+            "--streams",
+            help="Pull a single file from a remote companion over this many concurrent streams. An interrupted pull can be resumed by running it again.",
+            type=int,
+            default=None,
+            required=False,
+        )
         super().add_parser_arguments(parser)
 
     async def run_with_container(
         self, container: FileContainer, args: Namespace, client: Client
     ) -> None:
         await client.pull(
-            container=container, src_path=args.src, dest_path=os.path.abspath(args.dst)
+            container=container,
+            src_path=args.src,
+            dest_path=os.path.abspath(args.dst),
+            streams=args.streams,
         )
 
 
@@ -8,13 +8,16 @@
 
 from argparse import ArgumentParser, Namespace, REMAINDER
 
-from idb.cli import ClientCommand
+from idb.cli import ClientCommand, report_group_results
 from idb.common.misc import get_env_with_idb_prefix
 from idb.common.signal import signal_handler_event
-from idb.common.types import Client
+from idb.common.types import Client, IdbException
+from idb.grpc.group import ClientGroup
 
 
 class LaunchCommand(ClientCommand):
+    supports_client_group = True
+
     @property
     def description(self) -> str:
         return (
@@ -79,3 +82,21 @@ class LaunchCommand(ClientCommand):
             pid_file=args.pid_file,
             enable_repl=args.enable_repl,
         )
+
+    async def run_with_group(self, args: Namespace, group: ClientGroup) -> None:
+        if args.wait_for_debugger or args.wait_for or args.pid_file or args.enable_repl:
+            raise IdbException(
+                "-d, -w, --pid-file and --enable-repl can't be used when launching on more than one target"
+            )
+        results = await group.launch(
+            bundle_id=args.bundle_id,
+            args=args.app_arguments,
+            env=get_env_with_idb_prefix(),
+            foreground_if_running=args.foreground_if_running,
+        )
+        report_group_results(
+            results,
+            as_json=args.json,
+            describe=lambda _: {"launched": args.bundle_id},
+            summarize=lambda _: f"Launched: {args.bundle_id}",
+        )
@@ -11,7 +11,7 @@ from typing import List, Optional
 
 from idb.cli import ClientCommand
 from idb.common.signal import signal_handler_event
-from idb.common.types import Client
+from idb.common.types import Client, LogFilter, LogFormat, OutputBatching
 
 
 class LogCommand(ClientCommand):
@@ -46,16 +46,100 @@ log stream --predicate examples:
             default=[],
             nargs=REMAINDER,
         )
+        parser.add_argument(
+            "--batch-bytes",
+            help="Send log output once this many bytes have built up",
+            type=int,
+            default=None,
+        )
+        parser.add_argument(
+            "--batch-latency-ms",
+            help="Send log output once it has waited this long, 0 sends it immediately",
+            type=int,
+            default=None,
+        )
+        parser.add_argument(
+            "--max-buffered-bytes",
+            help="Drop log output while this many bytes are waiting to be sent",
+            type=int,
+            default=None,
+        )
+        parser.add_argument(
+            "--subsystem",
+            help="Only send entries from this subsystem, may be repeated",
+            action="append",
+            default=[],
+        )
+        parser.add_argument(
+            "--category",
+            help="Only send entries in this category, may be repeated",
+            action="append",
+            default=[],
+        )
+        parser.add_argument(
+            "--process",
+            help="Only send entries from this process name or pid, may be repeated",
+            action="append",
+            default=[],
+        )
+        parser.add_argument(
+            "--match",
+            help="Only send entries whose message contains a match for this regex",
+            default=None,
+        )
+        parser.add_argument(
+            "--ndjson",
+            help="Output one JSON object per log entry",
+            action="store_true",
+            default=False,
+        )
         super().add_parser_arguments(parser)
 
     async def run_with_client(self, args: Namespace, client: Client) -> None:
         async for chunk in client.tail_logs(
             stop=signal_handler_event("log"),
             arguments=self.normalise_log_arguments(args.log_arguments),
+            batching=self.output_batching(args),
+            log_filter=self.log_filter(args),
+            log_format=LogFormat.NDJSON if args.ndjson else LogFormat.TEXT,
         ):
             print(chunk, end="")
         print("")
 
+    def output_batching(self, args: Namespace) -> OutputBatching | None:
+        defaults = OutputBatching()
+        if (
+            args.batch_bytes is None
+            and args.batch_latency_ms is None
+            and args.max_buffered_bytes is None
+        ):
+            return None
+        return OutputBatching(
+            max_bytes=(
+                defaults.max_bytes if args.batch_bytes is None else args.batch_bytes
+            ),
+            max_latency_ms=(
+                defaults.max_latency_ms
+                if args.batch_latency_ms is None
+                else args.batch_latency_ms
+            ),
+            max_buffered_bytes=(
+                defaults.max_buffered_bytes
+                if args.max_buffered_bytes is None
+                else args.max_buffered_bytes
+            ),
+        )
+
+    def log_filter(self, args: Namespace) -> LogFilter | None:
+        if not (args.subsystem or args.category or args.process or args.match):
+            return None
+        return LogFilter(
+            subsystems=args.subsystem,
+            categories=args.category,
+            processes=args.process,
+            message_regex=args.match,
+        )
+
     def normalise_log_arguments(
         self, log_arguments: list[str] | None
     ) -> list[str] | None:
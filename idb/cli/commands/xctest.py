@@ -10,6 +10,7 @@ import json
 import os.path
 import sys
 from argparse import ArgumentParser, Namespace, REMAINDER
+from contextlib import ExitStack
 from pathlib import Path
 from typing import Optional, Set
 
@@ -22,6 +23,7 @@ from idb.common.format import (
     json_format_test_info,
 )
 from idb.common.misc import get_env_with_idb_prefix
+from idb.common.test_result_sink import make_test_result_sink, TestResultSinkFormat
 from idb.common.types import Client, CodeCoverageFormat, FileContainerType, IdbException
 
 NO_SPECIFIED_PATH = "NO_SPECIFIED_PATH"
@@ -47,11 +49,18 @@ class XctestInstallCommand(ClientCommand):
             default=None,
             required=False,
         )
+        parser.add_argument(
+            "--cache",
+            help="If set, the bundle is identified to a remote companion by a hash of its contents, and is not uploaded if a companion on the same host has installed it before. Speeds up installing one bundle on many simulators.",
+            action="store_true",
+            default=None,
+            required=False,
+        )
         super().add_parser_arguments(parser)
 
     async def run_with_client(self, args: Namespace, client: Client) -> None:
         async for install_response in client.install_xctest(
-            args.test_bundle_path, args.skip_signing_bundles
+            args.test_bundle_path, args.skip_signing_bundles, cache=args.cache
         ):
             if install_response.progress != 0.0 and not args.json:
                 print("Installed {install_response.progress}%")
@@ -177,6 +186,19 @@ class CommonRunXcTestCommand(ClientCommand):
                 "data blobs will be saved to this location"
             ),
         )
+        parser.add_argument(
+            "--result-sink-format",
+            choices=[format.value for format in TestResultSinkFormat],
+            default=None,
+            help="Also write each result to --result-sink-path as it arrives, "
+            "as JUnit XML, one JSON object per line, or compact binary records",
+        )
+        parser.add_argument(
+            "--result-sink-path",
+            default=None,
+            type=str,
+            help="Path of the file written by --result-sink-format",
+        )
         parser.add_argument(
             "--coverage-output-path",
             help="Outputs code coverage information. See --coverage-format option.",
@@ -200,6 +222,14 @@ class CommonRunXcTestCommand(ClientCommand):
             type=str,
             help="Path to save the test logs collected",
         )
+        parser.add_argument(
+            "--log-spill-bytes",
+            default=None,
+            type=int,
+            help="Keep the log lines of any test that logs more than this many "
+            "bytes in a temporary file, rather than in memory, until its result "
+            "arrives",
+        )
         parser.add_argument(
             "--wait-for-debugger",
             action="store_true",
@@ -264,32 +294,52 @@ class CommonRunXcTestCommand(ClientCommand):
                 "--wait_for_debugger flag is NOT supported for ui tests. It will default to False"
             )
 
+        if (args.result_sink_format is None) != (args.result_sink_path is None):
+            raise IdbException(
+                "--result-sink-format and --result-sink-path must be given together"
+            )
+
         formatter = json_format_test_info if args.json else human_format_test_info
         coverage_format = CodeCoverageFormat[args.coverage_format]
 
-        async for test_result in client.run_xctest(
-            test_bundle_id=args.test_bundle_id,
-            # pyrefly: ignore [bad-argument-type]
-            app_bundle_id=app_bundle_id,
-            test_host_app_bundle_id=test_host_app_bundle_id,
-            is_ui_test=is_ui,
-            is_logic_test=is_logic,
-            tests_to_run=tests_to_run,
-            tests_to_skip=tests_to_skip,
-            timeout=args.timeout,
-            env=get_env_with_idb_prefix(),
-            args=arguments,
-            result_bundle_path=args.result_bundle_path,
-            report_activities=args.report_activities or args.report_attachments,
-            report_attachments=args.report_attachments,
-            activities_output_path=args.activities_output_path,
-            coverage_output_path=args.coverage_output_path,
-            enable_continuous_coverage_collection=args.enable_continuous_coverage_collection,
-            coverage_format=coverage_format,
-            log_directory_path=args.log_directory_path,
-            wait_for_debugger=args.wait_for_debugger,
-        ):
-            print(formatter(test_result))
+        with ExitStack() as stack:
+            sink = None
+            if args.result_sink_path is not None:
+                output = stack.enter_context(open(args.result_sink_path, "wb"))
+                sink = stack.enter_context(
+                    make_test_result_sink(
+                        TestResultSinkFormat(args.result_sink_format), output
+                    )
+                )
+            async for test_result in client.run_xctest(
+                test_bundle_id=args.test_bundle_id,
+                # pyrefly: ignore [bad-argument-type]
+                app_bundle_id=app_bundle_id,
+                test_host_app_bundle_id=test_host_app_bundle_id,
+                is_ui_test=is_ui,
+                is_logic_test=is_logic,
+                tests_to_run=tests_to_run,
+                tests_to_skip=tests_to_skip,
+                timeout=args.timeout,
+                env=get_env_with_idb_prefix(),
+                args=arguments,
+                result_bundle_path=args.result_bundle_path,
+                report_activities=args.report_activities or args.report_attachments,
+                report_attachments=args.report_attachments,
+                activities_output_path=args.activities_output_path,
+                coverage_output_path=args.coverage_output_path,
+                enable_continuous_coverage_collection=args.enable_continuous_coverage_collection,
+                coverage_format=coverage_format,
+                log_directory_path=args.log_directory_path,
+                wait_for_debugger=args.wait_for_debugger,
+                log_spill_bytes=args.log_spill_bytes,
+                # A sink keeps memory flat over the run, so the results it is
+                # given carry their attachments as files rather than payloads.
+                attachments_as_paths=sink is not None,
+            ):
+                if sink is not None:
+                    sink.write(test_result)
+                print(formatter(test_result))
 
     async def install_bundles(self, args: Namespace, client: Client) -> None:
         async for test in client.install_xctest(
@@ -36,11 +36,16 @@ from idb.common.types import (
     HIDDirection,
     HIDOrientationType,
     IdbException,
+    InstalledArtifact,
     InstrumentsTimings,
+    LogFilter,
+    LogFormat,
     LoggingMetadata,
+    OutputBatching,
     Permission,
     TCPAddress,
 )
+from idb.grpc.group import TargetResult
 from idb.grpc.idb_pb2 import AccessibilityInfoRequest
 from idb.utils.testing import AsyncContextManagerMock, AsyncMock, TestCase
 
@@ -212,6 +217,8 @@ class TestParser(TestCase):
             make_debuggable=None,
             compression=compression,
             override_modification_time=None,
+            delta=None,
+            cache=None,
         )
 
     async def test_install_with_mtime_override(self) -> None:
@@ -224,6 +231,8 @@ class TestParser(TestCase):
             make_debuggable=None,
             compression=compression,
             override_modification_time=True,
+            delta=None,
+            cache=None,
         )
 
     async def test_install_with_bad_compression(self) -> None:
@@ -244,6 +253,87 @@ class TestParser(TestCase):
             make_debuggable=None,
             compression=Compression.ZSTD,
             override_modification_time=None,
+            delta=None,
+            cache=None,
+        )
+
+    async def test_install_with_delta(self) -> None:
+        self.client_mock.install = MagicMock(return_value=AsyncGeneratorMock())
+        app_path = "testApp.app"
+        await cli_main(cmd_input=["install", "--delta", app_path])
+        self.client_mock.install.assert_called_once_with(
+            bundle=app_path,
+            make_debuggable=None,
+            compression=None,
+            override_modification_time=None,
+            delta=True,
+            cache=None,
+        )
+
+    async def test_install_with_cache(self) -> None:
+        self.client_mock.install = MagicMock(return_value=AsyncGeneratorMock())
+        app_path = "testApp.app"
+        await cli_main(cmd_input=["install", "--cache", app_path])
+        self.client_mock.install.assert_called_once_with(
+            bundle=app_path,
+            make_debuggable=None,
+            compression=None,
+            override_modification_time=None,
+            delta=None,
+            cache=True,
+        )
+
+    async def test_install_on_several_targets(self) -> None:
+        group_mock = MagicMock(name="group_mock")
+        group_mock().install = AsyncMock(
+            return_value=[
+                TargetResult(
+                    udid=udid,
+                    value=InstalledArtifact(name="com.foo", uuid=udid, progress=None),
+                    error=None,
+                    duration=1.0,
+                )
+                for udid in ["A", "B"]
+            ]
+        )
+        with patch("idb.cli.ClientGroup", group_mock):
+            await cli_main(
+                cmd_input=[
+                    "install",
+                    "--udid",
+                    "A",
+                    "--udid",
+                    "B",
+                    "--parallelism",
+                    "2",
+                    "testApp.app",
+                ]
+            )
+        group_mock.assert_called_with(
+            manager=ANY, udids=["A", "B"], parallelism=2, logger=ANY
+        )
+        group_mock().install.assert_called_once_with(
+            bundle_path="testApp.app",
+            make_debuggable=None,
+            compression=None,
+            override_modification_time=None,
+        )
+        self.client_mock.install.assert_not_called()
+
+    async def test_launch_on_several_targets(self) -> None:
+        group_mock = MagicMock(name="group_mock")
+        group_mock().launch = AsyncMock(
+            return_value=[
+                TargetResult(udid=udid, value=None, error=None, duration=1.0)
+                for udid in ["A", "B"]
+            ]
+        )
+        with patch("idb.cli.ClientGroup", group_mock):
+            await cli_main(
+                cmd_input=["launch", "--udid", "A", "--udid", "B", "com.foo.app"]
+            )
+        group_mock().launch.assert_called_once_with(
+            bundle_id="com.foo.app", args=[], env={}, foreground_if_running=False
         )
 
     async def test_uninstall(self) -> None:
@@ -470,7 +560,7 @@ class TestParser(TestCase):
         cmd_input = ["file", "pull", src, dst]
         await cli_main(cmd_input=cmd_input)
         self.client_mock.pull.assert_called_once_with(
-            container=None, src_path=src, dest_path=os.path.abspath(dst)
+            container=None, src_path=src, dest_path=os.path.abspath(dst), streams=None
         )
 
     async def test_bundled_file_pull(self) -> None:
@@ -481,7 +571,20 @@ class TestParser(TestCase):
         cmd_input = ["file", "pull", src, dst, "--bundle-id", bundle_id]
         await cli_main(cmd_input=cmd_input)
         self.client_mock.pull.assert_called_once_with(
-            container=bundle_id, src_path=src, dest_path=os.path.abspath(dst)
+            container=bundle_id,
+            src_path=src,
+            dest_path=os.path.abspath(dst),
+            streams=None,
+        )
+
+    async def test_file_pull_with_streams(self) -> None:
+        self.client_mock.pull = AsyncMock(return_value=[])
+        src = "Library/myFile.txt"
+        dst = "someOutputDir"
+        cmd_input = ["file", "pull", "--streams", "8", src, dst]
+        await cli_main(cmd_input=cmd_input)
+        self.client_mock.pull.assert_called_once_with(
+            container=None, src_path=src, dest_path=os.path.abspath(dst), streams=8
         )
 
     async def test_list_targets(self) -> None:
@@ -498,7 +601,17 @@ class TestParser(TestCase):
         self.client_mock.install_xctest = MagicMock(return_value=AsyncGeneratorMock())
         test_bundle_path = "testBundle.xctest"
         await cli_main(cmd_input=["xctest", "install", test_bundle_path])
-        self.client_mock.install_xctest.assert_called_once_with(test_bundle_path, None)
+        self.client_mock.install_xctest.assert_called_once_with(
+            test_bundle_path, None, cache=None
+        )
+
+    async def test_xctest_install_with_cache(self) -> None:
+        self.client_mock.install_xctest = MagicMock(return_value=AsyncGeneratorMock())
+        test_bundle_path = "testBundle.xctest"
+        await cli_main(cmd_input=["xctest", "install", "--cache", test_bundle_path])
+        self.client_mock.install_xctest.assert_called_once_with(
+            test_bundle_path, None, cache=True
+        )
 
     def xctest_run_namespace(self, command: str, test_bundle_id: str) -> Namespace:
         namespace = Namespace()
@@ -526,6 +639,8 @@ class TestParser(TestCase):
         namespace.report_activities = False
         namespace.report_attachments = False
         namespace.activities_output_path = None
+        namespace.result_sink_format = None
+        namespace.result_sink_path = None
         namespace.coverage_output_path = None
         namespace.enable_continuous_coverage_collection = False
         namespace.coverage_format = "EXPORTED"
@@ -689,6 +804,14 @@ class TestParser(TestCase):
             namespace.json = False
             namespace.reason = None
             namespace.log_arguments = []
+            namespace.batch_bytes = None
+            namespace.batch_latency_ms = None
+            namespace.max_buffered_bytes = None
+            namespace.subsystem = []
+            namespace.category = []
+            namespace.process = []
+            namespace.match = None
+            namespace.ndjson = False
             namespace.companion_tls = False
             mock.assert_called_once_with(namespace)
 
@@ -708,9 +831,64 @@ class TestParser(TestCase):
             namespace.json = False
             namespace.reason = None
             namespace.log_arguments = ["--", "--style", "json"]
+            namespace.batch_bytes = None
+            namespace.batch_latency_ms = None
+            namespace.max_buffered_bytes = None
+            namespace.subsystem = []
+            namespace.category = []
+            namespace.process = []
+            namespace.match = None
+            namespace.ndjson = False
             namespace.companion_tls = False
             mock.assert_called_once_with(namespace)
 
+    async def test_log_batching(self) -> None:
+        async def tail_logs(**kwargs: object) -> AsyncIterator[str]:
+            yield "line"
+
+        self.client_mock.tail_logs = MagicMock(side_effect=tail_logs)
+        await cli_main(
+            cmd_input=["log", "--batch-latency-ms", "0", "--", "--style", "json"]
+        )
+        self.client_mock.tail_logs.assert_called_once_with(
+            stop=ANY,
+            arguments=["--style", "json"],
+            batching=OutputBatching(max_latency_ms=0),
+            log_filter=None,
+            log_format=LogFormat.TEXT,
+        )
+
+    async def test_log_filter(self) -> None:
+        async def tail_logs(**kwargs: object) -> AsyncIterator[str]:
+            yield "{}\n"
+
+        self.client_mock.tail_logs = MagicMock(side_effect=tail_logs)
+        await cli_main(
+            cmd_input=[
+                "log",
+                "--subsystem",
+                "com.apple.FrontBoard",
+                "--subsystem",
+                "com.apple.locationd",
+                "--process",
+                "SpringBoard",
+                "--match",
+                "scene \\d+",
+                "--ndjson",
+            ]
+        )
+        self.client_mock.tail_logs.assert_called_once_with(
+            stop=ANY,
+            arguments=[],
+            batching=None,
+            log_filter=LogFilter(
+                subsystems=["com.apple.FrontBoard", "com.apple.locationd"],
+                processes=["SpringBoard"],
+                message_regex="scene \\d+",
+            ),
+            log_format=LogFormat.NDJSON,
+        )
+
     async def test_reason(self) -> None:
         mock = AsyncMock()
         with patch("idb.cli.commands.log.LogCommand._run_impl", new=mock, create=True):
@@ -7,14 +7,15 @@
 # pyre-strict
 
 import asyncio
+import contextlib
+import fcntl
 import json
 import logging
 import os
+import time
+import uuid
 from collections.abc import AsyncGenerator
 from contextlib import asynccontextmanager
-from datetime import datetime, timedelta
-from pathlib import Path
-from typing import List, Optional
 
 from idb.common.constants import IDB_STATE_FILE_PATH
 from idb.common.format import json_data_companions, json_to_companion_info
@@ -27,53 +28,146 @@ from idb.common.types import (
 )
 
 
+WRITER_LOCK_TIMEOUT: float = 3.0
+WRITER_LOCK_RETRY_INTERVAL: float = 0.005
+# A state file written in place by an older idb can be read mid-write.
+READ_ATTEMPTS: int = 3
+READ_RETRY_INTERVAL: float = 0.01
+
+# Identifies a snapshot of the state file. Every write renames a new file into
+# place, so a snapshot is unchanged for as long as its inode is.
+_Version = tuple[int, int, int, int]
+
+
 @asynccontextmanager
-async def _open_lockfile(filename: str) -> AsyncGenerator[None, None]:
-    timeout = 3
-    retry_time = 0.05
-    deadline = datetime.now() + timedelta(seconds=timeout)
-    lock_path = filename + ".lock"
-    lock = None
+async def _writer_lock(filename: str) -> AsyncGenerator[None, None]:
+    # Held with flock rather than by creating the file, so it is released by the
+    # kernel if the holder dies and never has to be cleaned up. Readers don't take it.
+    lock_path = filename + ".writer.lock"
+    deadline = time.monotonic() + WRITER_LOCK_TIMEOUT
+    lock = os.open(lock_path, os.O_CREAT | os.O_RDWR, 0o644)
     try:
-        while lock is None:
+        while True:
             try:
-                lock = os.open(lock_path, os.O_CREAT | os.O_EXCL)
-                yield None
-            except FileExistsError:
-                if datetime.now() >= deadline:
-                    raise IdbException(f"Failed to open the lockfile {lock_path}")
-                await asyncio.sleep(retry_time)
+                fcntl.flock(lock, fcntl.LOCK_EX | fcntl.LOCK_NB)
+                break
+            except BlockingIOError:
+                if time.monotonic() >= deadline:
+                    raise IdbException(f"Failed to lock {lock_path}")
+                await asyncio.sleep(WRITER_LOCK_RETRY_INTERVAL)
+        await _acquire_legacy_lock(filename, deadline)
+        try:
+            yield None
+        finally:
+            with contextlib.suppress(FileNotFoundError):
+                os.unlink(filename + ".lock")
     finally:
-        if lock is not None:
-            os.close(lock)
-        os.unlink(lock_path)
+        os.close(lock)
+
+
+async def _acquire_legacy_lock(filename: str, deadline: float) -> None:
+    # An older idb serializes its writes by exclusively creating this file, so it
+    # is taken too, inside the writer lock. Only an older writer or a dead process
+    # can hold it then, and an older writer holds it for one small write, so one
+    # still there at the deadline is stale and is broken, once.
+    lock_path = filename + ".lock"
+    broken = False
+    while True:
+        try:
+            os.close(os.open(lock_path, os.O_CREAT | os.O_EXCL | os.O_RDWR, 0o644))
+            return
+        except FileExistsError:
+            if time.monotonic() >= deadline:
+                if broken:
+                    raise IdbException(f"Failed to lock {lock_path}")
+                broken = True
+                with contextlib.suppress(FileNotFoundError):
+                    os.unlink(lock_path)
+                continue
+            await asyncio.sleep(WRITER_LOCK_RETRY_INTERVAL)
+
+
+def _read_snapshot(filename: str) -> tuple[_Version | None, bytes]:
+    try:
+        fd = os.open(filename, os.O_RDONLY)
+    except FileNotFoundError:
+        return (None, b"")
+    with os.fdopen(fd, "rb") as f:
+        info = os.fstat(fd)
+        return (
+            (info.st_dev, info.st_ino, info.st_mtime_ns, info.st_size),
+            f.read(),
+        )
+
+
+def _write_snapshot(filename: str, companions: list[CompanionInfo]) -> None:
+    temporary_path = f"{filename}.{os.getpid()}.{uuid.uuid4().hex}.tmp"
+    try:
+        with open(temporary_path, "w") as f:
+            json.dump(json_data_companions(companions), f)
+        os.replace(temporary_path, filename)
+    except BaseException:
+        try:
+            os.unlink(temporary_path)
+        except FileNotFoundError:
+            pass
+        raise
 
 
 class CompanionSet:
+    """
+    The companions known to every idb client on this host, stored as a JSON array
+    at `state_file_path`, the same file and format as idb_companion's
+    CompanionRegistry.
+
+    Reads take no lock. Writers serialize with each other on a lock beside the
+    state file, and with an older idb's writers on the lockfile it creates, and
+    replace the state file with a rename, so a reader always sees a complete
+    snapshot. The last snapshot read is kept, so reading an unchanged file again
+    does not re-parse it.
+    """
+
     def __init__(
         self, logger: logging.Logger, state_file_path: str = IDB_STATE_FILE_PATH
     ) -> None:
         self.state_file_path = state_file_path
         self.logger = logger
+        self._snapshot: tuple[_Version, list[CompanionInfo]] | None = None
+
+    async def _read_companions(self) -> tuple[list[CompanionInfo], bool]:
+        """
+        Returns the stored companions sorted by udid, and whether the state file was
+        missing, empty or invalid.
+        """
+        for attempt in range(READ_ATTEMPTS):
+            (version, data) = _read_snapshot(self.state_file_path)
+            snapshot = self._snapshot
+            if snapshot is not None and snapshot[0] == version:
+                return (list(snapshot[1]), False)
+            # An empty file is a fresh one, not a write in progress.
+            if version is None or not data:
+                return ([], True)
+            try:
+                companions = sorted(
+                    json_to_companion_info(json.loads(data)),
+                    key=lambda companion: companion.udid,
+                )
+            except json.JSONDecodeError:
+                # Possibly cut short by an older idb writing in place, so read again.
+                if attempt + 1 < READ_ATTEMPTS:
+                    await asyncio.sleep(READ_RETRY_INTERVAL)
+                continue
+            self._snapshot = (version, companions)
+            return (list(companions), False)
+        self.logger.info(
+            "State file is invalid or empty, creating empty companion info"
+        )
+        return ([], True)
 
     @asynccontextmanager
     async def _use_stored_companions(self) -> AsyncGenerator[list[CompanionInfo], None]:
-        async with _open_lockfile(filename=self.state_file_path):
-            # Create the state file
-            Path(self.state_file_path).touch(exist_ok=True)
-            fresh_state = False
-            with open(self.state_file_path) as f:
-                try:
-                    companion_info_in = json_to_companion_info(json.load(f))
-                except json.JSONDecodeError:
-                    fresh_state = True
-                    self.logger.info(
-                        "State file is invalid or empty, creating empty companion info"
-                    )
-                    companion_info_in = []
-            companion_info_in = sorted(
-                companion_info_in, key=lambda companion: companion.udid
-            )
+        async with _writer_lock(filename=self.state_file_path):
+            (companion_info_in, fresh_state) = await self._read_companions()
             companion_info_out = list(companion_info_in)
             yield companion_info_out
             companion_info_out = sorted(
@@ -89,12 +183,11 @@ class CompanionSet:
                 )
             else:
                 return
-            with open(self.state_file_path, "w") as f:
-                json.dump(json_data_companions(companion_info_out), f)
+            _write_snapshot(self.state_file_path, companion_info_out)
 
     async def get_companions(self) -> list[CompanionInfo]:
-        async with self._use_stored_companions() as companions:
-            return companions
+        (companions, _) = await self._read_companions()
+        return companions
 
     async def add_companion(self, companion: CompanionInfo) -> CompanionInfo | None:
         async with self._use_stored_companions() as companions:
@@ -24,6 +24,7 @@ from idb.common.types import (
     TargetType,
     TCPAddress,
     TestActivity,
+    TestAttachment,
     TestRunInfo,
 )
 
@@ -155,18 +156,7 @@ def json_format_activity(activity: TestActivity) -> dict[str, Any]:
         "finish": activity.finish,
         "name": activity.name,
         "attachments": [
-            {
-                "payload": base64.b64encode(attachment.payload).decode("utf-8"),
-                "timestap": attachment.timestamp,
-                "name": attachment.name,
-                "uniform_type_identifier": attachment.uniform_type_identifier,
-                "user_info": (
-                    json.loads(attachment.user_info_json.decode("utf-8"))
-                    if len(attachment.user_info_json)
-                    else {}
-                ),
-            }
-            for attachment in activity.attachments
+            json_format_attachment(attachment) for attachment in activity.attachments
         ],
         "sub_activities": [
             json_format_activity(sub_activity)
@@ -175,6 +165,23 @@ def json_format_activity(activity: TestActivity) -> dict[str, Any]:
     }
 
 
+def json_format_attachment(attachment: TestAttachment) -> dict[str, Any]:
+    data: dict[str, Any] = {
+        "payload": base64.b64encode(attachment.payload).decode("utf-8"),
+        "timestap": attachment.timestamp,
+        "name": attachment.name,
+        "uniform_type_identifier": attachment.uniform_type_identifier,
+        "user_info": (
+            json.loads(attachment.user_info_json.decode("utf-8"))
+            if len(attachment.user_info_json)
+            else {}
+        ),
+    }
+    if attachment.path is not None:
+        data["path"] = attachment.path
+    return data
+
+
 def human_format_installed_app_info(app: InstalledAppInfo) -> str:
     return " | ".join(
         [
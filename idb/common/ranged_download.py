@@ -0,0 +1,224 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import json
+import logging
+import os
+from collections.abc import AsyncIterator, Awaitable, Callable
+from typing import NamedTuple
+
+
+DEFAULT_RANGE_SIZE: int = 1024 * 1024 * 16  # 16Mb per request
+DEFAULT_STREAMS: int = 4
+DEFAULT_RETRIES: int = 3
+
+
+class RemoteFile(NamedTuple):
+    size: int
+    # Names the remote contents, and changes whenever they do. Empty when the
+    # remote cannot say, in which case nothing fetched earlier is trusted.
+    version: str
+
+
+class RangeChunk(NamedTuple):
+    offset: int
+    data: bytes
+    # The version of the remote file the data was read from.
+    version: str
+
+
+# Fetches [offset, offset + length) of the remote file.
+RangeFetcher = Callable[[int, int], AsyncIterator[RangeChunk]]
+
+
+class RangedDownloadException(Exception):
+    pass
+
+
+class RemoteFileChangedException(RangedDownloadException):
+    pass
+
+
+class RangedDownload:
+    """
+    Downloads a file as fixed size ranges over several concurrent streams.
+
+    Data is written in place into `<path>.partial`, and the completed ranges are
+    recorded in `<path>.partial.json`. A download that is interrupted can be run
+    again and only fetches the ranges that are missing, as long as the remote
+    file has the same version. Once every range is present the file is renamed
+    to `path`.
+
+    Only failures fetching a range are retried. A failure writing it locally, or
+    data from another version of the remote file, fails the download.
+    """
+
+    def __init__(
+        self,
+        path: str,
+        logger: logging.Logger,
+        range_size: int = DEFAULT_RANGE_SIZE,
+        streams: int = DEFAULT_STREAMS,
+        retries: int = DEFAULT_RETRIES,
+        retryable: tuple[type[BaseException], ...] = (
+            OSError,
+            ConnectionError,
+            asyncio.TimeoutError,
+        ),
+    ) -> None:
+        self._path = path
+        self._partial_path = f"{path}.partial"
+        self._state_path = f"{path}.partial.json"
+        self._logger = logger
+        self._range_size = range_size
+        self._streams = max(1, streams)
+        self._retries = retries
+        self._retryable = retryable
+
+    async def run(
+        self,
+        fetch_remote: Callable[[], Awaitable[RemoteFile]],
+        fetch_range: RangeFetcher,
+    ) -> None:
+        remote = await fetch_remote()
+        total_size = remote.size
+        completed = self._load_completed(remote)
+        ranges = [
+            index
+            for index in range(self._range_count(total_size))
+            if index not in completed
+        ]
+        if completed:
+            self._logger.info(
+                f"Resuming {self._path}, {len(completed)} ranges already present"
+            )
+        fd = os.open(self._partial_path, os.O_WRONLY | os.O_CREAT, 0o644)
+        try:
+            os.ftruncate(fd, total_size)
+            queue: asyncio.Queue[int] = asyncio.Queue()
+            for index in ranges:
+                queue.put_nowait(index)
+
+            async def worker() -> None:
+                while not queue.empty():
+                    index = queue.get_nowait()
+                    await self._fetch_with_retries(fd, index, remote, fetch_range)
+                    completed.add(index)
+                    self._save_completed(remote, completed)
+
+            workers = [
+                asyncio.ensure_future(worker())
+                for _ in range(min(self._streams, len(ranges)))
+            ]
+            try:
+                await asyncio.gather(*workers)
+            except BaseException:
+                for task in workers:
+                    task.cancel()
+                await asyncio.gather(*workers, return_exceptions=True)
+                raise
+        finally:
+            os.close(fd)
+        os.replace(self._partial_path, self._path)
+        try:
+            os.remove(self._state_path)
+        except FileNotFoundError:
+            pass
+
+    def _range_count(self, total_size: int) -> int:
+        return (total_size + self._range_size - 1) // self._range_size
+
+    async def _fetch_with_retries(
+        self, fd: int, index: int, remote: RemoteFile, fetch_range: RangeFetcher
+    ) -> None:
+        offset = index * self._range_size
+        length = min(self._range_size, remote.size - offset)
+        attempt = 0
+        while True:
+            try:
+                await self._fetch(fd, offset, length, remote, fetch_range)
+                return
+            except self._retryable as e:
+                attempt += 1
+                if attempt > self._retries:
+                    raise
+                self._logger.info(
+                    f"Retrying range at {offset} of {self._path} after {e} "
+                    f"(attempt {attempt} of {self._retries})"
+                )
+
+    async def _fetch(
+        self,
+        fd: int,
+        offset: int,
+        length: int,
+        remote: RemoteFile,
+        fetch_range: RangeFetcher,
+    ) -> None:
+        end = offset + length
+        position = offset
+        async for chunk in fetch_range(offset, length):
+            if chunk.version != remote.version:
+                raise RemoteFileChangedException(
+                    f"The remote file changed while pulling {self._path}, "
+                    "pull it again to restart"
+                )
+            if chunk.offset != position or chunk.offset + len(chunk.data) > end:
+                raise RangedDownloadException(
+                    f"Got {len(chunk.data)} bytes at {chunk.offset}, "
+                    f"expected data at {position} up to {end}"
+                )
+            try:
+                os.pwrite(fd, chunk.data, chunk.offset)
+            except OSError as e:
+                # Not retryable: fetching the range again won't make room on the disk.
+                raise RangedDownloadException(
+                    f"Could not write to {self._partial_path}: {e}"
+                ) from e
+            position += len(chunk.data)
+        if position != end:
+            raise ConnectionError(
+                f"Range ended early at {position}, expected data up to {end}"
+            )
+
+    def _load_completed(self, remote: RemoteFile) -> set[int]:
+        if not os.path.exists(self._partial_path):
+            return set()
+        try:
+            with open(self._state_path) as f:
+                state = json.load(f)
+        except (OSError, ValueError):
+            return set()
+        if not remote.version:
+            self._logger.info(
+                f"Remote file has no version to compare, restarting {self._path}"
+            )
+            return set()
+        if (
+            state.get("total_size") != remote.size
+            or state.get("version") != remote.version
+            or state.get("range_size") != self._range_size
+        ):
+            self._logger.info(f"Remote file changed, restarting {self._path}")
+            return set()
+        return set(state.get("completed", []))
+
+    def _save_completed(self, remote: RemoteFile, completed: set[int]) -> None:
+        temporary_path = f"{self._state_path}.tmp"
+        with open(temporary_path, "w") as f:
+            json.dump(
+                {
+                    "total_size": remote.size,
+                    "version": remote.version,
+                    "range_size": self._range_size,
+                    "completed": sorted(completed),
+                },
+                f,
+            )
+        os.replace(temporary_path, self._state_path)
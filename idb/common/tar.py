@@ -9,11 +9,13 @@
 import asyncio
 import os
 import sys
+import tarfile
 import tempfile
 import uuid
+import zlib
 from abc import abstractmethod
-from collections.abc import AsyncGenerator, AsyncIterator
-from typing import List, Optional
+from collections.abc import AsyncGenerator, AsyncIterator, Callable
+from typing import List, Optional, Protocol
 
 from idb.common.types import Compression
 from idb.utils.contextlib import asynccontextmanager
@@ -29,6 +31,12 @@ def _has_executable(exe: str) -> bool:
 
 
 READ_CHUNK_SIZE: int = 1024 * 1024 * 4  # 4Mb, the default max read for gRPC
+# How many compressed chunks the archiving thread may get ahead of the consumer.
+IN_PROCESS_QUEUE_DEPTH: int = 4
+# Read size for file contents going into the archive.
+COPY_BUFFER_SIZE: int = 1024 * 1024
+# Matches the `gzip -4` fallback of the subprocess path; favours speed over ratio.
+IN_PROCESS_GZIP_LEVEL: int = 4
 
 
 async def is_gnu_tar() -> bool:
@@ -153,6 +161,171 @@ class ZstdArchive(TarArchiveProcess):
         )
 
 
+class _Compressor(Protocol):
+    def compress(self, data: bytes) -> bytes: ...
+
+    def flush(self) -> bytes: ...
+
+
+def _zstd_compressor() -> _Compressor | None:
+    try:
+        import zstandard  # pyre-ignore
+    except ImportError:
+        return None
+    return zstandard.ZstdCompressor().compressobj()
+
+
+def _make_compressor(compression: Compression) -> _Compressor | None:
+    if compression == Compression.GZIP:
+        # wbits=31 emits a gzip header/trailer, identical framing to gzip/pigz.
+        return zlib.compressobj(IN_PROCESS_GZIP_LEVEL, zlib.DEFLATED, 31)
+    if compression == Compression.ZSTD:
+        return _zstd_compressor()
+    return None
+
+
+class _ChunkedCompressingWriter:
+    """
+    A write-only, tell-able file object for tarfile.
+    Compresses everything written to it and hands off fixed size chunks.
+    """
+
+    def __init__(
+        self, compressor: _Compressor, emit: Callable[[bytes], None]
+    ) -> None:
+        self._compressor = compressor
+        self._emit = emit
+        self._buffer = bytearray()
+        self._offset = 0
+
+    def tell(self) -> int:
+        return self._offset
+
+    def write(self, data: bytes) -> int:
+        self._offset += len(data)
+        self._buffer += self._compressor.compress(data)
+        while len(self._buffer) >= READ_CHUNK_SIZE:
+            self._emit(bytes(self._buffer[:READ_CHUNK_SIZE]))
+            del self._buffer[:READ_CHUNK_SIZE]
+        return len(data)
+
+    def close(self) -> None:
+        self._buffer += self._compressor.flush()
+        while self._buffer:
+            self._emit(bytes(self._buffer[:READ_CHUNK_SIZE]))
+            del self._buffer[:READ_CHUNK_SIZE]
+
+
+class InProcessArchive:
+    """
+    Builds a compressed tar in a worker thread, without spawning tar or a compressor.
+    The output is a regular tar.gz/tar.zst, so the companion extracts it unchanged.
+    """
+
+    def __init__(
+        self,
+        paths: list[str],
+        compression: Compression,
+        place_in_subfolders: bool,
+        verbose: bool,
+        arcnames: list[str] | None = None,
+    ) -> None:
+        self._paths = paths
+        self._compression = compression
+        self._place_in_subfolders = place_in_subfolders
+        self._verbose = verbose
+        self._arcnames = arcnames
+
+    @classmethod
+    def supports(
+        cls, compression: Compression, additional_tar_args: list[str] | None
+    ) -> bool:
+        # Arbitrary tar flags can only be honoured by the real tar binary.
+        if additional_tar_args:
+            return False
+        return _make_compressor(compression) is not None
+
+    def _arcname(self, path: str) -> str:
+        name = os.path.basename(path)
+        if self._place_in_subfolders:
+            return os.path.join(str(uuid.uuid4()), name)
+        return name
+
+    def _log_member(self, info: tarfile.TarInfo) -> tarfile.TarInfo:
+        sys.stderr.write(f"a {info.name}\n")
+        return info
+
+    def _write(self, emit: Callable[[bytes], None]) -> None:
+        writer = _ChunkedCompressingWriter(
+            compressor=none_throws(_make_compressor(self._compression)), emit=emit
+        )
+        # Plain "w" rather than the "w|" stream mode, which re-buffers every write.
+        with tarfile.open(
+            fileobj=writer,  # pyre-ignore
+            mode="w",
+            copybufsize=COPY_BUFFER_SIZE,
+        ) as archive:
+            for index, path in enumerate(self._paths):
+                archive.add(
+                    path,
+                    arcname=(
+                        self._arcnames[index] if self._arcnames else self._arcname(path)
+                    ),
+                    recursive=True,
+                    filter=self._log_member if self._verbose else None,
+                )
+        writer.close()
+
+    async def generate(self) -> AsyncIterator[bytes]:
+        loop = asyncio.get_running_loop()
+        queue: asyncio.Queue[bytes | BaseException | None] = asyncio.Queue(
+            maxsize=IN_PROCESS_QUEUE_DEPTH
+        )
+        stopped = asyncio.Event()
+
+        async def offer(item: bytes | BaseException | None) -> None:
+            # Runs on the loop, so once the consumer has stopped no put gets through.
+            if stopped.is_set():
+                raise TarException("Archive consumer went away")
+            await queue.put(item)
+
+        def put(item: bytes | BaseException | None) -> None:
+            # Blocks the worker until the consumer has room, bounding memory.
+            asyncio.run_coroutine_threadsafe(offer(item), loop).result()
+
+        def run() -> None:
+            try:
+                self._write(put)
+                put(None)
+            except BaseException as e:
+                if stopped.is_set():
+                    return
+                try:
+                    put(e)
+                except TarException:
+                    # The consumer stopped in the meantime, so nobody is waiting.
+                    pass
+
+        worker = loop.run_in_executor(None, run)
+        try:
+            while True:
+                item = await queue.get()
+                if item is None:
+                    break
+                if isinstance(item, BaseException):
+                    raise TarException(
+                        f"Failed to generate tar file: {item}"
+                    ) from item
+                yield item
+        finally:
+            # If the consumer stopped early, make room for a put the worker may be
+            # blocked on. Its next put then fails, so it bails out.
+            stopped.set()
+            while not queue.empty():
+                queue.get_nowait()
+            await worker
+
+
 def _create_untar_command(
     output_path: str, gnu_tar: bool, verbose: bool = False
 ) -> list[str]:
@@ -174,6 +347,18 @@ async def create_tar(
     place_in_subfolders: bool = False,
     verbose: bool = False,
 ) -> bytes:
+    if InProcessArchive.supports(Compression.GZIP, additional_tar_args):
+        return b"".join(
+            [
+                chunk
+                async for chunk in InProcessArchive(
+                    paths=paths,
+                    compression=Compression.GZIP,
+                    place_in_subfolders=place_in_subfolders,
+                    verbose=verbose,
+                ).generate()
+            ]
+        )
     async with GzipArchive(
         paths=paths,
         additional_tar_args=additional_tar_args,
@@ -195,7 +380,17 @@ async def generate_tar(
     additional_tar_args: list[str] | None = None,
     place_in_subfolders: bool = False,
     verbose: bool = False,
+    in_process: bool = True,
 ) -> AsyncIterator[bytes]:
+    if in_process and InProcessArchive.supports(compression, additional_tar_args):
+        async for chunk in InProcessArchive(
+            paths=paths,
+            compression=compression,
+            place_in_subfolders=place_in_subfolders,
+            verbose=verbose,
+        ).generate():
+            yield chunk
+        return
     if compression == Compression.ZSTD:
         tar_process: TarArchiveProcess = ZstdArchive(
             paths=paths,
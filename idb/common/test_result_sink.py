@@ -0,0 +1,303 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Sinks that write the results of an xctest run to a file as they arrive.
+
+Each result is written and flushed when it is given to the sink, and nothing is
+kept of it afterwards, so a sink's memory does not grow with the suite. For the
+NDJSON and binary formats, a run that is killed part way leaves every result so
+far readable in the file. A JUnit file is only well-formed once the sink is
+closed.
+"""
+
+import re
+import struct
+from abc import ABC, abstractmethod
+from collections.abc import Iterator
+from enum import Enum
+from types import TracebackType
+from typing import IO
+from xml.sax.saxutils import escape, quoteattr
+
+from idb.common.format import json_format_test_info
+from idb.common.types import IdbException, TestRunFailureInfo, TestRunInfo
+
+
+class TestResultSinkFormat(Enum):
+    JUNIT = "junit"
+    NDJSON = "ndjson"
+    BINARY = "binary"
+
+
+class TestResultSink(ABC):
+    def __init__(self, output: IO[bytes]) -> None:
+        self.output = output
+
+    @abstractmethod
+    def write(self, result: TestRunInfo) -> None:
+        pass
+
+    def close(self) -> None:
+        self.output.flush()
+
+    def __enter__(self) -> "TestResultSink":
+        return self
+
+    def __exit__(
+        self,
+        exc_type: type[BaseException] | None,
+        exc: BaseException | None,
+        traceback: TracebackType | None,
+    ) -> None:
+        self.close()
+
+
+class NDJSONTestResultSink(TestResultSink):
+    """One json_format_test_info object per line."""
+
+    def write(self, result: TestRunInfo) -> None:
+        self.output.write(json_format_test_info(result).encode())
+        self.output.write(b"\n")
+        self.output.flush()
+
+
+# Characters that XML 1.0 does not allow, even escaped.
+_XML_INVALID = re.compile("[\x00-\x08\x0b\x0c\x0e-\x1f\ufffe\uffff]")
+# Room for the counts and time of any suite, so the tag can be rewritten in place.
+_JUNIT_SUITE_TAG_PADDING = 96
+
+
+def _xml_text(text: str) -> str:
+    return escape(_XML_INVALID.sub("", text))
+
+
+def _xml_attribute(text: str) -> str:
+    return quoteattr(_XML_INVALID.sub("", text))
+
+
+class JUnitTestResultSink(TestResultSink):
+    """A JUnit XML report with a single testsuite.
+
+    The testsuite's counts are only known at the end, so its tag is written with
+    room to spare and rewritten on close when the output can seek. Otherwise the
+    counts are left out, which JUnit readers accept. The closing tags are written
+    on close, so the file of a run killed part way is not valid XML.
+    """
+
+    def __init__(self, output: IO[bytes], suite_name: str = "idb") -> None:
+        super().__init__(output)
+        self.suite_name = suite_name
+        self.tests = 0
+        self.failures = 0
+        self.errors = 0
+        self.time = 0.0
+        self._closed = False
+        self.output.write(b'<?xml version="1.0" encoding="UTF-8"?>\n<testsuites>\n')
+        self._suite_tag_offset: int | None = (
+            self.output.tell() if self.output.seekable() else None
+        )
+        suite_tag = self._suite_tag()
+        self._suite_tag_length = len(suite_tag) + _JUNIT_SUITE_TAG_PADDING
+        self._write_suite_tag(suite_tag)
+        self.output.flush()
+
+    def write(self, result: TestRunInfo) -> None:
+        self.tests += 1
+        self.time += result.duration
+        classname = ".".join(
+            name for name in [result.bundle_name, result.class_name] if name
+        )
+        lines = [
+            f"<testcase classname={_xml_attribute(classname)} "
+            f"name={_xml_attribute(result.method_name)} "
+            f'time="{result.duration:.3f}">'
+        ]
+        failure_info = result.failure_info
+        if result.crashed:
+            self.errors += 1
+            message = failure_info.message if failure_info else "Crashed"
+            lines.append(
+                f'<error type="crash" message={_xml_attribute(message)}>'
+                f"{_xml_text(_failure_location(failure_info))}</error>"
+            )
+        elif not result.passed:
+            self.failures += 1
+            message = failure_info.message if failure_info else ""
+            lines.append(
+                f"<failure message={_xml_attribute(message)}>"
+                f"{_xml_text(_failure_location(failure_info))}</failure>"
+            )
+        if result.logs:
+            logs = _xml_text("\n".join(result.logs))
+            lines.append(f"<system-out>{logs}</system-out>")
+        lines.append("</testcase>\n")
+        self.output.write("\n".join(lines).encode())
+        self.output.flush()
+
+    def close(self) -> None:
+        if self._closed:
+            return
+        self._closed = True
+        self.output.write(b"</testsuite>\n</testsuites>\n")
+        offset = self._suite_tag_offset
+        if offset is not None:
+            end = self.output.tell()
+            self.output.seek(offset)
+            self._write_suite_tag(self._suite_tag())
+            self.output.seek(end)
+        super().close()
+
+    def _suite_tag(self) -> str:
+        tag = f"<testsuite name={_xml_attribute(self.suite_name)}"
+        if self._suite_tag_offset is not None:
+            tag += (
+                f' tests="{self.tests}" failures="{self.failures}"'
+                f' errors="{self.errors}" time="{self.time:.3f}"'
+            )
+        return tag
+
+    def _write_suite_tag(self, tag: str) -> None:
+        # Whitespace before the closing bracket keeps the length fixed.
+        self.output.write(tag.ljust(self._suite_tag_length).encode() + b">\n")
+
+
+def _failure_location(failure_info: TestRunFailureInfo | None) -> str:
+    if failure_info is None or not failure_info.file:
+        return ""
+    return f"{failure_info.file}:{failure_info.line}"
+
+
+# A binary result file is BINARY_MAGIC, then for each result a little-endian
+# uint32 length and a record of that many bytes. A record is a flags byte, the
+# duration as a float64 and the failure line as an int32, then the bundle, class
+# and method names, failure message and failure file, then a uint32 count of log
+# lines and the lines. Strings are a uint32 length and that many UTF-8 bytes.
+BINARY_MAGIC = b"IDBTR\x00\x00\x01"
+
+_LENGTH = struct.Struct("<I")
+_RECORD_HEADER = struct.Struct("<Bdi")
+_PASSED = 1
+_CRASHED = 2
+_HAS_FAILURE_INFO = 4
+
+
+def _pack_string(text: str) -> bytes:
+    data = text.encode()
+    return _LENGTH.pack(len(data)) + data
+
+
+class BinaryTestResultSink(TestResultSink):
+    """Compact length-prefixed records, for tools that read results back in bulk.
+
+    Activities are not recorded. Read the file with read_binary_test_results.
+    """
+
+    def __init__(self, output: IO[bytes]) -> None:
+        super().__init__(output)
+        self.output.write(BINARY_MAGIC)
+        self.output.flush()
+
+    def write(self, result: TestRunInfo) -> None:
+        failure_info = result.failure_info
+        flags = (
+            (_PASSED if result.passed else 0)
+            | (_CRASHED if result.crashed else 0)
+            | (_HAS_FAILURE_INFO if failure_info is not None else 0)
+        )
+        parts = [
+            _RECORD_HEADER.pack(
+                flags, result.duration, failure_info.line if failure_info else 0
+            ),
+            _pack_string(result.bundle_name),
+            _pack_string(result.class_name),
+            _pack_string(result.method_name),
+            _pack_string(failure_info.message if failure_info else ""),
+            _pack_string(failure_info.file if failure_info else ""),
+            _LENGTH.pack(len(result.logs)),
+        ]
+        parts.extend(_pack_string(line) for line in result.logs)
+        record = b"".join(parts)
+        self.output.write(_LENGTH.pack(len(record)))
+        self.output.write(record)
+        self.output.flush()
+
+
+class _RecordReader:
+    def __init__(self, record: bytes) -> None:
+        self.record = record
+        self.offset = 0
+
+    def unpack(self, fmt: struct.Struct) -> tuple[int | float, ...]:
+        values = fmt.unpack_from(self.record, self.offset)
+        self.offset += fmt.size
+        return values
+
+    def count(self) -> int:
+        (count,) = self.unpack(_LENGTH)
+        return int(count)
+
+    def string(self) -> str:
+        length = self.count()
+        data = self.record[self.offset : self.offset + length]
+        if len(data) != length:
+            raise IdbException("Truncated test result record")
+        self.offset += length
+        return data.decode()
+
+
+def read_binary_test_results(source: IO[bytes]) -> Iterator[TestRunInfo]:
+    """Reads back the results written by a BinaryTestResultSink.
+
+    A final record cut short, as by a run that was killed while writing it, is
+    ignored.
+    """
+    if source.read(len(BINARY_MAGIC)) != BINARY_MAGIC:
+        raise IdbException("Not a binary test result file")
+    while True:
+        header = source.read(_LENGTH.size)
+        if len(header) < _LENGTH.size:
+            return
+        (length,) = _LENGTH.unpack(header)
+        record = source.read(length)
+        if len(record) < length:
+            return
+        reader = _RecordReader(record)
+        flags, duration, line = reader.unpack(_RECORD_HEADER)
+        flags = int(flags)
+        bundle_name = reader.string()
+        class_name = reader.string()
+        method_name = reader.string()
+        message = reader.string()
+        file = reader.string()
+        logs = [reader.string() for _ in range(reader.count())]
+        yield TestRunInfo(
+            bundle_name=bundle_name,
+            class_name=class_name,
+            method_name=method_name,
+            logs=logs,
+            duration=float(duration),
+            passed=bool(flags & _PASSED),
+            failure_info=(
+                TestRunFailureInfo(message=message, file=file, line=int(line))
+                if flags & _HAS_FAILURE_INFO
+                else None
+            ),
+            activityLogs=None,
+            crashed=bool(flags & _CRASHED),
+        )
+
+
+def make_test_result_sink(
+    sink_format: TestResultSinkFormat, output: IO[bytes]
+) -> TestResultSink:
+    if sink_format == TestResultSinkFormat.JUNIT:
+        return JUnitTestResultSink(output)
+    if sink_format == TestResultSinkFormat.NDJSON:
+        return NDJSONTestResultSink(output)
+    return BinaryTestResultSink(output)
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Stresses the companion registry with many concurrent processes, as a host
+running dozens of idb invocations at once does.
+
+    python -m idb.common.tests.companion_set_benchmark [--readers N] [--writers N]
+
+Readers list the companions in a loop, as every idb command does. Writers add and
+remove their own companions, as connect/disconnect and spawning companions do.
+It reports p50/p99/max latency for each, how many operations failed, and checks
+that no writer's update was lost.
+"""
+
+import argparse
+import asyncio
+import logging
+import multiprocessing
+import os
+import statistics
+import tempfile
+import time
+from multiprocessing.queues import Queue
+
+from idb.common.companion_set import CompanionSet
+from idb.common.types import CompanionInfo, DomainSocketAddress, IdbException
+
+
+LOGGER: logging.Logger = logging.getLogger("companion_set_benchmark")
+
+
+def _companion(udid: str) -> CompanionInfo:
+    return CompanionInfo(
+        udid=udid,
+        address=DomainSocketAddress(path=f"/tmp/{udid}.sock"),
+        is_local=True,
+        pid=None,
+    )
+
+
+async def _read(path: str, operations: int) -> tuple[list[float], int]:
+    latencies = []
+    failures = 0
+    for _ in range(operations):
+        # A fresh CompanionSet per operation, as each idb invocation is a process.
+        companion_set = CompanionSet(logger=LOGGER, state_file_path=path)
+        start = time.monotonic()
+        try:
+            await companion_set.get_companions()
+        except IdbException:
+            failures += 1
+        latencies.append(time.monotonic() - start)
+    return (latencies, failures)
+
+
+async def _write(path: str, name: str, operations: int) -> tuple[list[float], int]:
+    latencies = []
+    failures = 0
+    for index in range(operations):
+        companion_set = CompanionSet(logger=LOGGER, state_file_path=path)
+        start = time.monotonic()
+        try:
+            # Every other write removes the previous companion, the rest stay.
+            if index % 2:
+                await companion_set.remove_companion(f"{name}-{index - 1}")
+            else:
+                await companion_set.add_companion(_companion(f"{name}-{index}"))
+        except IdbException:
+            failures += 1
+        latencies.append(time.monotonic() - start)
+    return (latencies, failures)
+
+
+def _worker(
+    kind: str, path: str, name: str, operations: int, results: "Queue[object]"
+) -> None:
+    logging.disable(logging.CRITICAL)
+    if kind == "read":
+        outcome = asyncio.run(_read(path, operations))
+    else:
+        outcome = asyncio.run(_write(path, name, operations))
+    results.put((kind, outcome))
+
+
+def _report(kind: str, latencies: list[float], failures: int) -> None:
+    if len(latencies) < 2:
+        return
+    percentiles = statistics.quantiles([latency * 1000 for latency in latencies], n=100)
+    print(
+        f"{kind:<6} {len(latencies):6} ops  "
+        f"p50 {percentiles[49]:7.2f}ms  p99 {percentiles[98]:7.2f}ms  "
+        f"max {max(latencies) * 1000:8.2f}ms  failures {failures}"
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--readers", type=int, default=32)
+    parser.add_argument("--writers", type=int, default=8)
+    parser.add_argument("--operations", type=int, default=200)
+    args = parser.parse_args()
+    context = multiprocessing.get_context("spawn")
+    results = context.Queue()
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "state")
+        workers = [
+            context.Process(
+                target=_worker, args=("read", path, "", args.operations, results)
+            )
+            for _ in range(args.readers)
+        ] + [
+            context.Process(
+                target=_worker,
+                args=("write", path, f"writer{index}", args.operations, results),
+            )
+            for index in range(args.writers)
+        ]
+        for worker in workers:
+            worker.start()
+        outcomes = [results.get() for _ in workers]
+        for worker in workers:
+            worker.join()
+
+        for kind in ["read", "write"]:
+            latencies: list[float] = []
+            failures = 0
+            for outcome_kind, (outcome_latencies, outcome_failures) in outcomes:
+                if outcome_kind == kind:
+                    latencies += outcome_latencies
+                    failures += outcome_failures
+            _report(kind, latencies, failures)
+
+        remaining = asyncio.run(
+            CompanionSet(logger=LOGGER, state_file_path=path).get_companions()
+        )
+        expected = args.writers * ((args.operations + 1) // 2 - args.operations // 2)
+        print(
+            f"{len(remaining)} companions remain, expected {expected}"
+            + ("" if len(remaining) == expected else ": UPDATES WERE LOST")
+        )
+
+
+if __name__ == "__main__":
+    main()
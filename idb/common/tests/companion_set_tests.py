@@ -6,6 +6,11 @@
 
 # pyre-strict
 
+import asyncio
+import fcntl
+import json
+import multiprocessing
+import os
 import tempfile
 from collections.abc import AsyncGenerator
 from pathlib import Path
@@ -170,3 +175,123 @@ class CompanionSetTests(TestCase):
             self.assertEqual(replaced, companion_first)
             companions = await manager.get_companions()
             self.assertEqual(companions, [companion_second])
+
+    async def test_reads_do_not_wait_for_writers(self) -> None:
+        with tempfile.TemporaryDirectory() as dir:
+            path = str(Path(dir) / "state_file")
+            manager = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+            companion = CompanionInfo(
+                udid="a",
+                address=DomainSocketAddress(path="/tmp/a.sock"),
+                is_local=True,
+                pid=None,
+            )
+            await manager.add_companion(companion)
+            # A lockfile left behind by an older idb, and a writer holding the lock.
+            Path(path + ".lock").touch()
+            lock = os.open(path + ".writer.lock", os.O_RDWR)
+            try:
+                fcntl.flock(lock, fcntl.LOCK_EX)
+                companions = await asyncio.wait_for(manager.get_companions(), 0.5)
+                self.assertEqual(companions, [companion])
+            finally:
+                os.close(lock)
+
+    async def test_writers_wait_for_an_older_writers_lockfile(self) -> None:
+        with tempfile.TemporaryDirectory() as dir:
+            path = str(Path(dir) / "state_file")
+            manager = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+            companion = CompanionInfo(
+                udid="a",
+                address=DomainSocketAddress(path="/tmp/a.sock"),
+                is_local=True,
+                pid=None,
+            )
+            # An older idb in the middle of a write.
+            Path(path + ".lock").touch()
+            add = asyncio.ensure_future(manager.add_companion(companion))
+            await asyncio.sleep(0.1)
+            self.assertFalse(add.done())
+            os.unlink(path + ".lock")
+            await asyncio.wait_for(add, 1)
+            self.assertEqual(await manager.get_companions(), [companion])
+            self.assertFalse(os.path.exists(path + ".lock"))
+
+    async def test_stale_lockfile_is_broken_at_the_deadline(self) -> None:
+        with tempfile.TemporaryDirectory() as dir:
+            path = str(Path(dir) / "state_file")
+            manager = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+            companion = CompanionInfo(
+                udid="a",
+                address=DomainSocketAddress(path="/tmp/a.sock"),
+                is_local=True,
+                pid=None,
+            )
+            # Left behind by an older idb that was killed mid-write.
+            Path(path + ".lock").touch()
+            with mock.patch("idb.common.companion_set.WRITER_LOCK_TIMEOUT", 0.1):
+                await asyncio.wait_for(manager.add_companion(companion), 1)
+            self.assertEqual(await manager.get_companions(), [companion])
+
+    async def test_empty_state_file_is_read_without_retrying(self) -> None:
+        with tempfile.NamedTemporaryFile() as f:
+            manager = CompanionSet(logger=mock.MagicMock(), state_file_path=f.name)
+            with mock.patch("idb.common.companion_set.asyncio.sleep") as sleep:
+                self.assertEqual(await manager.get_companions(), [])
+            sleep.assert_not_called()
+
+    async def test_writes_replace_the_state_file(self) -> None:
+        with tempfile.TemporaryDirectory() as dir:
+            path = str(Path(dir) / "state_file")
+            reader = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+            writer = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+            first = CompanionInfo(
+                udid="a", address=TCPAddress(host="a", port=1), is_local=False, pid=1
+            )
+            second = CompanionInfo(
+                udid="b", address=TCPAddress(host="b", port=2), is_local=False, pid=2
+            )
+            await writer.add_companion(first)
+            inode = os.stat(path).st_ino
+            self.assertEqual(await reader.get_companions(), [first])
+            await writer.add_companion(second)
+            self.assertNotEqual(os.stat(path).st_ino, inode)
+            self.assertEqual(await reader.get_companions(), [first, second])
+            # The format is unchanged, so older clients can still read it.
+            with open(path) as f:
+                self.assertEqual([item["udid"] for item in json.load(f)], ["a", "b"])
+            self.assertEqual(os.listdir(dir), ["state_file", "state_file.writer.lock"])
+
+    async def test_concurrent_writers_from_many_processes(self) -> None:
+        with tempfile.TemporaryDirectory() as dir:
+            path = str(Path(dir) / "state_file")
+            context = multiprocessing.get_context("spawn")
+            processes = [
+                context.Process(target=_add_companions, args=(path, f"p{index}", 10))
+                for index in range(4)
+            ]
+            for process in processes:
+                process.start()
+            for process in processes:
+                process.join()
+            self.assertEqual([process.exitcode for process in processes], [0] * 4)
+            companions = await CompanionSet(
+                logger=mock.MagicMock(), state_file_path=path
+            ).get_companions()
+            self.assertEqual(len(companions), 40)
+
+
+def _add_companions(path: str, prefix: str, count: int) -> None:
+    async def add() -> None:
+        manager = CompanionSet(logger=mock.MagicMock(), state_file_path=path)
+        for index in range(count):
+            await manager.add_companion(
+                CompanionInfo(
+                    udid=f"{prefix}-{index}",
+                    address=DomainSocketAddress(path=f"/tmp/{prefix}-{index}.sock"),
+                    is_local=True,
+                    pid=None,
+                )
+            )
+
+    asyncio.run(add())
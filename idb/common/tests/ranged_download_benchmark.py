@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Measures ranged pull throughput against a stand-in for a remote companion.
+
+    python -m idb.common.tests.ranged_download_benchmark [--megabytes N]
+
+The stand-in serves a local file with a fixed round trip time per request and a
+per-stream bandwidth cap, which is what bounds a single gRPC stream to a remote
+host. It reports MB/s for a range of concurrent stream counts.
+"""
+
+import argparse
+import asyncio
+import logging
+import os
+import tempfile
+import time
+from collections.abc import AsyncIterator
+
+from idb.common.ranged_download import RangeChunk, RangedDownload, RemoteFile
+
+
+CHUNK_SIZE: int = 1024 * 1024 * 4
+
+
+class CompanionStandIn:
+    def __init__(self, path: str, rtt: float, stream_bandwidth: float) -> None:
+        self._path = path
+        self._rtt = rtt
+        self._stream_bandwidth = stream_bandwidth
+
+    async def fetch_remote(self) -> RemoteFile:
+        await asyncio.sleep(self._rtt)
+        return RemoteFile(size=os.path.getsize(self._path), version="1")
+
+    async def fetch_range(self, offset: int, length: int) -> AsyncIterator[RangeChunk]:
+        await asyncio.sleep(self._rtt)
+        with open(self._path, "rb") as f:
+            f.seek(offset)
+            position = offset
+            while position < offset + length:
+                data = f.read(min(CHUNK_SIZE, offset + length - position))
+                await asyncio.sleep(len(data) / self._stream_bandwidth)
+                yield RangeChunk(offset=position, data=data, version="1")
+                position += len(data)
+
+
+async def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--megabytes", type=int, default=512)
+    parser.add_argument("--rtt-ms", type=float, default=40)
+    parser.add_argument("--stream-mbps", type=float, default=100)
+    args = parser.parse_args()
+    logger = logging.getLogger("ranged_download_benchmark")
+    with tempfile.TemporaryDirectory() as root:
+        source = os.path.join(root, "source")
+        with open(source, "wb") as f:
+            for _ in range(args.megabytes):
+                f.write(os.urandom(1024 * 1024))
+        companion = CompanionStandIn(
+            path=source,
+            rtt=args.rtt_ms / 1000,
+            stream_bandwidth=args.stream_mbps * 1e6,
+        )
+        for streams in [1, 2, 4, 8, 16]:
+            destination = os.path.join(root, f"pulled-{streams}")
+            start = time.monotonic()
+            await RangedDownload(path=destination, logger=logger, streams=streams).run(
+                companion.fetch_remote, companion.fetch_range
+            )
+            throughput = args.megabytes * 1024 * 1024 / (time.monotonic() - start)
+            print(f"{streams:>2} streams: {throughput / 1e6:8.1f} MB/s")
+            os.remove(destination)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import errno
+import logging
+import os
+import tempfile
+from collections.abc import AsyncIterator
+from unittest import mock
+
+from idb.common.ranged_download import (
+    RangeChunk,
+    RangedDownload,
+    RangedDownloadException,
+    RemoteFile,
+    RemoteFileChangedException,
+)
+from idb.utils.testing import TestCase
+
+
+class FakeRemoteFile:
+    def __init__(self, data: bytes, chunk_size: int = 3, version: str = "1") -> None:
+        self.data = data
+        self.chunk_size = chunk_size
+        self.version = version
+        self.requested: list[int] = []
+        self.failures: dict[int, BaseException] = {}
+
+    async def fetch_remote(self) -> RemoteFile:
+        return RemoteFile(size=len(self.data), version=self.version)
+
+    async def fetch_range(self, offset: int, length: int) -> AsyncIterator[RangeChunk]:
+        self.requested.append(offset)
+        end = offset + length
+        for position in range(offset, end, self.chunk_size):
+            if position != offset and offset in self.failures:
+                raise self.failures.pop(offset)
+            yield RangeChunk(
+                offset=position,
+                data=self.data[position : min(end, position + self.chunk_size)],
+                version=self.version,
+            )
+
+
+class RangedDownloadTests(TestCase):
+    def _download(self, path: str, streams: int = 3) -> RangedDownload:
+        return RangedDownload(
+            path=path,
+            logger=logging.getLogger(),
+            range_size=10,
+            streams=streams,
+            retries=1,
+        )
+
+    async def test_downloads_all_ranges(self) -> None:
+        remote = FakeRemoteFile(os.urandom(95))
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            await self._download(path).run(remote.fetch_remote, remote.fetch_range)
+            with open(path, "rb") as f:
+                self.assertEqual(f.read(), remote.data)
+            self.assertEqual(sorted(remote.requested), list(range(0, 95, 10)))
+            self.assertEqual(os.listdir(root), ["file"])
+
+    async def test_empty_file(self) -> None:
+        remote = FakeRemoteFile(b"")
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            await self._download(path).run(remote.fetch_remote, remote.fetch_range)
+            self.assertEqual(os.path.getsize(path), 0)
+
+    async def test_retries_dropped_range(self) -> None:
+        remote = FakeRemoteFile(os.urandom(40))
+        remote.failures[20] = ConnectionError("dropped")
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            await self._download(path).run(remote.fetch_remote, remote.fetch_range)
+            with open(path, "rb") as f:
+                self.assertEqual(f.read(), remote.data)
+            self.assertEqual(remote.requested.count(20), 2)
+
+    async def test_resumes_after_failure(self) -> None:
+        remote = FakeRemoteFile(os.urandom(50))
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            remote.failures[30] = ValueError("not retryable")
+            with self.assertRaises(ValueError):
+                await self._download(path, streams=1).run(
+                    remote.fetch_remote, remote.fetch_range
+                )
+            self.assertFalse(os.path.exists(path))
+
+            remote.requested = []
+            await self._download(path, streams=1).run(
+                remote.fetch_remote, remote.fetch_range
+            )
+            self.assertEqual(remote.requested, [30, 40])
+            with open(path, "rb") as f:
+                self.assertEqual(f.read(), remote.data)
+
+    async def test_restarts_when_remote_size_changes(self) -> None:
+        remote = FakeRemoteFile(os.urandom(50))
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            remote.failures[30] = ValueError("not retryable")
+            with self.assertRaises(ValueError):
+                await self._download(path, streams=1).run(
+                    remote.fetch_remote, remote.fetch_range
+                )
+
+            remote = FakeRemoteFile(os.urandom(60))
+            await self._download(path, streams=1).run(
+                remote.fetch_remote, remote.fetch_range
+            )
+            self.assertEqual(remote.requested, list(range(0, 60, 10)))
+            with open(path, "rb") as f:
+                self.assertEqual(f.read(), remote.data)
+
+    async def _interrupt(self, path: str, remote: FakeRemoteFile, at: int) -> None:
+        remote.failures[at] = ValueError("not retryable")
+        with self.assertRaises(ValueError):
+            await self._download(path, streams=1).run(
+                remote.fetch_remote, remote.fetch_range
+            )
+
+    async def test_restarts_when_remote_version_changes_at_the_same_size(
+        self,
+    ) -> None:
+        remote = FakeRemoteFile(os.urandom(50), version="1")
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            await self._interrupt(path, remote, at=30)
+
+            remote = FakeRemoteFile(os.urandom(50), version="2")
+            await self._download(path, streams=1).run(
+                remote.fetch_remote, remote.fetch_range
+            )
+            self.assertEqual(remote.requested, list(range(0, 50, 10)))
+            with open(path, "rb") as f:
+                self.assertEqual(f.read(), remote.data)
+
+    async def test_restarts_when_remote_has_no_version(self) -> None:
+        remote = FakeRemoteFile(os.urandom(50), version="")
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            await self._interrupt(path, remote, at=30)
+
+            remote.requested = []
+            await self._download(path, streams=1).run(
+                remote.fetch_remote, remote.fetch_range
+            )
+            self.assertEqual(remote.requested, list(range(0, 50, 10)))
+
+    async def test_fails_when_remote_changes_during_the_download(self) -> None:
+        remote = FakeRemoteFile(os.urandom(50), version="1")
+
+        async def fetch_range(offset: int, length: int) -> AsyncIterator[RangeChunk]:
+            async for chunk in remote.fetch_range(offset, length):
+                yield chunk._replace(version="2") if offset == 20 else chunk
+
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            with self.assertRaises(RemoteFileChangedException):
+                await self._download(path, streams=1).run(
+                    remote.fetch_remote, fetch_range
+                )
+            self.assertEqual(remote.requested, [0, 10, 20])
+            self.assertFalse(os.path.exists(path))
+
+    async def test_local_write_failures_are_not_retried(self) -> None:
+        remote = FakeRemoteFile(os.urandom(40))
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "file")
+            with mock.patch(
+                "idb.common.ranged_download.os.pwrite",
+                side_effect=OSError(errno.ENOSPC, "No space left on device"),
+            ):
+                with self.assertRaises(RangedDownloadException):
+                    await self._download(path, streams=1).run(
+                        remote.fetch_remote, remote.fetch_range
+                    )
+            self.assertEqual(remote.requested, [0])
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Compares the in-process archiver with the tar/gzip subprocess pipeline.
+
+    python -m idb.common.tests.tar_benchmark [PATH ...]
+
+Without paths a synthetic bundle of mixed compressible/random files is generated.
+"""
+
+import argparse
+import asyncio
+import os
+import resource
+import tempfile
+import time
+
+from idb.common.tar import generate_tar
+from idb.common.types import Compression
+
+
+def _make_synthetic_bundle(root: str, megabytes: int) -> str:
+    bundle = os.path.join(root, "Synthetic.app")
+    os.makedirs(bundle)
+    for i in range(megabytes):
+        with open(os.path.join(bundle, f"file{i}"), "wb") as f:
+            # Half random, half repetitive, roughly what a binary + resources looks like
+            f.write(os.urandom(512 * 1024))
+            f.write(bytes(i % 256 for i in range(256)) * 2048)
+    return bundle
+
+
+def _cpu_seconds() -> float:
+    own = resource.getrusage(resource.RUSAGE_SELF)
+    children = resource.getrusage(resource.RUSAGE_CHILDREN)
+    return own.ru_utime + own.ru_stime + children.ru_utime + children.ru_stime
+
+
+def _input_bytes(paths: list[str]) -> int:
+    total = 0
+    for path in paths:
+        if os.path.isfile(path):
+            total += os.path.getsize(path)
+        for root, _, files in os.walk(path):
+            total += sum(os.path.getsize(os.path.join(root, f)) for f in files)
+    return total
+
+
+async def _run(paths: list[str], compression: Compression, in_process: bool) -> None:
+    size = _input_bytes(paths)
+    cpu_start = _cpu_seconds()
+    wall_start = time.monotonic()
+    output = 0
+    async for chunk in generate_tar(
+        paths=paths, compression=compression, in_process=in_process
+    ):
+        output += len(chunk)
+    wall = time.monotonic() - wall_start
+    cpu = _cpu_seconds() - cpu_start
+    label = "in-process" if in_process else "subprocess"
+    print(
+        f"{compression.name:<5} {label:<11} "
+        f"{size / wall / 1e6:8.1f} MB/s  cpu {cpu:6.2f}s  wall {wall:6.2f}s  "
+        f"ratio {output / max(size, 1):.3f}"
+    )
+
+
+async def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("paths", nargs="*")
+    parser.add_argument("--megabytes", type=int, default=256)
+    parser.add_argument(
+        "--compression", choices=[c.name for c in Compression], default="GZIP"
+    )
+    args = parser.parse_args()
+    compression = Compression[args.compression]
+    with tempfile.TemporaryDirectory() as root:
+        paths = args.paths or [_make_synthetic_bundle(root, args.megabytes)]
+        for in_process in [False, True]:
+            await _run(paths, compression, in_process)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -6,7 +6,19 @@
 
 # pyre-strict
 
-from idb.common.tar import _create_untar_command
+import io
+import os
+import tarfile
+import tempfile
+
+from idb.common.tar import (
+    _create_untar_command,
+    create_tar,
+    generate_tar,
+    InProcessArchive,
+    READ_CHUNK_SIZE,
+)
+from idb.common.types import Compression
 from idb.utils.testing import TestCase
 
 
@@ -34,3 +46,75 @@ class UdidTests(TestCase):
             _create_untar_command(output_path=output_path, gnu_tar=False, verbose=True),
             ["tar", "-C", output_path, "-xzpfv", "-"],
         )
+
+
+class InProcessArchiveTests(TestCase):
+    def _make_tree(self, root: str) -> str:
+        bundle = os.path.join(root, "Foo.app")
+        os.makedirs(os.path.join(bundle, "Frameworks"))
+        with open(os.path.join(bundle, "Foo"), "wb") as f:
+            f.write(os.urandom(1024 * 64))
+        with open(os.path.join(bundle, "Frameworks", "Bar.dylib"), "wb") as f:
+            f.write(b"bar" * 1024)
+        os.symlink("Foo", os.path.join(bundle, "Link"))
+        return bundle
+
+    async def test_gzip_output_is_a_plain_tar_gz(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            bundle = self._make_tree(root)
+            data = b"".join(
+                [chunk async for chunk in generate_tar([bundle], Compression.GZIP)]
+            )
+            self.assertEqual(data[:2], b"\x1f\x8b")
+            with tarfile.open(fileobj=io.BytesIO(data), mode="r:gz") as archive:
+                names = set(archive.getnames())
+                link = archive.getmember("Foo.app/Link")
+            self.assertEqual(
+                names,
+                {
+                    "Foo.app",
+                    "Foo.app/Foo",
+                    "Foo.app/Frameworks",
+                    "Foo.app/Frameworks/Bar.dylib",
+                    "Foo.app/Link",
+                },
+            )
+            self.assertTrue(link.issym())
+            self.assertEqual(link.linkname, "Foo")
+
+    async def test_place_in_subfolders(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            bundle = self._make_tree(root)
+            data = await create_tar([bundle], place_in_subfolders=True)
+            with tarfile.open(fileobj=io.BytesIO(data), mode="r:gz") as archive:
+                top_level = {name.split("/")[0] for name in archive.getnames()}
+                second_level = {
+                    name.split("/")[1] for name in archive.getnames() if "/" in name
+                }
+            self.assertEqual(len(top_level), 1)
+            self.assertEqual(second_level, {"Foo.app"})
+
+    async def test_chunks_are_bounded(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "big")
+            with open(path, "wb") as f:
+                f.write(os.urandom(READ_CHUNK_SIZE * 2))
+            chunks = [chunk async for chunk in generate_tar([path])]
+            self.assertGreater(len(chunks), 1)
+            self.assertTrue(all(len(chunk) <= READ_CHUNK_SIZE for chunk in chunks))
+            self.assertTrue(all(len(chunk) == READ_CHUNK_SIZE for chunk in chunks[:-1]))
+
+    async def test_early_close_stops_worker(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            path = os.path.join(root, "big")
+            with open(path, "wb") as f:
+                f.write(os.urandom(READ_CHUNK_SIZE * 8))
+            generator = generate_tar([path])
+            await generator.__anext__()
+            await generator.aclose()
+
+    def test_extra_tar_args_fall_back_to_subprocess(self) -> None:
+        self.assertTrue(InProcessArchive.supports(Compression.GZIP, None))
+        self.assertFalse(
+            InProcessArchive.supports(Compression.GZIP, ["--exclude", "*.o"])
+        )
@@ -0,0 +1,140 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import io
+import json
+import os
+import tempfile
+import xml.etree.ElementTree as ElementTree
+
+from idb.common.test_result_sink import (
+    BinaryTestResultSink,
+    JUnitTestResultSink,
+    NDJSONTestResultSink,
+    read_binary_test_results,
+)
+from idb.common.types import IdbException, TestRunFailureInfo, TestRunInfo
+from idb.utils.testing import TestCase
+
+
+PASSED = TestRunInfo(
+    bundle_name="MyTests",
+    class_name="LoginTests",
+    method_name="testLogin",
+    logs=["starting", "done"],
+    duration=1.25,
+    passed=True,
+    failure_info=None,
+    activityLogs=None,
+    crashed=False,
+)
+FAILURE_INFO = TestRunFailureInfo(
+    message='XCTAssertEqual failed: ("1") is not equal to ("2")',
+    file="LoginTests.m",
+    line=42,
+)
+FAILED = TestRunInfo(
+    bundle_name="MyTests",
+    class_name="LoginTests",
+    method_name="testLogout",
+    logs=["<b>&\x07"],
+    duration=0.5,
+    passed=False,
+    failure_info=FAILURE_INFO,
+    activityLogs=None,
+    crashed=False,
+)
+CRASHED = TestRunInfo(
+    bundle_name="MyTests",
+    class_name="",
+    method_name="",
+    logs=[],
+    duration=0.0,
+    passed=False,
+    failure_info=None,
+    activityLogs=None,
+    crashed=True,
+)
+
+
+class TestResultSinkTests(TestCase):
+    def test_ndjson_writes_a_line_per_result(self) -> None:
+        output = io.BytesIO()
+        with NDJSONTestResultSink(output) as sink:
+            sink.write(PASSED)
+            self.assertEqual(output.getvalue().count(b"\n"), 1)
+            sink.write(FAILED)
+        lines = output.getvalue().decode().splitlines()
+        self.assertEqual(
+            [json.loads(line)["status"] for line in lines], ["passed", "failed"]
+        )
+
+    def test_junit_counts_are_rewritten_on_close(self) -> None:
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            path = os.path.join(tmp_dir, "results.xml")
+            with open(path, "wb") as output, JUnitTestResultSink(output) as sink:
+                for result in [PASSED, FAILED, CRASHED]:
+                    sink.write(result)
+            suite = ElementTree.parse(path).getroot().find("testsuite")
+        assert suite is not None
+        self.assertEqual(suite.get("tests"), "3")
+        self.assertEqual(suite.get("failures"), "1")
+        self.assertEqual(suite.get("errors"), "1")
+        self.assertEqual(suite.get("time"), "1.750")
+        cases = suite.findall("testcase")
+        self.assertEqual(
+            [(case.get("classname"), case.get("name")) for case in cases],
+            [
+                ("MyTests.LoginTests", "testLogin"),
+                ("MyTests.LoginTests", "testLogout"),
+                ("MyTests", ""),
+            ],
+        )
+        self.assertEqual(cases[0].findtext("system-out"), "starting\ndone")
+        failure = cases[1].find("failure")
+        assert failure is not None
+        self.assertEqual(failure.get("message"), FAILURE_INFO.message)
+        self.assertEqual(failure.text, "LoginTests.m:42")
+        # The control character is dropped, as XML cannot hold it.
+        self.assertEqual(cases[1].findtext("system-out"), "<b>&")
+        self.assertIsNotNone(cases[2].find("error"))
+
+    def test_junit_without_seeking_leaves_out_counts(self) -> None:
+        class Unseekable(io.BytesIO):
+            def seekable(self) -> bool:
+                return False
+
+        output = Unseekable()
+        with JUnitTestResultSink(output) as sink:
+            sink.write(FAILED)
+        suite = ElementTree.fromstring(output.getvalue()).find("testsuite")
+        assert suite is not None
+        self.assertIsNone(suite.get("tests"))
+        self.assertEqual(len(suite.findall("testcase")), 1)
+
+    def test_binary_round_trips(self) -> None:
+        output = io.BytesIO()
+        with BinaryTestResultSink(output) as sink:
+            for result in [PASSED, FAILED, CRASHED]:
+                sink.write(result)
+        self.assertEqual(
+            list(read_binary_test_results(io.BytesIO(output.getvalue()))),
+            [PASSED, FAILED, CRASHED],
+        )
+
+    def test_binary_ignores_a_truncated_record(self) -> None:
+        output = io.BytesIO()
+        with BinaryTestResultSink(output) as sink:
+            sink.write(PASSED)
+            sink.write(FAILED)
+        truncated = io.BytesIO(output.getvalue()[:-3])
+        self.assertEqual(list(read_binary_test_results(truncated)), [PASSED])
+
+    def test_binary_rejects_other_files(self) -> None:
+        with self.assertRaises(IdbException):
+            list(read_binary_test_results(io.BytesIO(b"<?xml")))
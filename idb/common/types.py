@@ -10,7 +10,13 @@ import asyncio
 import json
 from abc import ABC, abstractmethod
 from asyncio import StreamReader, StreamWriter
-from collections.abc import AsyncGenerator, AsyncIterable, AsyncIterator, Mapping
+from collections.abc import (
+    AsyncGenerator,
+    AsyncIterable,
+    AsyncIterator,
+    Iterable,
+    Mapping,
+)
 from contextlib import asynccontextmanager
 from dataclasses import asdict, dataclass, field
 from datetime import timedelta
@@ -165,6 +171,39 @@ class TargetDescription:
         return json.dumps(asdict(self))
 
 
+@dataclass(frozen=True)
+class OutputBatching:
+    """How the companion coalesces streamed log and tail output into messages.
+
+    Output is sent once max_bytes have built up, or once the oldest unsent byte
+    has waited max_latency_ms. Output written while max_buffered_bytes are
+    waiting to be sent is dropped by the companion, and reported as lost."""
+
+    max_bytes: int = 64 * 1024
+    max_latency_ms: int = 20
+    max_buffered_bytes: int = 8 * 1024 * 1024
+
+
+@dataclass(frozen=True)
+class LogFilter:
+    """Selects the log entries the companion sends.
+
+    Each list matches any one of its values, and an entry must match every list
+    that is not empty. Processes are names or pids. message_regex is searched for
+    in each entry's message: the eventMessage of a structured entry, the text
+    after the process and level of a syslog line, or the whole of any other line."""
+
+    subsystems: list[str] = field(default_factory=list)
+    categories: list[str] = field(default_factory=list)
+    processes: list[str] = field(default_factory=list)
+    message_regex: str | None = None
+
+
+class LogFormat(Enum):
+    TEXT = 0
+    NDJSON = 1
+
+
 @dataclass(frozen=True)
 class FileEntryInfo:
     path: str
@@ -269,6 +308,8 @@ class AccessibilityInfoOptions:
     format: AccessibilityOutputFormat | None = None
     profile: bool = False
     collect_frame_coverage: bool = False
+    # Whole-screen reads are sent as a diff from the client's last read.
+    incremental: bool = False
 
 
 class AccessibilityScrollDirection(Enum):
@@ -318,6 +359,8 @@ class TestAttachment:
     name: str
     uniform_type_identifier: str
     user_info_json: bytes
+    # Set when the payload was written straight to this file rather than kept.
+    path: str | None = None
 
 
 @dataclass(frozen=True)
@@ -599,6 +642,8 @@ class Client(ABC):
         coverage_format: CodeCoverageFormat = CodeCoverageFormat.EXPORTED,
         log_directory_path: str | None = None,
         wait_for_debugger: bool = False,
+        log_spill_bytes: int | None = None,
+        attachments_as_paths: bool = False,
     ) -> AsyncIterator[TestRunInfo]:
         # pyrefly: ignore [invalid-yield]
         yield
@@ -610,6 +655,8 @@ class Client(ABC):
         compression: Compression | None = None,
         make_debuggable: bool | None = None,
         override_modification_time: bool | None = None,
+        delta: bool | None = None,
+        cache: bool | None = None,
     ) -> AsyncIterator[InstalledArtifact]:
         # pyrefly: ignore [invalid-yield]
         yield
@@ -634,7 +681,10 @@ class Client(ABC):
 
     @abstractmethod
     async def install_xctest(
-        self, xctest: str | IO[bytes], skip_signing_bundles: bool | None = None
+        self,
+        xctest: str | IO[bytes],
+        skip_signing_bundles: bool | None = None,
+        cache: bool | None = None,
     ) -> AsyncIterator[InstalledArtifact]:
         # pyrefly: ignore [invalid-yield]
         yield
@@ -664,7 +714,12 @@ class Client(ABC):
 
     @abstractmethod
     async def tail_logs(
-        self, stop: asyncio.Event, arguments: list[str] | None = None
+        self,
+        stop: asyncio.Event,
+        arguments: list[str] | None = None,
+        batching: OutputBatching | None = None,
+        log_filter: LogFilter | None = None,
+        log_format: LogFormat = LogFormat.TEXT,
     ) -> AsyncIterator[str]:
         # pyrefly: ignore [invalid-yield]
         yield
@@ -933,6 +988,15 @@ class Client(ABC):
         radius: float = 100.0,
     ) -> None: ...
 
+    @abstractmethod
+    async def define_gesture(self, name: str, events: Iterable[HIDEvent]) -> None:
+        """Has the companion expand and keep a gesture, to perform by name."""
+        pass
+
+    @abstractmethod
+    async def perform_gesture(self, name: str) -> None:
+        pass
+
     @abstractmethod
     async def ls_single(
         self, container: FileContainer, path: str
@@ -959,7 +1023,11 @@ class Client(ABC):
 
     @abstractmethod
     async def pull(
-        self, container: FileContainer, src_path: str, dest_path: str
+        self,
+        container: FileContainer,
+        src_path: str,
+        dest_path: str,
+        streams: int | None = None,
     ) -> None:
         pass
 
@@ -975,7 +1043,11 @@ class Client(ABC):
 
     @abstractmethod
     async def tail(
-        self, stop: asyncio.Event, container: FileContainer, path: str
+        self,
+        stop: asyncio.Event,
+        container: FileContainer,
+        path: str,
+        batching: OutputBatching | None = None,
     ) -> AsyncIterator[bytes]:
         # pyrefly: ignore [invalid-yield]
         yield
@@ -0,0 +1,49 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+from typing import Any
+
+AccessibilityTree = list[dict[str, Any]]
+
+
+def apply_accessibility_diff(
+    base: AccessibilityTree, diff: dict[str, Any]
+) -> AccessibilityTree:
+    """
+    Applies a snapshot diff from the companion to the tree it was taken against,
+    in place, and returns the new tree. The wire form is described on
+    AccessibilityInfoResponse.diff.
+    """
+    preorder: list[dict[str, Any]] = []
+
+    def visit(nodes: AccessibilityTree) -> None:
+        for node in nodes:
+            preorder.append(node)
+            visit(node.get("children") or [])
+
+    visit(base)
+    for change in diff.get("changed", []):
+        node = preorder[change["node"]]
+        for key, value in change.get("set", {}).items():
+            # Children are diffed node by node; setting them only makes the key.
+            if key == "children":
+                node.setdefault("children", [])
+            else:
+                node[key] = value
+        for key in change.get("unset", []):
+            node.pop(key, None)
+    removed = {id(preorder[index]) for index in diff.get("removed", [])}
+    if removed:
+        lists = [base] + [node["children"] for node in preorder if "children" in node]
+        for nodes in lists:
+            nodes[:] = [node for node in nodes if id(node) not in removed]
+    for insertion in sorted(diff.get("inserted", []), key=lambda item: item["index"]):
+        parent = insertion["parent"]
+        nodes = base if parent == -1 else preorder[parent].setdefault("children", [])
+        nodes.insert(insertion["index"], insertion["node"])
+    return base
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import logging
+import time
+from collections.abc import AsyncGenerator
+from dataclasses import dataclass
+
+from grpclib.client import Channel
+from grpclib.exceptions import ProtocolError, StreamTerminatedError
+from idb.common.types import Address, CompanionInfo, IdbConnectionException
+from idb.grpc.client import Client
+from idb.grpc.idb_grpc import CompanionServiceStub
+from idb.utils.contextlib import asynccontextmanager
+
+
+DEFAULT_IDLE_TIMEOUT: float = 300.0
+DEFAULT_HANDSHAKE_MAX_AGE: float = 600.0
+
+_PoolKey = tuple[Address, bool, tuple[tuple[str, str], ...]]
+
+_CONNECTION_ERRORS: tuple[type[BaseException], ...] = (
+    IdbConnectionException,
+    OSError,
+    ProtocolError,
+    StreamTerminatedError,
+)
+
+
+def _is_connection_error(error: BaseException) -> bool:
+    # Client methods wrap transport errors in IdbException, keeping the cause.
+    cause: BaseException | None = error
+    while cause is not None:
+        if isinstance(cause, _CONNECTION_ERRORS):
+            return True
+        cause = cause.__cause__
+    return False
+
+
+@dataclass
+class _PooledChannel:
+    channel: Channel
+    stub: CompanionServiceStub
+    companion: CompanionInfo
+    connected_at: float
+    last_used: float
+    leases: int = 0
+    evicted: bool = False
+
+
+@dataclass
+class _KeyLock:
+    lock: asyncio.Lock
+    # The number of Clients acquiring a channel for the key, waiting or not.
+    users: int = 0
+
+
+class ChannelPool:
+    """
+    Keeps a channel open to each companion that a process talks to, so that every
+    Client after the first skips the connection setup and the connect handshake.
+
+    The result of the handshake, whether the companion is local and the metadata it
+    sent, is cached with the channel and replayed for each Client. Many Clients can
+    share one channel at once, as calls are multiplexed over the same HTTP/2
+    connection.
+
+    A channel is dropped when a call on it fails with a connection error, when it
+    has been idle for `idle_timeout`, and its handshake is repeated once it is older
+    than `handshake_max_age`, in case a different companion is now at the address.
+    """
+
+    def __init__(
+        self,
+        idle_timeout: float = DEFAULT_IDLE_TIMEOUT,
+        handshake_max_age: float = DEFAULT_HANDSHAKE_MAX_AGE,
+        logger: logging.Logger | None = None,
+    ) -> None:
+        self._idle_timeout = idle_timeout
+        self._handshake_max_age = handshake_max_age
+        self._logger: logging.Logger = (
+            logger if logger else logging.getLogger("idb_channel_pool")
+        )
+        self._channels: dict[_PoolKey, _PooledChannel] = {}
+        # Only kept while the key has a channel or a Client acquiring one.
+        self._locks: dict[_PoolKey, _KeyLock] = {}
+        self.connects = 0
+        self.reuses = 0
+
+    @asynccontextmanager
+    async def client(
+        self,
+        address: Address,
+        logger: logging.Logger,
+        exchange_metadata: bool = True,
+        extra_metadata: dict[str, str] | None = None,
+        use_tls: bool = False,
+    ) -> AsyncGenerator[Client, None]:
+        """
+        The pooled equivalent of Client.build.
+        """
+        metadata_to_companion = Client.metadata_to_companion(
+            logger=logger,
+            exchange_metadata=exchange_metadata,
+            extra_metadata=extra_metadata,
+        )
+        key: _PoolKey = (
+            address,
+            use_tls,
+            tuple(sorted(metadata_to_companion.items())),
+        )
+        pooled = await self._acquire(
+            key=key,
+            logger=logger,
+            metadata_to_companion=metadata_to_companion,
+        )
+        try:
+            if exchange_metadata:
+                Client.append_companion_metadata(
+                    companion=pooled.companion, logger=logger
+                )
+            yield Client(stub=pooled.stub, companion=pooled.companion, logger=logger)
+        except BaseException as e:
+            if _is_connection_error(e):
+                self._logger.debug(f"Dropping channel to {address} after {e}")
+                self._evict(key, pooled)
+            raise
+        finally:
+            self._release(pooled)
+
+    async def _acquire(
+        self,
+        key: _PoolKey,
+        logger: logging.Logger,
+        metadata_to_companion: dict[str, str],
+    ) -> _PooledChannel:
+        self._close_idle()
+        key_lock = self._locks.setdefault(key, _KeyLock(lock=asyncio.Lock()))
+        key_lock.users += 1
+        try:
+            # Concurrent Clients for a new address wait for one handshake between them.
+            async with key_lock.lock:
+                return await self._acquire_locked(
+                    key=key, logger=logger, metadata_to_companion=metadata_to_companion
+                )
+        finally:
+            key_lock.users -= 1
+            self._drop_unused_lock(key)
+
+    async def _acquire_locked(
+        self,
+        key: _PoolKey,
+        logger: logging.Logger,
+        metadata_to_companion: dict[str, str],
+    ) -> _PooledChannel:
+        now = time.monotonic()
+        pooled = self._channels.get(key)
+        if pooled is not None and now - pooled.connected_at > self._handshake_max_age:
+            self._evict(key, pooled)
+            pooled = None
+        if pooled is None:
+            pooled = await self._connect(
+                key=key, logger=logger, metadata_to_companion=metadata_to_companion
+            )
+        else:
+            self.reuses += 1
+        pooled.leases += 1
+        pooled.last_used = now
+        return pooled
+
+    async def _connect(
+        self,
+        key: _PoolKey,
+        logger: logging.Logger,
+        metadata_to_companion: dict[str, str],
+    ) -> _PooledChannel:
+        (address, use_tls, _) = key
+        channel = Client.open_channel(address=address, use_tls=use_tls)
+        stub = CompanionServiceStub(channel=channel)
+        try:
+            companion = await Client.handshake(
+                stub=stub,
+                address=address,
+                logger=logger,
+                metadata_to_companion=metadata_to_companion,
+            )
+        except BaseException:
+            channel.close()
+            raise
+        now = time.monotonic()
+        pooled = _PooledChannel(
+            channel=channel,
+            stub=stub,
+            companion=companion,
+            connected_at=now,
+            last_used=now,
+        )
+        self._channels[key] = pooled
+        self.connects += 1
+        self._logger.debug(f"Opened pooled channel to {address}")
+        return pooled
+
+    def _release(self, pooled: _PooledChannel) -> None:
+        pooled.leases -= 1
+        pooled.last_used = time.monotonic()
+        if pooled.evicted and pooled.leases == 0:
+            pooled.channel.close()
+
+    def _evict(self, key: _PoolKey, pooled: _PooledChannel) -> None:
+        if self._channels.get(key) is pooled:
+            del self._channels[key]
+        pooled.evicted = True
+        if pooled.leases == 0:
+            pooled.channel.close()
+        self._drop_unused_lock(key)
+
+    def _drop_unused_lock(self, key: _PoolKey) -> None:
+        key_lock = self._locks.get(key)
+        if key_lock is not None and key_lock.users == 0 and key not in self._channels:
+            del self._locks[key]
+
+    def _close_idle(self) -> None:
+        now = time.monotonic()
+        for key, pooled in list(self._channels.items()):
+            if pooled.leases == 0 and now - pooled.last_used > self._idle_timeout:
+                self._logger.debug(f"Closing idle channel to {key[0]}")
+                self._evict(key, pooled)
+
+    def close(self) -> None:
+        """
+        Closes every channel. Channels that are in use are closed once released.
+        """
+        for key, pooled in list(self._channels.items()):
+            self._evict(key, pooled)
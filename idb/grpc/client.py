@@ -10,12 +10,14 @@ import asyncio
 import codecs
 import functools
 import inspect
+import json
 import logging
 import os
 import shutil
 import sys
 import tempfile
 import urllib.parse
+import uuid
 from asyncio import StreamReader, StreamWriter
 from collections.abc import AsyncGenerator, AsyncIterable, AsyncIterator, Iterable
 from io import StringIO
@@ -24,6 +26,7 @@ from typing import Any
 
 import idb.common.plugin as plugin
 from grpclib.client import Channel
+from grpclib.const import Status
 from grpclib.exceptions import GRPCError, ProtocolError, StreamTerminatedError
 from idb.common.constants import TESTS_POLL_INTERVAL
 from idb.common.file import drain_to_file
@@ -42,8 +45,9 @@ from idb.common.hid import (
     text_to_events,
 )
 from idb.common.logging import log_call
+from idb.common.ranged_download import RangeChunk, RangedDownload, RemoteFile
 from idb.common.stream import stream_map
-from idb.common.tar import create_tar, drain_untar, generate_tar
+from idb.common.tar import create_tar, drain_untar, generate_tar, InProcessArchive
 from idb.common.types import (
     AccessibilityInfo,
     AccessibilityInfoOptions,
@@ -77,13 +81,17 @@ from idb.common.types import (
     InstalledTestInfo,
     InstrumentsTimings,
     LoggingMetadata,
+    LogFilter,
+    LogFormat,
     OnlyFilter,
+    OutputBatching,
     Permission,
     TargetDescription,
     TCPAddress,
     TestRunInfo,
     VideoFormat,
 )
+from idb.grpc.accessibility import AccessibilityTree, apply_accessibility_diff
 from idb.grpc.crash import (
     _to_crash_log,
     _to_crash_log_info_list,
@@ -91,7 +99,13 @@ from idb.grpc.crash import (
 )
 from idb.grpc.dap import RemoteDapServer
 from idb.grpc.file import container_to_grpc as file_container_to_grpc
-from idb.grpc.hid import event_to_grpc
+from idb.grpc.hid import (
+    event_to_grpc,
+    events_to_grpc_batches,
+    gesture_definition_to_grpc,
+    gesture_to_grpc,
+    GrpcHIDEvent,
+)
 from idb.grpc.idb_grpc import CompanionServiceStub
 from idb.grpc.idb_pb2 import (
     AccessibilityActionRequest,
@@ -143,11 +157,15 @@ from idb.grpc.idb_pb2 import (
     XctraceRecordRequest,
 )
 from idb.grpc.install import (
+    bundle_tree_digest,
     Bundle,
     Destination,
+    generate_app_manifest,
     generate_binary_chunks,
     generate_io_chunks,
+    generate_missing_content_chunks,
     generate_requests,
+    supports_bundle_cache,
 )
 from idb.grpc.instruments import (
     instruments_drain_until_running,
@@ -155,6 +173,11 @@ from idb.grpc.instruments import (
     translate_instruments_timings,
 )
 from idb.grpc.launch import drain_launch_stream, end_launch_stream
+from idb.grpc.log import (
+    log_filter_to_grpc,
+    log_format_to_grpc,
+    output_batching_to_grpc,
+)
 from idb.grpc.stream import (
     cancel_wrapper,
     drain_to_stream,
@@ -207,6 +230,13 @@ COMPRESSION_MAP: dict[Compression, "Payload.Compression"] = {
 }
 
 
+def _is_unrecognized_hid_event(error: GRPCError) -> bool:
+    return (
+        error.status == Status.INVALID_ARGUMENT
+        and error.message == "Unrecognized request.event"
+    )
+
+
 def log_and_handle_exceptions(grpc_method_name: str):  # pyre-ignore
     metadata: LoggingMetadata = {
         "grpc_method_name": grpc_method_name,
@@ -256,6 +286,15 @@ class Client(ClientBase):
         self.stub = stub
         self.companion = companion
         self.logger = logger
+        self._hid_batches_supported = True
+        self._hid_gestures_supported = True
+        # The events of each gesture defined through this client, to define
+        # again if the companion no longer has it.
+        self._gestures: dict[str, list[HIDEvent]] = {}
+        # The companion keeps the last tree read in this session, so that an
+        # incremental read is sent as a diff from the version held here.
+        self._accessibility_session: str = uuid.uuid4().hex
+        self._accessibility_snapshot: tuple[int, AccessibilityTree] | None = None
 
     @property
     def address(self) -> Address:
@@ -267,66 +306,102 @@ class Client(ClientBase):
             return False
         return self.companion.is_local
 
-    @classmethod
-    @asynccontextmanager
-    async def build(
-        cls,
-        address: Address,
+    @staticmethod
+    def metadata_to_companion(
         logger: logging.Logger,
         exchange_metadata: bool = True,
         extra_metadata: dict[str, str] | None = None,
-        use_tls: bool = False,
-    ) -> AsyncGenerator["Client", None]:
-        metadata_to_companion = (
-            {
-                **{
-                    key: value
-                    for (key, value) in plugin.resolve_metadata(logger=logger).items()
-                    if isinstance(value, str)
-                },
-                **(extra_metadata or {}),
-            }
-            if exchange_metadata
-            else {}
-        )
+    ) -> dict[str, str]:
+        if not exchange_metadata:
+            return {}
+        return {
+            **{
+                key: value
+                for (key, value) in plugin.resolve_metadata(logger=logger).items()
+                if isinstance(value, str)
+            },
+            **(extra_metadata or {}),
+        }
+
+    @staticmethod
+    def open_channel(address: Address, use_tls: bool = False) -> Channel:
         ssl_context = plugin.channel_ssl_context() if use_tls else None
         if use_tls:
             assert ssl_context is not None
-        async with (
-            Channel(
+        if isinstance(address, TCPAddress):
+            return Channel(
                 host=address.host,
                 port=address.port,
                 loop=asyncio.get_running_loop(),
                 ssl=ssl_context,
             )
-            if isinstance(address, TCPAddress)
-            else Channel(path=address.path, loop=asyncio.get_running_loop())
-        ) as channel:
-            stub = CompanionServiceStub(channel=channel)
-            with tempfile.NamedTemporaryFile(mode="w+b") as f:
-                try:
-                    response = await stub.connect(
-                        ConnectRequest(
-                            metadata=metadata_to_companion, local_file_path=f.name
-                        )
-                    )
-                except Exception as ex:
-                    raise IdbException(
-                        f"Failed to connect to companion at address {address}: {ex}"
+        return Channel(path=address.path, loop=asyncio.get_running_loop())
+
+    @staticmethod
+    async def handshake(
+        stub: CompanionServiceStub,
+        address: Address,
+        logger: logging.Logger,
+        metadata_to_companion: dict[str, str],
+    ) -> CompanionInfo:
+        """
+        Sends the connect request, which tells the client whether the companion is
+        on the same host and exchanges metadata with it.
+        """
+        with tempfile.NamedTemporaryFile(mode="w+b") as f:
+            try:
+                response = await stub.connect(
+                    ConnectRequest(
+                        metadata=metadata_to_companion, local_file_path=f.name
                     )
-            logger.debug(
-                f"Companion at {address} {'is' if response.companion.is_local else 'is not'} local"
+                )
+            except Exception as ex:
+                raise IdbException(
+                    f"Failed to connect to companion at address {address}: {ex}"
+                )
+        logger.debug(
+            f"Companion at {address} {'is' if response.companion.is_local else 'is not'} local"
+        )
+        return companion_to_py(companion=response.companion, address=address)
+
+    @staticmethod
+    def append_companion_metadata(
+        companion: CompanionInfo, logger: logging.Logger
+    ) -> None:
+        plugin.append_companion_metadata(
+            logger=logger,
+            metadata={
+                key: value
+                for (key, value) in companion.metadata.items()
+                if isinstance(value, str)
+            },
+        )
+
+    @classmethod
+    @asynccontextmanager
+    async def build(
+        cls,
+        address: Address,
+        logger: logging.Logger,
+        exchange_metadata: bool = True,
+        extra_metadata: dict[str, str] | None = None,
+        use_tls: bool = False,
+    ) -> AsyncGenerator["Client", None]:
+        metadata_to_companion = Client.metadata_to_companion(
+            logger=logger,
+            exchange_metadata=exchange_metadata,
+            extra_metadata=extra_metadata,
+        )
+        async with Client.open_channel(address=address, use_tls=use_tls) as channel:
+            stub = CompanionServiceStub(channel=channel)
+            companion = await Client.handshake(
+                stub=stub,
+                address=address,
+                logger=logger,
+                metadata_to_companion=metadata_to_companion,
             )
-            companion = companion_to_py(companion=response.companion, address=address)
             if exchange_metadata:
-                metadata_from_companion = {
-                    key: value
-                    for (key, value) in companion.metadata.items()
-                    if isinstance(value, str)
-                }
-                plugin.append_companion_metadata(
-                    logger=logger, metadata=metadata_from_companion
-                )
+                Client.append_companion_metadata(companion=companion, logger=logger)
             yield Client(stub=stub, companion=companion, logger=logger)
 
     @classmethod
@@ -357,17 +432,40 @@ class Client(ClientBase):
         source: LogRequest.Source,
         stop: asyncio.Event,
         arguments: list[str] | None,
+        batching: OutputBatching | None = None,
+        log_filter: LogFilter | None = None,
+        log_format: LogFormat = LogFormat.TEXT,
     ) -> AsyncIterator[str]:
         async with self.stub.log.open() as stream:
             await stream.send_message(
-                LogRequest(arguments=arguments, source=source), end=True
+                LogRequest(
+                    arguments=arguments,
+                    source=source,
+                    batching=output_batching_to_grpc(batching),
+                    filter=log_filter_to_grpc(log_filter),
+                    format=log_format_to_grpc(log_format),
+                ),
+                end=True,
             )
             # Use an incremental decoder to properly handle multi-byte UTF-8
             # characters that may be split across message boundaries
             decoder = codecs.getincrementaldecoder("utf-8")(errors="replace")
+            lost_bytes = 0
             async for message in cancel_wrapper(stream=stream, stop=stop):
+                lost_bytes = self._report_lost_output(
+                    "log", lost_bytes, message.lost_bytes
+                )
                 yield decoder.decode(message.output)
 
+    def _report_lost_output(self, name: str, reported: int, lost_bytes: int) -> int:
+        if lost_bytes > reported:
+            self.logger.warning(
+                f"The companion dropped {lost_bytes - reported} bytes of {name} "
+                f"output ({lost_bytes} in total) as it was produced faster than "
+                "it could be sent"
+            )
+        return max(reported, lost_bytes)
+
     async def _install_to_destination(
         self,
         bundle: Bundle,
@@ -378,9 +476,14 @@ class Client(ClientBase):
         bundle_type: FileContainerType | None,
         override_modification_time: bool | None = None,
         skip_signing_bundles: bool | None = None,
+        delta: bool | None = None,
+        cache: bool | None = None,
+        archive: AsyncIterator[bytes] | None = None,
     ) -> AsyncIterator[InstalledArtifact]:
         async with self.stub.install.open() as stream:
             generator = None
+            manifest_path = None
+            cache_path = None
             if isinstance(bundle, str):
                 url = urllib.parse.urlparse(bundle)
                 if url.scheme:
@@ -409,6 +512,23 @@ class Client(ClientBase):
                         generator = generate_requests(
                             [InstallRequest(payload=Payload(file_path=file_path))]
                         )
+                    elif (
+                        delta
+                        and destination == InstallRequest.APP
+                        and file_path.endswith(".app")
+                    ):
+                        self.logger.debug(
+                            f"Companion is remote, installing {file_path} by manifest"
+                        )
+                        manifest_path = file_path
+                    elif archive is not None:
+                        self.logger.debug(
+                            f"Companion is remote, sending pre-generated archive of {file_path}"
+                        )
+                        generator = stream_map(
+                            archive,
+                            lambda chunk: InstallRequest(payload=Payload(data=chunk)),
+                        )
                     else:
                         self.logger.debug(
                             f"Companion is remote, generating binary chunks for {file_path}"
@@ -420,6 +540,8 @@ class Client(ClientBase):
                             compression=compression,
                             logger=self.logger,
                         )
+                        if cache and supports_bundle_cache(file_path, destination):
+                            cache_path = file_path
 
             else:
                 # chunk file from memory
@@ -441,7 +563,7 @@ class Client(ClientBase):
                 await stream.send_message(
                     InstallRequest(skip_signing_bundles=skip_signing_bundles)
                 )
-            if compression is not None:
+            if compression is not None and manifest_path is None:
                 await stream.send_message(
                     InstallRequest(
                         payload=Payload(compression=COMPRESSION_MAP[compression])
@@ -462,6 +584,14 @@ class Client(ClientBase):
                 )
                 await stream.send_message(InstallRequest(link_dsym_to_bundle=message))
 
+            if manifest_path is not None:
+                generator = await self._send_install_manifest(
+                    stream=stream, app_path=manifest_path, compression=compression
+                )
+            if cache_path is not None and await self._send_bundle_digest(
+                stream=stream, bundle_path=cache_path
+            ):
+                generator = generate_requests([])
             async for message in generator:
                 await stream.send_message(message)
             self.logger.debug("Finished sending install payload to companion")
@@ -471,6 +601,53 @@ class Client(ClientBase):
                     name=response.name, uuid=response.uuid, progress=response.progress
                 )
 
+    async def _send_bundle_digest(
+        self,
+        stream: Any,  # pyre-ignore
+        bundle_path: str,
+    ) -> bool:
+        digest = await bundle_tree_digest(bundle_path, self.logger)
+        await stream.send_message(InstallRequest(bundle_digest=digest))
+        response = await stream.recv_message()
+        cached = response is not None and response.bundle_cached
+        self.logger.debug(
+            f"{bundle_path} is {'' if cached else 'not '}cached by the companion"
+        )
+        return cached
+
+    async def _send_install_manifest(
+        self,
+        stream: Any,  # pyre-ignore
+        app_path: str,
+        compression: Compression | None,
+    ) -> AsyncIterator[InstallRequest]:
+        manifest, digest_to_path = await generate_app_manifest(
+            app_path=app_path, logger=self.logger
+        )
+        await stream.send_message(InstallRequest(manifest=manifest))
+        response = await stream.recv_message()
+        missing = list(response.missing_digests)
+        unknown = [digest for digest in missing if digest not in digest_to_path]
+        if unknown:
+            raise IdbException(f"Companion requested unknown content {unknown}")
+        self.logger.info(
+            f"Uploading {len(missing)} of {len(digest_to_path)} files in {app_path}"
+        )
+        if not missing:
+            return generate_requests([])
+        compression = compression or Compression.GZIP
+        if not InProcessArchive.supports(compression, None):
+            compression = Compression.GZIP
+        await stream.send_message(
+            InstallRequest(payload=Payload(compression=COMPRESSION_MAP[compression]))
+        )
+        return generate_missing_content_chunks(
+            digests=missing,
+            digest_to_path=digest_to_path,
+            compression=compression,
+            logger=self.logger,
+        )
+
     @property
     def _is_verbose(self) -> bool:
         return self.logger.isEnabledFor(logging.DEBUG)
@@ -527,8 +704,43 @@ class Client(ClientBase):
         elif isinstance(target, AccessibilityPoint):
             request.point.x = target.x
             request.point.y = target.y
+        incremental = (
+            options.incremental
+            and target is None
+            and wire_format != AccessibilityInfoRequest.COMPLETE
+        )
+        # The base is captured with the request, so the diff is applied to the tree
+        # it was taken against even if another read replaced the snapshot meanwhile.
+        base = self._accessibility_snapshot if incremental else None
+        if incremental:
+            request.snapshot_session = self._accessibility_session
+            if base is not None:
+                request.base_version = base[0]
         response = await self.stub.accessibility_info(request)
-        return AccessibilityInfo(json=response.json)
+        # An older companion ignores the session and keeps nothing.
+        if not incremental or not response.version:
+            return AccessibilityInfo(json=response.json)
+        if response.diff and (
+            base is None
+            or response.base_version != base[0]
+            or self._accessibility_snapshot is not base
+        ):
+            # The diff is not from the tree this request holds, or a concurrent read
+            # has already applied one to it in place: drop it and read it whole.
+            self._accessibility_snapshot = None
+            request.ClearField("base_version")
+            response = await self.stub.accessibility_info(request)
+        if not response.diff:
+            tree = json.loads(response.json)
+            self._accessibility_snapshot = (response.version, tree)
+            return AccessibilityInfo(json=response.json)
+        if base is None or self._accessibility_snapshot is not base:
+            raise IdbException("Received an accessibility diff with no base tree")
+        # Cleared first, so a diff that fails to apply leaves no partial base.
+        self._accessibility_snapshot = None
+        tree = apply_accessibility_diff(base[1], json.loads(response.diff))
+        self._accessibility_snapshot = (response.version, tree)
+        return AccessibilityInfo(json=json.dumps(tree, separators=(",", ":")))
 
     @log_and_handle_exceptions("accessibility_tap")
     async def accessibility_tap(
@@ -793,6 +1005,8 @@ class Client(ClientBase):
         compression: Compression | None = None,
         make_debuggable: bool | None = None,
         override_modification_time: bool | None = None,
+        delta: bool | None = None,
+        cache: bool | None = None,
     ) -> AsyncIterator[InstalledArtifact]:
         async for response in self._install_to_destination(
             bundle=bundle,
@@ -802,6 +1016,35 @@ class Client(ClientBase):
             bundle_id=None,
             bundle_type=None,
             override_modification_time=override_modification_time,
+            delta=delta,
+            cache=cache,
+        ):
+            yield response
+
+    @log_and_handle_exceptions("install")
+    async def install_archive(
+        self,
+        bundle_path: str,
+        archive: AsyncIterator[bytes],
+        destination: Destination = InstallRequest.APP,
+        compression: Compression | None = None,
+        make_debuggable: bool | None = None,
+        override_modification_time: bool | None = None,
+    ) -> AsyncIterator[InstalledArtifact]:
+        """
+        Installs `bundle_path`, sending a remote companion the chunks of `archive`
+        rather than generating them. This lets one archive be sent to many targets.
+        A local companion installs from `bundle_path` and `archive` is not read.
+        """
+        async for response in self._install_to_destination(
+            bundle=bundle_path,
+            destination=destination,
+            compression=compression,
+            make_debuggable=make_debuggable,
+            bundle_id=None,
+            bundle_type=None,
+            override_modification_time=override_modification_time,
+            archive=archive,
         ):
             yield response
 
@@ -810,6 +1053,7 @@ class Client(ClientBase):
         self,
         xctest: Bundle,
         skip_signing_bundles: bool | None = None,
+        cache: bool | None = None,
     ) -> AsyncIterator[InstalledArtifact]:
         async for response in self._install_to_destination(
             bundle=xctest,
@@ -819,6 +1063,7 @@ class Client(ClientBase):
             bundle_id=None,
             bundle_type=None,
             skip_signing_bundles=skip_signing_bundles,
+            cache=cache,
         ):
             yield response
 
@@ -912,8 +1157,20 @@ class Client(ClientBase):
 
     @log_and_handle_exceptions("pull")
     async def pull(
-        self, container: FileContainer, src_path: str, dest_path: str
+        self,
+        container: FileContainer,
+        src_path: str,
+        dest_path: str,
+        streams: int | None = None,
     ) -> None:
+        if streams is not None and not self.is_local:
+            await self._pull_ranged(
+                container=container,
+                src_path=src_path,
+                dest_path=dest_path,
+                streams=streams,
+            )
+            return
         async with self.stub.pull.open() as stream:
             request = request = PullRequest(
                 src_path=src_path,
@@ -931,19 +1188,72 @@ class Client(ClientBase):
                 await drain_untar(generate_bytes(stream), output_path=dest_path)
             self.logger.info(f"pulled file to {dest_path}")
 
+    async def _pull_ranged(
+        self, container: FileContainer, src_path: str, dest_path: str, streams: int
+    ) -> None:
+        grpc_container = file_container_to_grpc(container)
+
+        def make_request(offset: int, length: int) -> PullRequest:
+            return PullRequest(
+                src_path=src_path,
+                container=grpc_container,
+                range=PullRequest.Range(offset=offset, length=length),
+            )
+
+        async def fetch_remote() -> RemoteFile:
+            async with self.stub.pull.open() as stream:
+                await stream.send_message(make_request(offset=0, length=0), end=True)
+                response = await stream.recv_message()
+                if response is None:
+                    raise IdbException(f"No size reported for {src_path}")
+                return RemoteFile(size=response.total_size, version=response.version)
+
+        async def fetch_range(offset: int, length: int) -> AsyncIterator[RangeChunk]:
+            async with self.stub.pull.open() as stream:
+                await stream.send_message(
+                    make_request(offset=offset, length=length), end=True
+                )
+                async for response in stream:
+                    yield RangeChunk(
+                        offset=response.offset,
+                        data=response.payload.data,
+                        version=response.version,
+                    )
+
+        # Matches the layout of an untarred pull, the file is placed inside dest_path.
+        os.makedirs(dest_path, exist_ok=True)
+        path = os.path.join(dest_path, os.path.basename(src_path.rstrip("/")))
+        await RangedDownload(
+            path=path,
+            logger=self.logger,
+            streams=streams,
+            retryable=(StreamTerminatedError, ProtocolError, ConnectionError, OSError),
+        ).run(fetch_remote=fetch_remote, fetch_range=fetch_range)
+        self.logger.info(f"pulled file to {path} over {streams} streams")
+
     @log_and_handle_exceptions("tail")
     async def tail(
-        self, stop: asyncio.Event, container: FileContainer, path: str
+        self,
+        stop: asyncio.Event,
+        container: FileContainer,
+        path: str,
+        batching: OutputBatching | None = None,
     ) -> AsyncIterator[bytes]:
         async with self.stub.tail.open() as stream:
             await stream.send_message(
                 TailRequest(
                     start=TailRequest.Start(
-                        container=file_container_to_grpc(container), path=path
+                        container=file_container_to_grpc(container),
+                        path=path,
+                        batching=output_batching_to_grpc(batching),
                     )
                 )
             )
+            lost_bytes = 0
             async for response in cancel_wrapper(stream=stream, stop=stop):
+                lost_bytes = self._report_lost_output(
+                    "tail", lost_bytes, response.lost_bytes
+                )
                 yield response.data
             await stream.send_message(TailRequest(stop=TailRequest.Stop()))
 
@@ -968,6 +1278,22 @@ class Client(ClientBase):
 
     @log_and_handle_exceptions("hid")
     async def send_events(self, events: Iterable[HIDEvent]) -> None:
+        # A gesture goes as batches the companion sends as one timed sequence,
+        # rather than as one message, and one dispatch, per event.
+        events = list(events)
+        if self._hid_batches_supported:
+            try:
+                await self._send_grpc_events(
+                    iterator_to_async_iterator(events_to_grpc_batches(events))
+                )
+                return
+            except GRPCError as e:
+                if not _is_unrecognized_hid_event(e):
+                    raise
+                # Companions from before batches reject the first batch before
+                # sending anything, so the events can be sent again one by one.
+                self.logger.info("Companion does not accept HID batches")
+                self._hid_batches_supported = False
         await self.hid(iterator_to_async_iterator(events))
 
     @log_and_handle_exceptions("hid")
@@ -1026,10 +1352,55 @@ class Client(ClientBase):
 
     @log_and_handle_exceptions("hid")
     async def hid(self, event_iterator: AsyncIterable[HIDEvent]) -> None:
-        async with self.stub.hid.open() as stream:
-            grpc_event_iterator = (
-                event_to_grpc(event) async for event in event_iterator
+        await self._send_grpc_events(
+            event_to_grpc(event) async for event in event_iterator
+        )
+
+    @log_and_handle_exceptions("hid")
+    async def define_gesture(self, name: str, events: Iterable[HIDEvent]) -> None:
+        events = list(events)
+        self._gestures[name] = events
+        if not self._hid_gestures_supported:
+            return
+        try:
+            await self._send_grpc_events(
+                iterator_to_async_iterator([gesture_definition_to_grpc(name, events)])
+            )
+        except GRPCError as e:
+            if not _is_unrecognized_hid_event(e):
+                del self._gestures[name]
+                raise
+            # Gestures defined on companions that do not keep them are sent
+            # in full each time they are performed.
+            self.logger.info("Companion does not keep HID gestures")
+            self._hid_gestures_supported = False
+
+    @log_and_handle_exceptions("hid")
+    async def perform_gesture(self, name: str) -> None:
+        events = self._gestures.get(name)
+        if not self._hid_gestures_supported and events is not None:
+            await self.send_events(events)
+            return
+        try:
+            await self._send_grpc_events(
+                iterator_to_async_iterator([gesture_to_grpc(name)])
             )
+        except GRPCError as e:
+            if e.status != Status.NOT_FOUND or events is None:
+                raise
+            # The companion has restarted, or evicted the gesture, since it was
+            # defined. Nothing was sent, so define it again and perform it.
+            self.logger.info(f"Companion no longer has gesture {name}, redefining")
+            await self._send_grpc_events(
+                iterator_to_async_iterator(
+                    [gesture_definition_to_grpc(name, events), gesture_to_grpc(name)]
+                )
+            )
+
+    async def _send_grpc_events(
+        self, grpc_event_iterator: AsyncIterable[GrpcHIDEvent]
+    ) -> None:
+        async with self.stub.hid.open() as stream:
             await drain_to_stream(
                 stream=stream,
                 generator=grpc_event_iterator,
@@ -1345,6 +1716,8 @@ class Client(ClientBase):
         coverage_format: CodeCoverageFormat = CodeCoverageFormat.EXPORTED,
         log_directory_path: str | None = None,
         wait_for_debugger: bool = False,
+        log_spill_bytes: int | None = None,
+        attachments_as_paths: bool = False,
     ) -> AsyncIterator[TestRunInfo]:
         async with self.stub.xctest_run.open() as stream:
             request = make_request(
@@ -1372,62 +1745,83 @@ class Client(ClientBase):
                 wait_for_debugger=wait_for_debugger,
                 collect_result_bundle=result_bundle_path is not None,
             )
-            log_parser = XCTestLogParser()
+            # Each test's log lines are released once its result has been made,
+            # so a long run holds only the logs of tests yet to report.
+            log_parser = XCTestLogParser(streaming=True, spill_bytes=log_spill_bytes)
             await stream.send_message(request)
             await stream.end()
-            async for response in stream:
-                # response.log_output is a container of strings.
-                # google.protobuf.pyext._message.RepeatedScalarContainer.
-                for line in [
-                    line
-                    for lines in response.log_output
-                    for line in lines.splitlines(keepends=True)
-                ]:
-                    log_parser.parse_streaming_log(line.rstrip())
-                    self._log_from_companion(line)
-                    if idb_log_buffer:
-                        idb_log_buffer.write(line)
-
-                if result_bundle_path:
-                    await untar_into_path(
-                        payload=response.result_bundle,
-                        description="result bundle",
-                        output_path=result_bundle_path,
-                        logger=self.logger,
-                    )
-                if log_directory_path:
-                    await untar_into_path(
-                        payload=response.log_directory,
-                        description="log directory",
-                        output_path=log_directory_path,
-                        logger=self.logger,
-                    )
-
-                await self._handle_code_coverage_in_response(
-                    response, coverage_output_path, coverage_format
-                )
+            try:
+                async for response in stream:
+                    # response.log_output is a container of strings.
+                    # google.protobuf.pyext._message.RepeatedScalarContainer.
+                    for lines in response.log_output:
+                        for line in lines.splitlines(keepends=True):
+                            log_parser.parse_streaming_log(line.rstrip())
+                            self._log_from_companion(line)
+                            if idb_log_buffer:
+                                idb_log_buffer.write(line)
+
+                    if result_bundle_path:
+                        await untar_into_path(
+                            payload=response.result_bundle,
+                            description="result bundle",
+                            output_path=result_bundle_path,
+                            logger=self.logger,
+                        )
+                    if log_directory_path:
+                        await untar_into_path(
+                            payload=response.log_directory,
+                            description="log directory",
+                            output_path=log_directory_path,
+                            logger=self.logger,
+                        )
 
-                if wait_for_debugger and response.debugger.pid:
-                    sys.stdout.buffer.write(
-                        json_format_debugger_info(response.debugger).encode()
+                    await self._handle_code_coverage_in_response(
+                        response, coverage_output_path, coverage_format
                     )
-                    sys.stdout.buffer.write(os.linesep.encode())
-                    sys.stdout.buffer.flush()
-
-                for result in make_results(response, log_parser):
-                    if activities_output_path:
-                        save_attachments(
-                            run_info=result,
-                            activities_output_path=activities_output_path,
+
+                    if wait_for_debugger and response.debugger.pid:
+                        sys.stdout.buffer.write(
+                            json_format_debugger_info(response.debugger).encode()
                         )
-                    yield result
+                        sys.stdout.buffer.write(os.linesep.encode())
+                        sys.stdout.buffer.flush()
+
+                    # With attachments_as_paths, attachments are written out as
+                    # each result is made, so the results hold their paths
+                    # rather than their payloads.
+                    for result in make_results(
+                        response,
+                        log_parser,
+                        attachments_output_path=(
+                            activities_output_path if attachments_as_paths else None
+                        ),
+                    ):
+                        if activities_output_path and not attachments_as_paths:
+                            save_attachments(
+                                run_info=result,
+                                activities_output_path=activities_output_path,
+                            )
+                        yield result
+            finally:
+                log_parser.close()
 
     @log_and_handle_exceptions("log")
     async def tail_logs(
-        self, stop: asyncio.Event, arguments: list[str] | None = None
+        self,
+        stop: asyncio.Event,
+        arguments: list[str] | None = None,
+        batching: OutputBatching | None = None,
+        log_filter: LogFilter | None = None,
+        log_format: LogFormat = LogFormat.TEXT,
     ) -> AsyncIterator[str]:
         async for message in self._tail_specific_logs(
-            source=LogRequest.TARGET, stop=stop, arguments=arguments
+            source=LogRequest.TARGET,
+            stop=stop,
+            arguments=arguments,
+            batching=batching,
+            log_filter=log_filter,
+            log_format=log_format,
         ):
             yield message
 
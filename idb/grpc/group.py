@@ -0,0 +1,308 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import logging
+import os
+import tempfile
+import time
+from collections.abc import AsyncIterator, Awaitable, Callable
+from dataclasses import dataclass
+from typing import Generic, TypeVar
+
+import aiofiles
+import idb.common.tar as tar
+from idb.common.types import Compression, IdbException, InstalledArtifact, TestRunInfo
+from idb.grpc.client import Client
+from idb.grpc.install import CHUNK_SIZE, Destination, InstallRequest
+from idb.grpc.management import ClientManager
+from idb.grpc.shard import (
+    DEFAULT_BATCH_SECONDS,
+    ShardResult,
+    TestDurationHistory,
+    XctestShardScheduler,
+)
+from idb.grpc.xctest import xctest_paths_to_tar
+
+
+DEFAULT_PARALLELISM: int = 8
+
+_T = TypeVar("_T")
+
+
+@dataclass(frozen=True)
+class TargetResult(Generic[_T]):
+    udid: str
+    value: _T | None
+    error: BaseException | None
+    duration: float
+
+    @property
+    def succeeded(self) -> bool:
+        return self.error is None
+
+
+class SpooledArchive:
+    """
+    Generates an archive once and lets any number of readers stream it.
+
+    Chunks are spooled to a temporary file as they are generated, so a reader can
+    start before generation has finished and a reader that starts late replays
+    from the file, rather than the whole archive being held in memory. Nothing is
+    generated until the first reader starts.
+    """
+
+    def __init__(self, source: AsyncIterator[bytes]) -> None:
+        self._source = source
+        self._lengths: list[int] = []
+        self._done = False
+        self._error: BaseException | None = None
+        self._condition = asyncio.Condition()
+        self._file: tempfile._TemporaryFileWrapper[bytes] = (
+            tempfile.NamedTemporaryFile(prefix="idb-group-", suffix=".spool")
+        )
+        self._task: asyncio.Task[None] | None = None
+
+    async def _spool(self) -> None:
+        fd = self._file.fileno()
+        try:
+            async for chunk in self._source:
+                if not chunk:
+                    continue
+                os.write(fd, chunk)
+                async with self._condition:
+                    self._lengths.append(len(chunk))
+                    self._condition.notify_all()
+        except BaseException as e:
+            self._error = e
+        finally:
+            async with self._condition:
+                self._done = True
+                self._condition.notify_all()
+
+    async def chunks(self) -> AsyncIterator[bytes]:
+        if self._task is None:
+            self._task = asyncio.ensure_future(self._spool())
+        fd = self._file.fileno()
+        index = 0
+        offset = 0
+        while True:
+            async with self._condition:
+                await self._condition.wait_for(
+                    lambda: index < len(self._lengths) or self._done
+                )
+                if index >= len(self._lengths):
+                    if self._error is not None:
+                        raise IdbException(
+                            f"Failed to generate archive: {self._error}"
+                        ) from self._error
+                    return
+                length = self._lengths[index]
+            yield os.pread(fd, length, offset)
+            index += 1
+            offset += length
+
+    async def close(self) -> None:
+        task = self._task
+        if task is not None:
+            task.cancel()
+            await asyncio.gather(task, return_exceptions=True)
+        self._file.close()
+
+
+def _archive_source(
+    bundle_path: str,
+    destination: Destination,
+    compression: Compression,
+    logger: logging.Logger,
+) -> AsyncIterator[bytes]:
+    # The same bytes as generate_binary_chunks, without the InstallRequest framing.
+    if destination == InstallRequest.XCTEST:
+        return tar.generate_tar(xctest_paths_to_tar(bundle_path, logger))
+    if destination != InstallRequest.APP:
+        raise IdbException(f"Can't install {bundle_path} on several targets at once")
+    if bundle_path.endswith(".app"):
+        return tar.generate_tar(paths=[bundle_path], compression=compression)
+    return _read_file(bundle_path)
+
+
+async def _read_file(path: str) -> AsyncIterator[bytes]:
+    async with aiofiles.open(path, "r+b") as file:
+        while True:
+            chunk = await file.read(CHUNK_SIZE)
+            if not chunk:
+                return
+            yield chunk
+
+
+class ClientGroup:
+    """
+    Runs the same operation against several targets, at most `parallelism` at a time.
+
+    Each target's companion is connected to when its turn comes, and a failure on one
+    target, including failing to connect, is reported in its result rather than
+    stopping the others.
+    """
+
+    def __init__(
+        self,
+        manager: ClientManager,
+        udids: list[str],
+        parallelism: int = DEFAULT_PARALLELISM,
+        logger: logging.Logger | None = None,
+    ) -> None:
+        self._manager = manager
+        self._udids: list[str] = list(dict.fromkeys(udids))
+        self._parallelism: int = max(1, parallelism)
+        self._logger: logging.Logger = (
+            logger if logger else logging.getLogger("idb_client_group")
+        )
+
+    @property
+    def udids(self) -> list[str]:
+        return self._udids
+
+    async def run(
+        self, operation: Callable[[Client], Awaitable[_T]]
+    ) -> list[TargetResult[_T]]:
+        semaphore = asyncio.Semaphore(self._parallelism)
+
+        async def run_on_target(udid: str) -> TargetResult[_T]:
+            async with semaphore:
+                start = time.monotonic()
+                try:
+                    async with self._manager.from_udid(udid=udid) as client:
+                        value = await operation(client)
+                except Exception as e:
+                    duration = time.monotonic() - start
+                    self._logger.info(f"Failed on {udid} after {duration:.2f}s: {e}")
+                    return TargetResult(
+                        udid=udid, value=None, error=e, duration=duration
+                    )
+                duration = time.monotonic() - start
+                self._logger.debug(f"Finished on {udid} in {duration:.2f}s")
+                return TargetResult(
+                    udid=udid, value=value, error=None, duration=duration
+                )
+
+        return list(
+            await asyncio.gather(*(run_on_target(udid) for udid in self._udids))
+        )
+
+    async def install(
+        self,
+        bundle_path: str,
+        destination: Destination = InstallRequest.APP,
+        compression: Compression | None = None,
+        make_debuggable: bool | None = None,
+        override_modification_time: bool | None = None,
+    ) -> list[TargetResult[InstalledArtifact]]:
+        """
+        Installs an .app, .ipa or .xctest on every target.
+
+        The archive is generated once, however many targets there are, and its
+        chunks are streamed to each remote companion. Local companions install
+        from the path, as they would for a single target.
+        """
+        archive = SpooledArchive(
+            _archive_source(
+                bundle_path=bundle_path,
+                destination=destination,
+                compression=compression or Compression.GZIP,
+                logger=self._logger,
+            )
+        )
+
+        async def install_on_target(client: Client) -> InstalledArtifact:
+            artifact = None
+            async for artifact in client.install_archive(
+                bundle_path=bundle_path,
+                archive=archive.chunks(),
+                destination=destination,
+                # Only .app archives can be sent with a compression other than gzip
+                compression=compression if destination == InstallRequest.APP else None,
+                make_debuggable=make_debuggable,
+                override_modification_time=override_modification_time,
+            ):
+                pass
+            if artifact is None:
+                raise IdbException(f"No install response for {bundle_path}")
+            return artifact
+
+        try:
+            return await self.run(install_on_target)
+        finally:
+            await archive.close()
+
+    async def launch(
+        self,
+        bundle_id: str,
+        args: list[str] | None = None,
+        env: dict[str, str] | None = None,
+        foreground_if_running: bool = False,
+    ) -> list[TargetResult[None]]:
+        async def launch_on_target(client: Client) -> None:
+            await client.launch(
+                bundle_id=bundle_id,
+                args=args,
+                env=env,
+                foreground_if_running=foreground_if_running,
+            )
+
+        return await self.run(launch_on_target)
+
+    def run_xctest(
+        self,
+        tests: list[str],
+        test_bundle_id: str,
+        app_bundle_id: str,
+        test_host_app_bundle_id: str | None = None,
+        is_ui_test: bool = False,
+        is_logic_test: bool = False,
+        env: dict[str, str] | None = None,
+        args: list[str] | None = None,
+        timeout: int | None = None,
+        history: TestDurationHistory | None = None,
+        batch_seconds: float = DEFAULT_BATCH_SECONDS,
+    ) -> AsyncIterator[ShardResult]:
+        """
+        Runs the tests, named ClassName/methodName, sharded across every target.
+
+        The bundle must already be installed on each target. Shards are balanced
+        by the durations in history, which defaults to the bundle's durations
+        kept in idb's state directory. Every target runs at once, whatever the
+        group's parallelism. See XctestShardScheduler.
+        """
+
+        def run_batch(
+            client: Client, tests_to_run: set[str]
+        ) -> AsyncIterator[TestRunInfo]:
+            return client.run_xctest(
+                test_bundle_id=test_bundle_id,
+                app_bundle_id=app_bundle_id,
+                test_host_app_bundle_id=test_host_app_bundle_id,
+                is_ui_test=is_ui_test,
+                is_logic_test=is_logic_test,
+                tests_to_run=tests_to_run,
+                env=env,
+                args=args,
+                timeout=timeout,
+            )
+
+        scheduler = XctestShardScheduler(
+            manager=self._manager,
+            udids=self._udids,
+            history=(
+                history
+                if history is not None
+                else TestDurationHistory(bundle_id=test_bundle_id, logger=self._logger)
+            ),
+            batch_seconds=batch_seconds,
+            logger=self._logger,
+        )
+        return scheduler.run(tests, run_batch)
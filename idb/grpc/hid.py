@@ -41,6 +41,9 @@ GrpcHIDDirection = GrpcHIDEvent.HIDDirection
 GrpcHIDOrientation = GrpcHIDEvent.HIDOrientation
 GrpcHIDShake = GrpcHIDEvent.HIDShake
 GrpcHIDOrientationType = GrpcHIDEvent.HIDOrientationType
+GrpcHIDBatch = GrpcHIDEvent.HIDBatch
+GrpcHIDGestureDefinition = GrpcHIDEvent.HIDGestureDefinition
+GrpcHIDGesture = GrpcHIDEvent.HIDGesture
 _A = TypeVar("_A")
 _B = TypeVar("_B")
 
@@ -168,3 +171,34 @@ def event_to_grpc(event: HIDEvent) -> GrpcHIDEvent:
         return GrpcHIDEvent(shake=shake_to_grpc(event))
     else:
         raise Exception(f"Invalid event {event}")
+
+
+# Well within the companion's limit, so that a long string is still a handful of
+# messages rather than one very large one.
+MAX_EVENTS_PER_BATCH = 4096
+
+
+def events_to_grpc_batches(events: list[HIDEvent]) -> list[GrpcHIDEvent]:
+    return [
+        GrpcHIDEvent(
+            batch=GrpcHIDBatch(
+                events=[
+                    event_to_grpc(event)
+                    for event in events[start : start + MAX_EVENTS_PER_BATCH]
+                ]
+            )
+        )
+        for start in range(0, len(events), MAX_EVENTS_PER_BATCH)
+    ]
+
+
+def gesture_definition_to_grpc(name: str, events: list[HIDEvent]) -> GrpcHIDEvent:
+    return GrpcHIDEvent(
+        define_gesture=GrpcHIDGestureDefinition(
+            name=name, events=[event_to_grpc(event) for event in events]
+        )
+    )
+
+
+def gesture_to_grpc(name: str) -> GrpcHIDEvent:
+    return GrpcHIDEvent(gesture=GrpcHIDGesture(name=name))
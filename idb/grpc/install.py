@@ -6,7 +6,10 @@
 
 # pyre-strict
 
+import asyncio
+import hashlib
 import os
+import stat
 from collections.abc import AsyncIterator
 from logging import Logger
 from typing import IO, List, Optional, Union
@@ -26,6 +29,7 @@ CHUNK_SIZE = (
 )  # 4Mb, matching tar.py/gzip.py and well under the companion's 16Mb max receive size
 Destination = InstallRequest.Destination
 Bundle = Union[str, IO[bytes]]
+Manifest = InstallRequest.Manifest
 
 
 async def _generate_ipa_chunks(
@@ -87,6 +91,143 @@ async def _generate_framework_chunks(
     logger.debug(f"Finished generating chunks {path}")
 
 
+def _file_digest(path: str) -> str:
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        while True:
+            chunk = file.read(CHUNK_SIZE)
+            if not chunk:
+                return digest.hexdigest()
+            digest.update(chunk)
+
+
+def _build_manifest(app_path: str) -> tuple[Manifest, dict[str, str]]:
+    entries: list[Manifest.Entry] = []
+    digest_to_path: dict[str, str] = {}
+    parent = os.path.dirname(app_path)
+
+    def visit(path: str) -> None:
+        relative = os.path.relpath(path, parent)
+        info = os.lstat(path)
+        mode = stat.S_IMODE(info.st_mode)
+        if stat.S_ISLNK(info.st_mode):
+            entries.append(
+                Manifest.Entry(
+                    path=relative,
+                    kind=Manifest.Entry.SYMLINK,
+                    mode=mode,
+                    symlink_destination=os.readlink(path),
+                )
+            )
+        elif stat.S_ISDIR(info.st_mode):
+            entries.append(
+                Manifest.Entry(path=relative, kind=Manifest.Entry.DIRECTORY, mode=mode)
+            )
+            for name in sorted(os.listdir(path)):
+                visit(os.path.join(path, name))
+        elif stat.S_ISREG(info.st_mode):
+            digest = _file_digest(path)
+            digest_to_path.setdefault(digest, path)
+            entries.append(
+                Manifest.Entry(
+                    path=relative,
+                    kind=Manifest.Entry.FILE,
+                    digest=digest,
+                    mode=mode,
+                    size=info.st_size,
+                )
+            )
+
+    visit(app_path)
+    return (Manifest(entries=entries), digest_to_path)
+
+
+async def generate_app_manifest(
+    app_path: str, logger: Logger
+) -> tuple[Manifest, dict[str, str]]:
+    """
+    Describes every path in an .app by content, for a manifest install.
+    Returns the manifest, along with a path to read each distinct digest from.
+    """
+    logger.debug(f"Hashing contents of {app_path}")
+    result = await asyncio.get_running_loop().run_in_executor(
+        None, _build_manifest, app_path
+    )
+    logger.debug(f"Hashed {len(result[1])} distinct files in {app_path}")
+    return result
+
+
+def _bundle_tree_digest(bundle_path: str) -> str:
+    # Must match FBInstallArtifactCache.digest(ofTreeAt:) in the companion.
+    parent = os.path.dirname(bundle_path)
+    records: list[tuple[bytes, str]] = []
+
+    def visit(path: str) -> None:
+        relative = os.path.relpath(path, parent)
+        info = os.lstat(path)
+        if stat.S_ISLNK(info.st_mode):
+            records.append((relative.encode(), f"L\0{relative}\0{os.readlink(path)}\0"))
+        elif stat.S_ISDIR(info.st_mode):
+            records.append((relative.encode(), f"D\0{relative}\0\0"))
+            for name in os.listdir(path):
+                visit(os.path.join(path, name))
+        elif stat.S_ISREG(info.st_mode):
+            executable = "x" if info.st_mode & stat.S_IXUSR else ""
+            records.append(
+                (
+                    relative.encode(),
+                    f"F\0{relative}\0{_file_digest(path)}{executable}\0",
+                )
+            )
+
+    visit(bundle_path)
+    digest = hashlib.sha256()
+    for _, record in sorted(records):
+        digest.update(record.encode())
+    return digest.hexdigest()
+
+
+def supports_bundle_cache(path: str, destination: Destination) -> bool:
+    if not os.path.isdir(path):
+        return False
+    if destination == InstallRequest.APP:
+        return path.endswith(".app")
+    if destination == InstallRequest.XCTEST:
+        return path.endswith(".xctest")
+    return False
+
+
+async def bundle_tree_digest(bundle_path: str, logger: Logger) -> str:
+    """
+    Identifies a bundle by its contents, so that a companion can tell whether the
+    bundle is already in its host's install cache without it being uploaded.
+    """
+    logger.debug(f"Hashing contents of {bundle_path}")
+    digest = await asyncio.get_running_loop().run_in_executor(
+        None, _bundle_tree_digest, bundle_path
+    )
+    logger.debug(f"{bundle_path} has digest {digest}")
+    return digest
+
+
+async def generate_missing_content_chunks(
+    digests: list[str],
+    digest_to_path: dict[str, str],
+    compression: Compression,
+    logger: Logger,
+) -> AsyncIterator[InstallRequest]:
+    logger.debug(f"Generating chunks for {len(digests)} changed files")
+    async for chunk in tar.InProcessArchive(
+        paths=[digest_to_path[digest] for digest in digests],
+        arcnames=digests,
+        compression=compression,
+        place_in_subfolders=False,
+        verbose=False,
+    ).generate():
+        yield InstallRequest(payload=Payload(data=chunk))
+    logger.debug("Finished generating changed file chunks")
+
+
 async def generate_requests(
     requests: list[InstallRequest],
 ) -> AsyncIterator[InstallRequest]:
@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+from idb.common.types import LogFilter, LogFormat, OutputBatching
+from idb.grpc.idb_pb2 import (
+    LogFilter as GrpcLogFilter,
+    LogRequest,
+    OutputBatching as GrpcOutputBatching,
+)
+
+
+def output_batching_to_grpc(
+    batching: OutputBatching | None,
+) -> GrpcOutputBatching | None:
+    # Unset leaves the companion's defaults in place.
+    if batching is None:
+        return None
+    return GrpcOutputBatching(
+        max_bytes=batching.max_bytes,
+        max_latency_ms=batching.max_latency_ms,
+        max_buffered_bytes=batching.max_buffered_bytes,
+    )
+
+
+def log_filter_to_grpc(log_filter: LogFilter | None) -> GrpcLogFilter | None:
+    if log_filter is None:
+        return None
+    return GrpcLogFilter(
+        subsystems=log_filter.subsystems,
+        categories=log_filter.categories,
+        processes=log_filter.processes,
+        message_regex=log_filter.message_regex or "",
+    )
+
+
+def log_format_to_grpc(log_format: LogFormat) -> LogRequest.Format:
+    if log_format == LogFormat.NDJSON:
+        return LogRequest.NDJSON
+    return LogRequest.TEXT
@@ -11,12 +11,14 @@ import logging
 import os
 import signal
 from collections.abc import AsyncGenerator
+from contextlib import AbstractAsyncContextManager
 
 from idb.common.companion import Companion, CompanionServerConfig
 from idb.common.companion_set import CompanionSet
 from idb.common.constants import BASE_IDB_FILE_PATH
 from idb.common.logging import log_call
 from idb.common.types import (
+    Address,
     ClientManager as ClientManagerBase,
     CompanionInfo,
     ConnectionDestination,
@@ -27,6 +29,7 @@ from idb.common.types import (
     TargetType,
     TCPAddress,
 )
+from idb.grpc.channel_pool import ChannelPool
 from idb.grpc.client import Client
 from idb.grpc.target import merge_connected_targets
 from idb.utils.contextlib import asynccontextmanager
@@ -105,6 +108,7 @@ class ClientManager(ClientManagerBase):
         device_set_path: str | None = None,
         prune_dead_companion: bool = True,
         logger: logging.Logger | None = None,
+        channel_pool: ChannelPool | None = None,
     ) -> None:
         os.makedirs(BASE_IDB_FILE_PATH, exist_ok=True)
         self._logger: logging.Logger = (
@@ -121,6 +125,7 @@ class ClientManager(ClientManagerBase):
             else None
         )
         self._prune_dead_companion = prune_dead_companion
+        self._channel_pool = channel_pool
 
     async def _spawn_companion_server(self, udid: str) -> CompanionInfo:
         companion = self._companion
@@ -186,13 +191,17 @@ class ClientManager(ClientManagerBase):
             raise IdbException(
                 f"No udid provided and there are multiple companions to run against {companions.keys()}. Please specify a UDID unclear which target to run against"
             )
-        async with Client.build(
-            address=companion.address,
-            logger=self._logger,
-        ) as client:
+        async with self._client(address=companion.address) as client:
             self._logger.debug(f"Constructed client for companion {companion}")
             yield client
 
+    def _client(self, address: Address) -> AbstractAsyncContextManager[Client]:
+        # With a pool, a companion connected to while spawning is not connected
+        # to again for the client that follows.
+        if self._channel_pool is not None:
+            return self._channel_pool.client(address=address, logger=self._logger)
+        return Client.build(address=address, logger=self._logger)
+
     @log_call()
     async def list_targets(
         self, only: OnlyFilter | None = None
@@ -224,7 +233,7 @@ class ClientManager(ClientManagerBase):
         if isinstance(destination, TCPAddress) or isinstance(
             destination, DomainSocketAddress
         ):
-            async with Client.build(address=destination, logger=self._logger) as client:
+            async with self._client(address=destination) as client:
                 companion = client.companion
             self._logger.debug(f"Connected directly to {companion}")
             await self._companion_set.add_companion(companion)
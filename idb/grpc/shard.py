@@ -0,0 +1,329 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import heapq
+import json
+import logging
+import os
+import statistics
+import tempfile
+from collections import deque
+from collections.abc import AsyncIterator, Callable
+from dataclasses import dataclass
+
+from idb.common.constants import BASE_IDB_FILE_PATH
+from idb.common.types import IdbException, TestRunInfo
+from idb.grpc.client import Client
+from idb.grpc.management import ClientManager
+
+
+DEFAULT_DURATIONS_PATH: str = os.path.join(
+    BASE_IDB_FILE_PATH, "xctest_durations.json"
+)
+# The expected length of each xctest run a shard is split into. Shorter batches
+# balance better at the end of a run, longer ones pay the test host launch less.
+DEFAULT_BATCH_SECONDS: float = 30.0
+DEFAULT_MAX_ATTEMPTS: int = 2
+# What a test with no history is expected to take, when nothing in its bundle has.
+UNKNOWN_TEST_SECONDS: float = 1.0
+
+RunTests = Callable[[Client, set[str]], AsyncIterator[TestRunInfo]]
+
+
+def test_name(result: TestRunInfo) -> str:
+    """A result's test, named as in tests_to_run: ClassName/methodName."""
+    return f"{result.class_name}/{result.method_name}"
+
+
+class TestDurationHistory:
+    """
+    How long each test of a bundle took when it last ran, kept in a JSON file.
+
+    Recorded durations are smoothed with the earlier ones, so a single slow run
+    does not unbalance the next. Tests that have not run before are expected to
+    take the median of those that have.
+    """
+
+    def __init__(
+        self,
+        bundle_id: str,
+        path: str = DEFAULT_DURATIONS_PATH,
+        smoothing: float = 0.5,
+        logger: logging.Logger | None = None,
+    ) -> None:
+        self.bundle_id = bundle_id
+        self.path = path
+        self.smoothing = smoothing
+        self._logger: logging.Logger = (
+            logger if logger else logging.getLogger("idb_xctest_shard")
+        )
+        self._durations: dict[str, float] = self._read().get(bundle_id, {})
+        self._recorded: dict[str, float] = {}
+        self._unknown: float = (
+            statistics.median(self._durations.values())
+            if self._durations
+            else UNKNOWN_TEST_SECONDS
+        )
+
+    def _read(self) -> dict[str, dict[str, float]]:
+        try:
+            with open(self.path) as f:
+                data = json.load(f)
+        except FileNotFoundError:
+            return {}
+        except (OSError, ValueError) as e:
+            self._logger.warning(f"Ignoring unreadable durations in {self.path}: {e}")
+            return {}
+        return data if isinstance(data, dict) else {}
+
+    def expected(self, test: str) -> float:
+        return self._durations.get(test, self._unknown)
+
+    def record(self, test: str, duration: float) -> None:
+        # Kept apart until saved, so that expectations hold still during a run.
+        self._recorded[test] = duration
+
+    def save(self) -> None:
+        for test, duration in self._recorded.items():
+            previous = self._durations.get(test)
+            self._durations[test] = (
+                duration
+                if previous is None
+                else previous * self.smoothing + duration * (1 - self.smoothing)
+            )
+        self._recorded = {}
+        # Other bundles' durations are re-read, as another run may have saved them.
+        data = self._read()
+        data[self.bundle_id] = self._durations
+        directory = os.path.dirname(self.path) or "."
+        os.makedirs(directory, exist_ok=True)
+        with tempfile.NamedTemporaryFile(
+            "w", dir=directory, prefix=".xctest_durations-", delete=False
+        ) as f:
+            json.dump(data, f)
+        os.replace(f.name, self.path)
+
+
+@dataclass(frozen=True)
+class ShardResult:
+    udid: str
+    result: TestRunInfo
+
+
+class _Shard:
+    def __init__(self, udid: str) -> None:
+        self.udid = udid
+        self.tests: deque[str] = deque()
+        self.expected = 0.0
+        self.alive = True
+        self.running = False
+
+
+class XctestShardScheduler:
+    """
+    Runs a list of tests across several targets, as one stream of results.
+
+    Tests are dealt to each target's shard longest first, onto whichever shard
+    is expected to finish soonest, by their durations in the history. Each shard
+    is run as a sequence of xctest runs of about batch_seconds each, so that a
+    shard that finishes early can steal half of the remaining work of the shard
+    with the most left, rather than idling. The durations of this run are saved
+    to the history as it ends.
+
+    Tests left unreported by a run, because the run failed or the test host
+    crashed, are queued again up to max_attempts times. A target whose run fails
+    takes no more work, and its shard is left to the others to steal. Tests that
+    could not be run are raised as an IdbException once every result has been
+    yielded.
+    """
+
+    def __init__(
+        self,
+        manager: ClientManager,
+        udids: list[str],
+        history: TestDurationHistory | None = None,
+        batch_seconds: float = DEFAULT_BATCH_SECONDS,
+        max_attempts: int = DEFAULT_MAX_ATTEMPTS,
+        logger: logging.Logger | None = None,
+    ) -> None:
+        self._manager = manager
+        self._udids: list[str] = list(dict.fromkeys(udids))
+        if not self._udids:
+            raise IdbException("Sharding needs at least one target")
+        self._history = history
+        self._batch_seconds = batch_seconds
+        self._max_attempts: int = max(1, max_attempts)
+        self._logger: logging.Logger = (
+            logger if logger else logging.getLogger("idb_xctest_shard")
+        )
+        self._shards: dict[str, _Shard] = {}
+        self._attempts: dict[str, int] = {}
+        self._abandoned: list[str] = []
+        self._changed = asyncio.Condition()
+
+    def _expected(self, test: str) -> float:
+        history = self._history
+        if history is None:
+            return UNKNOWN_TEST_SECONDS
+        return history.expected(test)
+
+    def plan(self, tests: list[str]) -> dict[str, list[str]]:
+        """Deals the tests to a shard per target, longest first."""
+        self._shards = {udid: _Shard(udid) for udid in self._udids}
+        self._attempts = {}
+        self._abandoned = []
+        loads = [(0.0, index, udid) for index, udid in enumerate(self._udids)]
+        for test in sorted(
+            dict.fromkeys(tests), key=lambda test: (-self._expected(test), test)
+        ):
+            load, index, udid = heapq.heappop(loads)
+            self._push(self._shards[udid], test)
+            heapq.heappush(loads, (load + self._expected(test), index, udid))
+        return {udid: list(shard.tests) for udid, shard in self._shards.items()}
+
+    def _push(self, shard: _Shard, test: str) -> None:
+        shard.tests.append(test)
+        shard.expected += self._expected(test)
+
+    def _next_batch(self, shard: _Shard) -> list[str]:
+        if not shard.tests:
+            self._steal(shard)
+        batch = []
+        expected = 0.0
+        while shard.tests and (not batch or expected < self._batch_seconds):
+            test = shard.tests.popleft()
+            cost = self._expected(test)
+            shard.expected -= cost
+            expected += cost
+            batch.append(test)
+        return batch
+
+    def _steal(self, thief: _Shard) -> None:
+        victims = [
+            shard
+            for shard in self._shards.values()
+            if shard is not thief and shard.tests
+        ]
+        if not victims:
+            return
+        victim = max(victims, key=lambda shard: shard.expected)
+        # Everything, when its target can no longer run it.
+        target = victim.expected / 2 if victim.alive else victim.expected
+        stolen: list[str] = []
+        taken = 0.0
+        while victim.tests and (not stolen or taken < target):
+            test = victim.tests.pop()
+            cost = self._expected(test)
+            victim.expected -= cost
+            taken += cost
+            stolen.append(test)
+        self._logger.debug(f"{thief.udid} stole {len(stolen)} tests from {victim.udid}")
+        for test in reversed(stolen):
+            self._push(thief, test)
+
+    def _requeue(self, shard: _Shard, tests: list[str]) -> None:
+        for test in tests:
+            attempts = self._attempts.get(test, 0) + 1
+            self._attempts[test] = attempts
+            if attempts >= self._max_attempts:
+                self._abandoned.append(test)
+            else:
+                self._push(shard, test)
+
+    async def _run_batch(
+        self,
+        shard: _Shard,
+        client: Client,
+        batch: list[str],
+        run: RunTests,
+        results: "asyncio.Queue[ShardResult | None]",
+    ) -> None:
+        unreported = set(batch)
+        shard.running = True
+        try:
+            async for result in run(client, set(batch)):
+                name = test_name(result)
+                unreported.discard(name)
+                if self._history is not None:
+                    self._history.record(name, result.duration)
+                await results.put(ShardResult(udid=shard.udid, result=result))
+        finally:
+            shard.running = False
+            if unreported:
+                self._logger.info(
+                    f"{len(unreported)} tests were not reported on {shard.udid}"
+                )
+                self._requeue(shard, [test for test in batch if test in unreported])
+
+    async def _notify(self) -> None:
+        async with self._changed:
+            self._changed.notify_all()
+
+    async def _run_shard(
+        self,
+        shard: _Shard,
+        run: RunTests,
+        results: "asyncio.Queue[ShardResult | None]",
+    ) -> None:
+        try:
+            async with self._manager.from_udid(udid=shard.udid) as client:
+                while True:
+                    batch = self._next_batch(shard)
+                    if batch:
+                        try:
+                            await self._run_batch(shard, client, batch, run, results)
+                        finally:
+                            await self._notify()
+                        continue
+                    # A running batch may yet leave tests to be run again.
+                    if not any(other.running for other in self._shards.values()):
+                        return
+                    async with self._changed:
+                        await self._changed.wait()
+        except Exception as e:
+            self._logger.info(f"Shard on {shard.udid} stopped: {e}")
+        finally:
+            shard.alive = False
+            await self._notify()
+
+    async def run(self, tests: list[str], run: RunTests) -> AsyncIterator[ShardResult]:
+        """
+        Runs the tests, calling run with a target's client and a batch of its
+        tests for each xctest run, and yields each result as it arrives.
+        """
+        self.plan(tests)
+        results: asyncio.Queue[ShardResult | None] = asyncio.Queue()
+        tasks = [
+            asyncio.ensure_future(self._run_shard(shard, run, results))
+            for shard in self._shards.values()
+        ]
+
+        async def finish() -> None:
+            await asyncio.gather(*tasks)
+            await results.put(None)
+
+        finisher = asyncio.ensure_future(finish())
+        try:
+            while (result := await results.get()) is not None:
+                yield result
+        finally:
+            finisher.cancel()
+            for task in tasks:
+                task.cancel()
+            await asyncio.gather(finisher, *tasks, return_exceptions=True)
+            if self._history is not None:
+                self._history.save()
+        unrun = self._abandoned + [
+            test for shard in self._shards.values() for test in shard.tests
+        ]
+        if unrun:
+            raise IdbException(
+                f"{len(unrun)} tests could not be run on {self._udids}: "
+                + ", ".join(sorted(unrun)[:10])
+            )
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import copy
+import json
+from types import SimpleNamespace
+from typing import Any
+from unittest.mock import AsyncMock, MagicMock
+
+from idb.common.types import AccessibilityInfoOptions
+from idb.grpc.accessibility import AccessibilityTree, apply_accessibility_diff
+from idb.grpc.client import Client
+from idb.utils.testing import TestCase
+
+
+def _element(
+    label: str,
+    y: float,
+    type: str = "Button",
+    children: AccessibilityTree | None = None,
+) -> dict[str, Any]:
+    element: dict[str, Any] = {
+        "AXLabel": label,
+        "type": type,
+        "frame": {"x": 0.0, "y": y, "width": 100.0, "height": 40.0},
+    }
+    if children is not None:
+        element["children"] = children
+    return element
+
+
+BASE: AccessibilityTree = [
+    _element(
+        "App",
+        0,
+        type="Application",
+        children=[
+            _element("Title", 50, type="StaticText"),
+            _element("Login", 100),
+            _element("Cancel", 150),
+        ],
+    )
+]
+
+
+class AccessibilityDiffTests(TestCase):
+    def test_changed_attributes(self) -> None:
+        tree = apply_accessibility_diff(
+            copy.deepcopy(BASE),
+            {
+                "changed": [
+                    {"node": 2, "set": {"AXLabel": "Log out"}, "unset": []},
+                    {"node": 3, "set": {"children": []}, "unset": ["type"]},
+                ],
+                "removed": [],
+                "inserted": [],
+            },
+        )
+        login = tree[0]["children"][1]
+        cancel = tree[0]["children"][2]
+        self.assertEqual(login["AXLabel"], "Log out")
+        self.assertNotIn("type", cancel)
+        self.assertEqual(cancel["children"], [])
+
+    def test_removed_and_inserted_elements(self) -> None:
+        alert = _element("Alert", 300, type="Alert", children=[_element("OK", 320)])
+        # The companion's diff for moving Title behind Cancel, dropping Login
+        # and presenting an alert.
+        tree = apply_accessibility_diff(
+            copy.deepcopy(BASE),
+            {
+                "changed": [],
+                "removed": [1, 2],
+                "inserted": [
+                    {"parent": 0, "index": 2, "node": alert},
+                    {"parent": 0, "index": 1, "node": BASE[0]["children"][0]},
+                ],
+            },
+        )
+        self.assertEqual(
+            [child["AXLabel"] for child in tree[0]["children"]],
+            ["Cancel", "Title", "Alert"],
+        )
+        self.assertEqual(tree[0]["children"][2]["children"][0]["AXLabel"], "OK")
+
+    def test_inserted_roots(self) -> None:
+        keyboard = _element("Keyboard", 400, type="Keyboard")
+        tree = apply_accessibility_diff(
+            copy.deepcopy(BASE),
+            {
+                "changed": [],
+                "removed": [],
+                "inserted": [{"parent": -1, "index": 1, "node": keyboard}],
+            },
+        )
+        self.assertEqual([root["AXLabel"] for root in tree], ["App", "Keyboard"])
+
+
+class IncrementalAccessibilityInfoTests(TestCase):
+    async def test_client_reassembles_tree_from_diff(self) -> None:
+        stub = MagicMock()
+        stub.accessibility_info = AsyncMock(
+            side_effect=[
+                SimpleNamespace(json=json.dumps(BASE), version=7, diff=""),
+                SimpleNamespace(
+                    json="",
+                    version=9,
+                    base_version=7,
+                    diff=json.dumps(
+                        {
+                            "changed": [
+                                {
+                                    "node": 2,
+                                    "set": {"AXLabel": "Log out"},
+                                    "unset": [],
+                                }
+                            ],
+                            "removed": [],
+                            "inserted": [],
+                        }
+                    ),
+                ),
+            ]
+        )
+        client = Client(stub=stub, companion=MagicMock(), logger=MagicMock())
+        options = AccessibilityInfoOptions(incremental=True)
+
+        first = await client.accessibility_info(target=None, options=options)
+        self.assertEqual(json.loads(first.json), BASE)
+        second = await client.accessibility_info(target=None, options=options)
+        expected = copy.deepcopy(BASE)
+        expected[0]["children"][1]["AXLabel"] = "Log out"
+        self.assertEqual(json.loads(second.json), expected)
+
+        requests = [call.args[0] for call in stub.accessibility_info.call_args_list]
+        self.assertEqual(requests[0].snapshot_session, requests[1].snapshot_session)
+        self.assertEqual(requests[1].base_version, 7)
+
+    async def test_client_rereads_whole_tree_when_diff_base_does_not_match(
+        self,
+    ) -> None:
+        stub = MagicMock()
+        stub.accessibility_info = AsyncMock(
+            side_effect=[
+                SimpleNamespace(json=json.dumps(BASE), version=7, diff=""),
+                SimpleNamespace(
+                    json="",
+                    version=9,
+                    base_version=8,
+                    diff=json.dumps({"changed": [], "removed": [], "inserted": []}),
+                ),
+                SimpleNamespace(json=json.dumps(BASE), version=10, diff=""),
+            ]
+        )
+        client = Client(stub=stub, companion=MagicMock(), logger=MagicMock())
+        options = AccessibilityInfoOptions(incremental=True)
+
+        await client.accessibility_info(target=None, options=options)
+        second = await client.accessibility_info(target=None, options=options)
+        self.assertEqual(json.loads(second.json), BASE)
+        self.assertEqual(client._accessibility_snapshot, (10, BASE))
+
+        requests = [call.args[0] for call in stub.accessibility_info.call_args_list]
+        self.assertEqual(len(requests), 3)
+        self.assertEqual(requests[2].base_version, 0)
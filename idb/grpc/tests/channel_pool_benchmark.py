@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Compares per-command latency with and without a ChannelPool against a running
+companion.
+
+    python -m idb.grpc.tests.channel_pool_benchmark ADDRESS [--commands N]
+
+ADDRESS is a companion's host:port or unix domain socket path, as for --companion.
+Each command builds a Client and makes one describe call, which is what a short
+command such as `idb describe` or `idb ui tap` costs. It reports p50/p99/max in
+milliseconds for both.
+"""
+
+import argparse
+import asyncio
+import logging
+import statistics
+import time
+from collections.abc import Callable
+from contextlib import AbstractAsyncContextManager
+
+from idb.common.types import Address, DomainSocketAddress, TCPAddress
+from idb.grpc.channel_pool import ChannelPool
+from idb.grpc.client import Client
+
+
+LOGGER: logging.Logger = logging.getLogger("channel_pool_benchmark")
+
+
+def _parse_address(value: str) -> Address:
+    values = value.rsplit(":", 1)
+    if len(values) == 1:
+        return DomainSocketAddress(path=value)
+    (host, port) = values
+    return TCPAddress(host=host, port=int(port))
+
+
+async def _run(
+    label: str,
+    commands: int,
+    build: Callable[[], AbstractAsyncContextManager[Client]],
+) -> None:
+    latencies: list[float] = []
+    for _ in range(commands):
+        start = time.monotonic()
+        async with build() as client:
+            await client.describe()
+        latencies.append((time.monotonic() - start) * 1000)
+    percentiles = statistics.quantiles(latencies, n=100)
+    print(
+        f"{label:<8} p50 {percentiles[49]:7.2f}ms  p99 {percentiles[98]:7.2f}ms  "
+        f"max {max(latencies):7.2f}ms  over {commands} commands"
+    )
+
+
+async def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("address")
+    parser.add_argument("--commands", type=int, default=1000)
+    args = parser.parse_args()
+    address = _parse_address(args.address)
+
+    await _run(
+        "fresh",
+        args.commands,
+        lambda: Client.build(address=address, logger=LOGGER),
+    )
+    pool = ChannelPool()
+    try:
+        await _run(
+            "pooled",
+            args.commands,
+            lambda: pool.client(address=address, logger=LOGGER),
+        )
+    finally:
+        pool.close()
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
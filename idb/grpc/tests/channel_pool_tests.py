@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import logging
+from unittest.mock import MagicMock, patch
+
+from grpclib.exceptions import StreamTerminatedError
+from idb.common.types import (
+    CompanionInfo,
+    DomainSocketAddress,
+    IdbConnectionException,
+    IdbException,
+)
+from idb.grpc.channel_pool import ChannelPool
+from idb.grpc.client import Client
+from idb.utils.testing import TestCase
+
+
+LOGGER: logging.Logger = logging.getLogger("channel_pool_tests")
+ADDRESS = DomainSocketAddress(path="/tmp/companion.sock")
+OTHER_ADDRESS = DomainSocketAddress(path="/tmp/other.sock")
+
+
+class ChannelPoolTest(TestCase):
+    def setUp(self) -> None:
+        self.channels: list[MagicMock] = []
+        self.handshakes = 0
+
+        def open_channel(address: object, use_tls: bool = False) -> MagicMock:
+            channel = MagicMock(name=f"channel_{len(self.channels)}")
+            self.channels.append(channel)
+            return channel
+
+        async def handshake(address: object, **_kwargs: object) -> CompanionInfo:
+            self.handshakes += 1
+            await asyncio.sleep(0.01)
+            return CompanionInfo(
+                udid="udid", is_local=True, pid=None, address=ADDRESS, metadata={}
+            )
+
+        patches = [
+            patch.object(Client, "open_channel", side_effect=open_channel),
+            patch.object(Client, "handshake", side_effect=handshake),
+            patch.object(Client, "metadata_to_companion", return_value={}),
+            patch.object(Client, "append_companion_metadata"),
+            patch("idb.grpc.channel_pool.CompanionServiceStub"),
+        ]
+        for p in patches:
+            p.start()
+            self.addCleanup(p.stop)
+
+    async def test_reuses_channel_and_handshake(self) -> None:
+        pool = ChannelPool()
+        for _ in range(5):
+            async with pool.client(address=ADDRESS, logger=LOGGER) as client:
+                self.assertTrue(client.is_local)
+        self.assertEqual(len(self.channels), 1)
+        self.assertEqual(self.handshakes, 1)
+        self.assertEqual(pool.connects, 1)
+        self.assertEqual(pool.reuses, 4)
+        self.channels[0].close.assert_not_called()
+        pool.close()
+        self.channels[0].close.assert_called_once()
+
+    async def test_concurrent_clients_share_one_handshake(self) -> None:
+        pool = ChannelPool()
+
+        async def use() -> None:
+            async with pool.client(address=ADDRESS, logger=LOGGER):
+                await asyncio.sleep(0.01)
+
+        await asyncio.gather(*(use() for _ in range(10)))
+        self.assertEqual(self.handshakes, 1)
+        self.assertEqual(len(self.channels), 1)
+
+    async def test_channels_are_per_address(self) -> None:
+        pool = ChannelPool()
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        async with pool.client(address=OTHER_ADDRESS, logger=LOGGER):
+            pass
+        self.assertEqual(len(self.channels), 2)
+
+    async def test_connection_error_drops_channel_once_released(self) -> None:
+        pool = ChannelPool()
+        with self.assertRaises(IdbException):
+            async with pool.client(address=ADDRESS, logger=LOGGER):
+                try:
+                    raise StreamTerminatedError("Connection lost")
+                except StreamTerminatedError as e:
+                    raise IdbException("call failed") from e
+        self.channels[0].close.assert_called_once()
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        self.assertEqual(len(self.channels), 2)
+        self.assertEqual(self.handshakes, 2)
+
+    async def test_other_errors_keep_channel(self) -> None:
+        pool = ChannelPool()
+        with self.assertRaises(IdbException):
+            async with pool.client(address=ADDRESS, logger=LOGGER):
+                raise IdbException("app not installed")
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        self.assertEqual(len(self.channels), 1)
+        self.channels[0].close.assert_not_called()
+
+    async def test_failed_handshake_is_not_pooled(self) -> None:
+        pool = ChannelPool()
+        with patch.object(
+            Client, "handshake", side_effect=IdbConnectionException("refused")
+        ):
+            with self.assertRaises(IdbConnectionException):
+                async with pool.client(address=ADDRESS, logger=LOGGER):
+                    pass
+        self.channels[0].close.assert_called_once()
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        self.assertEqual(len(self.channels), 2)
+
+    async def test_locks_are_dropped_with_their_channels(self) -> None:
+        pool = ChannelPool(idle_timeout=0)
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        self.assertEqual(len(pool._locks), 1)
+        await asyncio.sleep(0.001)
+        # Acquiring any channel closes the idle ones, and their locks go with them.
+        async with pool.client(address=OTHER_ADDRESS, logger=LOGGER):
+            self.assertEqual(len(pool._locks), 1)
+        with patch.object(
+            Client, "handshake", side_effect=IdbConnectionException("refused")
+        ):
+            with self.assertRaises(IdbConnectionException):
+                async with pool.client(address=ADDRESS, logger=LOGGER):
+                    pass
+        pool.close()
+        self.assertEqual(pool._locks, {})
+
+    async def test_idle_and_stale_channels_are_replaced(self) -> None:
+        pool = ChannelPool(idle_timeout=0)
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        await asyncio.sleep(0.001)
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            pass
+        self.channels[0].close.assert_called_once()
+
+        pool = ChannelPool(handshake_max_age=0)
+        async with pool.client(address=ADDRESS, logger=LOGGER):
+            await asyncio.sleep(0.001)
+            # A channel in use is only closed once it is released.
+            async with pool.client(address=ADDRESS, logger=LOGGER):
+                self.channels[2].close.assert_not_called()
+        self.channels[2].close.assert_called_once()
+        self.assertEqual(self.handshakes, 4)
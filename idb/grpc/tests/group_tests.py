@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+from collections.abc import AsyncIterator
+from contextlib import asynccontextmanager
+from unittest.mock import patch
+
+from idb.common.types import IdbException, InstalledArtifact
+from idb.grpc import group
+from idb.grpc.group import ClientGroup, SpooledArchive
+from idb.utils.testing import TestCase
+
+
+async def _chunks(chunks: list[bytes], delay: float = 0) -> AsyncIterator[bytes]:
+    for chunk in chunks:
+        await asyncio.sleep(delay)
+        yield chunk
+
+
+async def _failing_chunks() -> AsyncIterator[bytes]:
+    yield b"partial"
+    raise OSError("disk on fire")
+
+
+class FakeClient:
+    def __init__(self, udid: str, fail: bool = False) -> None:
+        self.udid = udid
+        self.fail = fail
+        self.received = b""
+
+    async def install_archive(
+        self, bundle_path: str, archive: AsyncIterator[bytes], **_kwargs: object
+    ) -> AsyncIterator[InstalledArtifact]:
+        async for chunk in archive:
+            self.received += chunk
+        if self.fail:
+            raise IdbException(f"install failed on {self.udid}")
+        yield InstalledArtifact(name="com.foo.bar", uuid=self.udid, progress=None)
+
+
+class FakeManager:
+    def __init__(self, failing: frozenset[str] = frozenset()) -> None:
+        self.failing = failing
+        self.clients: dict[str, FakeClient] = {}
+        self.active = 0
+        self.max_active = 0
+
+    @asynccontextmanager
+    async def from_udid(self, udid: str | None) -> AsyncIterator[FakeClient]:
+        if udid == "unreachable":
+            raise IdbException("no companion for unreachable")
+        self.active += 1
+        self.max_active = max(self.max_active, self.active)
+        try:
+            # Give every other target a chance to connect.
+            await asyncio.sleep(0.01)
+            client = FakeClient(udid=str(udid), fail=udid in self.failing)
+            self.clients[str(udid)] = client
+            yield client
+        finally:
+            self.active -= 1
+
+
+class SpooledArchiveTest(TestCase):
+    async def test_readers_see_every_chunk_once_generated(self) -> None:
+        generated = 0
+
+        async def source() -> AsyncIterator[bytes]:
+            nonlocal generated
+            for chunk in [b"a" * 10, b"b" * 20, b"c" * 30]:
+                generated += 1
+                await asyncio.sleep(0.001)
+                yield chunk
+
+        archive = SpooledArchive(source())
+        try:
+
+            async def read() -> bytes:
+                return b"".join([chunk async for chunk in archive.chunks()])
+
+            concurrent = await asyncio.gather(read(), read(), read())
+            # A reader that starts after generation has finished replays the spool.
+            late = await read()
+        finally:
+            await archive.close()
+        expected = b"a" * 10 + b"b" * 20 + b"c" * 30
+        self.assertEqual(concurrent, [expected, expected, expected])
+        self.assertEqual(late, expected)
+        self.assertEqual(generated, 3)
+
+    async def test_generation_failure_fails_readers(self) -> None:
+        archive = SpooledArchive(_failing_chunks())
+        try:
+            with self.assertRaises(IdbException):
+                async for _ in archive.chunks():
+                    pass
+        finally:
+            await archive.close()
+
+
+class ClientGroupTest(TestCase):
+    async def test_install_generates_archive_once(self) -> None:
+        manager = FakeManager()
+        sources = []
+
+        def archive_source(**_kwargs: object) -> AsyncIterator[bytes]:
+            source = _chunks([b"x" * 100, b"y" * 100], delay=0.001)
+            sources.append(source)
+            return source
+
+        with patch.object(group, "_archive_source", side_effect=archive_source):
+            results = await ClientGroup(
+                manager=manager,  # pyre-ignore
+                udids=["A", "B", "C"],
+            ).install(bundle_path="/tmp/Foo.app")
+        self.assertEqual(len(sources), 1)
+        self.assertEqual([result.udid for result in results], ["A", "B", "C"])
+        self.assertTrue(all(result.succeeded for result in results))
+        self.assertEqual(
+            [result.value.uuid for result in results if result.value], ["A", "B", "C"]
+        )
+        for client in manager.clients.values():
+            self.assertEqual(client.received, b"x" * 100 + b"y" * 100)
+
+    async def test_failures_are_reported_per_target(self) -> None:
+        manager = FakeManager(failing=frozenset(["B"]))
+        with patch.object(
+            group, "_archive_source", side_effect=lambda **_: _chunks([b"x"])
+        ):
+            results = await ClientGroup(
+                manager=manager,  # pyre-ignore
+                udids=["A", "B", "unreachable"],
+            ).install(bundle_path="/tmp/Foo.app")
+        self.assertEqual(
+            [result.succeeded for result in results], [True, False, False]
+        )
+        self.assertIn("install failed on B", str(results[1].error))
+        self.assertIn("no companion", str(results[2].error))
+
+    async def test_parallelism_is_bounded(self) -> None:
+        manager = FakeManager()
+        udids = [f"target-{i}" for i in range(10)]
+        results = await ClientGroup(
+            manager=manager,  # pyre-ignore
+            udids=udids + udids[:2],
+            parallelism=3,
+        ).run(lambda client: asyncio.sleep(0.01, result=client.udid))
+        # Duplicate udids are only run against once.
+        self.assertEqual([result.value for result in results], udids)
+        self.assertEqual(manager.max_active, 3)
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Compares gesture latency with HID events streamed one at a time against the
+same events sent as batches, against a running companion with a booted
+simulator.
+
+    python -m idb.grpc.tests.hid_benchmark ADDRESS [--runs N] [--text-length N]
+
+ADDRESS is a companion's host:port or unix domain socket path, as for --companion.
+The gestures are what `idb ui text`, `idb ui swipe` and `idb ui pinch` send: a
+string of mixed case text, a run of swipes made of many timed touches, and a
+pair of two finger pinches. It reports p50/p99/max in milliseconds for each
+gesture, sent each way. Focus a text field first so that the typed text has
+somewhere to go.
+"""
+
+import argparse
+import asyncio
+import logging
+import statistics
+import string
+import time
+from collections.abc import Awaitable, Callable
+
+from idb.common.hid import (
+    iterator_to_async_iterator,
+    pinch_to_events,
+    swipe_to_events,
+    text_to_events,
+)
+from idb.common.types import Address, DomainSocketAddress, HIDEvent, TCPAddress
+from idb.grpc.client import Client
+
+
+LOGGER: logging.Logger = logging.getLogger("hid_benchmark")
+
+
+def _parse_address(value: str) -> Address:
+    values = value.rsplit(":", 1)
+    if len(values) == 1:
+        return DomainSocketAddress(path=value)
+    (host, port) = values
+    return TCPAddress(host=host, port=int(port))
+
+
+def _text(length: int) -> str:
+    alphabet = string.ascii_letters + string.digits + " "
+    return "".join(alphabet[i % len(alphabet)] for i in range(length))
+
+
+def _swipes() -> list[HIDEvent]:
+    events: list[HIDEvent] = []
+    for i in range(5):
+        x = 100 + i * 20
+        events.extend(swipe_to_events((x, 600), (x, 200), duration=0.1, delta=5))
+    return events
+
+
+async def _run(
+    label: str,
+    runs: int,
+    gestures: dict[str, list[HIDEvent]],
+    send: Callable[[list[HIDEvent]], Awaitable[None]],
+) -> None:
+    for name, events in gestures.items():
+        latencies: list[float] = []
+        for _ in range(runs):
+            start = time.monotonic()
+            await send(events)
+            latencies.append((time.monotonic() - start) * 1000)
+        percentiles = statistics.quantiles(latencies, n=100)
+        print(
+            f"{label:<9} {name:<7} p50 {percentiles[49]:8.2f}ms  "
+            f"p99 {percentiles[98]:8.2f}ms  max {max(latencies):8.2f}ms  "
+            f"over {runs} runs of {len(events)} events"
+        )
+
+
+async def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("address")
+    parser.add_argument("--runs", type=int, default=20)
+    parser.add_argument("--text-length", type=int, default=200)
+    args = parser.parse_args()
+    gestures = {
+        "text": text_to_events(_text(args.text_length)),
+        "swipes": _swipes(),
+        "pinches": [
+            *pinch_to_events(200, 400, scale=2.0, duration=0.2),
+            *pinch_to_events(200, 400, scale=0.5, duration=0.2),
+        ],
+    }
+
+    async with Client.build(
+        address=_parse_address(args.address), logger=LOGGER
+    ) as client:
+        await _run(
+            "streamed",
+            args.runs,
+            gestures,
+            lambda events: client.hid(iterator_to_async_iterator(events)),
+        )
+        await _run("batched", args.runs, gestures, client.send_events)
+
+
+if __name__ == "__main__":
+    asyncio.run(main())
@@ -6,8 +6,15 @@
 
 # pyre-strict
 
+from unittest.mock import AsyncMock, MagicMock
+
+from grpclib.const import Status
+from grpclib.exceptions import GRPCError
+from idb.grpc.client import Client
 from idb.grpc.hid import (
     event_to_grpc,
+    events_to_grpc_batches,
+    GrpcHIDBatch,
     GrpcHIDButton,
     GrpcHIDDelay,
     GrpcHIDEvent,
@@ -25,6 +32,7 @@ from idb.grpc.hid import (
     HIDPress,
     HIDSwipe,
     HIDTouch,
+    MAX_EVENTS_PER_BATCH,
     Point,
 )
 from idb.utils.testing import TestCase
@@ -78,3 +86,95 @@ class HidTests(TestCase):
             event_to_grpc(HIDDelay(duration=1)),
             GrpcHIDEvent(delay=GrpcHIDDelay(duration=1)),
         )
+
+    def test_batches(self) -> None:
+        events = [HIDDelay(duration=i) for i in range(MAX_EVENTS_PER_BATCH + 1)]
+        batches = events_to_grpc_batches(events)
+        self.assertEqual(
+            batches,
+            [
+                GrpcHIDEvent(
+                    batch=GrpcHIDBatch(
+                        events=[event_to_grpc(e) for e in events[:-1]]
+                    )
+                ),
+                GrpcHIDEvent(batch=GrpcHIDBatch(events=[event_to_grpc(events[-1])])),
+            ],
+        )
+        self.assertEqual(events_to_grpc_batches([]), [])
+
+
+class SendEventsTests(TestCase):
+    def _client(self) -> Client:
+        client = Client(stub=MagicMock(), companion=MagicMock(), logger=MagicMock())
+        client._send_grpc_events = AsyncMock()
+        client.hid = AsyncMock()
+        return client
+
+    async def test_sends_gesture_as_batch(self) -> None:
+        client = self._client()
+        await client.send_events([HIDDelay(duration=1), HIDDelay(duration=2)])
+        client._send_grpc_events.assert_called_once()
+        client.hid.assert_not_called()
+
+    async def test_falls_back_to_single_events(self) -> None:
+        client = self._client()
+        client._send_grpc_events.side_effect = GRPCError(
+            Status.INVALID_ARGUMENT, "Unrecognized request.event"
+        )
+        await client.send_events([HIDDelay(duration=1)])
+        await client.send_events([HIDDelay(duration=2)])
+        # The companion is only asked to take a batch once.
+        client._send_grpc_events.assert_called_once()
+        self.assertEqual(client.hid.call_count, 2)
+
+    async def test_does_not_fall_back_for_invalid_events(self) -> None:
+        client = self._client()
+        client._send_grpc_events.side_effect = GRPCError(
+            Status.INVALID_ARGUMENT, "Event 0 of batch: Invalid delay duration -1.0"
+        )
+        with self.assertRaises(Exception):
+            await client.send_events([HIDDelay(duration=-1)])
+        client.hid.assert_not_called()
+
+    async def test_performs_defined_gesture_by_name(self) -> None:
+        client = self._client()
+        await client.define_gesture("tap", [HIDDelay(duration=1)])
+        await client.perform_gesture("tap")
+        await client.perform_gesture("tap")
+        self.assertEqual(client._send_grpc_events.call_count, 3)
+
+    async def test_redefines_gesture_the_companion_no_longer_has(self) -> None:
+        client = self._client()
+        client._send_grpc_events.side_effect = [
+            None,
+            GRPCError(Status.NOT_FOUND, "No gesture named 'tap' is defined"),
+            None,
+        ]
+        await client.define_gesture("tap", [HIDDelay(duration=1)])
+        await client.perform_gesture("tap")
+        self.assertEqual(client._send_grpc_events.call_count, 3)
+
+    async def test_unknown_gesture_fails(self) -> None:
+        client = self._client()
+        client._send_grpc_events.side_effect = GRPCError(
+            Status.NOT_FOUND, "No gesture named 'tap' is defined"
+        )
+        with self.assertRaises(Exception):
+            await client.perform_gesture("tap")
+
+    async def test_sends_gesture_events_when_companion_does_not_keep_them(
+        self,
+    ) -> None:
+        client = self._client()
+        client._send_grpc_events.side_effect = [
+            GRPCError(Status.INVALID_ARGUMENT, "Unrecognized request.event"),
+            None,
+            None,
+        ]
+        await client.define_gesture("tap", [HIDDelay(duration=1)])
+        await client.perform_gesture("tap")
+        await client.perform_gesture("tap")
+        # Each performance is sent as a batch of the gesture's events.
+        self.assertEqual(client._send_grpc_events.call_count, 3)
+        client.hid.assert_not_called()
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import hashlib
+import io
+import logging
+import os
+import tarfile
+import tempfile
+
+from idb.common.types import Compression
+from idb.grpc.idb_pb2 import InstallRequest
+from idb.grpc.install import (
+    bundle_tree_digest,
+    generate_app_manifest,
+    generate_missing_content_chunks,
+    Manifest,
+    supports_bundle_cache,
+)
+from idb.utils.testing import TestCase
+
+
+class InstallManifestTests(TestCase):
+    async def test_manifest_describes_bundle(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            app = os.path.join(root, "Foo.app")
+            os.makedirs(os.path.join(app, "Frameworks"))
+            with open(os.path.join(app, "Foo"), "wb") as f:
+                f.write(b"binary")
+            with open(os.path.join(app, "Frameworks", "Copy"), "wb") as f:
+                f.write(b"binary")
+            os.symlink("Foo", os.path.join(app, "Link"))
+
+            manifest, digest_to_path = await generate_app_manifest(
+                app_path=app, logger=logging.getLogger()
+            )
+
+            entries = {entry.path: entry for entry in manifest.entries}
+            self.assertEqual(
+                set(entries),
+                {
+                    "Foo.app",
+                    "Foo.app/Foo",
+                    "Foo.app/Frameworks",
+                    "Foo.app/Frameworks/Copy",
+                    "Foo.app/Link",
+                },
+            )
+            self.assertEqual(entries["Foo.app"].kind, Manifest.Entry.DIRECTORY)
+            self.assertEqual(entries["Foo.app/Link"].kind, Manifest.Entry.SYMLINK)
+            self.assertEqual(entries["Foo.app/Link"].symlink_destination, "Foo")
+            digest = hashlib.sha256(b"binary").hexdigest()
+            self.assertEqual(entries["Foo.app/Foo"].digest, digest)
+            self.assertEqual(entries["Foo.app/Frameworks/Copy"].digest, digest)
+            # Identical files are uploaded once
+            self.assertEqual(list(digest_to_path), [digest])
+
+    async def test_missing_content_is_named_by_digest(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            app = os.path.join(root, "Foo.app")
+            os.makedirs(app)
+            for name in ["A", "B"]:
+                with open(os.path.join(app, name), "wb") as f:
+                    f.write(name.encode())
+            _, digest_to_path = await generate_app_manifest(
+                app_path=app, logger=logging.getLogger()
+            )
+            missing = [hashlib.sha256(b"B").hexdigest()]
+
+            data = b"".join(
+                [
+                    request.payload.data
+                    async for request in generate_missing_content_chunks(
+                        digests=missing,
+                        digest_to_path=digest_to_path,
+                        compression=Compression.GZIP,
+                        logger=logging.getLogger(),
+                    )
+                ]
+            )
+
+            with tarfile.open(fileobj=io.BytesIO(data), mode="r:gz") as archive:
+                self.assertEqual(archive.getnames(), missing)
+
+
+class BundleDigestTests(TestCase):
+    def _make_app(self, root: str) -> str:
+        app = os.path.join(root, "Foo.app")
+        os.makedirs(os.path.join(app, "Frameworks"))
+        with open(os.path.join(app, "Foo"), "wb") as f:
+            f.write(b"binary")
+        os.chmod(os.path.join(app, "Foo"), 0o755)
+        with open(os.path.join(app, "Info.plist"), "wb") as f:
+            f.write(b"plist")
+        os.chmod(os.path.join(app, "Info.plist"), 0o644)
+        os.symlink("Foo", os.path.join(app, "Link"))
+        return app
+
+    async def test_digest_matches_companion(self) -> None:
+        # The same tree is hashed by FBInstallArtifactCacheTests in the companion.
+        with tempfile.TemporaryDirectory() as root:
+            digest = await bundle_tree_digest(
+                self._make_app(root), logger=logging.getLogger()
+            )
+            self.assertEqual(
+                digest,
+                "539f3041599a7e8ce8735be03b3b86b27bddc05300d00faa2fc3a83dc0ccf61f",
+            )
+
+    async def test_digest_does_not_depend_on_location(self) -> None:
+        with tempfile.TemporaryDirectory() as first:
+            with tempfile.TemporaryDirectory() as second:
+                self.assertEqual(
+                    await bundle_tree_digest(
+                        self._make_app(first), logger=logging.getLogger()
+                    ),
+                    await bundle_tree_digest(
+                        self._make_app(os.path.join(second, "nested")),
+                        logger=logging.getLogger(),
+                    ),
+                )
+
+    async def test_digest_changes_with_contents_and_modes(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            app = self._make_app(root)
+            original = await bundle_tree_digest(app, logger=logging.getLogger())
+            os.chmod(os.path.join(app, "Info.plist"), 0o755)
+            executable = await bundle_tree_digest(app, logger=logging.getLogger())
+            with open(os.path.join(app, "Info.plist"), "wb") as f:
+                f.write(b"changed")
+            changed = await bundle_tree_digest(app, logger=logging.getLogger())
+            self.assertEqual(len({original, executable, changed}), 3)
+
+    def test_supports_bundle_cache(self) -> None:
+        with tempfile.TemporaryDirectory() as root:
+            app = self._make_app(root)
+            self.assertTrue(supports_bundle_cache(app, InstallRequest.APP))
+            self.assertFalse(supports_bundle_cache(app, InstallRequest.DYLIB))
+            self.assertFalse(
+                supports_bundle_cache(
+                    os.path.join(root, "Foo.ipa"), InstallRequest.APP
+                )
+            )
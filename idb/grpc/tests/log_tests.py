@@ -15,10 +15,11 @@ from unittest.mock import AsyncMock, MagicMock, patch
 class MockMessage:
     """Mock gRPC message with output bytes."""
 
-    __slots__ = ["output"]
+    __slots__ = ["output", "lost_bytes"]
 
-    def __init__(self, output: bytes) -> None:
+    def __init__(self, output: bytes, lost_bytes: int = 0) -> None:
         self.output = output
+        self.lost_bytes = lost_bytes
 
 
 class LogDecodingTest(IsolatedAsyncioTestCase):
@@ -131,3 +132,46 @@ class LogDecodingTest(IsolatedAsyncioTestCase):
         combined = "".join(results)
         # The invalid byte should be replaced with the Unicode replacement character
         self.assertEqual(combined, "Hello \ufffd world")
+
+    async def test_tail_specific_logs_reports_lost_output_once(self) -> None:
+        """The running total of dropped bytes is logged only when it grows."""
+        from idb.grpc.client import Client
+        from idb.grpc.idb_pb2 import LogRequest
+
+        messages = [
+            MockMessage(b"a", lost_bytes=0),
+            MockMessage(b"b", lost_bytes=100),
+            MockMessage(b"c", lost_bytes=100),
+            MockMessage(b"d", lost_bytes=250),
+        ]
+
+        mock_stub = MagicMock()
+        mock_stream = AsyncMock()
+        mock_stream.send_message = AsyncMock()
+
+        async def mock_message_iterator() -> AsyncIterator[MockMessage]:
+            for msg in messages:
+                yield msg
+
+        mock_stream.__aenter__ = AsyncMock(return_value=mock_stream)
+        mock_stream.__aexit__ = AsyncMock(return_value=None)
+        mock_stub.log.open = MagicMock(return_value=mock_stream)
+
+        with patch("idb.grpc.client.cancel_wrapper") as mock_cancel_wrapper:
+            mock_cancel_wrapper.return_value = mock_message_iterator()
+
+            client = Client.__new__(Client)
+            client.stub = mock_stub
+            client.logger = MagicMock()
+
+            results = []
+            async for decoded_str in client._tail_specific_logs(
+                source=LogRequest.TARGET,
+                stop=asyncio.Event(),
+                arguments=None,
+            ):
+                results.append(decoded_str)
+
+        self.assertEqual("".join(results), "abcd")
+        self.assertEqual(client.logger.warning.call_count, 2)
+        self.assertIn("dropped 150 bytes", client.logger.warning.call_args.args[0])
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+import asyncio
+import json
+import os
+import tempfile
+from collections import Counter
+from collections.abc import AsyncIterator
+from contextlib import asynccontextmanager
+
+from idb.common.types import IdbException, TestRunInfo
+from idb.grpc.shard import (
+    ShardResult,
+    test_name,
+    TestDurationHistory,
+    XctestShardScheduler,
+)
+from idb.utils.testing import TestCase
+
+# Real seconds per second of test duration in the fakes.
+TIME_SCALE = 0.002
+
+
+class FakeCompanion:
+    """
+    Runs tests by sleeping for their duration, scaled by TIME_SCALE and by its
+    own slowness. It can stop responding after a number of results, and crash
+    the test host at given tests, as a companion that dies or a test that
+    crashes would.
+    """
+
+    def __init__(
+        self,
+        udid: str,
+        durations: dict[str, float],
+        slowness: float = 1.0,
+        fail_after: int | None = None,
+        crashing: frozenset[str] = frozenset(),
+    ) -> None:
+        self.udid = udid
+        self.durations = durations
+        self.slowness = slowness
+        self.fail_after = fail_after
+        self.crashing = crashing
+        self.ran: list[str] = []
+        self.batches: list[set[str]] = []
+
+    async def run_xctest(
+        self, tests_to_run: set[str], **_kwargs: object
+    ) -> AsyncIterator[TestRunInfo]:
+        self.batches.append(tests_to_run)
+        for test in sorted(tests_to_run):
+            if self.fail_after is not None and len(self.ran) >= self.fail_after:
+                raise IdbException(f"{self.udid} went away")
+            class_name, method_name = test.split("/")
+            if test in self.crashing:
+                # The host crashes, and the rest of the batch is never run.
+                yield _result("", "", passed=False, crashed=True)
+                return
+            duration = self.durations.get(test, 1.0)
+            await asyncio.sleep(duration * self.slowness * TIME_SCALE)
+            self.ran.append(test)
+            yield _result(class_name, method_name, duration=duration)
+
+
+class FakeManager:
+    def __init__(self, companions: list[FakeCompanion]) -> None:
+        self.companions: dict[str, FakeCompanion] = {
+            companion.udid: companion for companion in companions
+        }
+
+    @asynccontextmanager
+    async def from_udid(self, udid: str | None) -> AsyncIterator[FakeCompanion]:
+        companion = self.companions.get(str(udid))
+        if companion is None:
+            raise IdbException(f"no companion for {udid}")
+        yield companion
+
+
+def _result(
+    class_name: str,
+    method_name: str,
+    duration: float = 0.0,
+    passed: bool = True,
+    crashed: bool = False,
+) -> TestRunInfo:
+    return TestRunInfo(
+        bundle_name="Tests",
+        class_name=class_name,
+        method_name=method_name,
+        logs=[],
+        duration=duration,
+        passed=passed,
+        failure_info=None,
+        activityLogs=None,
+        crashed=crashed,
+    )
+
+
+def _run_batch(
+    client: FakeCompanion, tests_to_run: set[str]
+) -> AsyncIterator[TestRunInfo]:
+    return client.run_xctest(tests_to_run=tests_to_run)
+
+
+async def _collect(
+    scheduler: XctestShardScheduler, tests: list[str]
+) -> list[ShardResult]:
+    # pyre-ignore
+    return [result async for result in scheduler.run(tests, _run_batch)]
+
+
+class ShardTest(TestCase):
+    def setUp(self) -> None:
+        super().setUp()
+        self.directory = tempfile.TemporaryDirectory()
+        self.history_path: str = os.path.join(self.directory.name, "durations.json")
+
+    def tearDown(self) -> None:
+        self.directory.cleanup()
+        super().tearDown()
+
+    def _history(self, durations: dict[str, float]) -> TestDurationHistory:
+        with open(self.history_path, "w") as f:
+            json.dump({"com.tests": durations, "com.other": {"A/b": 1}}, f)
+        return TestDurationHistory(bundle_id="com.tests", path=self.history_path)
+
+    def test_plan_balances_by_history(self) -> None:
+        history = self._history(
+            {"C/a": 4.0, "C/b": 3.0, "C/c": 2.0, "C/d": 2.0, "C/e": 1.0}
+        )
+        scheduler = XctestShardScheduler(
+            manager=FakeManager([]),  # pyre-ignore
+            udids=["X", "Y"],
+            history=history,
+        )
+        plan = scheduler.plan(["C/e", "C/d", "C/c", "C/b", "C/a", "C/a"])
+        self.assertEqual(plan, {"X": ["C/a", "C/d"], "Y": ["C/b", "C/c", "C/e"]})
+        # Tests that have not run before are expected to take the median.
+        self.assertEqual(history.expected("C/new"), 2.0)
+
+    async def test_results_merge_and_durations_are_saved(self) -> None:
+        durations = {f"C/test{i}": float(i % 5 + 1) for i in range(30)}
+        manager = FakeManager(
+            [FakeCompanion(udid, durations) for udid in ["X", "Y", "Z"]]
+        )
+        scheduler = XctestShardScheduler(
+            manager=manager,  # pyre-ignore
+            udids=["X", "Y", "Z"],
+            history=self._history({}),
+            batch_seconds=5.0,
+        )
+        results = await _collect(scheduler, list(durations))
+        self.assertEqual(
+            Counter(test_name(result.result) for result in results),
+            Counter(list(durations)),
+        )
+        self.assertEqual({result.udid for result in results}, {"X", "Y", "Z"})
+        with open(self.history_path) as f:
+            saved = json.load(f)
+        self.assertEqual(saved["com.tests"], durations)
+        self.assertEqual(saved["com.other"], {"A/b": 1})
+
+    async def test_idle_shards_steal_from_slow_ones(self) -> None:
+        durations = {f"C/test{i:02}": 1.0 for i in range(40)}
+        fast = FakeCompanion("fast", durations)
+        slow = FakeCompanion("slow", durations, slowness=8.0)
+        scheduler = XctestShardScheduler(
+            manager=FakeManager([fast, slow]),  # pyre-ignore
+            udids=["fast", "slow"],
+            batch_seconds=2.0,
+        )
+        planned = scheduler.plan(list(durations))
+        results = await _collect(scheduler, list(durations))
+        self.assertEqual(len(results), 40)
+        self.assertGreater(len(fast.ran), len(planned["fast"]))
+        self.assertTrue(set(fast.ran) & set(planned["slow"]))
+
+    async def test_tests_of_a_failed_target_run_elsewhere(self) -> None:
+        durations = {f"C/test{i:02}": 1.0 for i in range(20)}
+        healthy = FakeCompanion("healthy", durations)
+        failing = FakeCompanion("failing", durations, fail_after=3)
+        scheduler = XctestShardScheduler(
+            manager=FakeManager([healthy, failing]),  # pyre-ignore
+            udids=["healthy", "failing", "unreachable"],
+            batch_seconds=4.0,
+        )
+        results = await _collect(scheduler, list(durations))
+        self.assertEqual(
+            Counter(test_name(result.result) for result in results),
+            Counter(list(durations)),
+        )
+        self.assertEqual(len(failing.ran), 3)
+        self.assertEqual(len(healthy.ran), 17)
+
+    async def test_tests_that_keep_crashing_are_raised_after_the_rest(self) -> None:
+        durations = {f"C/test{i:02}": 1.0 for i in range(10)}
+        companions = [
+            FakeCompanion(udid, durations, crashing=frozenset(["C/test03"]))
+            for udid in ["X", "Y"]
+        ]
+        scheduler = XctestShardScheduler(
+            manager=FakeManager(companions),  # pyre-ignore
+            udids=["X", "Y"],
+            batch_seconds=3.0,
+            max_attempts=2,
+        )
+        names = []
+        with self.assertRaisesRegex(IdbException, "C/test03"):
+            # pyre-ignore
+            async for result in scheduler.run(list(durations), _run_batch):
+                names.append(test_name(result.result))
+        self.assertEqual(
+            Counter(name for name in names if name != "/"),
+            Counter(test for test in durations if test != "C/test03"),
+        )
+        self.assertEqual(
+            sum(
+                "C/test03" in batch
+                for companion in companions
+                for batch in companion.batches
+            ),
+            2,
+        )
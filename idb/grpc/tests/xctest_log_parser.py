@@ -8,6 +8,8 @@
 
 
 import json
+import os
+import tempfile
 from unittest import TestCase
 
 from idb.grpc.xctest_log_parser import XCTestLogParser
@@ -104,3 +106,70 @@ class XCTestLogParserTestCase(TestCase):
         self.assertListEqual(
             parser.get_logs_for_test("MyTestClass", "OtherMethod"), ["123", "456"]
         )
+
+    def test_streaming_releases_logs_once_got(self) -> None:
+        parser = XCTestLogParser(streaming=True)
+        for line in [
+            _begin_test("MyTestClass", "MyTestMethod"),
+            "abc",
+            "def",
+            _end_test("MyTestClass", "MyTestMethod"),
+            _begin_test("MyTestClass", "OtherMethod"),
+            "123",
+        ]:
+            parser.parse_streaming_log(line)
+        self.assertEqual(parser.pending_tests, 2)
+        self.assertListEqual(
+            parser.get_logs_for_test("MyTestClass", "MyTestMethod"), ["abc", "def"]
+        )
+        self.assertEqual(parser.pending_tests, 1)
+        self.assertListEqual(
+            parser.get_logs_for_test("MyTestClass", "MyTestMethod"), []
+        )
+        self.assertListEqual(
+            parser.get_logs_for_test("MyTestClass", "OtherMethod"), ["123"]
+        )
+        self.assertEqual(parser.pending_tests, 0)
+
+    def test_streaming_drops_lines_logged_after_result(self) -> None:
+        parser = XCTestLogParser(streaming=True)
+        parser.parse_streaming_log(_begin_test("MyTestClass", "MyTestMethod"))
+        parser.parse_streaming_log("abc")
+        self.assertListEqual(
+            parser.get_logs_for_test("MyTestClass", "MyTestMethod"), ["abc"]
+        )
+        parser.parse_streaming_log("def")
+        self.assertEqual(parser.pending_tests, 0)
+        parser.parse_streaming_log(_end_test("MyTestClass", "MyTestMethod"))
+        parser.parse_streaming_log(_begin_test("MyTestClass", "MyTestMethod"))
+        parser.parse_streaming_log("ghi")
+        self.assertListEqual(
+            parser.get_logs_for_test("MyTestClass", "MyTestMethod"), ["ghi"]
+        )
+
+    def test_spills_large_tests_to_disk(self) -> None:
+        with tempfile.TemporaryDirectory() as directory:
+            parser = XCTestLogParser(
+                streaming=True, spill_bytes=10, spill_directory=directory
+            )
+            lines = ["line one", 'line "two"\nwith a newline', "line three"]
+            parser.parse_streaming_log(_begin_test("MyTestClass", "MyTestMethod"))
+            for line in lines:
+                parser.parse_streaming_log(line)
+            parser.parse_streaming_log(_begin_test("MyTestClass", "OtherMethod"))
+            parser.parse_streaming_log("small")
+            # The spilled file is unlinked as it is made.
+            self.assertListEqual(os.listdir(directory), [])
+            self.assertListEqual(
+                parser.get_logs_for_test("MyTestClass", "MyTestMethod"), lines
+            )
+            self.assertListEqual(
+                parser.get_logs_for_test("MyTestClass", "OtherMethod"), ["small"]
+            )
+
+    def test_close_releases_pending_logs(self) -> None:
+        parser = XCTestLogParser(streaming=True, spill_bytes=1)
+        parser.parse_streaming_log(_begin_test("MyTestClass", "MyTestMethod"))
+        parser.parse_streaming_log("abc")
+        parser.close()
+        self.assertEqual(parser.pending_tests, 0)
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+# Copyright (c) Meta Platforms, Inc. and affiliates.
+#
+# This source code is licensed under the MIT license found in the
+# LICENSE file in the root directory of this source tree.
+
+# pyre-strict
+
+"""
+Compares the peak memory of XCTestLogParser keeping every test's logs for the
+whole run against streaming them, with and without spilling large tests to disk.
+
+    python -m idb.grpc.tests.xctest_log_parser_benchmark [--tests N] [--lines N]
+        [--result-lag N] [--spill-bytes N]
+
+The stream is synthetic: N tests, each logging a number of lines around --lines,
+with one test in a hundred logging a hundred times as much. Each test's result
+arrives, and its logs are got as in `idb xctest run`, --result-lag tests after it
+ends, as when results are reported in batches. It reports the peak traced
+allocation and the time taken for each mode.
+"""
+
+import argparse
+import json
+import random
+import time
+import tracemalloc
+from collections import deque
+from collections.abc import Iterator
+
+from idb.grpc.xctest_log_parser import XCTestLogParser
+
+
+def _event(event: str, class_name: str, method_name: str) -> str:
+    return json.dumps(
+        {"event": event, "className": class_name, "methodName": method_name}
+    )
+
+
+def _stream(tests: int, lines: int) -> Iterator[tuple[str, str, list[str]]]:
+    rng = random.Random(0)
+    for index in range(tests):
+        class_name = f"Class{index // 20}"
+        method_name = f"testMethod{index}"
+        count = rng.randint(lines // 2, lines * 3 // 2)
+        if index % 100 == 0:
+            count *= 100
+        log = [_event("begin-test", class_name, method_name)]
+        log.extend(
+            f"2024-01-01 00:00:00.000 {class_name} {method_name} verbose line {line}"
+            for line in range(count)
+        )
+        log.append(_event("end-test", class_name, method_name))
+        yield (class_name, method_name, log)
+
+
+def _run(
+    label: str, parser: XCTestLogParser, tests: int, lines: int, result_lag: int
+) -> None:
+    tracemalloc.start()
+    start = time.monotonic()
+    correlated = 0
+    awaiting_results: deque[tuple[str, str]] = deque()
+    for class_name, method_name, log in _stream(tests, lines):
+        for line in log:
+            parser.parse_streaming_log(line)
+        del log
+        awaiting_results.append((class_name, method_name))
+        if len(awaiting_results) > result_lag:
+            correlated += len(parser.get_logs_for_test(*awaiting_results.popleft()))
+    while awaiting_results:
+        correlated += len(parser.get_logs_for_test(*awaiting_results.popleft()))
+    elapsed = time.monotonic() - start
+    _, peak = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+    parser.close()
+    print(
+        f"{label:<16} peak {peak / 1024 / 1024:9.1f}MB  {elapsed:6.2f}s  "
+        f"{correlated} lines correlated over {tests} tests"
+    )
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--tests", type=int, default=10_000)
+    parser.add_argument("--lines", type=int, default=100)
+    parser.add_argument("--result-lag", type=int, default=50)
+    parser.add_argument("--spill-bytes", type=int, default=64 * 1024)
+    args = parser.parse_args()
+
+    for label, log_parser in [
+        ("keep everything", XCTestLogParser()),
+        ("streaming", XCTestLogParser(streaming=True)),
+        (
+            "streaming+spill",
+            XCTestLogParser(streaming=True, spill_bytes=args.spill_bytes),
+        ),
+    ]:
+        _run(label, log_parser, args.tests, args.lines, args.result_lag)
+
+
+if __name__ == "__main__":
+    main()
@@ -11,7 +11,8 @@ import plistlib
 import tempfile
 from unittest import IsolatedAsyncioTestCase
 
-from idb.grpc.xctest import extract_paths_from_xctestrun
+from idb.grpc.idb_pb2 import XctestRunResponse
+from idb.grpc.xctest import extract_paths_from_xctestrun, translate_activity
 
 
 class XCTestsTestCase(IsolatedAsyncioTestCase):
@@ -34,3 +35,38 @@ class XCTestsTestCase(IsolatedAsyncioTestCase):
             self.assertEqual(
                 [file_path, tmp_dir + "/rest1", tmp_dir + "/rest2"], results
             )
+
+    async def test_translate_activity_writes_attachments(self) -> None:
+        activity = XctestRunResponse.TestRunInfo.TestActivity(
+            title="Tap",
+            name="Tap",
+            attachments=[
+                XctestRunResponse.TestRunInfo.TestAttachment(
+                    payload=b"png-bytes",
+                    timestamp=1.5,
+                    name="Screenshot",
+                    uniform_type_identifier="public.png",
+                )
+            ],
+            sub_activities=[
+                XctestRunResponse.TestRunInfo.TestActivity(
+                    name="Assert",
+                    attachments=[
+                        XctestRunResponse.TestRunInfo.TestAttachment(
+                            payload=b"data", timestamp=2.0, name="Dump"
+                        )
+                    ],
+                )
+            ],
+        )
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            translated = translate_activity(activity, tmp_dir)
+            attachment = translated.attachments[0]
+            self.assertEqual(attachment.payload, b"")
+            screenshot_path = os.path.join(tmp_dir, "1.5 - Tap - Screenshot.png")
+            self.assertEqual(attachment.path, screenshot_path)
+            with open(screenshot_path, "rb") as f:
+                self.assertEqual(f.read(), b"png-bytes")
+            with open(os.path.join(tmp_dir, "2.0 - Assert - Dump.data"), "rb") as f:
+                self.assertEqual(f.read(), b"data")
+        self.assertEqual(translate_activity(activity).attachments[0].path, None)
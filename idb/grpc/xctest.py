@@ -170,29 +170,56 @@ async def untar_into_path(
 
 
 def make_results(
-    response: XctestRunResponse, log_parser: XCTestLogParser
+    response: XctestRunResponse,
+    log_parser: XCTestLogParser,
+    attachments_output_path: str | None = None,
 ) -> list[TestRunInfo]:
+    """Makes a TestRunInfo for each result in the response.
+
+    With attachments_output_path, each attachment's payload is written from the
+    response straight to a file under a directory for its test, and the
+    TestAttachment carries that path in place of the payload, so that results
+    kept by the caller do not hold attachment data.
+    """
     return [
-        TestRunInfo(
-            bundle_name=result.bundle_name,
-            class_name=result.class_name,
-            method_name=result.method_name,
-            logs=(
-                list(result.logs)
-                + log_parser.get_logs_for_test(result.class_name, result.method_name)
-            ),
-            duration=result.duration,
-            passed=result.status == XctestRunResponse.TestRunInfo.PASSED,
-            failure_info=(make_failure_info(result) if result.failure_info else None),
-            activityLogs=[
-                translate_activity(activity) for activity in result.activityLogs or []
-            ],
-            crashed=result.status == XctestRunResponse.TestRunInfo.CRASHED,
-        )
+        make_result(result, log_parser, attachments_output_path)
         for result in response.results or []
     ]
 
 
+def make_result(
+    result: XctestRunResponse.TestRunInfo,
+    log_parser: XCTestLogParser,
+    attachments_output_path: str | None = None,
+) -> TestRunInfo:
+    attachments_path = None
+    if attachments_output_path:
+        attachments_path = make_attachments_directory(
+            attachments_output_path,
+            result.bundle_name,
+            result.class_name,
+            result.method_name,
+        )
+    return TestRunInfo(
+        bundle_name=result.bundle_name,
+        class_name=result.class_name,
+        method_name=result.method_name,
+        # A streaming parser releases the test's lines here.
+        logs=(
+            list(result.logs)
+            + log_parser.get_logs_for_test(result.class_name, result.method_name)
+        ),
+        duration=result.duration,
+        passed=result.status == XctestRunResponse.TestRunInfo.PASSED,
+        failure_info=(make_failure_info(result) if result.failure_info else None),
+        activityLogs=[
+            translate_activity(activity, attachments_path)
+            for activity in result.activityLogs or []
+        ],
+        crashed=result.status == XctestRunResponse.TestRunInfo.CRASHED,
+    )
+
+
 def make_failure_info(result: XctestRunResponse.TestRunInfo) -> TestRunFailureInfo:
     if result.other_failures is None or len(result.other_failures) == 0:
         return TestRunFailureInfo(
@@ -224,6 +251,7 @@ def make_failure_info(result: XctestRunResponse.TestRunInfo) -> TestRunFailureIn
 
 def translate_activity(
     activity: XctestRunResponse.TestRunInfo.TestActivity,
+    attachments_path: str | None = None,
 ) -> TestActivity:
     return TestActivity(
         title=activity.title,
@@ -234,38 +262,84 @@ def translate_activity(
         finish=activity.finish,
         name=activity.name,
         attachments=[
-            TestAttachment(
-                payload=attachment.payload,
-                timestamp=attachment.timestamp,
-                name=attachment.name,
-                uniform_type_identifier=attachment.uniform_type_identifier,
-                user_info_json=attachment.user_info_json,
-            )
+            translate_attachment(attachment, activity.name, attachments_path)
             for attachment in activity.attachments or []
         ],
         sub_activities=[
-            translate_activity(sub_activity)
+            translate_activity(sub_activity, attachments_path)
             for sub_activity in activity.sub_activities or []
         ],
     )
 
 
+def translate_attachment(
+    attachment: XctestRunResponse.TestRunInfo.TestAttachment,
+    activity_name: str,
+    attachments_path: str | None,
+) -> TestAttachment:
+    if attachments_path is None:
+        return TestAttachment(
+            payload=attachment.payload,
+            timestamp=attachment.timestamp,
+            name=attachment.name,
+            uniform_type_identifier=attachment.uniform_type_identifier,
+            user_info_json=attachment.user_info_json,
+        )
+    path = os.path.join(
+        attachments_path,
+        attachment_file_name(
+            attachment.timestamp,
+            activity_name,
+            attachment.name,
+            attachment.uniform_type_identifier,
+        ),
+    )
+    with open(path, "wb") as f:
+        f.write(attachment.payload)
+    return TestAttachment(
+        payload=b"",
+        timestamp=attachment.timestamp,
+        name=attachment.name,
+        uniform_type_identifier=attachment.uniform_type_identifier,
+        user_info_json=attachment.user_info_json,
+        path=path,
+    )
+
+
+def make_attachments_directory(
+    activities_output_path: str, bundle_name: str, class_name: str, method_name: str
+) -> str:
+    base_path = os.path.join(
+        activities_output_path, f"{bundle_name} - {class_name} - {method_name}"
+    )
+    os.makedirs(base_path, exist_ok=True)
+    return base_path
+
+
 def save_attachments(run_info: TestRunInfo, activities_output_path: str) -> None:
-    test_name = (
-        f"{run_info.bundle_name} - {run_info.class_name} - {run_info.method_name}"
+    base_path = make_attachments_directory(
+        activities_output_path,
+        run_info.bundle_name,
+        run_info.class_name,
+        run_info.method_name,
     )
-    base_path = os.path.join(activities_output_path, test_name)
-    os.makedirs(base_path)
     for activity in run_info.activityLogs or []:
         save_activities_attachments(activity, base_path)
 
 
 def save_activities_attachments(activity: TestActivity, path: str) -> None:
     for attachment in activity.attachments:
-        extension = attachment_to_file_extension(attachment)
+        if attachment.path is not None:
+            # Already written as the result was made.
+            continue
         attachment_path = os.path.join(
             path,
-            f"{attachment.timestamp} - {activity.name} - {attachment.name}.{extension}",
+            attachment_file_name(
+                attachment.timestamp,
+                activity.name,
+                attachment.name,
+                attachment.uniform_type_identifier,
+            ),
         )
         with open(attachment_path, "wb") as f:
             f.write(attachment.payload)
@@ -273,8 +347,14 @@ def save_activities_attachments(activity: TestActivity, path: str) -> None:
         save_activities_attachments(sub_activity, path)
 
 
-def attachment_to_file_extension(attachment: TestAttachment) -> str:
-    uti = attachment.uniform_type_identifier
+def attachment_file_name(
+    timestamp: float, activity_name: str, name: str, uniform_type_identifier: str
+) -> str:
+    extension = uniform_type_identifier_to_file_extension(uniform_type_identifier)
+    return f"{timestamp} - {activity_name} - {name}.{extension}"
+
+
+def uniform_type_identifier_to_file_extension(uti: str) -> str:
     if uti == "public.jpeg":
         return "jpeg"
     elif uti == "public.png":
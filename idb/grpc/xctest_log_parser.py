@@ -6,8 +6,9 @@
 # pyre-strict
 
 import json
+import tempfile
 from collections import defaultdict
-from typing import Dict, List, NamedTuple, Optional
+from typing import Dict, IO, List, NamedTuple, Optional
 
 
 class XCTestLogParserKey(NamedTuple):
@@ -52,13 +53,95 @@ def _try_parse_event(log_line: str) -> Event | None:
     return None
 
 
+class _TestLogs:
+    """The lines logged by one test, in memory until there are more than
+    spill_bytes of them, then in a temporary file."""
+
+    def __init__(self, spill_bytes: int | None, spill_directory: str | None) -> None:
+        self._lines: list[str] = []
+        self._size = 0
+        self._spill_bytes = spill_bytes
+        self._spill_directory = spill_directory
+        self._spill: IO[str] | None = None
+
+    def append(self, line: str) -> None:
+        spill = self._spill
+        if spill is not None:
+            # Encoded, so that a line containing a newline reads back as one line.
+            spill.write(json.dumps(line))
+            spill.write("\n")
+            return
+        self._lines.append(line)
+        self._size += len(line)
+        if self._spill_bytes is not None and self._size > self._spill_bytes:
+            self._spill_to_disk()
+
+    def take(self) -> list[str]:
+        spill = self._spill
+        if spill is None:
+            lines = self._lines
+        else:
+            spill.seek(0)
+            lines = [json.loads(line) for line in spill]
+            spill.close()
+        self._lines = []
+        self._size = 0
+        self._spill = None
+        return lines
+
+    def close(self) -> None:
+        if self._spill is not None:
+            self._spill.close()
+            self._spill = None
+
+    def _spill_to_disk(self) -> None:
+        spill = tempfile.TemporaryFile(
+            mode="w+",
+            encoding="utf-8",
+            prefix="idb-xctest-log-",
+            dir=self._spill_directory,
+        )
+        for line in self._lines:
+            spill.write(json.dumps(line))
+            spill.write("\n")
+        self._spill = spill
+        self._lines = []
+        self._size = 0
+
+
 class XCTestLogParser:
+    """Correlates the lines of an xctest run's log with the test that logged them.
+
+    By default every line is kept for the whole run, and get_logs_for_test can be
+    called for a test any number of times. In streaming mode a test's lines are
+    released once they are got, as its result arrives, so memory follows the tests
+    that have not reported yet rather than the whole run. Lines the running test
+    logs after its result has been got are dropped, as there is no result left to
+    carry them.
+
+    In streaming mode, spill_bytes moves the lines of any test that logs more than
+    about that many bytes to a temporary file until they are got. Sizes are counted
+    in characters, which is close for the mostly ASCII lines of a log and saves
+    encoding each one.
+    """
+
     _logs: XCTestLogParserData
     _current_test: XCTestLogParserKey | None
 
-    def __init__(self) -> None:
+    def __init__(
+        self,
+        streaming: bool = False,
+        spill_bytes: int | None = None,
+        spill_directory: str | None = None,
+    ) -> None:
         self._logs = defaultdict(list)
         self._current_test = None
+        # Whether the running test's result has been made, in streaming mode.
+        self._current_test_taken = False
+        self.streaming = streaming
+        self._spill_bytes = spill_bytes
+        self._spill_directory = spill_directory
+        self._pending: dict[XCTestLogParserKey, _TestLogs] = {}
 
     def parse_streaming_log(self, line: str) -> None:
         event = _try_parse_event(line)
@@ -69,14 +152,50 @@ class XCTestLogParser:
                 className=event.className,
                 methodName=event.methodName,
             )
+            self._current_test_taken = False
         elif event.event == "end-test":
             self._current_test = None
+            self._current_test_taken = False
 
     def get_logs_for_test(self, class_name: str, method_name: str) -> list[str]:
+        if self.streaming:
+            return self.take_logs_for_test(class_name, method_name)
         key = XCTestLogParserKey(className=class_name, methodName=method_name)
         return self._logs[key]
 
+    def take_logs_for_test(self, class_name: str, method_name: str) -> list[str]:
+        """Returns the lines logged by a test so far, and releases them."""
+        key = XCTestLogParserKey(className=class_name, methodName=method_name)
+        if not self.streaming:
+            return self._logs.pop(key, [])
+        if key == self._current_test:
+            self._current_test_taken = True
+        logs = self._pending.pop(key, None)
+        return [] if logs is None else logs.take()
+
+    @property
+    def pending_tests(self) -> int:
+        """The number of tests with lines that have not been taken."""
+        return len(self._pending) if self.streaming else len(self._logs)
+
+    def close(self) -> None:
+        """Releases the lines of every test, including any spilled to disk."""
+        for logs in self._pending.values():
+            logs.close()
+        self._pending.clear()
+        self._logs.clear()
+
     def _append_line_to_test(self, line: str) -> None:
         key = self._current_test
-        if key is not None:
+        if key is None:
+            return
+        if not self.streaming:
             self._logs[key].append(line)
+            return
+        if self._current_test_taken:
+            return
+        logs = self._pending.get(key)
+        if logs is None:
+            logs = _TestLogs(self._spill_bytes, self._spill_directory)
+            self._pending[key] = logs
+        logs.append(line)